@@ -0,0 +1,33 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark/AllocationCounter.h"
+
+using namespace std;
+
+// The replacements are kept in their own translation unit, so that
+// they are not inlined into the code allocating and releasing memory.
+
+static atomic<size_t> numAllocations(0);
+
+void* operator new(size_t size) {
+    ++numAllocations;
+    void* p = malloc(size == 0 ? 1 : size);
+    if ( p == nullptr ) throw bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+size_t getNumAllocations()
+{
+    return numAllocations;
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_BENCHMARK_ALLOCATIONCOUNTER_H_
+#define FSM_BENCHMARK_ALLOCATIONCOUNTER_H_
+
+#include <cstddef>
+
+/**
+ Return the number of heap allocations performed so far by this
+ program. The counter is maintained by the replacements of the global
+ operator new in AllocationCounter.cpp, which are linked into the
+ benchmarks only.
+ */
+size_t getNumAllocations();
+
+#endif //FSM_BENCHMARK_ALLOCATIONCOUNTER_H_
@@ -0,0 +1,360 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <interface/FsmPresentationLayer.h>
+#include <fsm/ConformanceChecker.h>
+#include <fsm/Dfsm.h>
+#include <fsm/Fsm.h>
+#include <fsm/FsmNode.h>
+#include <fsm/FsmTransition.h>
+#include <fsm/InputTrace.h>
+#include <trees/IOListContainer.h>
+#include <trees/OutputTree.h>
+#include <trees/SuffixSharingTree.h>
+#include <trees/TestSuite.h>
+#include <trees/Tree.h>
+#include "benchmark/AllocationCounter.h"
+
+using namespace std;
+
+/**
+ * Run an algorithm once and report the size of its result, its
+ * run time and the number of heap allocations it performs.
+ */
+template <typename Generator>
+void benchmark(const string& name, const string& unit, Generator gen) {
+    
+    size_t allocBefore = getNumAllocations();
+    auto start = chrono::steady_clock::now();
+    size_t resultSize = gen();
+    auto stop = chrono::steady_clock::now();
+    
+    cout << name << ": "
+    << resultSize << " " << unit << ", "
+    << chrono::duration_cast<chrono::milliseconds>(stop - start).count()
+    << " ms, "
+    << (getNumAllocations() - allocBefore) << " allocations" << endl;
+}
+
+/**
+ * Benchmark the W-Method and the H-Method on a minimised random
+ * DFSM with 500 states, and the W-Method and the Wp-Method with three
+ * additional states on a minimised random DFSM with 400 states, whose
+ * W-Method test suite is also executed without expanding its test tree.
+ * Traces and trees created by the generators share the presentation
+ * layer of the DFSM instead of copying it, so the allocation counts
+ * are a measure for this overhead.
+ */
+void benchmarkTestGeneration() {
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    Dfsm d("BENCH",500,1,1,pl);
+    Dfsm dMin = d.minimise();
+    
+    cout << "Benchmark on minimised random DFSM with "
+    << dMin.size() << " states" << endl;
+    
+    benchmark("W-Method", "test cases", [&dMin]() {
+        return dMin.wMethodOnMinimisedDfsm(0).size();
+    });
+    benchmark("H-Method", "test cases", [&dMin]() {
+        return dMin.hMethodOnMinimisedDfsm(0).size();
+    });
+    
+    Dfsm dWide("BENCH",400,3,3,pl);
+    Dfsm dWideMin = dWide.minimise();
+    benchmark("W-Method on 400 states, m=3", "test cases", [&dWideMin]() {
+        return dWideMin.wMethodOnMinimisedDfsm(3).size();
+    });
+    benchmark("Wp-Method on 400 states, m=3", "test cases", [&dWideMin]() {
+        return dWideMin.wpMethod(3).size();
+    });
+    benchmark("Streamed execution of the W-Method on 400 states, m=3", "output trees", [&dWideMin]() {
+        SuffixSharingTree wTree = dWideMin.wMethodTreeOnMinimisedDfsm(3);
+        size_t numOutputTrees = 0;
+        dWideMin.createTestSuite([&wTree](const IOListContainer::IOListVisitor& visitor) {
+            wTree.forEachIOList(visitor);
+        }, [&numOutputTrees](const OutputTree&) {
+            numOutputTrees++;
+        });
+        return numOutputTrees;
+    });
+    
+    IOListContainer testCases = dMin.wMethodOnMinimisedDfsm(2);
+    benchmark("Fsm::apply() per test case of the W-Method, m=2", "output trees", [&dMin, &testCases]() {
+        TestSuite suite;
+        for ( auto const &trc : testCases.getIOLists() ) {
+            suite.push_back(dMin.apply(InputTrace(trc,dMin.getPresentationLayer())));
+        }
+        return suite.size();
+    });
+    benchmark("Fsm::createTestSuite() of the W-Method, m=2", "output trees", [&dMin, &testCases]() {
+        return dMin.createTestSuite(testCases).size();
+    });
+}
+
+/**
+ * Benchmark the minimisation of a random DFSM with 10000 states,
+ * both by Pk-tables (Dfsm::minimise()) and by OFSM-tables
+ * (Fsm::minimiseObservableFSM()), and the OFSM-table minimisation
+ * of a random DFSM with a large alphabet.
+ */
+void benchmarkMinimisation() {
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    Dfsm d("BENCH",10000,3,3,pl);
+    
+    cout << "Benchmark on random DFSM with "
+    << d.size() << " states" << endl;
+    
+    benchmark("Dfsm::minimise()", "states", [&d]() {
+        return d.minimise().size();
+    });
+    benchmark("Fsm::minimiseObservableFSM()", "states", [&d]() {
+        return d.minimiseObservableFSM().size();
+    });
+    
+    Dfsm dLarge("BENCH",2000,15,15,pl);
+    
+    cout << "Benchmark on random DFSM with "
+    << dLarge.size() << " states and 16 inputs and outputs" << endl;
+    
+    benchmark("Fsm::minimiseObservableFSM()", "states", [&dLarge]() {
+        return dLarge.minimiseObservableFSM().size();
+    });
+    
+    Dfsm dHuge("BENCH",50000,3,3,pl);
+    
+    cout << "Benchmark on random DFSM with "
+    << dHuge.size() << " states" << endl;
+    
+    benchmark("Fsm::minimiseObservableFSM()", "states", [&dHuge]() {
+        return dHuge.minimiseObservableFSM().size();
+    });
+}
+
+/**
+ * Benchmark the transformation of a nondeterministic FSM with 5000
+ * states into an observable FSM. The FSM is the union of a random
+ * DFSM with 2500 states and a mutant of it with output faults,
+ * sharing the initial state.
+ */
+void benchmarkObservable() {
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    Dfsm d("BENCH",2500,3,3,pl);
+    unique_ptr<Fsm> m = d.createMutant("BENCH_M",100,0);
+    
+    const int n = static_cast<int>(d.size());
+    vector<unique_ptr<FsmNode>> lst;
+    for ( int i = 0; i < 2 * n; i++ ) {
+        lst.emplace_back(new FsmNode(i, "BENCH"));
+    }
+    for ( int i = 0; i < n; i++ ) {
+        for ( auto const &tr : d.getNodes()[i]->getTransitions() ) {
+            unique_ptr<FsmTransition> t { new FsmTransition(lst[i].get(),
+                lst[tr->getTarget()->getId()].get(), *tr->getLabel()) };
+            lst[i]->addTransition(std::move(t));
+        }
+        // The mutant's initial state is merged with node 0, the
+        // initial state of the union
+        FsmNode* src = (i == 0) ? lst[0].get() : lst[n + i].get();
+        for ( auto const &tr : m->getNodes()[i]->getTransitions() ) {
+            unique_ptr<FsmTransition> t { new FsmTransition(src,
+                lst[n + tr->getTarget()->getId()].get(), *tr->getLabel()) };
+            src->addTransition(std::move(t));
+        }
+    }
+    Fsm f("BENCH",d.getMaxInput(),d.getMaxOutput(),std::move(lst),pl);
+    
+    cout << "Benchmark on nondeterministic FSM with "
+    << f.size() << " states" << endl;
+    
+    benchmark("Fsm::transformToObservableFSM()", "states", [&f]() {
+        return f.transformToObservableFSM().size();
+    });
+}
+
+/**
+ * Benchmark the intersection of a random DFSM with 20000 states
+ * and a mutant of it, and the equivalence check of the mutant and
+ * of the DFSM itself against the DFSM, reporting the length of the
+ * counterexample found.
+ */
+void benchmarkIntersection() {
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    Dfsm d("BENCH",20000,3,3,pl);
+    unique_ptr<Fsm> m = d.createMutant("BENCH_M",100,100);
+    
+    cout << "Benchmark on random DFSM and mutant with "
+    << d.size() << " states" << endl;
+    
+    benchmark("Fsm::intersect()", "states", [&d, &m]() {
+        return d.intersect(*m).size();
+    });
+    benchmark("ConformanceChecker::isEquivalent() on mutant", "counterexample length", [&d, &m]() {
+        ConformanceChecker checker(*m,d);
+        return checker.isEquivalent() ? 0 : checker.getCounterexample()->getInputTrace().size();
+    });
+    benchmark("ConformanceChecker::isEquivalent() on DFSM", "counterexample length", [&d]() {
+        ConformanceChecker checker(d,d);
+        return checker.isEquivalent() ? 0 : checker.getCounterexample()->getInputTrace().size();
+    });
+}
+
+/**
+ * Benchmark the calculation of the characterisation set of a
+ * minimised random DFSM with 3000 states, using a single thread
+ * and one thread per hardware thread, and the calculation of the
+ * state identification sets of a minimised random DFSM with 500 states.
+ */
+void benchmarkCharacterisationSet() {
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    Dfsm d("BENCH",3000,3,3,pl);
+    Dfsm dMin = d.minimise();
+    
+    cout << "Benchmark on minimised random DFSM with "
+    << dMin.size() << " states" << endl;
+    
+    for ( unsigned numThreads : { 1, 0 } ) {
+        Dfsm copy(dMin);
+        copy.setNumThreads(numThreads);
+        benchmark(numThreads == 1 ? "Dfsm::getCharacterisationSet(), 1 thread"
+                                  : "Dfsm::getCharacterisationSet(), all threads",
+                  "traces", [&copy]() {
+            return copy.getCharacterisationSet().size();
+        });
+    }
+    
+    Dfsm dSmall("BENCH",500,3,3,pl);
+    Dfsm dSmallMin = dSmall.minimise();
+    dSmallMin.getCharacterisationSet();
+    
+    cout << "Benchmark on minimised random DFSM with "
+    << dSmallMin.size() << " states" << endl;
+    
+    for ( unsigned numThreads : { 1, 0 } ) {
+        dSmallMin.setNumThreads(numThreads);
+        benchmark(numThreads == 1 ? "Fsm::calcStateIdentificationSets(), 1 thread"
+                                  : "Fsm::calcStateIdentificationSets(), all threads",
+                  "states", [&dSmallMin]() {
+            dSmallMin.calcStateIdentificationSets();
+            return dSmallMin.size();
+        });
+    }
+}
+
+/**
+ * Benchmark the construction of a test tree over 200 inputs, consisting
+ * of all traces of length 1 and 2 extended by 20 random traces of
+ * length 2, and the lookup of random traces of length 3 in this tree.
+ */
+void benchmarkTrees() {
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    srand(1);
+    IOListContainer::IOListBaseType w;
+    for ( int i = 0; i < 20; i++ ) {
+        w.push_back({ rand() % 200, rand() % 200 });
+    }
+    
+    Tree tree(pl);
+    benchmark("Tree::add() over 200 inputs", "nodes", [&tree, &w, &pl]() {
+        tree.addToRoot(IOListContainer(199,1,2,pl));
+        tree.add(IOListContainer(w,pl));
+        return tree.size();
+    });
+    benchmark("TreeNode::after() over 200 inputs", "traces found", [&tree]() {
+        size_t found = 0;
+        vector<int> trc(3);
+        for ( int i = 0; i < 2000000; i++ ) {
+            for ( int &x : trc ) x = rand() % 200;
+            if ( tree.getRoot()->after(trc.cbegin(), trc.cend()) != nullptr ) found++;
+        }
+        return found;
+    });
+}
+
+/**
+ * Benchmark FsmNode::distinguished() on all pairs of states of a random
+ * DFSM and of a random observable FSM, for all input traces up to
+ * length 4. The queries are run once before, so that the scratch
+ * buffers of the lockstep simulation have grown and the allocation
+ * counts show the allocations per query run.
+ */
+void benchmarkDistinguished() {
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    Dfsm d("BENCH",50,1,2,pl);
+    Fsm o = Fsm::createRandomFsm("BENCH",1,2,12,pl,1)->transformToObservableFSM();
+    
+    // All input traces of length 0..4
+    vector<vector<int>> traces { { } };
+    for ( size_t k = 0; k < traces.size(); k++ ) {
+        if ( traces[k].size() == 4 ) continue;
+        for ( int x = 0; x <= 1; x++ ) {
+            traces.push_back(traces[k]);
+            traces.back().push_back(x);
+        }
+    }
+    
+    for ( const Fsm* f : { static_cast<const Fsm*>(&d), static_cast<const Fsm*>(&o) } ) {
+        auto query = [f, &traces]() {
+            size_t numDistinguished = 0;
+            for ( auto const &n1 : f->getNodes() ) {
+                for ( auto const &n2 : f->getNodes() ) {
+                    for ( auto const &itrc : traces ) {
+                        if ( n1->distinguished(n2.get(),itrc) ) numDistinguished++;
+                    }
+                }
+            }
+            return numDistinguished;
+        };
+        query();
+        
+        cout << "Benchmark on " << (f == &d ? "random DFSM" : "random observable FSM")
+        << " with " << f->size() << " states" << endl;
+        
+        benchmark("FsmNode::distinguished()", "positive queries", query);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    
+    if ( argc > 1 and string(argv[1]) == "minimise" ) {
+        benchmarkMinimisation();
+    }
+    else if ( argc > 1 and string(argv[1]) == "observable" ) {
+        benchmarkObservable();
+    }
+    else if ( argc > 1 and string(argv[1]) == "intersect" ) {
+        benchmarkIntersection();
+    }
+    else if ( argc > 1 and string(argv[1]) == "charset" ) {
+        benchmarkCharacterisationSet();
+    }
+    else if ( argc > 1 and string(argv[1]) == "trees" ) {
+        benchmarkTrees();
+    }
+    else if ( argc > 1 and string(argv[1]) == "distinguished" ) {
+        benchmarkDistinguished();
+    }
+    else {
+        benchmarkTestGeneration();
+    }
+    
+    exit(0);
+    
+}
@@ -50,7 +50,7 @@ static string testSuiteFileName;
 static string fsmSutName;
 
 
-static FsmPresentationLayer *pl = nullptr;
+static shared_ptr<const FsmPresentationLayer> pl = nullptr;
 static shared_ptr<Dfsm> dfsmSut = nullptr;
 
 static bool isDeterministic = true;
@@ -131,94 +131,83 @@ static void readSUTModel() {
     }
     
     if ( dfsmSut != nullptr ) {
+        pl = dfsmSut->getPresentationLayer();
         dfsmSut->toDot(fsmSutName);
     }
      
 }
 
-static void getNextIO(char** p, char** x, char** y) {
-    
-    *x = NULL;
-    *y = NULL;
-    
-    char* aux;
-    
-    while ( **p != 0 && **p != '(' ) (*p)++;
-    if ( **p == 0 ) return;
-    
-    (*p)++;
-    aux = strchr(*p,'/');
-    if ( aux == NULL ) return;
-    
-    *x = *p;
-    *aux = 0;
-    
-    *p = aux+1;
-    aux = strchr(*p,')');
-    if ( aux == NULL ) return;
-    
-    *y = *p;
-    *aux = 0;
+/**
+ * Write an IO trace to standard output, in the same format
+ * as used by operator<< for IOTrace instances.
+ */
+static void printIOTrace(const vector<int>& inVec, const vector<int>& outVec) {
     
-    *p = aux + 1;
+    for ( size_t i = 0; i < inVec.size(); i++ ) {
+        if ( i > 0 ) cout << ".";
+        cout << pl->getInId(inVec[i]);
+    }
+    cout << "/";
+    for ( size_t i = 0; i < outVec.size(); i++ ) {
+        if ( i > 0 ) cout << ".";
+        cout << pl->getOutId(outVec[i]);
+    }
     
 }
 
-static void executeTestCase(const char* tcId, char* line) {
+/**
+ * Return the name of the input (or output) of the i-th IO pair
+ * (x/y) of a test case line, as it occurs in the line.
+ */
+static string getIOName(const char* line, size_t i, bool output) {
     
-    char* p = line;
-    char* x = 0;
-    char* y = 0;
-    int xInt;
-    int yInt;
     string theLine(line);
-    vector<int> inVec;
-    vector<int> outVec;
+    size_t pos = 0;
+    for ( size_t k = 0; k <= i; k++ ) {
+        pos = theLine.find('(',pos);
+        if ( pos == string::npos ) return string();
+        pos++;
+    }
+    size_t slash = theLine.find('/',pos);
+    size_t close = theLine.find(')',slash);
+    if ( output ) return theLine.substr(slash + 1,close - slash - 1);
+    return theLine.substr(pos,slash - pos);
     
+}
+
+static void executeTestCase(const char* tcId, const char* line) {
     
+    // Re-used across test cases, so that symbolising a line
+    // does not allocate once the vectors have reached their size
+    static vector<int> inVec;
+    static vector<int> outVec;
     
     printf("%s",tcId);
     
+    if ( not pl->ioLine2Num(line,inVec,outVec) ) {
+        cerr << "Could not parse test case " << line << endl;
+        return;
+    }
     
-    
-    while ( *p ) {
-        
-        getNextIO(&p,&x,&y);
-        
-        if ( x != NULL && y != NULL ) {
-            xInt = pl->in2Num(x).value();
-            yInt = pl->out2Num(y).value();
-        }
-        else {
-            cerr << "Could not parse test case " << theLine << endl;
+    for ( size_t i = 0; i < inVec.size(); i++ ) {
+        if ( inVec[i] < 0 ) {
+            cerr << "Unknown input " << getIOName(line,i,false)
+            << " in test case " << line << endl;
             return;
         }
-        
-        if ( xInt < 0 ) {
-            cerr << "Unknown input " << x
-            << " i test case " << theLine << endl;
-        }
-        else if ( yInt < 0 ) {
+        if ( outVec[i] < 0 ) {
             cout << "FAIL: SUT does not produce expected output "
-            << y << " occurring in test case " << theLine << endl;
+            << getIOName(line,i,true) << " occurring in test case " << line << endl;
             return;
         }
-        
-        inVec.push_back(xInt);
-        outVec.push_back(yInt);
-        
     }
     
     
-    InputTrace inTrace(inVec,pl->clone());
-    OutputTrace outTrace(outVec,pl->clone());
-    
-    IOTrace io(inTrace,outTrace);
-    
-    
-    cout << "Check IO Trace " << io << ": ";
+    cout << "Check IO Trace ";
+    printIOTrace(inVec,outVec);
+    cout << ": ";
     
-    if ( dfsmSut->pass(io) ) {
+    if ( dfsmSut->pass(inVec,outVec) ) {
         printf(" PASS\n");
     }
     else {
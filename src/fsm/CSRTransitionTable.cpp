@@ -0,0 +1,249 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <unordered_map>
+
+#include "fsm/CSRTransitionTable.h"
+#include "fsm/Fsm.h"
+#include "fsm/FsmNode.h"
+#include "fsm/FsmTransition.h"
+
+using namespace std;
+
+namespace {
+    struct CSREntry {
+        int input;
+        int output;
+        int target;
+    };
+
+    /**
+     * Paths followed by response(), reused across calls: the state
+     * reached by every path, the number of outputs produced and the
+     * outputs, stored with a stride of the length of the input trace
+     */
+    struct ResponseBuffers {
+        vector<int> states;
+        vector<int> nextStates;
+        vector<int> lengths;
+        vector<int> nextLengths;
+        vector<int> outputs;
+        vector<int> nextOutputs;
+        vector<int> order;
+    };
+
+    thread_local ResponseBuffers buffers;
+}
+
+CSRTransitionTable::CSRTransitionTable(const Fsm& fsm)
+: maxInput(fsm.getMaxInput()),
+maxOutput(fsm.getMaxOutput()),
+initStateIdx(-1)
+{
+    auto const &nodes = fsm.getNodes();
+
+    // Map nodes to their positions in the node list - node ids
+    // usually coincide with these positions, but this is not enforced.
+    unordered_map<FsmNode const*, int> node2Idx;
+    node2Idx.reserve(nodes.size());
+    size_t numTransitions = 0;
+    for ( size_t n = 0; n < nodes.size(); n++ ) {
+        node2Idx[nodes[n].get()] = static_cast<int>(n);
+        numTransitions += nodes[n]->getTransitions().size();
+        if ( nodes[n].get() == fsm.getInitialState() ) {
+            initStateIdx = static_cast<int>(n);
+        }
+    }
+
+    offset.reserve(nodes.size() + 1);
+    input.reserve(numTransitions);
+    output.reserve(numTransitions);
+    target.reserve(numTransitions);
+
+    vector<CSREntry> entries;
+    for ( auto const &n : nodes ) {
+        offset.push_back(static_cast<int>(target.size()));
+
+        entries.clear();
+        for ( auto const &tr : n->getTransitions() ) {
+            entries.push_back({ tr->getLabel()->getInput(),
+                tr->getLabel()->getOutput(),
+                node2Idx.at(tr->getTarget()) });
+        }
+
+        // Stable sorting preserves the original transition order
+        // among transitions carrying the same input
+        stable_sort(entries.begin(), entries.end(),
+                    [](CSREntry const &a, CSREntry const &b) {
+                        return a.input < b.input;
+                    });
+
+        for ( auto const &e : entries ) {
+            input.push_back(e.input);
+            output.push_back(e.output);
+            target.push_back(e.target);
+        }
+    }
+    offset.push_back(static_cast<int>(target.size()));
+}
+
+pair<int, int> CSRTransitionTable::range(const int s, const int x) const
+{
+    auto first = input.begin() + offset[s];
+    auto last = input.begin() + offset[s + 1];
+    auto lo = lower_bound(first, last, x);
+    auto hi = upper_bound(lo, last, x);
+    return make_pair(static_cast<int>(lo - input.begin()),
+                     static_cast<int>(hi - input.begin()));
+}
+
+vector<int> CSRTransitionTable::after(const vector<int>& states,
+                                      const vector<int>& itrc) const
+{
+    vector<int> current(states);
+    vector<int> next;
+
+    for ( int x : itrc ) {
+        next.clear();
+        for ( int s : current ) {
+            auto r = range(s, x);
+            next.insert(next.end(), target.begin() + r.first, target.begin() + r.second);
+        }
+        sort(next.begin(), next.end());
+        next.erase(unique(next.begin(), next.end()), next.end());
+        current.swap(next);
+        if ( current.empty() ) break;
+    }
+
+    return current;
+}
+
+void CSRTransitionTable::image(const StateSet& states, const int x, StateSet& result) const
+{
+    result.clear();
+    states.forEach([this, x, &result](int s) {
+        auto r = range(s, x);
+        for ( int t = r.first; t < r.second; t++ ) {
+            result.insert(target[t]);
+        }
+    });
+}
+
+StateSet CSRTransitionTable::after(const StateSet& states,
+                                   const vector<int>& itrc) const
+{
+    StateSet current(states);
+    StateSet next(size());
+    
+    for ( int x : itrc ) {
+        image(current, x, next);
+        swap(current, next);
+        if ( current.empty() ) break;
+    }
+    
+    return current;
+}
+
+void CSRTransitionTable::response(const int s, const vector<int>& itrc, vector<int>& result) const
+{
+    auto &states = buffers.states;
+    auto &nextStates = buffers.nextStates;
+    auto &lengths = buffers.lengths;
+    auto &nextLengths = buffers.nextLengths;
+    auto &outputs = buffers.outputs;
+    auto &nextOutputs = buffers.nextOutputs;
+    auto &order = buffers.order;
+    const size_t stride = itrc.size();
+
+    states.assign(1, s);
+    lengths.assign(1, 0);
+    outputs.resize(stride);
+    for ( int x : itrc ) {
+        nextStates.clear();
+        nextLengths.clear();
+        nextOutputs.clear();
+        for ( size_t p = 0; p < states.size(); p++ ) {
+            auto first = outputs.begin() + p * stride;
+            auto r = range(states[p], x);
+            if ( r.first == r.second ) {
+                // Undefined inputs leave the path unchanged
+                nextStates.push_back(states[p]);
+                nextLengths.push_back(lengths[p]);
+                nextOutputs.insert(nextOutputs.end(), first, first + stride);
+                continue;
+            }
+            for ( int t = r.first; t < r.second; t++ ) {
+                nextStates.push_back(target[t]);
+                nextLengths.push_back(lengths[p] + 1);
+                nextOutputs.insert(nextOutputs.end(), first, first + stride);
+                nextOutputs[nextOutputs.size() - stride + lengths[p]] = output[t];
+            }
+        }
+        states.swap(nextStates);
+        lengths.swap(nextLengths);
+        outputs.swap(nextOutputs);
+    }
+
+    // Sort the output traces of the paths and drop duplicates
+    auto less = [&](int p1, int p2) {
+        auto first1 = outputs.begin() + p1 * stride;
+        auto first2 = outputs.begin() + p2 * stride;
+        return lexicographical_compare(first1, first1 + lengths[p1],
+                                       first2, first2 + lengths[p2]);
+    };
+    auto equal = [&](int p1, int p2) {
+        auto first1 = outputs.begin() + p1 * stride;
+        auto first2 = outputs.begin() + p2 * stride;
+        return lengths[p1] == lengths[p2] and
+            std::equal(first1, first1 + lengths[p1], first2);
+    };
+    order.resize(states.size());
+    for ( size_t p = 0; p < order.size(); p++ ) order[p] = static_cast<int>(p);
+    sort(order.begin(), order.end(), less);
+    order.erase(unique(order.begin(), order.end(), equal), order.end());
+
+    result.clear();
+    for ( int p : order ) {
+        auto first = outputs.begin() + p * stride;
+        result.push_back(lengths[p]);
+        result.insert(result.end(), first, first + lengths[p]);
+    }
+}
+
+bool CSRTransitionTable::isObservable(const int s) const
+{
+    // Transitions are sorted by input, so transitions with equal
+    // labels can only occur within the same input slice
+    for ( int t = offset[s]; t < offset[s + 1]; t++ ) {
+        for ( int other = t + 1;
+             other < offset[s + 1] and input[other] == input[t];
+             other++ ) {
+            if ( output[other] == output[t] ) return false;
+        }
+    }
+    return true;
+}
+
+bool CSRTransitionTable::isObservable() const
+{
+    for ( int s = 0; s < size(); s++ ) {
+        if ( not isObservable(s) ) return false;
+    }
+    return true;
+}
+
+bool CSRTransitionTable::isCompletelyDefined() const
+{
+    for ( int s = 0; s < size(); s++ ) {
+        // Inputs are sorted, so counting the distinct ones suffices
+        int numInputs = 0;
+        for ( int t = begin(s); t < end(s); t++ ) {
+            if ( t == begin(s) or input[t] != input[t - 1] ) ++ numInputs;
+        }
+        if ( numInputs != maxInput + 1 ) return false;
+    }
+    return true;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_CSRTRANSITIONTABLE_H_
+#define FSM_FSM_CSRTRANSITIONTABLE_H_
+
+#include <utility>
+#include <vector>
+
+#include "fsm/StateSet.h"
+
+class Fsm;
+
+/**
+ Class representing the transition relation of an FSM in
+ compressed sparse row (CSR) format.
+
+ The outgoing transitions of state s are stored at the positions
+ offset[s] .. offset[s+1]-1 of the arrays input, output and target.
+ Within each state, transitions are sorted by input, so that all
+ transitions labelled with a given input form one contiguous slice
+ which can be located by binary search. Inside a slice, the original
+ order of the transitions is preserved.
+
+ States are identified by their index in Fsm::getNodes(). Every
+ transition costs 12 bytes, so that traversals stream through memory
+ instead of chasing FsmTransition and FsmLabel pointers.
+
+ The table is a snapshot: it does not reflect changes applied to the
+ FSM after its creation.
+ */
+class CSRTransitionTable
+{
+private:
+    /** Maximal value of the input alphabet in range 0..maxInput */
+    int maxInput;
+
+    /** Maximal value of the output alphabet in range 0..maxOutput */
+    int maxOutput;
+
+    /** Index of the initial state, or -1 if the FSM has none */
+    int initStateIdx;
+
+    /** offset[s] is the position of the first transition of state s */
+    std::vector<int> offset;
+
+    /** Input, output and target state of each transition */
+    std::vector<int> input;
+    std::vector<int> output;
+    std::vector<int> target;
+
+public:
+    /**
+     * Create the CSR representation of the transition relation of an FSM
+     * @param fsm The FSM whose transitions are copied into the table
+     */
+    CSRTransitionTable(const Fsm& fsm);
+
+    /** Return the number of states */
+    int size() const { return static_cast<int>(offset.size()) - 1; }
+
+    /** Return the number of transitions */
+    int getNumTransitions() const { return static_cast<int>(target.size()); }
+
+    int getMaxInput() const { return maxInput; }
+    int getMaxOutput() const { return maxOutput; }
+    int getInitStateIdx() const { return initStateIdx; }
+
+    /** Position of the first outgoing transition of state s */
+    int begin(const int s) const { return offset[s]; }
+
+    /** Position after the last outgoing transition of state s */
+    int end(const int s) const { return offset[s + 1]; }
+
+    int getInput(const int t) const { return input[t]; }
+    int getOutput(const int t) const { return output[t]; }
+    int getTarget(const int t) const { return target[t]; }
+
+    /**
+     * Locate the transitions of state s labelled with input x
+     * @return Pair [first,last) of transition positions; the
+     *         range is empty if x is undefined in s
+     */
+    std::pair<int, int> range(const int s, const int x) const;
+
+    /**
+     * Calculate the set of states reachable from a set of states
+     * by applying an input trace.
+     * @param states Sorted list of start states without duplicates
+     * @param itrc   Input trace
+     * @return Sorted list of the states reached, without duplicates
+     */
+    std::vector<int> after(const std::vector<int>& states,
+                           const std::vector<int>& itrc) const;
+
+    /**
+     * Calculate the image of a set of states under input x.
+     * @param states Set of start states
+     * @param x      Input
+     * @param result On return, the set of states reachable from a member
+     *               of states by a transition labelled with input x. The
+     *               set must range over the states of this table.
+     */
+    void image(const StateSet& states, const int x, StateSet& result) const;
+
+    /**
+     * Calculate the set of states reachable from a set of states
+     * by applying an input trace.
+     * @param states Set of start states
+     * @param itrc   Input trace
+     * @return Set of the states reached
+     */
+    StateSet after(const StateSet& states, const std::vector<int>& itrc) const;
+
+    /**
+     * Calculate the response of state s to an input trace, i.e. the set
+     * of output traces produced when applying the trace in s. As in
+     * FsmNode::apply(), inputs undefined in a state reached are skipped.
+     * @param s      Start state
+     * @param itrc   Input trace
+     * @param result On return, the sorted list of output traces without
+     *               duplicates, every output trace preceded by its length,
+     *               so that two states have equal responses if and only
+     *               if their results coincide
+     */
+    void response(const int s, const std::vector<int>& itrc, std::vector<int>& result) const;
+
+    /**
+     * Check whether state s has at most one transition
+     * for every input/output label
+     */
+    bool isObservable(const int s) const;
+
+    /** Check whether every state of the table is observable */
+    bool isObservable() const;
+
+    /**
+     * Check whether every state has at least one transition
+     * for every input
+     */
+    bool isCompletelyDefined() const;
+};
+#endif //FSM_FSM_CSRTRANSITIONTABLE_H_
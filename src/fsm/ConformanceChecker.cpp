@@ -0,0 +1,230 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+
+#include "fsm/ConformanceChecker.h"
+#include "fsm/CSRTransitionTable.h"
+#include "fsm/Fsm.h"
+#include "fsm/InputTrace.h"
+#include "fsm/IOTrace.h"
+#include "fsm/OutputTrace.h"
+
+using namespace std;
+
+namespace {
+
+    /** Transition given by input, output and target state */
+    typedef tuple<int, int, int> Entry;
+
+    /** A node of the breadth-first search */
+    struct SearchNode {
+        /** States of the implementation and of the reference FSM */
+        vector<int> impl;
+        vector<int> ref;
+        /** Predecessor node, or -1 for the initial node */
+        int parent;
+        /** Label of the transition from the predecessor */
+        int input;
+        int output;
+    };
+
+    /** Hash of a sorted list of state indices */
+    struct KeyHash {
+        size_t operator()(const vector<int>& key) const {
+            uint64_t h = key.size();
+            for ( int s : key ) {
+                h ^= static_cast<uint64_t>(s) + 0x9e3779b97f4a7c15ULL + (h << 12) + (h >> 4);
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+    /**
+     * Collect the outgoing transitions of a set of states, ordered by
+     * label and target state, without duplicates
+     */
+    void collect(const LabelIndex& idx, const vector<int>& states, vector<Entry>& trans) {
+        trans.clear();
+        for ( int s : states ) {
+            for ( int t = idx.begin(s); t < idx.end(s); t++ ) {
+                trans.emplace_back(idx.getInput(t), idx.getOutput(t), idx.getTarget(t));
+            }
+        }
+        if ( states.size() > 1 ) {
+            sort(trans.begin(), trans.end());
+            trans.erase(unique(trans.begin(), trans.end()), trans.end());
+        }
+    }
+
+    /** Compare the labels of two transitions */
+    int compareLabels(const Entry& e1, const Entry& e2) {
+        if ( get<0>(e1) != get<0>(e2) ) return get<0>(e1) < get<0>(e2) ? -1 : 1;
+        if ( get<1>(e1) != get<1>(e2) ) return get<1>(e1) < get<1>(e2) ? -1 : 1;
+        return 0;
+    }
+
+    /**
+     * Append the targets of the transitions with the same label as
+     * trans[k] to targets, and return the position after them
+     */
+    size_t labelTargets(const vector<Entry>& trans, size_t k, vector<int>& targets) {
+        targets.clear();
+        const Entry& first = trans[k];
+        for ( ; k < trans.size() and compareLabels(trans[k], first) == 0; k++ ) {
+            targets.push_back(get<2>(trans[k]));
+        }
+        return k;
+    }
+
+}
+
+ConformanceChecker::ConformanceChecker(const Fsm& impl, const Fsm& ref)
+: presentationLayer(ref.getPresentationLayer()),
+  implCsr(impl.getCSRTransitionTable()),
+  refCsr(ref.getCSRTransitionTable()),
+  implIdx(*implCsr),
+  refIdx(*refCsr)
+{
+}
+
+bool ConformanceChecker::isEquivalent()
+{
+    return check(false);
+}
+
+bool ConformanceChecker::isReduction()
+{
+    return check(true);
+}
+
+bool ConformanceChecker::check(const bool reduction)
+{
+    counterexample = nullptr;
+
+    // An FSM without initial state only has the empty trace, so that
+    // its initial search node has no states
+    vector<int> implInit;
+    vector<int> refInit;
+    if ( implCsr->getInitStateIdx() >= 0 ) implInit.push_back(implCsr->getInitStateIdx());
+    if ( refCsr->getInitStateIdx() >= 0 ) refInit.push_back(refCsr->getInitStateIdx());
+    if ( implInit.empty() and (reduction or refInit.empty()) ) return true;
+
+    vector<SearchNode> nodes;
+    nodes.push_back({ implInit, refInit, -1, -1, -1 });
+
+    // Equivalence: search nodes by their implementation states, -1
+    // and their reference states. Reduction: the search nodes of each
+    // implementation state whose reference sets form an antichain.
+    unordered_map<vector<int>, int, KeyHash> nodeOfKey;
+    vector< vector<int> > antichain(reduction ? implCsr->size() : 0);
+    if ( reduction ) {
+        antichain[nodes[0].impl[0]].push_back(0);
+    }
+    else {
+        vector<int> key(implInit);
+        key.push_back(-1);
+        key.insert(key.end(), refInit.begin(), refInit.end());
+        nodeOfKey.emplace(std::move(key), 0);
+    }
+
+    // Record the trace to node n, extended by label x/y, as counterexample
+    auto setCounterexample = [this, &nodes](int n, const int x, const int y) {
+        vector<int> inputs { x };
+        vector<int> outputs { y };
+        for ( ; nodes[n].parent >= 0; n = nodes[n].parent ) {
+            inputs.push_back(nodes[n].input);
+            outputs.push_back(nodes[n].output);
+        }
+        reverse(inputs.begin(), inputs.end());
+        reverse(outputs.begin(), outputs.end());
+        counterexample = make_shared<IOTrace>(InputTrace(inputs, presentationLayer),
+                                              OutputTrace(outputs, presentationLayer));
+    };
+
+    // Add the successor of node n under label x/y, unless it is
+    // already known or, for reductions, subsumed by a known node
+    auto addNode = [&](const int n, vector<int>& impl, vector<int>& ref,
+                       const int x, const int y) {
+        if ( reduction ) {
+            vector<int>& sets = antichain[impl[0]];
+            for ( int m : sets ) {
+                const vector<int>& known = nodes[m].ref;
+                if ( known.size() <= ref.size() and
+                    includes(ref.begin(), ref.end(), known.begin(), known.end()) ) {
+                    return;
+                }
+            }
+            // Drop the sets subsumed by the new one
+            sets.erase(remove_if(sets.begin(), sets.end(), [&nodes, &ref](const int m) {
+                const vector<int>& known = nodes[m].ref;
+                return includes(known.begin(), known.end(), ref.begin(), ref.end());
+            }), sets.end());
+            sets.push_back(static_cast<int>(nodes.size()));
+        }
+        else {
+            vector<int> key(impl);
+            key.push_back(-1);
+            key.insert(key.end(), ref.begin(), ref.end());
+            if ( not nodeOfKey.emplace(std::move(key), static_cast<int>(nodes.size())).second ) {
+                return;
+            }
+        }
+        nodes.push_back({ impl, ref, n, x, y });
+    };
+
+    vector<Entry> implTrans;
+    vector<Entry> refTrans;
+    vector<int> implTargets;
+    vector<int> refTargets;
+    vector<int> implTarget(1);
+    for ( size_t next = 0; next < nodes.size(); next++ ) {
+        const int n = static_cast<int>(next);
+        collect(implIdx, nodes[n].impl, implTrans);
+        collect(refIdx, nodes[n].ref, refTrans);
+
+        // Both transition lists are ordered by label: labels occurring
+        // in one list only are counterexamples (for reductions, only
+        // those of the implementation), labels occurring in both lead
+        // to successor nodes
+        size_t a = 0;
+        size_t b = 0;
+        while ( a < implTrans.size() or b < refTrans.size() ) {
+            int cmp = (a == implTrans.size()) ? 1 :
+                      (b == refTrans.size()) ? -1 :
+                      compareLabels(implTrans[a], refTrans[b]);
+            if ( cmp < 0 ) {
+                setCounterexample(n, get<0>(implTrans[a]), get<1>(implTrans[a]));
+                return false;
+            }
+            if ( cmp > 0 ) {
+                if ( not reduction ) {
+                    setCounterexample(n, get<0>(refTrans[b]), get<1>(refTrans[b]));
+                    return false;
+                }
+                b = labelTargets(refTrans, b, refTargets);
+                continue;
+            }
+
+            const int x = get<0>(implTrans[a]);
+            const int y = get<1>(implTrans[a]);
+            a = labelTargets(implTrans, a, implTargets);
+            b = labelTargets(refTrans, b, refTargets);
+            if ( reduction ) {
+                // Implementation states are explored separately
+                for ( int i : implTargets ) {
+                    implTarget[0] = i;
+                    addNode(n, implTarget, refTargets, x, y);
+                }
+            }
+            else {
+                addNode(n, implTargets, refTargets, x, y);
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_CONFORMANCECHECKER_H_
+#define FSM_FSM_CONFORMANCECHECKER_H_
+
+#include <memory>
+#include <vector>
+
+#include "fsm/LabelIndex.h"
+
+class CSRTransitionTable;
+class Fsm;
+class FsmPresentationLayer;
+class IOTrace;
+
+/**
+ Class checking whether an implementation FSM is I/O-equivalent to, or
+ a reduction of, a reference FSM, without creating test suites or the
+ complete product of both FSMs.
+
+ The constructor indexes the transitions of both FSMs by label (see
+ LabelIndex), in time and memory linear in their size. Only the search
+ over the product is restricted to the nodes that are reached.
+
+ The I/O traces of both FSMs are explored simultaneously in
+ breadth-first order. A node of the search consists of the sets of
+ implementation and reference states reached by the same I/O trace;
+ for observable FSMs these sets are singletons, so that the search
+ runs over the reachable part of the synchronous product. The search
+ stops at the first I/O trace that can be executed by only one of the
+ FSMs (equivalence) or by the implementation only (reduction), which
+ is therefore a shortest counterexample.
+
+ For reductions, the search node (i,S) is pruned if a node (i,T) with
+ T a subset of S has already been found: every counterexample reached
+ from (i,S) is also reached from (i,T), by a trace that is not longer.
+ For each implementation state only the minimal sets (an antichain)
+ are kept.
+
+ For completely specified FSMs, the results coincide with those of
+ TestSuite::isEquivalentTo() and TestSuite::isReductionOf() applied to
+ exhaustive test suites.
+ */
+class ConformanceChecker
+{
+private:
+    /** Presentation layer of the reference FSM, used for counterexamples */
+    std::shared_ptr<const FsmPresentationLayer> presentationLayer;
+
+    /** Transitions of the implementation and reference FSM */
+    std::shared_ptr<const CSRTransitionTable> implCsr;
+    std::shared_ptr<const CSRTransitionTable> refCsr;
+    LabelIndex implIdx;
+    LabelIndex refIdx;
+
+    /** Counterexample found by the last check, or nullptr */
+    std::shared_ptr<IOTrace> counterexample;
+
+    /**
+     * Explore the I/O traces of both FSMs until a counterexample
+     * has been found or all reachable search nodes are processed
+     * @param reduction true to check for a reduction, false to
+     *        check for equivalence
+     * @return true if and only if no counterexample exists
+     */
+    bool check(const bool reduction);
+
+public:
+    /**
+     * Create a checker for an implementation and a reference FSM
+     * over the same input and output alphabets
+     */
+    ConformanceChecker(const Fsm& impl, const Fsm& ref);
+
+    /**
+     * Check whether the implementation FSM produces exactly the
+     * same I/O traces as the reference FSM
+     */
+    bool isEquivalent();
+
+    /**
+     * Check whether every I/O trace of the implementation FSM is
+     * also an I/O trace of the reference FSM
+     */
+    bool isReduction();
+
+    /**
+     * Return a shortest I/O trace violating the relation checked
+     * last, or nullptr if the check has passed
+     */
+    std::shared_ptr<IOTrace> getCounterexample() const { return counterexample; }
+};
+#endif //FSM_FSM_CONFORMANCECHECKER_H_
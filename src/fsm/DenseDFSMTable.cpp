@@ -0,0 +1,74 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include "fsm/DenseDFSMTable.h"
+#include "fsm/CSRTransitionTable.h"
+
+using namespace std;
+
+DenseDFSMTable::DenseDFSMTable(const CSRTransitionTable& csr)
+: numInputs(csr.getMaxInput() + 1),
+initStateIdx(csr.getInitStateIdx())
+{
+    next.assign(static_cast<size_t>(csr.size()) * numInputs, -1);
+    out.assign(static_cast<size_t>(csr.size()) * numInputs, -1);
+    
+    for ( int s = 0; s < csr.size(); s++ ) {
+        for ( int t = csr.begin(s); t < csr.end(s); t++ ) {
+            int x = csr.getInput(t);
+            if ( x < 0 or x >= numInputs ) continue;
+            size_t idx = static_cast<size_t>(s) * numInputs + x;
+            if ( next[idx] >= 0 ) continue;
+            next[idx] = csr.getTarget(t);
+            out[idx] = csr.getOutput(t);
+        }
+    }
+}
+
+bool DenseDFSMTable::isCompletelyDefined() const
+{
+    for ( int nxt : next ) {
+        if ( nxt < 0 ) return false;
+    }
+    return true;
+}
+
+int DenseDFSMTable::apply(const int s, const vector<int>& itrc, vector<int>& otrc) const
+{
+    otrc.clear();
+    int current = s;
+    for ( int x : itrc ) {
+        int nxt = getNext(current, x);
+        if ( nxt < 0 ) break;
+        otrc.push_back(getOutput(current, x));
+        current = nxt;
+    }
+    return current;
+}
+
+int DenseDFSMTable::after(const int s, const vector<int>& itrc) const
+{
+    int current = s;
+    for ( int x : itrc ) {
+        if ( current < 0 ) break;
+        current = getNext(current, x);
+    }
+    return current;
+}
+
+bool DenseDFSMTable::pass(const int s, const vector<int>& itrc, const vector<int>& otrc) const
+{
+    int current = s;
+    size_t k = 0;
+    for ( ; k < itrc.size() and current >= 0; k++ ) {
+        int nxt = getNext(current, itrc[k]);
+        if ( nxt < 0 ) break;
+        if ( k >= otrc.size() or getOutput(current, itrc[k]) != otrc[k] ) {
+            return false;
+        }
+        current = nxt;
+    }
+    return k == otrc.size();
+}
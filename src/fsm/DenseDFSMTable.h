@@ -0,0 +1,91 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_DENSEDFSMTABLE_H_
+#define FSM_FSM_DENSEDFSMTABLE_H_
+
+#include <vector>
+
+class CSRTransitionTable;
+
+/**
+ Class representing a deterministic FSM as flat next-state and
+ output arrays, indexed by state * (maxInput + 1) + input.
+ Undefined transitions are marked by -1 in both arrays.
+
+ The table is intended for replaying large numbers of traces:
+ every simulation step is a single array access, and none of the
+ simulation operations allocates memory.
+ */
+class DenseDFSMTable
+{
+private:
+    /** Number of inputs, i.e. maxInput + 1 */
+    int numInputs;
+
+    /** Index of the initial state, or -1 if the FSM has none */
+    int initStateIdx;
+
+    /** next[s * numInputs + x] is the post-state of s under x, or -1 */
+    std::vector<int> next;
+
+    /** out[s * numInputs + x] is the output of s under x, or -1 */
+    std::vector<int> out;
+
+public:
+    /**
+     * Compile the transition relation of a deterministic FSM.
+     * If a state has several transitions for the same input, only the
+     * first one is used, as in FsmNode::apply(const int, OutputTrace&).
+     * @param csr Transition relation in CSR format
+     */
+    DenseDFSMTable(const CSRTransitionTable& csr);
+
+    /** Return the number of states */
+    int size() const { return numInputs == 0 ? 0 : static_cast<int>(next.size()) / numInputs; }
+
+    int getInitStateIdx() const { return initStateIdx; }
+
+    /** Return the number of inputs, i.e. maxInput + 1 */
+    int getNumInputs() const { return numInputs; }
+
+    /** Return true if every state has a transition for every input */
+    bool isCompletelyDefined() const;
+
+    /** Return the post-state of s under input x, or -1 if undefined */
+    int getNext(const int s, const int x) const {
+        return (x < 0 or x >= numInputs) ? -1 : next[s * numInputs + x];
+    }
+
+    /** Return the output of s under input x, or -1 if undefined */
+    int getOutput(const int s, const int x) const {
+        return (x < 0 or x >= numInputs) ? -1 : out[s * numInputs + x];
+    }
+
+    /**
+     * Apply an input trace to state s, as far as it is accepted.
+     * @param s     Start state
+     * @param itrc  Input trace
+     * @param otrc  Output buffer; on return it contains the outputs of
+     *              the longest accepted prefix of itrc. The buffer is
+     *              cleared, but its capacity is reused.
+     * @return The state reached after the accepted prefix
+     */
+    int apply(const int s, const std::vector<int>& itrc, std::vector<int>& otrc) const;
+
+    /**
+     * Return the state reached from s by input trace itrc,
+     * or -1 if itrc is not completely accepted in s.
+     */
+    int after(const int s, const std::vector<int>& itrc) const;
+
+    /**
+     * Check whether the IO trace itrc/otrc is in the language of
+     * state s. This is the case if and only if the outputs produced
+     * for the accepted prefix of itrc equal otrc.
+     */
+    bool pass(const int s, const std::vector<int>& itrc, const std::vector<int>& otrc) const;
+};
+#endif //FSM_FSM_DENSEDFSMTABLE_H_
@@ -3,13 +3,19 @@
  *
  * Licensed under the EUPL V.1.1
  */
+#include "fsm/CSRTransitionTable.h"
+#include "fsm/DenseDFSMTable.h"
+#include "fsm/DistinguishingOracle.h"
 #include "fsm/Dfsm.h"
 #include "fsm/FsmNode.h"
 #include "fsm/FsmTransition.h"
+#include "fsm/HopcroftPartition.h"
 #include "fsm/PkTable.h"
+#include "fsm/SplittingTree.h"
 #include "fsm/DFSMTableRow.h"
 #include "fsm/InputTrace.h"
 #include "fsm/IOTrace.h"
+#include "trees/SuffixSharingTree.h"
 #include "trees/Tree.h"
 
 using namespace std;
@@ -315,8 +321,7 @@ void Dfsm::createDfsmTransitionGraph(const string& fname) {
             tableEntry.erase(tableEntry.find_last_not_of(" \n\r\t\"")+1);
             if ( tableEntry.empty() ) {
                 tgtNode = currentParsedNode;
-                std::unique_ptr<FsmLabel> lbl { new FsmLabel(x,0,presentationLayer.get()) };
-                std::unique_ptr<FsmTransition> tr { new FsmTransition(currentParsedNode,tgtNode,std::move(lbl)) };
+                std::unique_ptr<FsmTransition> tr { new FsmTransition(currentParsedNode,tgtNode,FsmLabel(x,0)) };
                 currentParsedNode->addTransition(std::move(tr));
             }
             else {
@@ -356,8 +361,7 @@ void Dfsm::createDfsmTransitionGraph(const string& fname) {
                     : presentationLayer->out2Num(outStr);
                     
                     if ( static_cast<bool>(y) ) {
-                        std::unique_ptr<FsmLabel> lbl { new FsmLabel(x,y.value(),presentationLayer.get()) };
-                        std::unique_ptr<FsmTransition> tr { new FsmTransition(currentParsedNode,tgtNode,std::move(lbl)) };
+                        std::unique_ptr<FsmTransition> tr { new FsmTransition(currentParsedNode,tgtNode,FsmLabel(x,y.value())) };
                         currentParsedNode->addTransition(std::move(tr));
                     }
                     
@@ -395,17 +399,17 @@ Dfsm::Dfsm(const string & fname,
            const string & fsmName) : Fsm(nullptr)   {
     dfsmTable = nullptr;
     name = fsmName;
-    presentationLayer = createPresentationLayerFromCsvFormat(fname)->clone();
+    presentationLayer = createPresentationLayerFromCsvFormat(fname);
     createDfsmTransitionGraph(fname);
 }
 
 Dfsm::Dfsm(const string & fname,
            const string & fsmName,
-           std::unique_ptr<FsmPresentationLayer> &&pl) : Fsm(nullptr)   {
+           const std::shared_ptr<const FsmPresentationLayer>& pl) : Fsm(nullptr)   {
     
     dfsmTable = nullptr;
     name = fsmName;
-    presentationLayer = createPresentationLayerFromCsvFormat(fname,pl.get())->clone();
+    presentationLayer = createPresentationLayerFromCsvFormat(fname,pl.get());
     createDfsmTransitionGraph(fname);
 }
 
@@ -431,17 +435,20 @@ void Dfsm::createAtRandom()
             std::unique_ptr<FsmTransition> transition { 
                     new FsmTransition(source,
                                       target,
-                                      std::unique_ptr<FsmLabel>(new FsmLabel(input,
-                                                                             output,
-                                                                             presentationLayer.get()))) };
+                                      FsmLabel(input,output)) };
             source->addTransition(std::move(transition));
         }
     }
 }
 
-vector<shared_ptr<PkTable> > Dfsm::getPktblLst() const
+shared_ptr<PkTable> Dfsm::getPkTable() const
 {
-    return pktblLst;
+    return pkTable;
+}
+
+shared_ptr<const SplittingTree> Dfsm::getPkSplittingTree() const
+{
+    return pkSplittingTree;
 }
 
 shared_ptr<DFSMTable> Dfsm::toDFSMTable() const
@@ -471,22 +478,22 @@ shared_ptr<DFSMTable> Dfsm::toDFSMTable() const
     return tbl;
 }
 
-Dfsm::Dfsm(const string & fname, const string & fsmName, const int maxNodes, const int maxInput, const int maxOutput, std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-: Fsm(fname, fsmName, maxNodes, maxInput, maxOutput, std::move(presentationLayer))
+Dfsm::Dfsm(const string & fname, const string & fsmName, const int maxNodes, const int maxInput, const int maxOutput, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+: Fsm(fname, fsmName, maxNodes, maxInput, maxOutput, presentationLayer)
 {
     dfsmTable = nullptr;
 }
 
 Dfsm::Dfsm(const string& fname,
-           std::unique_ptr<FsmPresentationLayer> &&presentationLayer,
+           const std::shared_ptr<const FsmPresentationLayer>& presentationLayer,
            const string & fsmName)
-: Fsm(fname,std::move(presentationLayer),fsmName)
+: Fsm(fname,presentationLayer,fsmName)
 {
     dfsmTable = nullptr;
 }
 
-Dfsm::Dfsm(const string & fsmName, const int maxNodes, const int maxInput, const int maxOutput, std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-: Fsm(std::move(presentationLayer))
+Dfsm::Dfsm(const string & fsmName, const int maxNodes, const int maxInput, const int maxOutput, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+: Fsm(presentationLayer)
 {
     dfsmTable = nullptr;
     name = fsmName;
@@ -508,8 +515,8 @@ Dfsm::Dfsm(const string & fsmName,
            const int maxInput,
            const int maxOutput,
            std::vector<std::unique_ptr<FsmNode>> &&lst,
-           std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-: Fsm(fsmName, maxInput, maxOutput, std::move(lst), std::move(presentationLayer))
+           const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+: Fsm(fsmName, maxInput, maxOutput, std::move(lst), presentationLayer)
 {
     dfsmTable = nullptr;
 }
@@ -687,8 +694,7 @@ Fsm()
                 << endl;
                 exit(1);
             }
-            std::unique_ptr<FsmLabel> theLabel { new FsmLabel(x.value(),y.value(),presentationLayer.get()) };
-            std::unique_ptr<FsmTransition> tr { new FsmTransition(srcNode,tgtNode,std::move(theLabel)) };
+            std::unique_ptr<FsmTransition> tr { new FsmTransition(srcNode,tgtNode,FsmLabel(x.value(),y.value())) };
             
             // Record the requirements satisfied by the transition
             Json::Value satisfies = transition["requirements"];
@@ -729,8 +735,7 @@ Fsm()
         }
         for ( int x = 0; x <= maxInput; x++ ) {
             if ( not inputs[x] ) {
-                std::unique_ptr<FsmLabel> theLabel { new FsmLabel(x,theNopNo,presentationLayer.get()) };
-                std::unique_ptr<FsmTransition> tr { new FsmTransition(n.get(),n.get(),std::move(theLabel)) };
+                std::unique_ptr<FsmTransition> tr { new FsmTransition(n.get(),n.get(),FsmLabel(x,theNopNo)) };
                 n->addTransition(std::move(tr));
             }
         }
@@ -913,8 +918,7 @@ Fsm()
                 << endl;
                 exit(1);
             }
-            std::unique_ptr<FsmLabel> theLabel { new FsmLabel(x.value(),y.value(),presentationLayer.get()) };
-            std::unique_ptr<FsmTransition> tr { new FsmTransition(srcNode,tgtNode,std::move(theLabel)) };
+            std::unique_ptr<FsmTransition> tr { new FsmTransition(srcNode,tgtNode,FsmLabel(x.value(),y.value())) };
             
             // Record the requirements satisfied by the transition
             Json::Value satisfies = transition["requirements"];
@@ -955,8 +959,7 @@ Fsm()
         }
         for ( int x = 0; x <= maxInput; x++ ) {
             if ( not inputs[x] ) {
-                std::unique_ptr<FsmLabel> theLabel { new FsmLabel(x,theNopNo.value(),presentationLayer.get()) };
-                std::unique_ptr<FsmTransition> tr { new FsmTransition(n.get(),n.get(),std::move(theLabel)) };
+                std::unique_ptr<FsmTransition> tr { new FsmTransition(n.get(),n.get(),FsmLabel(x,theNopNo.value())) };
                 n->addTransition(std::move(tr));
             }
         }
@@ -970,23 +973,20 @@ void Dfsm::calcPkTables() {
     
     dfsmTable = toDFSMTable();
     
-    pktblLst.clear();
-    shared_ptr<PkTable> p1 = dfsmTable->getP1Table();
-    pktblLst.push_back(p1);
-    
-    for (shared_ptr<PkTable> pk = p1->getPkPlusOneTable();
+    // Only the splitting tree of the sequence P_1, P_2, ... and its
+    // last table are kept
+    pkSplittingTree = make_shared<SplittingTree>(static_cast<int>(nodes.size()));
+    for (shared_ptr<PkTable> pk = dfsmTable->getP1Table();
          pk != nullptr;
          pk = pk->getPkPlusOneTable())
     {
-        pktblLst.push_back(pk);
+        pkSplittingTree->refine(pk->getS2C());
+        pkTable = pk;
     }
     
 #if 0
     cout << "MINIMISE" << endl;
-    for (auto p : pktblLst) {
-        
-        cout << *p << endl;
-    }
+    cout << *pkTable << endl;
 #endif
     
 }
@@ -998,14 +998,75 @@ Dfsm Dfsm::minimise()
     std::vector<std::unique_ptr<FsmNode>> uNodes;
     removeUnreachableNodes(uNodes);
     
+    if ( getDenseDFSMTable()->isCompletelyDefined() ) {
+        pkTable = nullptr;
+        pkSplittingTree = nullptr;
+        calcPartition();
+        
+        auto dfsm = partition->toFsm(maxOutput, *presentationLayer);
+        dfsm.calcPartition();
+        return dfsm;
+    }
+    
+    partition = nullptr;
     calcPkTables();
-    shared_ptr<PkTable> pMin = pktblLst[pktblLst.size()-1];
+    shared_ptr<PkTable> pMin = pkTable;
     
     auto dfsm = pMin->toFsm(name, maxOutput);
     dfsm.calcPkTables();
     return dfsm;
 }
 
+void Dfsm::calcPartition()
+{
+    partition = make_shared<HopcroftPartition>(getDenseDFSMTable());
+}
+
+int Dfsm::getMinimisedStateIdx(const int n) const
+{
+    if ( partition != nullptr ) {
+        return partition->getClass(n);
+    }
+    return pkTable->getClass(n);
+}
+
+void Dfsm::calcDistinguishingOracle(const size_t maxBytes)
+{
+    distOracleMaxBytes = maxBytes;
+    distOracleSource = getDenseDFSMTable();
+    distOracle = distOracleSource->isCompletelyDefined() ?
+    DistinguishingOracle::create(distOracleSource, maxBytes) : nullptr;
+}
+
+const DistinguishingOracle* Dfsm::getDistinguishingOracle()
+{
+    if ( distOracleSource != getDenseDFSMTable() ) {
+        calcDistinguishingOracle(distOracleMaxBytes);
+    }
+    return distOracle.get();
+}
+
+InputTrace Dfsm::calcDistinguishingTrace(FsmNode *s1, FsmNode *s2)
+{
+    if ( auto oracle = getDistinguishingOracle() ) {
+        return InputTrace(oracle->calcDistinguishingTrace(s1->getId(), s2->getId()),
+                          presentationLayer);
+    }
+    
+    if ( pkSplittingTree == nullptr ) {
+        if ( partition == nullptr and getDenseDFSMTable()->isCompletelyDefined() ) {
+            calcPartition();
+        }
+        if ( partition != nullptr ) {
+            return InputTrace(partition->calcDistinguishingTrace(s1->getId(), s2->getId()),
+                              presentationLayer);
+        }
+        calcPkTables();
+    }
+    
+    return s1->calcDistinguishingTrace(s2, *pkSplittingTree, maxInput);
+}
+
 void Dfsm::printTables() const
 {
     ofstream file("tables.tex");
@@ -1014,75 +1075,38 @@ void Dfsm::printTables() const
         file << *dfsmTable;
     }
     
-    for (const auto &i : pktblLst) {
-        file << *i << endl << endl;
+    if (pkTable != nullptr)
+    {
+        file << *pkTable << endl << endl;
     }
     file.close();
 }
 
 IOListContainer Dfsm::getCharacterisationSet()
 {
-    /*Create Pk-tables for the minimised FSM*/
-    dfsmTable = toDFSMTable();
-    pktblLst.clear();
-    shared_ptr<PkTable> p1 = dfsmTable->getP1Table();
-    pktblLst.push_back(p1);
-    
-    for (shared_ptr<PkTable> pk = p1->getPkPlusOneTable();
-         pk != nullptr;
-         pk = pk->getPkPlusOneTable())
-    {
-        pktblLst.push_back(pk);
+    /*Create Pk-tables for the minimised FSM, unless the distinguishing
+     traces are provided by the distinguishing oracle*/
+    if ( getDistinguishingOracle() == nullptr ) {
+        calcPkTables();
     }
     
     
 #if 0
     
     cout << "Dfsm::getCharacterisationSet()" << endl;
-    cout << *p1 << endl;
-    for (auto p : pktblLst) {
-        
-        cout << *p << endl;
-    }
+    cout << *pkTable << endl;
     
 #endif
     
     /*Create an empty characterisation set as an empty InputTree instance*/
-    characterisationSet.reset(new Tree(presentationLayer->clone()));
+    characterisationSet.reset(new Tree(presentationLayer));
     
     /*Loop over all non-equal pairs of states. If they are not already distinguished by
      the input sequences contained in w, create a new input traces that distinguishes them
-     and add it to w.*/
-    for (unsigned int left = 0; left < nodes.size(); ++ left)
-    {
-        FsmNode *leftNode = nodes.at(left).get();
-        for (unsigned int right = left + 1; right < nodes.size(); ++ right)
-        {
-            FsmNode *rightNode = nodes.at(right).get();
-            
-            if (leftNode->distinguished(rightNode, characterisationSet.get()) != nullptr)
-            {
-                continue;
-            }
-            
-            /*We have to create a new input trace and add it to w, because
-             leftNode and rightNode are not distinguished by the current
-             input traces contained in w. This step is performed
-             according to Gill's algorithm.*/
-            InputTrace i = leftNode->calcDistinguishingTrace(rightNode, pktblLst, maxInput);
-            IOListContainer::IOListBaseType lli;
-            lli.push_back(i.get());
-            IOListContainer tcli = IOListContainer(lli, presentationLayer->clone());
-            characterisationSet->addToRoot(tcli);
-            
-#if 0
-            cout << "Distinguishing trace for " << nodes[left]->getName()
-            << " and " << nodes[right]->getName() << ": " << endl;
-            cout << i << endl;
-#endif
-            
-        }
-    }
+     and add it to w. This step is performed according to Gill's algorithm.*/
+    addDistinguishingTraces(*characterisationSet, [this](FsmNode *leftNode, FsmNode *rightNode) {
+        return calcDistinguishingTrace(leftNode, rightNode);
+    });
     
 #if 0
     /* CHECK */
@@ -1110,61 +1134,55 @@ IOListContainer Dfsm::getCharacterisationSet()
     return tcl;
 }
 
+std::shared_ptr<const DenseDFSMTable> Dfsm::getDenseDFSMTable() const
+{
+    std::shared_ptr<const CSRTransitionTable> csr = getCSRTransitionTable();
+    if ( denseTable == nullptr or denseTableSource != csr ) {
+        denseTable = make_shared<DenseDFSMTable>(*csr);
+        denseTableSource = csr;
+    }
+    return denseTable;
+}
+
 IOTrace Dfsm::applyDet(const InputTrace & i)
 {
-    OutputTrace o = OutputTrace(presentationLayer->clone());
+    vector<int> o;
     
-    FsmNode *currentNode = nodes.at(initStateIdx).get();
-    
-    // Apply input trace to FSM, as far as possible
-    for ( int input : i.get() ) {
-        if ( currentNode == nullptr ) break;
-        currentNode = currentNode->apply(input, o);
+    // Apply input trace to FSM, as far as possible. If the initial
+    // node does not exist, an empty IOTrace is returned.
+    if ( not nodes.empty() ) {
+        auto dense = getDenseDFSMTable();
+        dense->apply(dense->getInitStateIdx(), i.get(), o);
     }
     
-    // Handle the case where the very first input is not accpeted
-    // by the incomplete DFSM, or even the initial node does not exist:
-    // we return an empty IOTrace
-    if (currentNode == nullptr && o.get().empty())
-    {
-        return IOTrace(InputTrace(presentationLayer->clone()),
-                       OutputTrace(presentationLayer->clone()));
-    }
+    // If only a prefix of the input trace has been accepted by
+    // the incomplete DFSM, the IOTrace consists of this prefix,
+    // together with the associated outputs.
+    // @note The number of inputs processed equals o.size()
+    auto ifirst = i.cbegin();
+    auto ilast = ifirst + o.size();
     
-    // Handle the case where only a prefix of the input trace
-    // has been accepted by the incomplete DFSM: we return
-    // an IOTrace whose input consist of this prefix, together
-    // with the associated outputs already contained in o.
-    if (currentNode == nullptr)
-    {
-        
-        // Constant iterator to start of input trace.
-        auto ifirst = i.cbegin();
-        // Iterator pointing BEHIND the last input applied
-        // @note The number of inputs processed so far equals o.size()
-        auto ilast = ifirst + o.get().size();
-        
-        // Constant iterator to start of output trace.
-        auto ofirst = o.cbegin();
-        // Iterator pointing BEHIND last obtained output.
-        auto olast = ofirst + o.get().size();
-        
-        return IOTrace(InputTrace(vector<int>(ifirst, ilast), presentationLayer->clone()),
-                       OutputTrace(vector<int>(ofirst, olast), presentationLayer->clone()));
-        
-    }
-    
-    // The full input trace has been processed by the DFSM.
-    // The associated outputs are contained in o.
-    return IOTrace(InputTrace(i.get(), presentationLayer->clone()),
-                   OutputTrace(o.get(), presentationLayer->clone()));
+    return IOTrace(InputTrace(vector<int>(ifirst, ilast), presentationLayer),
+                   OutputTrace(o, presentationLayer));
     
 }
 
 bool Dfsm::pass(const IOTrace & io)
 {
-    IOTrace myIO = applyDet(io.getInputTrace());
-    return myIO.getOutputTrace() == io.getOutputTrace();
+    return pass(io.getInputTrace().get(), io.getOutputTrace().get());
+}
+
+bool Dfsm::pass(const vector<int>& itrc, const vector<int>& otrc) const
+{
+    if ( nodes.empty() ) return otrc.empty();
+    auto dense = getDenseDFSMTable();
+    return dense->pass(dense->getInitStateIdx(), itrc, otrc);
+}
+
+FsmNode * Dfsm::after(FsmNode const *s, const vector<int>& itrc) const
+{
+    int tgt = getDenseDFSMTable()->after(s->getId(), itrc);
+    return (tgt < 0) ? nullptr : nodes[tgt].get();
 }
 
 
@@ -1178,22 +1196,27 @@ IOListContainer Dfsm::wMethod(const unsigned int numAddStates) {
 
 
 IOListContainer Dfsm::wMethodOnMinimisedDfsm(const unsigned int numAddStates)
+{
+    return wMethodTreeOnMinimisedDfsm(numAddStates).getIOLists();
+}
+
+SuffixSharingTree Dfsm::wMethodTreeOnMinimisedDfsm(const unsigned int numAddStates)
 {
     
-    shared_ptr<Tree> iTree = getTransitionCover();
+    SuffixSharingTree iTree(*getTransitionCover());
     
     if (numAddStates > 0)
     {
         IOListContainer inputEnum = IOListContainer(maxInput,
                                                     1,
                                                     (int)numAddStates,
-                                                    presentationLayer->clone());
-        iTree->add(inputEnum);
+                                                    presentationLayer);
+        iTree.add(inputEnum);
     }
     
     IOListContainer w = getCharacterisationSet();
-    iTree->add(w);
-    return iTree->getIOLists();
+    iTree.add(w);
+    return iTree;
 }
 
 IOListContainer Dfsm::wpMethod(const unsigned int numAddStates)
@@ -1202,7 +1225,18 @@ IOListContainer Dfsm::wpMethod(const unsigned int numAddStates)
     return dfsmMin.wpMethodOnMinimisedDfsm(numAddStates);
 }
 
+SuffixSharingTree Dfsm::wpMethodTree(const unsigned int numAddStates)
+{
+    Dfsm dfsmMin = minimise();
+    return dfsmMin.wpMethodTreeOnMinimisedDfsm(numAddStates);
+}
+
 IOListContainer Dfsm::wpMethodOnMinimisedDfsm(const unsigned int numAddStates)
+{
+    return wpMethodTreeOnMinimisedDfsm(numAddStates).getIOLists();
+}
+
+SuffixSharingTree Dfsm::wpMethodTreeOnMinimisedDfsm(const unsigned int numAddStates)
 {
     std::unique_ptr<Tree> scov = getStateCover();
 
@@ -1214,27 +1248,27 @@ IOListContainer Dfsm::wpMethodOnMinimisedDfsm(const unsigned int numAddStates)
 
     calcStateIdentificationSetsFast();
 
-    std::unique_ptr<Tree> Wp1 = scov->clone();
+    SuffixSharingTree Wp1(*scov);
     if (numAddStates > 0) {
         IOListContainer inputEnum = IOListContainer(maxInput, 1,
                                                     (int)numAddStates,
-                                                    presentationLayer->clone());
-        Wp1->add(inputEnum);
+                                                    presentationLayer);
+        Wp1.add(inputEnum);
     }
-    Wp1->add(w);
+    Wp1.add(w);
 
-    std::unique_ptr<Tree> Wp2 = tcov->clone();
+    SuffixSharingTree Wp2(*tcov);
     if (numAddStates > 0) {
         IOListContainer inputEnum = IOListContainer(maxInput,
                                                     (int)numAddStates,
                                                     (int)numAddStates,
-                                                    presentationLayer->clone());
-        Wp2->add(inputEnum);
+                                                    presentationLayer);
+        Wp2.add(inputEnum);
     }
-    appendStateIdentificationSets(Wp2.get());
+    appendStateIdentificationSets(Wp2);
 
-    Wp1->unionTree(Wp2.get());
-    return Wp1->getIOLists();
+    Wp1.unionTree(Wp2);
+    return Wp1;
 }
 
 IOListContainer Dfsm::hsiMethod(const unsigned int numAddStates)
@@ -1243,6 +1277,12 @@ IOListContainer Dfsm::hsiMethod(const unsigned int numAddStates)
     return fMin.hsiMethod(numAddStates);
 }
 
+SuffixSharingTree Dfsm::hsiMethodTree(const unsigned int numAddStates)
+{
+    Fsm fMin = minimiseObservableFSM();
+    return fMin.hsiMethodTree(numAddStates);
+}
+
 IOListContainer Dfsm::tMethod()
 {
     
@@ -1293,8 +1333,8 @@ InputTrace Dfsm::calcDistinguishingTrace(
         Tree const *tree)
 {
     FsmNode *s0 = getInitialState();
-    FsmNode *s1 = *s0->after(*iAlpha).begin();
-    FsmNode *s2 = *s0->after(*iBeta).begin();
+    FsmNode *s1 = after(s0, iAlpha->get());
+    FsmNode *s2 = after(s0, iBeta->get());
 
     InputTrace gamma = calcDistinguishingTraceInTree(s1, s2, tree);
     if (!gamma.get().empty())
@@ -1304,9 +1344,7 @@ InputTrace Dfsm::calcDistinguishingTrace(
     if (!gamma2.get().empty())
         return gamma2;
 
-    return s1->calcDistinguishingTrace(s2,
-                                       pktblLst,
-                                       maxInput);
+    return calcDistinguishingTrace(s1, s2);
 }
 
 
@@ -1315,7 +1353,7 @@ vector<int> Dfsm::calcDistinguishingTrace(SegmentedTrace *alpha,
     FsmNode *s1 = alpha->getTgtNode();
     FsmNode *s2 = beta->getTgtNode();
     
-    std::unique_ptr<Tree> tree { new Tree(treeNode->clone(),presentationLayer->clone()) };
+    std::unique_ptr<Tree> tree { new Tree(treeNode->clone(),presentationLayer) };
     
     InputTrace gamma = calcDistinguishingTraceInTree(s1, s2, tree.get());
     if (!gamma.get().empty())
@@ -1325,9 +1363,7 @@ vector<int> Dfsm::calcDistinguishingTrace(SegmentedTrace *alpha,
     if (!gamma2.get().empty())
         return gamma2.get();
     
-    return s1->calcDistinguishingTrace(s2,
-                                       pktblLst,
-                                       maxInput).get();
+    return calcDistinguishingTrace(s1, s2).get();
 }
 
 
@@ -1345,7 +1381,7 @@ InputTrace Dfsm::calcDistinguishingTraceInTree(
     /* initialize queue */
     for (auto const &e : currentNode->getChildren())
     {
-        std::unique_ptr<InputTrace> itrc { new InputTrace(presentationLayer->clone()) };
+        std::unique_ptr<InputTrace> itrc { new InputTrace(presentationLayer) };
         itrc->add(e->getIO());
         q1.push_back(std::move(itrc));
     }
@@ -1365,7 +1401,7 @@ InputTrace Dfsm::calcDistinguishingTraceInTree(
 
         for (auto const &ne : currentNode->getChildren())
         {
-            std::unique_ptr<InputTrace> itrcTmp { new InputTrace(itrc->get(), presentationLayer->clone()) };
+            std::unique_ptr<InputTrace> itrcTmp { new InputTrace(itrc->get(), presentationLayer) };
             vector<int>nItrc;
             nItrc.push_back(ne->getIO());
             itrcTmp->append(nItrc);
@@ -1373,14 +1409,14 @@ InputTrace Dfsm::calcDistinguishingTraceInTree(
         }
     }
     // Return empty trace: no distinguishing trace found in tree
-    return InputTrace(presentationLayer->clone());
+    return InputTrace(presentationLayer);
 }
 
 InputTrace Dfsm::calcDistinguishingTraceInTree(InputTrace const *alpha, InputTrace const *beta, Tree const *tree)
 {
     // Only one element in the set, since FSM is deterministic
-    FsmNode *s_i = *(getInitialState()->after(*alpha)).begin();
-    FsmNode *s_j = *(getInitialState()->after(*beta)).begin();
+    FsmNode *s_i = after(getInitialState(), alpha->get());
+    FsmNode *s_j = after(getInitialState(), beta->get());
     return calcDistinguishingTraceInTree(s_i, s_j, tree);
 }
 
@@ -1391,9 +1427,9 @@ InputTrace Dfsm::calcDistinguishingTraceAfterTree(
 {
     for(TreeNode const *leaf : tree->getLeaves())
     {
-        InputTrace itrc(leaf->getPath(), presentationLayer->clone());
-        FsmNode *s_i_after_input = *(s_i->after(itrc)).begin();
-        FsmNode *s_j_after_input = *(s_j->after(itrc)).begin();
+        InputTrace itrc(leaf->getPath(), presentationLayer);
+        FsmNode *s_i_after_input = after(s_i, itrc.get());
+        FsmNode *s_j_after_input = after(s_j, itrc.get());
         
         // Cannot find distinguishing trace if the states reached
         // by the path are identical
@@ -1401,9 +1437,8 @@ InputTrace Dfsm::calcDistinguishingTraceAfterTree(
 
         // Since we are dealing with a minimised DFSM, a distinguishing
         // trace can ALWAYS be found, if s_i_after_input != s_j_after_input
-        InputTrace gamma = s_i_after_input->calcDistinguishingTrace(s_j_after_input,
-                                                                    pktblLst,
-                                                                    maxInput);
+        InputTrace gamma = calcDistinguishingTrace(s_i_after_input,
+                                                   s_j_after_input);
 
         itrc.append(gamma.get());
 
@@ -1412,7 +1447,7 @@ InputTrace Dfsm::calcDistinguishingTraceAfterTree(
     
     // Return empty trace: could not find a tree extension
     // distinguishing s_i and s_j
-    return InputTrace(presentationLayer->clone());
+    return InputTrace(presentationLayer);
 }
 
 IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
@@ -1420,8 +1455,9 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
     // Our initial state
     FsmNode *s0 = getInitialState();
     
-    // We need a valid set of DFSM table and Pk-Tables for this method
-    if ( dfsmTable == nullptr ) {
+    // We need a valid set of DFSM table and Pk-Tables for this method,
+    // unless the distinguishing oracle is available
+    if ( getDistinguishingOracle() == nullptr and dfsmTable == nullptr ) {
         calcPkTables();
     }
     
@@ -1434,7 +1470,7 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
     IOListContainer inputEnum = IOListContainer(maxInput,
                                                 (int)numAddStates+1,
                                                 (int)numAddStates+1,
-                                                presentationLayer->clone());
+                                                presentationLayer);
     
     // Initial test suite set is V.Sigma^{m-n+1}, m-n = numAddStates
     iTree->add(inputEnum);
@@ -1448,11 +1484,11 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
     IOListContainer::IOListBaseType iolV = iolcV.getIOLists();
     
     for ( size_t i = 0; i < iolV.size(); i++ ) {
-        InputTrace alpha(iolV.at(i),presentationLayer->clone());
+        InputTrace alpha(iolV.at(i),presentationLayer);
 
         for ( size_t j = i+1; j < iolV.size(); j++ ) {
             
-            InputTrace beta(iolV.at(j),presentationLayer->clone());
+            InputTrace beta(iolV.at(j),presentationLayer);
 
             std::unique_ptr<Tree> alphaTree = iTree->getSubTree(&alpha);
             std::unique_ptr<Tree> betaTree = iTree->getSubTree(&beta);
@@ -1460,10 +1496,10 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
 
             InputTrace gamma = calcDistinguishingTrace(&alpha, &beta, prefixRelationTree.get());
 
-            InputTrace iAlphaGamma(alpha.get(), presentationLayer->clone());
+            InputTrace iAlphaGamma(alpha.get(), presentationLayer);
             iAlphaGamma.append(gamma);
 
-            InputTrace iBetaGamma(beta.get(), presentationLayer->clone());
+            InputTrace iBetaGamma(beta.get(), presentationLayer);
             iBetaGamma.append(gamma);
 
             iTree->addToRoot(iAlphaGamma.get());
@@ -1481,7 +1517,7 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
     IOListContainer allBeta = IOListContainer(maxInput,
                                               1,
                                               (int)numAddStates+1,
-                                              presentationLayer->clone());
+                                              presentationLayer);
     
     IOListContainer::IOListBaseType iolAllBeta = allBeta.getIOLists();
     
@@ -1489,15 +1525,13 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
         
         for (const auto &alpha : iolV ) {
             
-            InputTrace iAlphaBeta(alpha,presentationLayer->clone());
+            InputTrace iAlphaBeta(alpha,presentationLayer);
             iAlphaBeta.append(beta);
-            std::unordered_set<FsmNode*> s_alpha_betaSet = s0->after(iAlphaBeta);
-            FsmNode *s_alpha_beta = *s_alpha_betaSet.begin();
+            FsmNode *s_alpha_beta = after(s0, iAlphaBeta.get());
             
             for ( auto omega : iolV ) {
-                InputTrace iOmega(omega,presentationLayer->clone());
-                std::unordered_set<FsmNode*> s_omegaSet = s0->after(iOmega);
-                FsmNode *s_omega = *s_omegaSet.begin();
+                InputTrace iOmega(omega,presentationLayer);
+                FsmNode *s_omega = after(s0, iOmega.get());
 
                 if ( s_alpha_beta == s_omega ) continue;
 
@@ -1507,10 +1541,10 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
 
                 InputTrace gamma = calcDistinguishingTrace(&iAlphaBeta, &iOmega, prefixRelationTree.get());
 
-                InputTrace iAlphaBetaGamma(iAlphaBeta.get(), presentationLayer->clone());
+                InputTrace iAlphaBetaGamma(iAlphaBeta.get(), presentationLayer);
                 iAlphaBetaGamma.append(gamma.get());
 
-                InputTrace iOmegaGamma(iOmega.get(), presentationLayer->clone());
+                InputTrace iOmegaGamma(iOmega.get(), presentationLayer);
                 iOmegaGamma.append(gamma.get());
 
                 iTree->addToRoot(iAlphaBetaGamma.get());
@@ -1531,33 +1565,31 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
     
     for ( auto alpha : iolV ) {
         
-        InputTrace iAlpha(alpha,presentationLayer->clone());
+        InputTrace iAlpha(alpha,presentationLayer);
         
         for ( auto beta : inputEnum.getIOLists() ) {
         
             for ( size_t i = 0; i < beta.size() - 1; i++ ) {
-                InputTrace iBeta_1(presentationLayer->clone());
+                InputTrace iBeta_1(presentationLayer);
                 for ( size_t k = 0; k <= i; k++ ) {
                     iBeta_1.add(beta[k]);
                 }
                 
                 for ( size_t j = i+1; j < beta.size(); j++ ) {
-                    InputTrace iBeta_2(presentationLayer->clone());
+                    InputTrace iBeta_2(presentationLayer);
                     for ( size_t k = 0; k <= j; k++ ) {
                         iBeta_2.add(beta[k]);
                     }
                     
-                    InputTrace iAlphaBeta_1(alpha,presentationLayer->clone());
+                    InputTrace iAlphaBeta_1(alpha,presentationLayer);
                     iAlphaBeta_1.append(iBeta_1.get());
                     
-                    InputTrace iAlphaBeta_2(alpha,presentationLayer->clone());
+                    InputTrace iAlphaBeta_2(alpha,presentationLayer);
                     iAlphaBeta_2.append(iBeta_2.get());
                     
-                    unordered_set<FsmNode*> s1Set = s0->after(iAlphaBeta_1);
-                    FsmNode *s1 = *s1Set.begin();
+                    FsmNode *s1 = after(s0, iAlphaBeta_1.get());
                     
-                    unordered_set<FsmNode*> s2Set = s0->after(iAlphaBeta_2);
-                    FsmNode *s2 = *s2Set.begin();
+                    FsmNode *s2 = after(s0, iAlphaBeta_2.get());
                     
                     if ( s1 == s2 ) continue;
 
@@ -1567,10 +1599,10 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
 
                     InputTrace gamma = calcDistinguishingTrace(&iAlphaBeta_1, &iAlphaBeta_2, prefixRelationTree.get());
 
-                    InputTrace iAlphaBeta_1Gamma(iAlphaBeta_1.get(), presentationLayer->clone());
+                    InputTrace iAlphaBeta_1Gamma(iAlphaBeta_1.get(), presentationLayer);
                     iAlphaBeta_1Gamma.append(gamma.get());
 
-                    InputTrace iAlphaBeta_2Gamma(iAlphaBeta_2.get(), presentationLayer->clone());
+                    InputTrace iAlphaBeta_2Gamma(iAlphaBeta_2.get(), presentationLayer);
                     iAlphaBeta_2Gamma.append(gamma.get());
 
                     iTree->addToRoot(iAlphaBeta_1Gamma.get());
@@ -1588,19 +1620,25 @@ IOListContainer Dfsm::hMethodOnMinimisedDfsm(const unsigned int numAddStates) {
 
 bool Dfsm::distinguishable(const FsmNode& s1, const FsmNode& s2) {
     
-    if ( pktblLst.empty() ) {
+    if ( pkSplittingTree == nullptr ) {
+        if ( partition == nullptr and getDenseDFSMTable()->isCompletelyDefined() ) {
+            calcPartition();
+        }
+        if ( partition != nullptr ) {
+            return partition->distinguishable(s1.getId(), s2.getId());
+        }
         calcPkTables();
     }
     
-    shared_ptr<PkTable> p = pktblLst.back();
-    
-    return ( p->getClass(s1.getId()) != p->getClass(s2.getId()) );
+    return pkSplittingTree->distinguishable(s1.getId(), s2.getId());
     
 }
 
 void Dfsm::calculateDistMatrix() {
     initDistTraces();
-    calcPkTables();
+    if ( getDistinguishingOracle() == nullptr ) {
+        calcPkTables();
+    }
     
     for ( size_t n = 0; n < size(); n++ ) {
         for ( size_t m = n+1; m < size(); m++ ) {
@@ -1639,14 +1677,15 @@ vector< vector<int> > Dfsm::calcDistTraces(size_t l, vector<int> const &trc, int
     if ( l == 0 ) return calcDistTraces(trc,id1,id2);
     
     vector< vector<int> > v;
-    shared_ptr<PkTable> thisPkTbl = pktblLst[l];
-    shared_ptr<PkTable> prevPkTbl = pktblLst[l-1];
     
     for ( int x = 0; x <= maxInput; x++ ) {
-        int idNext1 = thisPkTbl->getRow(id1)->getI2PMap()[x];
-        int idNext2 = thisPkTbl->getRow(id2)->getI2PMap()[x];
+        int idNext1 = pkTable->getRow(id1)->getI2PMap()[x];
+        int idNext2 = pkTable->getRow(id2)->getI2PMap()[x];
 
-        if ( prevPkTbl->getClass(idNext1) != prevPkTbl->getClass(idNext2) ) {
+        // The post-states must be distinguished by table P_l,
+        // i.e. separated in a round <= l
+        int r = pkSplittingTree->separatingRound(idNext1, idNext2);
+        if ( r > 0 and static_cast<size_t>(r) <= l ) {
             vector<int> newTrc(trc);
             newTrc.push_back(x);
             vector< vector<int> > w = calcDistTraces(l-1,newTrc,idNext1,idNext2);
@@ -1662,16 +1701,16 @@ vector< vector<int> > Dfsm::calcDistTraces(FsmNode& s1, FsmNode& s2) {
     int id1 = s1.getId();
     int id2 = s2.getId();
     
-    // Find first Pk-table distPkTbl,  where s1 and s2 are distinguished
-    size_t l = 0;
-    shared_ptr<PkTable> distPkTbl = nullptr;
-    for ( ; l < pktblLst.size(); l++ ) {
-        distPkTbl = pktblLst[l];
-        if ( distPkTbl->getClass(id1) != distPkTbl->getClass(id2) )
-            break;
+    if ( auto oracle = getDistinguishingOracle() ) {
+        return oracle->calcDistinguishingTraces(id1, id2);
     }
     
-    return calcDistTraces(l,{},id1,id2);
+    // Find first Pk-table P_(l+1), where s1 and s2 are distinguished;
+    // equivalent states have no distinguishing traces
+    int r = pkSplittingTree->separatingRound(id1, id2);
+    if ( r < 1 ) return vector< vector<int> >();
+    
+    return calcDistTraces(static_cast<size_t>(r - 1),{},id1,id2);
 }
 
 
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "fsm/DFSMTable.h"
+#include "fsm/DistinguishingOracle.h"
 #include "fsm/Fsm.h"
 #include "fsm/SegmentedTrace.h"
 #include "json/json.h"
@@ -24,7 +25,11 @@
 
 class PkTable;
 class IOTrace;
+class DenseDFSMTable;
+class CSRTransitionTable;
+class HopcroftPartition;
 class SegmentedTrace;
+class SplittingTree;
 class TreeNode;
 
 class Dfsm : public Fsm
@@ -33,8 +38,50 @@ private:
 	//TODO
 	std::shared_ptr<DFSMTable> dfsmTable;
 
-	//TODO
-	std::vector<std::shared_ptr<PkTable>> pktblLst;
+	/**
+	 *  Last Pk-table of the DFSM, carrying the Pk-equivalence classes,
+	 *  created by calcPkTables()
+	 */
+	std::shared_ptr<PkTable> pkTable;
+
+	/**
+	 *  History of the Pk-table refinement, where round k corresponds
+	 *  to table P_k, created by calcPkTables() instead of keeping
+	 *  all Pk-tables
+	 */
+	std::shared_ptr<SplittingTree> pkSplittingTree;
+
+    /**
+     *  Equivalence classes of the DFSM calculated by Hopcroft's
+     *  algorithm, used instead of the Pk-tables by minimise(),
+     *  distinguishable() and for the calculation of distinguishing
+     *  traces, if the DFSM is completely specified.
+     */
+    std::shared_ptr<HopcroftPartition> partition;
+
+    /**
+     *  Dense next-state/output table used for simulation, and the
+     *  CSR table it has been compiled from. The dense table is
+     *  recompiled when the CSR table of the FSM has been replaced.
+     */
+    mutable std::shared_ptr<DenseDFSMTable> denseTable;
+    mutable std::shared_ptr<const CSRTransitionTable> denseTableSource;
+
+    /**
+     *  Shortest distinguishing traces for all pairs of states, and the
+     *  dense table they have been calculated for. The oracle is
+     *  recalculated when the dense table has been replaced, and is
+     *  nullptr if the DFSM is not completely specified or the oracle
+     *  would exceed its memory cap.
+     */
+    std::shared_ptr<DistinguishingOracle> distOracle;
+    std::shared_ptr<const DenseDFSMTable> distOracleSource;
+    
+    /**
+     *  Memory cap of the oracle, as set by the last call of
+     *  calcDistinguishingOracle()
+     */
+    size_t distOracleMaxBytes = DistinguishingOracle::defaultMaxBytes;
 
 	/**
 	Create a DFSMTable from the DFSM
@@ -47,6 +94,23 @@ private:
     std::shared_ptr<FsmPresentationLayer> createPresentationLayerFromCsvFormat(const std::string& fname, FsmPresentationLayer const *pl);
     
     void createDfsmTransitionGraph(const std::string& fname);
+
+    /**
+     *  Return the distinguishing oracle for the current transition
+     *  relation, or nullptr if it is not available. The oracle is
+     *  recalculated with the memory cap passed to the last call of
+     *  calcDistinguishingOracle(), or with the default memory cap if
+     *  it has not been called.
+     */
+    const DistinguishingOracle* getDistinguishingOracle();
+
+    /**
+     *  Calculate an input trace distinguishing two inequivalent states,
+     *  from the distinguishing oracle if it is available, from the
+     *  Pk-table splitting tree if it has been calculated, and from
+     *  the Hopcroft partition otherwise.
+     */
+    InputTrace calcDistinguishingTrace(FsmNode *s1, FsmNode *s2);
     
     /**
      *   distTraces[n][m] contains a vector of pointers to
@@ -79,7 +143,7 @@ public:
          const int maxNodes,
          const int maxInput,
          const int maxOutput,
-         std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+         const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
     
     /**
      Create a DFSM from a file description
@@ -91,7 +155,7 @@ public:
      are determined from the input file specifying the FSM.
      */
     Dfsm(const std::string & fname,
-         std::unique_ptr<FsmPresentationLayer> &&presentationLayer,
+         const std::shared_ptr<const FsmPresentationLayer>& presentationLayer,
          const std::string & fsmName);
 
     
@@ -114,7 +178,7 @@ public:
          const int maxNodes,
          const int maxInput,
          const int maxOutput,
-         std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+         const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	/**
 	Create a DFSM from a list of nodes
@@ -130,7 +194,7 @@ public:
          const int maxInput,
          const int maxOutput,
          std::vector<std::unique_ptr<FsmNode>> &&lst,
-         std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+         const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	/**
 	Create a DFSM from the equivalent deterministic FSM
@@ -177,7 +241,7 @@ public:
      */
     Dfsm(const std::string& fname,
          const std::string& fsmName,
-         std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+         const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
     
     
     /**
@@ -211,18 +275,46 @@ public:
 
 	/**
 	Minimise this DFSM
-	As a side effect, create the DFSM table and all Pk tables needed.
+	If the DFSM is completely specified, the equivalence classes are
+	calculated by Hopcroft's algorithm (see calcPartition()), otherwise
+	as a side effect, create the DFSM table and all Pk tables needed.
 	@return the new minimised DFSM
 	*/
 	Dfsm minimise();
 
+    /**
+     *  Calculate the equivalence classes of this completely specified
+     *  DFSM by Hopcroft's algorithm, in O(|I| n log n) time.
+     */
+    void calcPartition();
+
+    /**
+     *  Calculate shortest distinguishing traces for all pairs of states
+     *  of this completely specified DFSM (see DistinguishingOracle),
+     *  used for all distinguishing traces calculated afterwards.
+     *  @param maxBytes Memory cap: if the oracle would need more memory,
+     *         it is not calculated, and distinguishing traces are
+     *         derived from the Pk-tables instead.
+     */
+    void calcDistinguishingOracle(const size_t maxBytes);
+
+    /**
+     *  Return the index of the state of the DFSM created by the last
+     *  call of minimise(), which represents state n of this DFSM
+     */
+    int getMinimisedStateIdx(const int n) const;
+
 	/**
-	Output the DFSM table and the Pk-tables in LaTeX format.
+	Output the DFSM table and the last Pk-table in LaTeX format.
 	The output file name is hard-coded as tables.tex.
 	\note This requires that the operation minimise() has been called before.
 	*/
 	void printTables() const;
 
+    /**
+     *  Calculate the sequence of Pk-tables, keeping the last table
+     *  and the splitting tree of the sequence
+     */
     void calcPkTables();
 
 	/**
@@ -252,6 +344,27 @@ public:
 	*/
 	bool pass(const IOTrace & io);
 
+    /**
+     Check whether the IO trace consisting of inputs itrc and
+     outputs otrc is in the language of the DFSM. Unlike
+     pass(const IOTrace&), this operation does not allocate memory
+     once the dense simulation table has been compiled.
+     */
+    bool pass(const std::vector<int>& itrc, const std::vector<int>& otrc) const;
+
+    /**
+     Return the state reached from s by applying input trace itrc,
+     or nullptr if itrc is not accepted by s.
+     */
+    FsmNode * after(FsmNode const *s, const std::vector<int>& itrc) const;
+
+    /**
+     Return the DFSM compiled into flat next-state and output arrays.
+     The table is created on first use and recompiled whenever the
+     transition relation has changed.
+     */
+    std::shared_ptr<const DenseDFSMTable> getDenseDFSMTable() const;
+
    /**
 	* Perform test generation by means of the W-Method.
     * The DFSM this method is applied to is regarded as the reference
@@ -283,6 +396,12 @@ public:
      *  Apply the W-Method on a DFSM that is already minimised
      */
     IOListContainer wMethodOnMinimisedDfsm(const unsigned int numAddStates);
+    
+    /**
+     *  Return the test tree of wMethodOnMinimisedDfsm(),
+     *  see Fsm::wMethodTreeOnMinimisedFsm()
+     */
+    SuffixSharingTree wMethodTreeOnMinimisedDfsm(const unsigned int numAddStates);
 
 
 	/**
@@ -300,11 +419,21 @@ public:
 	* @return A test suite
 	*/
 	IOListContainer wpMethod(const unsigned int numAddStates);
+    
+    /**
+     * Return the test tree of wpMethod(), see Fsm::wMethodTreeOnMinimisedFsm()
+     */
+    SuffixSharingTree wpMethodTree(const unsigned int numAddStates);
 
     /**
      * Apply the Wp Method on a DFSM that is already minimised
      */
     IOListContainer wpMethodOnMinimisedDfsm(const unsigned int numAddStates);
+    
+    /**
+     * Return the test tree of wpMethodOnMinimisedDfsm()
+     */
+    SuffixSharingTree wpMethodTreeOnMinimisedDfsm(const unsigned int numAddStates);
 
     /**
      * WORK IN PROGRESS
@@ -318,6 +447,12 @@ public:
      * @return a test suite
      */
     IOListContainer hsiMethod(const unsigned int numAddStates);
+    
+    /**
+     * Return the test tree of hsiMethod(), see Fsm::wMethodTreeOnMinimisedFsm()
+     */
+    SuffixSharingTree hsiMethodTree(const unsigned int numAddStates);
+    
     /**
      * Perform test generation by means of the T-Method. The algorithm 
      * applies to deterministic FSMs which are completely defined.
@@ -411,7 +546,16 @@ public:
      */
     InputTrace calcDistinguishingTraceAfterTree(FsmNode *s_i, FsmNode *s_j, Tree const *tree);
 
-    std::vector<std::shared_ptr<PkTable> > getPktblLst() const;
+    /**
+     *  Return the last Pk-table calculated by calcPkTables(), or nullptr
+     */
+    std::shared_ptr<PkTable> getPkTable() const;
+
+    /**
+     *  Return the splitting tree of the Pk-tables calculated by
+     *  calcPkTables(), or nullptr
+     */
+    std::shared_ptr<const SplittingTree> getPkSplittingTree() const;
     std::shared_ptr<DFSMTable> getDFSMTable() const { return dfsmTable; }
     
     
@@ -0,0 +1,167 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+#include "fsm/CSRTransitionTable.h"
+#include "fsm/DistinguishabilityMatrix.h"
+
+using namespace std;
+
+namespace {
+
+    /** Minimal number of states whose responses are calculated by one thread */
+    const int minStatesPerThread = 256;
+
+    /** Hash of a response */
+    struct ResponseHash {
+        size_t operator()(const vector<int>& key) const {
+            uint64_t h = key.size();
+            for ( int v : key ) {
+                h ^= static_cast<uint64_t>(v) + 0x9e3779b97f4a7c15ULL + (h << 12) + (h >> 4);
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+}
+
+DistinguishabilityMatrix::DistinguishabilityMatrix(const shared_ptr<const CSRTransitionTable>& csr,
+                                                   const vector<vector<int>>& traces,
+                                                   const unsigned numThreads)
+: numStates(csr->size()),
+  numTraces(static_cast<int>(traces.size())),
+  words((traces.size() + 63) / 64)
+{
+    calcSignatures(*csr, traces,
+                   numThreads > 0 ? numThreads : max(1u, thread::hardware_concurrency()));
+}
+
+void DistinguishabilityMatrix::calcSignatures(const CSRTransitionTable& csr,
+                                              const vector<vector<int>>& traces,
+                                              const unsigned numThreads)
+{
+    signatures.assign(static_cast<size_t>(numStates) * numTraces, 0);
+    if ( numStates == 0 ) return;
+
+    vector< vector<int> > responses(numStates);
+    int threads = min(static_cast<int>(numThreads), numStates / minStatesPerThread);
+    for ( int u = 0; u < numTraces; u++ ) {
+        auto calcResponses = [&csr, &traces, &responses, u](const int first, const int last) {
+            for ( int s = first; s < last; s++ ) {
+                csr.response(s, traces[u], responses[s]);
+            }
+        };
+        if ( threads <= 1 ) {
+            calcResponses(0, numStates);
+        }
+        else {
+            vector<thread> workers;
+            int chunk = (numStates + threads - 1) / threads;
+            for ( int first = 0; first < numStates; first += chunk ) {
+                workers.emplace_back(calcResponses, first, min(first + chunk, numStates));
+            }
+            for ( auto& w : workers ) {
+                w.join();
+            }
+        }
+
+        // Responses are numbered in the order of their smallest state
+        unordered_map<vector<int>, int, ResponseHash> numberOfResponse;
+        for ( int s = 0; s < numStates; s++ ) {
+            auto ins = numberOfResponse.emplace(std::move(responses[s]),
+                                                static_cast<int>(numberOfResponse.size()));
+            signatures[static_cast<size_t>(s) * numTraces + u] = ins.first->second;
+        }
+    }
+}
+
+void DistinguishabilityMatrix::calcDistinguishingBits(const int s1, const int s2, uint64_t *bits) const
+{
+    // A trace distinguishes the pair if the signatures differ at its position
+    const int *sig1 = &signatures[static_cast<size_t>(s1) * numTraces];
+    const int *sig2 = &signatures[static_cast<size_t>(s2) * numTraces];
+    fill(bits, bits + words, 0);
+    for ( int u = 0; u < numTraces; u++ ) {
+        if ( sig1[u] != sig2[u] ) bits[u / 64] |= uint64_t(1) << (u % 64);
+    }
+}
+
+bool DistinguishabilityMatrix::distinguished(const int s1, const int s2) const
+{
+    return firstDistinguishingTrace(s1, s2) >= 0;
+}
+
+int DistinguishabilityMatrix::firstDistinguishingTrace(const int s1, const int s2) const
+{
+    if ( s1 == s2 ) return -1;
+    const int *sig1 = &signatures[static_cast<size_t>(s1) * numTraces];
+    const int *sig2 = &signatures[static_cast<size_t>(s2) * numTraces];
+    for ( int u = 0; u < numTraces; u++ ) {
+        if ( sig1[u] != sig2[u] ) return u;
+    }
+    return -1;
+}
+
+unordered_set<int> DistinguishabilityMatrix::getDistinguishingTraces(const int s1, const int s2) const
+{
+    unordered_set<int> result;
+    if ( s1 == s2 ) return result;
+    for ( int u = 0; u < numTraces; u++ ) {
+        if ( distinguished(s1, s2, u) ) result.insert(u);
+    }
+    return result;
+}
+
+vector<unordered_set<int>> DistinguishabilityMatrix::getDistinguishingTraceSets(const int s) const
+{
+    vector<uint64_t> bitsets(numStates > 0 ? (numStates - 1) * words : 0);
+    vector<const uint64_t*> rows;
+    for ( int s2 = 0; s2 < numStates; s2++ ) {
+        if ( s2 == s ) continue;
+        uint64_t *bits = &bitsets[rows.size() * words];
+        calcDistinguishingBits(s, s2, bits);
+        rows.push_back(bits);
+    }
+    auto less = [this](const uint64_t *a, const uint64_t *b) {
+        return lexicographical_compare(a, a + words, b, b + words);
+    };
+    auto equal = [this](const uint64_t *a, const uint64_t *b) {
+        return std::equal(a, a + words, b);
+    };
+    sort(rows.begin(), rows.end(), less);
+    rows.erase(unique(rows.begin(), rows.end(), equal), rows.end());
+
+    vector<unordered_set<int>> result;
+    for ( const uint64_t *bits : rows ) {
+        result.emplace_back();
+        for ( size_t w = 0; w < words; w++ ) {
+            for ( uint64_t b = bits[w]; b != 0; b &= b - 1 ) {
+                result.back().insert(static_cast<int>(w * 64 + __builtin_ctzll(b)));
+            }
+        }
+    }
+    return result;
+}
+
+bool DistinguishabilityMatrix::distinguishesAllStates() const
+{
+    // All pairs are distinguished if and only if the signatures are
+    // pairwise different, which is checked on the sorted signatures
+    vector<const int*> sigs;
+    for ( int s = 0; s < numStates; s++ ) {
+        sigs.push_back(&signatures[static_cast<size_t>(s) * numTraces]);
+    }
+    auto less = [this](const int *a, const int *b) {
+        return lexicographical_compare(a, a + numTraces, b, b + numTraces);
+    };
+    auto equal = [this](const int *a, const int *b) {
+        return std::equal(a, a + numTraces, b);
+    };
+    sort(sigs.begin(), sigs.end(), less);
+    return adjacent_find(sigs.begin(), sigs.end(), equal) == sigs.end();
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_DISTINGUISHABILITYMATRIX_H_
+#define FSM_FSM_DISTINGUISHABILITYMATRIX_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+class CSRTransitionTable;
+
+/**
+ Class representing, for every pair of states of an FSM, the set of
+ input traces of a list (usually a characterisation set W) which
+ distinguish the two states.
+
+ Two states are distinguished by an input trace if their responses,
+ i.e. the sets of output traces produced when applying the trace, differ.
+ For observable FSMs, this is the relation checked by
+ FsmNode::distinguished(). Instead of comparing the responses of every
+ pair of states, the response of every state to every trace is
+ calculated once and numbered, so that equal responses get equal numbers. The vector of these numbers over all traces is the
+ signature of a state, and a trace distinguishes two states if and only
+ if their signatures differ at its position.
+
+ The signatures are calculated on the read-only CSR transition table
+ of the FSM, concurrently by the given number of threads. Only the
+ signatures are stored, in memory O(n*|W|) for n states; the traces
+ distinguishing a pair are derived from them when requested, instead
+ of keeping a bitset for each of the n*(n-1)/2 pairs.
+ */
+class DistinguishabilityMatrix
+{
+private:
+    /** Number of states */
+    int numStates;
+
+    /** Number of input traces */
+    int numTraces;
+
+    /** Number of 64 bit words of a bitset over the traces */
+    size_t words;
+
+    /** signatures[s * numTraces + u] is the number of the response
+     of state s to trace u */
+    std::vector<int> signatures;
+
+    /**
+     * Store the bitset of the traces distinguishing states s1 and s2
+     * in bits[0..words-1]
+     */
+    void calcDistinguishingBits(const int s1, const int s2, uint64_t *bits) const;
+
+    /**
+     * Calculate the signatures of all states
+     * @param csr Transition relation of the FSM
+     * @param traces Input traces
+     * @param numThreads Number of threads calculating the responses
+     */
+    void calcSignatures(const CSRTransitionTable& csr,
+                        const std::vector<std::vector<int>>& traces,
+                        const unsigned numThreads);
+
+public:
+    /**
+     * Create the matrix for the states of an FSM and a list of input traces
+     * @param csr Transition relation of the FSM
+     * @param traces Input traces, identified by their position in the list
+     * @param numThreads Number of threads calculating the responses,
+     *        or 0 to use one thread per hardware thread
+     */
+    DistinguishabilityMatrix(const std::shared_ptr<const CSRTransitionTable>& csr,
+                             const std::vector<std::vector<int>>& traces,
+                             const unsigned numThreads);
+
+    /** Return the number of states */
+    int size() const { return numStates; }
+
+    /** Return the number of input traces */
+    int getNumTraces() const { return numTraces; }
+
+    /**
+     * Return the number of the response of state s to trace u.
+     * Two states have equal responses to u if and only if these
+     * numbers coincide.
+     */
+    int getSignature(const int s, const int u) const {
+        return signatures[static_cast<size_t>(s) * numTraces + u];
+    }
+
+    /** Return true if and only if trace u distinguishes states s1 and s2 */
+    bool distinguished(const int s1, const int s2, const int u) const {
+        return getSignature(s1, u) != getSignature(s2, u);
+    }
+
+    /**
+     * Return true if and only if states s1 and s2 are distinguished
+     * by one of the traces
+     */
+    bool distinguished(const int s1, const int s2) const;
+
+    /**
+     * Return the smallest index of a trace distinguishing states s1
+     * and s2, or -1 if they are not distinguished
+     */
+    int firstDistinguishingTrace(const int s1, const int s2) const;
+
+    /** Return the indices of all traces distinguishing states s1 and s2 */
+    std::unordered_set<int> getDistinguishingTraces(const int s1, const int s2) const;
+
+    /**
+     * Return the distinct sets getDistinguishingTraces(s, s2) for all
+     * states s2 other than s, ordered by their bitsets, which are
+     * calculated for this call only. Many pairs are
+     * distinguished by the same traces, so that there are usually far
+     * less sets than states.
+     */
+    std::vector<std::unordered_set<int>> getDistinguishingTraceSets(const int s) const;
+
+    /**
+     * Return true if and only if every pair of different states is
+     * distinguished by one of the traces
+     */
+    bool distinguishesAllStates() const;
+};
+#endif //FSM_FSM_DISTINGUISHABILITYMATRIX_H_
@@ -0,0 +1,171 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include "fsm/DenseDFSMTable.h"
+#include "fsm/DistinguishingOracle.h"
+
+using namespace std;
+
+const size_t DistinguishingOracle::defaultMaxBytes = static_cast<size_t>(256) << 20;
+
+size_t DistinguishingOracle::memoryRequired(const int numStates,
+                                            const int numInputs)
+{
+    size_t numPairs = static_cast<size_t>(numStates) * (numStates - 1) / 2;
+    size_t numEdges = static_cast<size_t>(numInputs) * numStates;
+    // dist and input, the pair queue, predStart, preds and fill
+    return numPairs * 2 * sizeof(int)
+    + numPairs * sizeof(pair<int,int>)
+    + (3 * numEdges + 1) * sizeof(int);
+}
+
+shared_ptr<DistinguishingOracle>
+DistinguishingOracle::create(const shared_ptr<const DenseDFSMTable>& table,
+                             const size_t maxBytes)
+{
+    if ( memoryRequired(table->size(), table->getNumInputs()) > maxBytes ) {
+        return nullptr;
+    }
+    return shared_ptr<DistinguishingOracle>(new DistinguishingOracle(table));
+}
+
+DistinguishingOracle::DistinguishingOracle(const shared_ptr<const DenseDFSMTable>& table)
+: table(table), numStates(table->size())
+{
+    const int n = numStates;
+    const int k = table->getNumInputs();
+    const size_t numPairs = static_cast<size_t>(n) * (n - 1) / 2;
+    dist.assign(numPairs, 0);
+    input.assign(numPairs, -1);
+    if ( n < 2 ) return;
+    
+    // Inverse transition relation: the x-predecessors of state t
+    // are preds[predStart[edgeIdx(x,t)]..predStart[edgeIdx(x,t)+1]-1]
+    auto edgeIdx = [n](const int x, const int t) {
+        return static_cast<size_t>(x) * n + t;
+    };
+    vector<int> predStart(static_cast<size_t>(k) * n + 1, 0);
+    for ( int s = 0; s < n; s++ ) {
+        for ( int x = 0; x < k; x++ ) {
+            ++ predStart[edgeIdx(x, table->getNext(s, x)) + 1];
+        }
+    }
+    for ( size_t i = 1; i < predStart.size(); i++ ) {
+        predStart[i] += predStart[i-1];
+    }
+    vector<int> preds(predStart.back());
+    vector<int> fill(predStart.begin(), predStart.end() - 1);
+    for ( int s = 0; s < n; s++ ) {
+        for ( int x = 0; x < k; x++ ) {
+            preds[fill[edgeIdx(x, table->getNext(s, x))]++] = s;
+        }
+    }
+    
+    // Pairs distinguished by a single input
+    // Each pair is queued at most once
+    vector< pair<int,int> > queue;
+    queue.reserve(numPairs);
+    for ( int s2 = 1; s2 < n; s2++ ) {
+        for ( int s1 = 0; s1 < s2; s1++ ) {
+            for ( int x = 0; x < k; x++ ) {
+                if ( table->getOutput(s1, x) != table->getOutput(s2, x) ) {
+                    dist[pairIdx(s1, s2)] = 1;
+                    input[pairIdx(s1, s2)] = x;
+                    queue.push_back(make_pair(s1, s2));
+                    break;
+                }
+            }
+        }
+    }
+    
+    // Backward breadth-first search: a pair reaching a pair at
+    // distance d by some input, and not distinguished yet, has
+    // distance d+1
+    for ( size_t head = 0; head < queue.size(); head++ ) {
+        int t1 = queue[head].first;
+        int t2 = queue[head].second;
+        int d = dist[pairIdx(t1, t2)];
+        for ( int x = 0; x < k; x++ ) {
+            for ( int i = predStart[edgeIdx(x, t1)]; i < predStart[edgeIdx(x, t1) + 1]; i++ ) {
+                for ( int j = predStart[edgeIdx(x, t2)]; j < predStart[edgeIdx(x, t2) + 1]; j++ ) {
+                    int s1 = preds[i];
+                    int s2 = preds[j];
+                    if ( s1 == s2 ) continue;
+                    size_t idx = pairIdx(s1, s2);
+                    if ( dist[idx] == 0 ) {
+                        dist[idx] = d + 1;
+                        queue.push_back(make_pair(s1, s2));
+                    }
+                }
+            }
+        }
+    }
+    
+    // Select the smallest input leading to a pair at distance d-1
+    for ( const auto& p : queue ) {
+        size_t idx = pairIdx(p.first, p.second);
+        int d = dist[idx];
+        if ( d == 1 ) continue;
+        for ( int x = 0; x < k; x++ ) {
+            int t1 = table->getNext(p.first, x);
+            int t2 = table->getNext(p.second, x);
+            if ( t1 != t2 and dist[pairIdx(t1, t2)] == d - 1 ) {
+                input[idx] = x;
+                break;
+            }
+        }
+    }
+}
+
+vector<int> DistinguishingOracle::calcDistinguishingTrace(int s1, int s2) const
+{
+    vector<int> trc;
+    if ( not distinguishable(s1, s2) ) return trc;
+    
+    trc.reserve(getDistance(s1, s2));
+    while ( true ) {
+        int x = input[pairIdx(s1, s2)];
+        trc.push_back(x);
+        if ( table->getOutput(s1, x) != table->getOutput(s2, x) ) break;
+        s1 = table->getNext(s1, x);
+        s2 = table->getNext(s2, x);
+    }
+    return trc;
+}
+
+vector< vector<int> > DistinguishingOracle::calcDistinguishingTraces(const int s1, const int s2) const
+{
+    vector< vector<int> > traces;
+    vector<int> trc;
+    if ( distinguishable(s1, s2) ) {
+        calcDistinguishingTraces(s1, s2, trc, traces);
+    }
+    return traces;
+}
+
+void DistinguishingOracle::calcDistinguishingTraces(const int s1,
+                                                    const int s2,
+                                                    vector<int>& trc,
+                                                    vector< vector<int> >& traces) const
+{
+    const int d = getDistance(s1, s2);
+    for ( int x = 0; x < table->getNumInputs(); x++ ) {
+        if ( d == 1 ) {
+            if ( table->getOutput(s1, x) != table->getOutput(s2, x) ) {
+                trc.push_back(x);
+                traces.push_back(trc);
+                trc.pop_back();
+            }
+            continue;
+        }
+        int t1 = table->getNext(s1, x);
+        int t2 = table->getNext(s2, x);
+        if ( getDistance(t1, t2) == d - 1 ) {
+            trc.push_back(x);
+            calcDistinguishingTraces(t1, t2, trc, traces);
+            trc.pop_back();
+        }
+    }
+}
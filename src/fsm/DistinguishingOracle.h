@@ -0,0 +1,113 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_DISTINGUISHINGORACLE_H_
+#define FSM_FSM_DISTINGUISHINGORACLE_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class DenseDFSMTable;
+
+/**
+ Class providing shortest distinguishing traces for all pairs of states
+ of a completely specified DFSM.
+
+ The lengths of the shortest distinguishing traces are calculated by
+ one backward breadth-first search over the graph of unordered state
+ pairs, starting from the pairs producing different outputs for some
+ input. For each pair, the smallest input leading to a pair whose
+ shortest distinguishing trace is one step shorter is stored, so that
+ a shortest distinguishing trace is read off in time linear in its
+ length. This input is the one selected when deriving the trace from
+ the Pk-tables, so both yield the same traces.
+
+ Calculating the oracle needs memoryRequired(n,k) bytes for n states
+ and k inputs, and create() refuses to build it if this exceeds a given
+ memory cap.
+ */
+class DistinguishingOracle
+{
+private:
+    /** The DFSM table the oracle has been calculated for */
+    std::shared_ptr<const DenseDFSMTable> table;
+
+    /** Number of states */
+    int numStates;
+
+    /**
+     * Length of the shortest distinguishing trace of each pair,
+     * or 0 if the states of the pair are equivalent
+     */
+    std::vector<int> dist;
+
+    /**
+     * First input of the shortest distinguishing trace of each pair,
+     * or -1 if the states of the pair are equivalent
+     */
+    std::vector<int> input;
+
+    /** Index of the unordered pair {s1,s2}, s1 != s2 */
+    static size_t pairIdx(int s1, int s2) {
+        if ( s1 > s2 ) std::swap(s1, s2);
+        return static_cast<size_t>(s2) * (s2 - 1) / 2 + s1;
+    }
+
+    explicit DistinguishingOracle(const std::shared_ptr<const DenseDFSMTable>& table);
+
+    void calcDistinguishingTraces(const int s1,
+                                  const int s2,
+                                  std::vector<int>& trc,
+                                  std::vector< std::vector<int> >& traces) const;
+
+public:
+    /** Default memory cap used by Dfsm, 256 MiB */
+    static const size_t defaultMaxBytes;
+
+    /**
+     * Return the number of bytes needed to calculate an oracle for
+     * numStates states and numInputs inputs
+     */
+    static size_t memoryRequired(const int numStates, const int numInputs);
+
+    /**
+     * Calculate the oracle for a DFSM
+     * @param table Transition table of the DFSM
+     * @param maxBytes Memory cap
+     * @return the oracle, or nullptr if it would need more than maxBytes
+     * \pre The DFSM is completely specified
+     */
+    static std::shared_ptr<DistinguishingOracle>
+    create(const std::shared_ptr<const DenseDFSMTable>& table,
+           const size_t maxBytes = defaultMaxBytes);
+
+    /**
+     * Return the length of the shortest trace distinguishing s1 and s2,
+     * or 0 if they are equivalent
+     */
+    int getDistance(const int s1, const int s2) const {
+        return s1 == s2 ? 0 : dist[pairIdx(s1, s2)];
+    }
+
+    /** Return true if and only if states s1 and s2 are not equivalent */
+    bool distinguishable(const int s1, const int s2) const {
+        return getDistance(s1, s2) > 0;
+    }
+
+    /**
+     * Return a shortest input trace distinguishing s1 and s2, or an
+     * empty trace if they are equivalent
+     */
+    std::vector<int> calcDistinguishingTrace(int s1, int s2) const;
+
+    /**
+     * Return all shortest input traces distinguishing s1 and s2, in
+     * lexicographic order
+     */
+    std::vector< std::vector<int> > calcDistinguishingTraces(const int s1, const int s2) const;
+};
+#endif //FSM_FSM_DISTINGUISHINGORACLE_H_
@@ -4,57 +4,144 @@
  * Licensed under the EUPL V.1.1
  */
 
+#include <algorithm>
 #include <chrono>
+#include <thread>
+#include <unordered_map>
 
+#include "fsm/CSRTransitionTable.h"
 #include "fsm/Dfsm.h"
+#include "fsm/DistinguishabilityMatrix.h"
 #include "fsm/Fsm.h"
 #include "fsm/FsmNode.h"
 #include "fsm/FsmTransition.h"
 #include "fsm/InputTrace.h"
+#include "fsm/LabelIndex.h"
+#include "fsm/OFSMPartition.h"
 #include "fsm/OFSMTable.h"
+#include "fsm/ResponsePartition.h"
+#include "fsm/SplittingTree.h"
 #include "sets/HittingSet.h"
+#include "trees/TreeEdge.h"
 #include "trees/TreeNode.h"
 #include "trees/OutputTree.h"
 #include "trees/Tree.h"
 #include "trees/IOListContainer.h"
+#include "trees/SuffixSharingTree.h"
 #include "trees/TestSuite.h"
 
 
 using namespace std;
 
+namespace {
+
+    /** Hash of a sorted list of state indices, used as subset key */
+    struct SubsetHash {
+        size_t operator()(const vector<int>& subset) const {
+            uint64_t h = subset.size();
+            for ( int s : subset ) {
+                h ^= static_cast<uint64_t>(s) + 0x9e3779b97f4a7c15ULL + (h << 12) + (h >> 4);
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+    /**
+     * Check whether one of the input traces distinguishes n1 and n2.
+     * The traces of a tree are extracted once by the callers instead
+     * of once per pair, as FsmNode::distinguished(node, w) does.
+     */
+    bool distinguishedByAny(FsmNode const *n1, FsmNode const *n2,
+                            const IOListContainer::IOListBaseType& traces) {
+        for ( auto const &iLst : traces ) {
+            if ( n1->distinguished(n2, iLst) ) return true;
+        }
+        return false;
+    }
+
+    /** A leaf of the output tree created by PrefixSimulation */
+    struct LeafEntry {
+        /** State reached */
+        FsmNode *state;
+        /** Index of the leaf of the previous level extended by this one */
+        int parent;
+        /** Output produced, unless the input is undefined in the parent's state */
+        int output;
+        bool undefined;
+    };
+
+    /**
+     * Execution of input traces from a state, sharing the simulation of
+     * common prefixes between consecutive traces. Level d holds the
+     * leaves of the output tree after the first d inputs of the last
+     * trace, in the order in which FsmNode::apply() creates them.
+     */
+    class PrefixSimulation {
+    private:
+        vector< vector<LeafEntry> > levels;
+        vector<TreeNode*> treeNodes;
+        vector<TreeNode*> nextTreeNodes;
+
+    public:
+        explicit PrefixSimulation(FsmNode *state)
+        : levels(1, vector<LeafEntry> { { state, -1, 0, true } }) { }
+
+        /**
+         * Return the output tree of trc, reusing the levels of the
+         * first numShared inputs, which trc shares with the last trace
+         */
+        OutputTree run(const vector<int>& trc, const size_t numShared,
+                       const shared_ptr<const FsmPresentationLayer>& pl) {
+            if ( levels.size() <= trc.size() ) levels.resize(trc.size() + 1);
+            for ( size_t d = numShared + 1; d <= trc.size(); d++ ) {
+                vector<LeafEntry>& level = levels[d];
+                level.clear();
+                const vector<LeafEntry>& previous = levels[d - 1];
+                for ( size_t i = 0; i < previous.size(); i++ ) {
+                    bool defined = false;
+                    for ( auto const &tr : previous[i].state->getTransitions() ) {
+                        if ( tr->getLabel()->getInput() != trc[d - 1] ) continue;
+                        level.push_back({ tr->getTarget(), static_cast<int>(i),
+                                          tr->getLabel()->getOutput(), false });
+                        defined = true;
+                    }
+                    // Undefined inputs leave the leaf unchanged
+                    if ( not defined ) {
+                        level.push_back({ previous[i].state, static_cast<int>(i), 0, true });
+                    }
+                }
+            }
+
+            OutputTree ot(InputTrace(trc, pl), pl);
+            treeNodes.assign(1, ot.getRoot());
+            for ( size_t d = 1; d <= trc.size(); d++ ) {
+                nextTreeNodes.clear();
+                for ( auto const &leaf : levels[d] ) {
+                    TreeNode *parentNode = treeNodes[leaf.parent];
+                    if ( leaf.undefined ) {
+                        nextTreeNodes.push_back(parentNode);
+                        continue;
+                    }
+                    unique_ptr<TreeEdge> edge { new TreeEdge(leaf.output) };
+                    nextTreeNodes.push_back(edge->getTarget());
+                    parentNode->add(std::move(edge));
+                }
+                treeNodes.swap(nextTreeNodes);
+            }
+            return ot;
+        }
+    };
+
+}
+
 std::unique_ptr<FsmNode> Fsm::newNode(const int id, std::pair<FsmNode*, FsmNode*> const &p,
-                                      FsmPresentationLayer *pl) const
+                                      FsmPresentationLayer const *pl) const
 {
     FsmNode *n { new FsmNode(id, pl->getStateId(id,"")) };
     n->setDerivedFrom(p.first, p.second);
     return std::unique_ptr<FsmNode>(n);
 }
 
-bool Fsm::contains(deque<pair<FsmNode*, FsmNode*>> const &lst,
-                   pair<FsmNode*, FsmNode*> const &p) const {
-    return std::find(lst.begin(), lst.end(), p) != lst.end();
-}
-
-bool Fsm::contains(vector<FsmNode*> const &lst, FsmNode const *n) const {
-    return std::any_of(lst.begin(), lst.end(), [n](FsmNode const *node)->bool{
-        return node->isDerivedFrom(n->getDerivedFrom());
-    });
-}
-
-FsmNode * Fsm::findp(vector<FsmNode*> const &lst,
-                               pair<FsmNode*, FsmNode*> const &p) const {
-    std::vector<FsmNode*> vec;
-    vec.push_back(p.first);
-    vec.push_back(p.second);
-    auto iter = std::find_if(lst.begin(), lst.end(), [&vec](FsmNode const *node)->bool{
-        return node->isDerivedFrom(vec);
-    });
-    if(iter != lst.end()) {
-        return *iter;
-    }
-    return nullptr;
-}
-
 void Fsm::parseLine(const string & line)
 {
     stringstream ss(line);
@@ -114,8 +201,7 @@ void Fsm::parseLine(const string & line)
         nodes.at(target)->setFsm(this);
     }
     
-    FsmLabel *lbl = new FsmLabel(input, output, presentationLayer.get());
-    std::unique_ptr<FsmTransition> transition { new FsmTransition(currentParsedNode, nodes.at(target).get(), std::unique_ptr<FsmLabel>(lbl)) };
+    std::unique_ptr<FsmTransition> transition { new FsmTransition(currentParsedNode, nodes.at(target).get(), FsmLabel(input, output)) };
     currentParsedNode->addTransition(std::move(transition));
 }
 
@@ -199,18 +285,19 @@ void Fsm::readFsmInitial (const string & fname)
 }
 
 
-string Fsm::labelString(unordered_set<FsmNode*> const &lbl) const
+string Fsm::labelString(vector<int> const &lbl) const
 {
     string s = "{ ";
     
     bool isFirst = true;
-    for (FsmNode *n : lbl)
+    for (int idx : lbl)
     {
         if (!isFirst)
         {
             s += ",";
         }
         isFirst = false;
+        FsmNode *n = nodes[idx].get();
         s += n->getName() + "(" + to_string(n->getId()) + ")";
     }
     
@@ -218,7 +305,7 @@ string Fsm::labelString(unordered_set<FsmNode*> const &lbl) const
     return s;
 }
 
-Fsm::Fsm() { }
+Fsm::Fsm() : numThreads(1) { }
 
 Fsm::Fsm(const Fsm& other) {
     
@@ -230,7 +317,8 @@ Fsm::Fsm(const Fsm& other) {
     initStateIdx = other.initStateIdx;
     characterisationSet = nullptr;
     minimal = other.minimal;
-    presentationLayer = other.presentationLayer->clone();
+    presentationLayer = other.presentationLayer;
+    numThreads = other.numThreads;
     
     for ( int n = 0; n <= maxState; n++ ) {
         nodes.emplace_back(new FsmNode(n,name));
@@ -244,8 +332,7 @@ Fsm::Fsm(const Fsm& other) {
         auto theOldFsmNodeSrc = other.nodes[n].get();
         for ( auto &tr : theOldFsmNodeSrc->getTransitions() ) {
             int tgtId = tr->getTarget()->getId();
-            std::unique_ptr<FsmLabel> newLbl { new FsmLabel(*tr->getLabel()) };
-            std::unique_ptr<FsmTransition> transition { new FsmTransition(theNewFsmNodeSrc,nodes[tgtId].get(),std::move(newLbl)) };
+            std::unique_ptr<FsmTransition> transition { new FsmTransition(theNewFsmNodeSrc,nodes[tgtId].get(),*tr->getLabel()) };
             theNewFsmNodeSrc->addTransition(std::move(transition));
         }
     }
@@ -255,7 +342,7 @@ Fsm::Fsm(const Fsm& other) {
     
 }
 
-Fsm::Fsm(std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
+Fsm::Fsm(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
 :
 name(""),
 currentParsedNode(nullptr),
@@ -265,13 +352,14 @@ maxState(-1),
 initStateIdx(-1),
 characterisationSet(nullptr),
 minimal(Maybe),
-presentationLayer(std::move(presentationLayer))
+presentationLayer(presentationLayer),
+numThreads(1)
 {
     
 }
 
 Fsm::Fsm(const string& fname,
-         std::unique_ptr<FsmPresentationLayer> &&presentationLayer,
+         const std::shared_ptr<const FsmPresentationLayer>& presentationLayer,
          const string& fsmName)
 :
 name(fsmName),
@@ -281,7 +369,8 @@ maxOutput(-1),
 maxState(-1),
 characterisationSet(nullptr),
 minimal(Maybe),
-presentationLayer(std::move(presentationLayer))
+presentationLayer(presentationLayer),
+numThreads(1)
 {
     readFsm(fname);
     if ( initStateIdx >= 0 ) nodes[initStateIdx]->markAsInitial();
@@ -293,7 +382,7 @@ Fsm::Fsm(const string & fname,
          const int maxNodes,
          const int maxInput,
          const int maxOutput,
-         std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
+         const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
 :
 name(fsmName),
 currentParsedNode(nullptr),
@@ -302,7 +391,8 @@ maxOutput(maxOutput),
 maxState(maxNodes),
 characterisationSet(nullptr),
 minimal(Maybe),
-presentationLayer(std::move(presentationLayer))
+presentationLayer(presentationLayer),
+numThreads(1)
 {
     
     for (int i = 0; i < maxNodes; ++ i)
@@ -318,7 +408,7 @@ Fsm::Fsm(const string & fsmName,
          const int maxInput,
          const int maxOutput,
          std::vector<std::unique_ptr<FsmNode>> &&lst,
-         std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
+         const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
 :
 name(fsmName),
 nodes(std::move(lst)),
@@ -329,7 +419,8 @@ maxState((int)(nodes.size()-1)),
 initStateIdx(0),
 characterisationSet(nullptr),
 minimal(Maybe),
-presentationLayer(std::move(presentationLayer))
+presentationLayer(presentationLayer),
+numThreads(1)
 {
     // reset all nodes as 'white' and 'unvisited'
     for ( auto &n : nodes ) {
@@ -376,6 +467,8 @@ void Fsm::setInitialState(FsmNode *node) {
     });
     if(found != nodes.end()) {
         initStateIdx = found - nodes.begin();
+        // The CSR table records the initial state
+        invalidateCSRTransitionTable();
     }
 }
 
@@ -403,9 +496,17 @@ std::vector<std::unique_ptr<FsmNode>> const &Fsm::getNodes() const {
     return nodes;
 }
 
-FsmPresentationLayer *Fsm::getPresentationLayer() const
+const std::shared_ptr<const FsmPresentationLayer>& Fsm::getPresentationLayer() const
+{
+    return presentationLayer;
+}
+
+std::shared_ptr<const CSRTransitionTable> Fsm::getCSRTransitionTable() const
 {
-    return presentationLayer.get();
+    if ( csrTable == nullptr ) {
+        csrTable = make_shared<CSRTransitionTable>(*this);
+    }
+    return csrTable;
 }
 
 int Fsm::getInitStateIdx() const
@@ -429,19 +530,12 @@ void Fsm::toDot(const string & fname)
 
 Fsm Fsm::intersect(const Fsm & f) const
 {
-    // A list of node pairs which is used to
-    // control the breath-first search (BFS)
-    std::deque<std::pair<FsmNode*, FsmNode*>> nodeList;
-
-    // A list of new FSM states, each state created from a pair of
-    // this-nodes and f-nodes. At the end of this operation,
-    // the new FSM will be created from this list.
-    std::vector<FsmNode*> fsmInterNodes;
-    int id = 0;
-    
-    // Initially, add the pair of initial this-node and f-node
-    // into the BFS list.
-    nodeList.push_back(std::pair<FsmNode*, FsmNode*>(getInitialState(), f.getInitialState()));
+    // The outgoing transitions of both FSMs, indexed by label, so that
+    // the transitions of a pair of states are joined by one merge pass
+    shared_ptr<const CSRTransitionTable> myCsr = getCSRTransitionTable();
+    shared_ptr<const CSRTransitionTable> theirCsr = f.getCSRTransitionTable();
+    LabelIndex myIdx(*myCsr);
+    LabelIndex theirIdx(*theirCsr);
     
     // We need a new presentation layer. It has the same inputs and
     // outputs as this Fsm, but the state names will be pairs of
@@ -452,154 +546,123 @@ Fsm Fsm::intersect(const Fsm & f) const
                                 presentationLayer->getOut2String(),
                                 stateNames) };
     
-    // This is the BFS loop, running over the (this,f)-node pairs
-    while (!nodeList.empty())
-    {
-        // Remove the head of the list and use p to refer to it
-        // p refers to the SOURCE node pair, from where all
-        // outgoing transitions are investigated in this loop cycle
-        std::pair<FsmNode*, FsmNode*> p = nodeList.front();
-        nodeList.pop_front();
-        
-        // current node of this FSM
-        FsmNode *myCurrentNode = p.first;
-        
-        // current node of the f-FSM
-        FsmNode *theirCurrentNode = p.second;
-        
-        // Do we already have an FSM state for the new FSM
-        // stored in fsmInterNodes, which is associated
-        // with the current pair p?
-        FsmNode *nSource = findp(fsmInterNodes, p);
-        
-        if (nSource == nullptr)
+    // A list of new FSM states, each state created from a pair of
+    // this-nodes and f-nodes, in breadth-first order. The pair of
+    // each state is stored in pairLst, and the pairs are mapped to
+    // the states by a hash table keyed by (this-index << 32 | f-index).
+    std::vector<FsmNode*> fsmInterNodes;
+    std::vector<std::pair<int, int>> pairLst;
+    unordered_map<uint64_t, int> nodeOfPair;
+    
+    // Return the new state for the pair of this-node i and f-node j,
+    // creating it if it does not exist yet
+    auto getNode = [&](const int i, const int j) -> FsmNode* {
+        uint64_t key = (static_cast<uint64_t>(i) << 32) | static_cast<uint64_t>(j);
+        auto ins = nodeOfPair.emplace(key, static_cast<int>(fsmInterNodes.size()));
+        if (ins.second)
         {
+            FsmNode *myNode = nodes[i].get();
+            FsmNode *theirNode = f.nodes[j].get();
             
             // Set the node name as pair of the individual node names
-            string newNodeName("(" + myCurrentNode->getName() + "," +
-                               theirCurrentNode->getName() + ")");
-            
-            // Register node name in new presentation layer
-            newPl->addState2String(newNodeName);
-            
-            // We create the new FSM state associated with p:
-            // nSource is created from the state
-            // pair(myCurrentNode,theirCurrentNode)
-            // which is identified by p.
-            nSource = newNode(id++, p, newPl.get()).release();
-            fsmInterNodes.push_back(nSource);
+            // and register it in the new presentation layer
+            newPl->addState2String("(" + myNode->getName() + "," +
+                                   theirNode->getName() + ")");
             
+            const int id = static_cast<int>(fsmInterNodes.size());
+            fsmInterNodes.push_back(newNode(id, make_pair(myNode, theirNode), newPl.get()).release());
+            pairLst.emplace_back(i, j);
         }
+        return fsmInterNodes[ins.first->second];
+    };
+    
+    // The BFS starts with the pair of initial this-node and f-node.
+    // Pairs created while processing a pair are appended to pairLst,
+    // so that only reachable pairs are explored.
+    getNode(myCsr->getInitStateIdx(), theirCsr->getInitStateIdx());
+    
+    for (size_t next = 0; next < pairLst.size(); ++ next)
+    {
+        const int i = pairLst[next].first;
+        const int j = pairLst[next].second;
+        FsmNode *nSource = fsmInterNodes[next];
         
-        // Mark this node: now all of its outgoing transitions are constructed
-        nSource->setVisited();
-        
-        // Loop over all transitions emanating from myCurrentNode
-        for (auto &tr : myCurrentNode->getTransitions())
+        // Both transition lists are ordered by label: advance the one
+        // with the smaller label, and on equal labels create one
+        // transition per pair of target nodes
+        int tMy = myIdx.begin(i);
+        int tTheir = theirIdx.begin(j);
+        while (tMy < myIdx.end(i) and tTheir < theirIdx.end(j))
         {
-            // Loop over all transitions emanating from theirCurrentNode
-            for (auto &trOther : theirCurrentNode->getTransitions())
+            if (myIdx.labelLess(tMy, theirIdx, tTheir))
+            {
+                ++ tMy;
+                continue;
+            }
+            if (theirIdx.labelLess(tTheir, myIdx, tMy))
             {
-                /* If tr and trOther have identical labels, we can create a
-                   transition for the new FSM to be created.
-                   The transition has source node (myCurrentNode,theirCurrentNode)
-                   and label tr.getLabel(), which is the same as
-                   the label associated with the other transition,
-                   and target node (tr.getTarget(),trOther.getTarget()),
-                   which is the pair of the target nodes
-                   of each transition.*/
-                
-                if (*tr->getLabel() == *trOther->getLabel())
+                ++ tTheir;
+                continue;
+            }
+            
+            const int myEnd = myIdx.labelEnd(i, tMy);
+            const int theirEnd = theirIdx.labelEnd(j, tTheir);
+            FsmLabel lbl(myIdx.getInput(tMy), myIdx.getOutput(tMy));
+            for (int t1 = tMy; t1 < myEnd; ++ t1)
+            {
+                for (int t2 = tTheir; t2 < theirEnd; ++ t2)
                 {
-                    
-                    // New target node represented as a pair (this-node,f-node)
-                    auto pTarget = std::pair<FsmNode*, FsmNode*>(tr->getTarget(), trOther->getTarget());
-                    
-                    // If the target node does not yet exist in the list
-                    // of state for the new FSM, then create it now
-                    FsmNode *nTarget = findp(fsmInterNodes, pTarget);
-                    if (nTarget == nullptr)
-                    {
-                        // Set the node name as pair of the individual node names
-                        string newNodeName("(" + tr->getTarget()->getName() +
-                                           "," +
-                                           trOther->getTarget()->getName() + ")");
-                        
-                        // Register node name in new presentation layer
-                        newPl->addState2String(newNodeName);
-                        
-                        nTarget = newNode(id++, pTarget, newPl.get()).release();
-                        fsmInterNodes.push_back(nTarget);
-                    }
-                    
-                    // Add transition from nSource to nTarget
+                    FsmNode *nTarget = getNode(myIdx.getTarget(t1), theirIdx.getTarget(t2));
                     std::unique_ptr<FsmTransition> transition { new FsmTransition(nSource,
                                                                                   nTarget,
-                                                                                  tr->getLabel()->clone()) };
+                                                                                  lbl) };
                     nSource->addTransition(std::move(transition));
-                    
-                    /* Conditions for insertion of the target pair
-                       into the nodeList:
-                     1. the target node corresponding to the pair
-                        has not yet been processed
-                        (that is,  nTarget.hasBeenVisited() == false)
-                     2. The target pair is not already entered into the nodeList
-                     */
-                    if (not (nTarget->hasBeenVisited() or
-                             contains(nodeList, pTarget)))
-                    {
-                        nodeList.push_back(pTarget);
-                    }
                 }
             }
+            tMy = myEnd;
+            tTheir = theirEnd;
         }
     }
     
-    newPl->dumpState(cout);
     std::vector<std::unique_ptr<FsmNode>> newNodes;
     std::transform(fsmInterNodes.begin(), fsmInterNodes.end(), std::back_inserter(newNodes), [](FsmNode * const &node){
         return std::unique_ptr<FsmNode>(node);
     });
     
-    return Fsm(f.getName(), maxInput, maxOutput, std::move(newNodes), newPl->clone());
+    return Fsm(f.getName(), maxInput, maxOutput, std::move(newNodes), std::move(newPl));
 }
 
 std::unique_ptr<Tree> Fsm::getStateCover()
 {
-    resetColor();
-    std::deque<FsmNode*> bfsLst;
-    unordered_map<FsmNode*, TreeNode*> f2t;
+    std::shared_ptr<const CSRTransitionTable> csr = getCSRTransitionTable();
+    std::deque<int> bfsLst;
+    vector<TreeNode*> f2t(csr->size(), nullptr);
     
-    std::unique_ptr<Tree> scov { new Tree(presentationLayer->clone()) };
+    std::unique_ptr<Tree> scov { new Tree(presentationLayer) };
     TreeNode *root = scov->getRoot();
     
-    FsmNode *initState = getInitialState();
-    initState->setColor(FsmNode::grey);
+    int initState = csr->getInitStateIdx();
     bfsLst.push_back(initState);
     f2t[initState] = root;
     
     while (!bfsLst.empty())
     {
-        FsmNode *thisNode = bfsLst.front();
+        int thisNode = bfsLst.front();
         bfsLst.pop_front();
         TreeNode *currentTreeNode = f2t[thisNode];
         
-        for (int x = 0; x <= maxInput; ++x)
+        // Transitions are sorted by input, so this visits the
+        // targets in the same order as iterating over all inputs
+        for (int t = csr->begin(thisNode); t < csr->end(thisNode); ++t)
         {
-            for (FsmNode *tgt : thisNode->after(x))
+            int tgt = csr->getTarget(t);
+            if (f2t[tgt] == nullptr)
             {
-                if (tgt->getColor() == FsmNode::white)
-                {
-                    tgt->setColor(FsmNode::grey);
-                    TreeNode *itn = currentTreeNode->add(x);
-                    bfsLst.push_back(tgt);
-                    f2t[tgt] = itn;
-                }
+                f2t[tgt] = currentTreeNode->add(csr->getInput(t));
+                bfsLst.push_back(tgt);
             }
         }
-        thisNode->setColor(FsmNode::black);
     }
-    resetColor();
     return std::move(scov);
 }
 
@@ -617,7 +680,7 @@ std::unique_ptr<Tree> Fsm::getTransitionCover()
         tlst.push_back(l);
     }
     
-    IOListContainer tcl = IOListContainer(tlst, presentationLayer->clone());
+    IOListContainer tcl = IOListContainer(tlst, presentationLayer);
     
     //TODO: Shouldn't this be filtered for traces that actually exist?
     scov->add(tcl);
@@ -632,28 +695,12 @@ OutputTree Fsm::apply(const InputTrace & itrc, bool markAsVisited)
 
 Fsm Fsm::transformToObservableFSM() const
 {
-    
-    // List to be filled with the new states to be created
-    // for the observable FSM
-    vector<FsmNode*> nodeLst;
-    
-    // Breadth first search list, containing the
-    // new FSM nodes, still to be processed by the algorithm
-    vector<FsmNode*> bfsLst;
-
-    // Map a newly created node to the set of nodes from the
-    // original FSM, comprised in the new FSM state
-    unordered_map<FsmNode*, unordered_set<FsmNode*>> node2NodeLabel;
-    
-    // Set of nodes from the original FSM, comprised in the
-    // current new node
-    unordered_set<FsmNode*> theNodeLabel;
-    
-    // For the first step of the algorithm, the initial
-    // state of the original FSM is the only state comprised
-    // in the initial state of the new FSM
-    theNodeLabel.insert(getInitialState());
-
+    // Each state of the observable FSM comprises a set of states of
+    // this FSM. These sets are represented by sorted lists of state
+    // indices, which serve as canonical keys in a hash table.
+    shared_ptr<const CSRTransitionTable> csr = getCSRTransitionTable();
+    LabelIndex lblIdx(*csr);
+    const uint64_t numOutputs = static_cast<uint64_t>(maxOutput) + 1;
     
     // Create a new presentation layer which has
     // the same names for the inputs and outputs as
@@ -665,120 +712,91 @@ Fsm Fsm::transformToObservableFSM() const
                                 presentationLayer->getOut2String(),
                                 obsState2String) };
     
-    
-    // id to be taken for the next state of the new
-    // observable FSM to be created.
-    int id = 0;
+    // New states in order of creation, and the set of states of
+    // this FSM comprised by each of them. The keys of an unordered_map
+    // are not moved on rehashing, so that the pointers remain valid.
+    vector<FsmNode*> nodeLst;
+    vector<const vector<int>*> subsetOf;
+    unordered_map<vector<int>, int, SubsetHash> nodeOfSubset;
+    
+    // Return the new state comprising a set of states, creating
+    // it if it does not exist yet. The subset is only moved into
+    // the table for new states, so that its buffer is reused otherwise.
+    auto getNode = [&](vector<int>& subset) -> FsmNode* {
+        auto it = nodeOfSubset.find(subset);
+        if (it != nodeOfSubset.end())
+        {
+            return nodeLst[it->second];
+        }
+        it = nodeOfSubset.emplace(std::move(subset), static_cast<int>(nodeLst.size())).first;
+        string nodeName = labelString(it->first);
+        nodeLst.push_back(new FsmNode(static_cast<int>(nodeLst.size()), nodeName));
+        subsetOf.push_back(&it->first);
+        obsPl->addState2String(nodeName);
+        return nodeLst.back();
+    };
     
     // The initial state of the new FSM is labelled with
     // the set containing just the initial state of the old FSM
-    string nodeName = labelString(theNodeLabel);
-    FsmNode *q0 = new FsmNode(id++, nodeName);
-    nodeLst.push_back(q0);
-    bfsLst.push_back(q0);
-    node2NodeLabel[q0] = theNodeLabel;
-    
-    // The node label is added to the presentation layer,
-    // as name of the initial state
-    obsPl->addState2String(nodeName);
-    
-    // Loop while there is at least one node in the BFS list.
-    // Initially, the list contains just the new initial state
-    // of the new FSM.
-    while (!bfsLst.empty())
+    vector<int> subset { csr->getInitStateIdx() };
+    getNode(subset);
+    
+    // Process the new states in breadth first order. States created
+    // while processing state q are appended to nodeLst.
+    vector<uint64_t> trans;
+    for (size_t next = 0; next < nodeLst.size(); ++ next)
     {
-        // Pop the first node from the list
-        FsmNode *q = bfsLst.front();
-        bfsLst.erase(bfsLst.begin());
+        FsmNode *q = nodeLst[next];
+        const vector<int>& members = *subsetOf[next];
         
-        // Nested loop over all input/output labels that
-        // might be associated with one or more outgoing transitions
-        for (int x = 0; x <= maxInput; ++ x)
+        // Collect the labelled transitions of all states comprised by q,
+        // ordered by label and target state and
+        // encoded as (x*(maxOutput+1)+y) << 32 | target
+        trans.clear();
+        for (int s : members)
         {
-            for (int y = 0; y <= maxOutput; ++ y)
+            for (int t = lblIdx.begin(s); t < lblIdx.end(s); ++ t)
             {
-                // This is the transition label currently processed
-                std::unique_ptr<FsmLabel> lbl { new FsmLabel(x, y, obsPl.get()) };
-                
-                // Clear the set of node labels that may
-                // serve as node name for the target node to be
-                // created (or already exists). This target node
-                // comprises all nodes of the original FSM that
-                // can be reached from q under a transition labelled
-                // with lbl
-                theNodeLabel.clear();
-                
-                // Loop over all nodes of the original FSM which
-                // are comprised by q
-                for (FsmNode *n : node2NodeLabel.at(q))
-                {
-                    // For each node comprised by q, check
-                    // its outgoing transitions, whether they are
-                    // labelled by lbl
-                    for (auto &tr : n->getTransitions())
-                    {
-                        if (*tr->getLabel() == *lbl)
-                        {
-                            // If so, insert the target node
-                            // into the node label set
-                            theNodeLabel.insert(tr->getTarget());
-                        }
-                    }
-                }
-                
-                // Process only non-empty label sets.
-                // An empty label set means that no transition labelled
-                // by lbl exists.
-                if (!theNodeLabel.empty())
-                {
-                    
-                    FsmNode *tgtNode = nullptr;
-                    
-                    // Loop over the node-2-label map and check
-                    // if there exists already a node labelled
-                    // by theNodeLabel. If this is the case,
-                    // it will become the target node reached from q
-                    // under lbl
-                    for ( auto u : node2NodeLabel ) {
-                        
-                        if ( u.second == theNodeLabel ) {
-                            tgtNode = u.first;
-                            break;
-                        }
-                        
-                    }
-                    
-                    if (tgtNode == nullptr)
-                    {
-                        // We need to create a new target node, to be reached
-                        // from q under lbl
-                        nodeName = labelString(theNodeLabel);
-                        tgtNode = new FsmNode(id++, nodeName);
-                        nodeLst.push_back(tgtNode);
-                        bfsLst.push_back(tgtNode);
-                        node2NodeLabel[tgtNode] = theNodeLabel;
-                        obsPl->addState2String(nodeName);
-                    }
-                    
-                    // Create the transition from q to tgtNode
-                    std::unique_ptr<FsmTransition> transition { new FsmTransition(q, tgtNode, std::move(lbl)) };
-                    q->addTransition(std::move(transition));
-                }
+                uint64_t code = lblIdx.getInput(t) * numOutputs + lblIdx.getOutput(t);
+                trans.push_back((code << 32) | static_cast<uint64_t>(lblIdx.getTarget(t)));
             }
         }
+        if (members.size() > 1)
+        {
+            sort(trans.begin(), trans.end());
+            trans.erase(unique(trans.begin(), trans.end()), trans.end());
+        }
+        
+        // Each label occurring in trans yields one transition of q,
+        // leading to the set of targets of this label. The labels are
+        // processed in ascending order.
+        size_t i = 0;
+        while (i < trans.size())
+        {
+            uint64_t code = trans[i] >> 32;
+            subset.clear();
+            for ( ; i < trans.size() and (trans[i] >> 32) == code; ++ i)
+            {
+                subset.push_back(static_cast<int>(trans[i] & 0xffffffffULL));
+            }
+            
+            FsmNode *tgtNode = getNode(subset);
+            FsmLabel lbl(static_cast<int>(code / numOutputs),
+                         static_cast<int>(code % numOutputs));
+            std::unique_ptr<FsmTransition> transition { new FsmTransition(q, tgtNode, lbl) };
+            q->addTransition(std::move(transition));
+        }
     }
 
     std::vector<std::unique_ptr<FsmNode>> newNodes;
     std::transform(nodeLst.begin(), nodeLst.end(), std::back_inserter(newNodes), [](FsmNode * const &node){
         return std::unique_ptr<FsmNode>(node);
     });
-    return Fsm(name + "_O", maxInput, maxOutput, std::move(newNodes), obsPl->clone());
+    return Fsm(name + "_O", maxInput, maxOutput, std::move(newNodes), std::move(obsPl));
 }
 
 bool Fsm::isObservable() const {
-    return std::all_of(nodes.begin(), nodes.end(), [](std::unique_ptr<FsmNode> const &node){
-        return node->isObservable();
-    });
+    return getCSRTransitionTable()->isObservable();
 }
 
 Minimal Fsm::isMinimal() const
@@ -786,31 +804,27 @@ Minimal Fsm::isMinimal() const
     return minimal;
 }
 
-void Fsm::calcOFSMTables() {
+void Fsm::calcOFSMPartition() {
     
-    ofsmTableLst.clear();
-    
-    // Create the initial OFSMTable representing the FSM,
-    //  where all FSM states belong to the same class
-    shared_ptr<OFSMTable> tbl = make_shared<OFSMTable>(nodes, maxInput, maxOutput, presentationLayer.get());
-    
-    // Create all possible OFSMTables, each new one from its
-    // predecessor, and add them to the ofsmTableLst
-    while (tbl != nullptr)
-    {
-        ofsmTableLst.push_back(tbl);
-        tbl = tbl->next();
-    }
+    ofsmTable = make_shared<OFSMTable>(nodes, maxInput, maxOutput, presentationLayer.get());
+    OFSMPartition partition(*ofsmTable, numThreads);
+    ofsmTable->setS2C(partition.getS2C());
+    ofsmSplittingTree = make_shared<SplittingTree>(partition.getSplittingTree());
     
 }
 
+void Fsm::invalidateOFSMPartition() {
+    ofsmTable = nullptr;
+    ofsmSplittingTree = nullptr;
+}
+
 Fsm Fsm::minimiseObservableFSM()
 {
-    calcOFSMTables();
+    calcOFSMPartition();
 
-    // The last OFSMTable defined has classes corresponding to
-    // the minimised FSM to be constructed*/
-    shared_ptr<OFSMTable> tbl = ofsmTableLst.back();
+    // The classes of the OFSM table correspond to the states of
+    // the minimised FSM to be constructed
+    shared_ptr<OFSMTable> tbl = ofsmTable;
     
     // Create the minimised FSM from tbl and return it
     Fsm fsm = tbl->toFsm(name + "_MIN");
@@ -834,17 +848,9 @@ Fsm Fsm::minimise()
 
 bool Fsm::isCharSet(Tree const *w) const
 {
-    for (unsigned int i = 0; i < nodes.size(); ++ i)
-    {
-        for (unsigned int j = i + 1; j < nodes.size(); ++ j)
-        {
-            if (nodes.at(i)->distinguished(nodes.at(j).get(), w) == nullptr)
-            {
-                return false;
-            }
-        }
-    }
-    return true;
+    IOListContainer iolc = w->getIOLists();
+    DistinguishabilityMatrix matrix(getCSRTransitionTable(), iolc.getIOLists(), numThreads);
+    return matrix.distinguishesAllStates();
 }
 
 void Fsm::minimiseCharSet(Tree const *w)
@@ -860,7 +866,7 @@ void Fsm::minimiseCharSet(Tree const *w)
         IOListContainer wcntNew = IOListContainer(wcnt);
         wcnt.getIOLists().erase(wcnt.getIOLists().begin() + i);
         
-        std::unique_ptr<Tree> itr { new Tree(presentationLayer->clone()) };
+        std::unique_ptr<Tree> itr { new Tree(presentationLayer) };
         itr->addToRoot(wcntNew);
         if (isCharSet(itr.get()))
         {
@@ -873,6 +879,67 @@ void Fsm::minimiseCharSet(Tree const *w)
     }
 }
 
+void Fsm::addDistinguishingTraces(Tree& w,
+                                  const std::function<InputTrace(FsmNode*, FsmNode*)>& calcTrace)
+{
+    // Add trace i to w
+    auto addTrace = [this, &w](const InputTrace& i) {
+        IOListContainer::IOListBaseType lli;
+        lli.push_back(i.get());
+        IOListContainer tcli = IOListContainer(lli, presentationLayer);
+        w.addToRoot(tcli);
+    };
+    
+    shared_ptr<const CSRTransitionTable> csr = getCSRTransitionTable();
+    if (not csr->isCompletelyDefined())
+    {
+        // Undefined inputs are skipped when applying a trace, so that
+        // extending a trace of w may merge states it has distinguished
+        // before: check each pair against the traces currently in w.
+        IOListContainer iolc = w.getIOLists();
+        for (unsigned int left = 0; left < nodes.size(); ++ left)
+        {
+            FsmNode *leftNode = nodes.at(left).get();
+            for (unsigned int right = left + 1; right < nodes.size(); ++ right)
+            {
+                FsmNode *rightNode = nodes.at(right).get();
+                if (not distinguishedByAny(leftNode, rightNode, iolc.getIOLists()))
+                {
+                    addTrace(calcTrace(leftNode, rightNode));
+                    iolc = w.getIOLists();
+                }
+            }
+        }
+        return;
+    }
+    
+    // For completely specified FSMs, the response to a trace of w
+    // determines the responses to all its prefixes, so that the pairs
+    // distinguished by w are those distinguished by any trace added.
+    ResponsePartition partition(csr, numThreads);
+    for (int left = 0; left < static_cast<int>(nodes.size()); ++ left)
+    {
+        // Visit the states right > left not distinguished from left
+        // in ascending order, skipping those a new trace has failed
+        // to distinguish from left
+        int right = left;
+        while (true)
+        {
+            int next = partition.nextUndistinguished(left);
+            while (next >= 0 and next <= right)
+            {
+                next = partition.nextUndistinguished(next);
+            }
+            if (next < 0) break;
+            right = next;
+            
+            InputTrace i = calcTrace(nodes[left].get(), nodes[right].get());
+            addTrace(i);
+            partition.refine(i.get());
+        }
+    }
+}
+
 IOListContainer Fsm::getCharacterisationSet()
 {
    std::cout << "Calculating characterisation set." << std::endl;
@@ -893,40 +960,17 @@ IOListContainer Fsm::getCharacterisationSet()
     minimise();
     
     /*Create an empty characterisation set as an empty InputTree instance*/
-    std::unique_ptr<Tree> w { new Tree(presentationLayer->clone()) };
+    std::unique_ptr<Tree> w { new Tree(presentationLayer) };
     
     /*Loop over all non-equal pairs of states.
      Calculate the state identification sets.*/
-    for (unsigned int left = 0; left < nodes.size(); ++ left)
-    {
-        FsmNode *leftNode = nodes.at(left).get();
-        
-        for (unsigned int right = left + 1; right < nodes.size(); ++ right)
-        {
-            FsmNode *rightNode = nodes.at(right).get();
-            
-            /*Nothing to do if leftNode and rightNode are
-             already distinguished by an element of w*/
-            if (leftNode->distinguished(rightNode, w.get()) != nullptr)
-            {
-                continue;
-            }
-            
-            /*We have to create a new input trace and add it to w, because
-             leftNode and rightNode are not distinguished by the current
-             input traces contained in w. */
-            InputTrace i = leftNode->calcDistinguishingTrace(rightNode,
-                                                             ofsmTableLst,
-                                                             maxInput,
-                                                             maxOutput);
-            IOListContainer::IOListBaseType lli;
-            lli.push_back(i.get());
-            IOListContainer tcli = IOListContainer(lli, presentationLayer->clone());
-            
-            /*Insert this also into w*/
-            w->addToRoot(tcli);
-        }
-    }
+    addDistinguishingTraces(*w, [this](FsmNode *leftNode, FsmNode *rightNode) {
+        return leftNode->calcDistinguishingTrace(rightNode,
+                                                 *ofsmSplittingTree,
+                                                 *ofsmTable,
+                                                 maxInput,
+                                                 maxOutput);
+    });
     
     /*Minimise and store characterisation set*/
     characterisationSet = std::move(w);
@@ -962,53 +1006,45 @@ void Fsm::calcStateIdentificationSets()
     /*wLst.get(0) is identified with Integer(0),
      wLst.get(1) is identified with Integer(1), ...*/
     
-    vector<vector<unordered_set<int>>> z;
-    z.resize(nodes.size());
-    for (unsigned int i = 0; i < nodes.size(); ++ i) {
-        z.at(i).resize(nodes.size());
-    }
+    /*The traces of W distinguishing each pair of FsmNodes*/
+    DistinguishabilityMatrix z(getCSRTransitionTable(), wLst, numThreads);
     
-    for (unsigned int i = 0; i < nodes.size(); ++ i)
-    {
-        FsmNode *iNode = nodes.at(i).get();
-        
-        for (unsigned int j = i + 1; j < nodes.size(); ++ j)
+    /*Calculate minimal state identification sets for the
+     FsmNodes i = first, first + step, ...*/
+    vector<unordered_set<int>> hittingSets(nodes.size());
+    auto calcHittingSets = [this, &z, &hittingSets](const size_t first, const size_t step) {
+        for (size_t i = first; i < nodes.size(); i += step)
         {
-            FsmNode *jNode = nodes.at(j).get();
-            
-            for (unsigned int u = 0; u < wLst.size(); ++ u)
-            {
-                vector<int> thisTrace = wLst.at(u);
-                
-                if (iNode->distinguished(jNode, thisTrace))
-                {
-                    z.at(i).at(j).insert(u);
-                    z.at(j).at(i).insert(u);
-                }
-            }
+            HittingSet hs = HittingSet(z.getDistinguishingTraceSets(static_cast<int>(i)));
+            hittingSets[i] = hs.calcMinCardHittingSet();
+        }
+    };
+    
+    unsigned threads = numThreads > 0 ? numThreads : max(1u, thread::hardware_concurrency());
+    threads = static_cast<unsigned>(min<size_t>(threads, nodes.size()));
+    if (threads <= 1)
+    {
+        calcHittingSets(0, 1);
+    }
+    else
+    {
+        vector<thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back(calcHittingSets, t, threads);
+        }
+        for (auto& w : workers) {
+            w.join();
         }
     }
     
     for (unsigned int i = 0; i < nodes.size(); ++ i)
     {
-        vector<unordered_set<int>> iLst;
-        for (unsigned int j = 0; j < nodes.size(); ++ j) {
-            if (i != j) {
-                iLst.push_back(z.at(i).at(j));
-            }
-        }
-        
-        /*Calculate minimal state identification set for
-         FsmNode i*/
-        HittingSet hs = HittingSet(iLst);
-        unordered_set<int> h = hs.calcMinCardHittingSet();
-        
-        std::unique_ptr<Tree> iTree { new Tree(presentationLayer->clone()) };
-        for (int u : h) {
+        std::unique_ptr<Tree> iTree { new Tree(presentationLayer) };
+        for (int u : hittingSets[i]) {
             vector<int> lli = wLst.at(u);
             IOListContainer::IOListBaseType lllli;
             lllli.push_back(lli);
-            iTree->addToRoot(IOListContainer(lllli, presentationLayer->clone()));
+            iTree->addToRoot(IOListContainer(lllli, presentationLayer));
         }
         stateIdentificationSets.push_back(std::move(iTree));
         
@@ -1038,22 +1074,19 @@ void Fsm::calcStateIdentificationSetsFast()
     IOListContainer wIC = characterisationSet->getIOLists();
     IOListContainer::IOListBaseType wLst = wIC.getIOLists();
     
-    // Matrix indexed over nodes
-    vector< vector<int> > distinguish;
+    // The traces of W distinguishing each pair of nodes
+    DistinguishabilityMatrix distinguish(getCSRTransitionTable(), wLst, numThreads);
     
     // Every node is associated with an IOListContainer
     // containing its distinguishing traces
     vector< IOListContainer > node2iolc;
     
     for (size_t i = 0; i < size(); ++ i) {
-        node2iolc.push_back(IOListContainer(presentationLayer->clone()));
-        vector<int> v;
-        distinguish.push_back(v);
-        for (size_t j = 0; j < size(); j++ ) {
-            distinguish.at(i).push_back(-1);
-        }
+        node2iolc.push_back(IOListContainer(presentationLayer));
     }
     
+    // Every pair of nodes is distinguished by the first trace
+    // of W distinguishing them
     for (size_t i = 0; i < size(); ++ i) {
         
         int traceIdx = 0;
@@ -1061,23 +1094,18 @@ void Fsm::calcStateIdentificationSetsFast()
             
             bool complete = true;
             for ( size_t j = i+1; j < size(); j++ ) {
-                if ( distinguish.at(i).at(j) == -1 ) {
-                    
-                    if (nodes[i]->distinguished(nodes[j].get(), trc))
-                    {
-                        distinguish.at(i).at(j) = traceIdx;
-                        distinguish.at(j).at(i) = traceIdx;
-                        Trace tr(trc,presentationLayer->clone());
-                        node2iolc.at(i).add(tr);
-                        node2iolc.at(j).add(tr);
-                    }
-                    else {
-                        complete = false;
-                    }
-                    
+                int first = distinguish.firstDistinguishingTrace(i, j);
+                if ( first == traceIdx ) {
+                    Trace tr(trc,presentationLayer);
+                    node2iolc.at(i).add(tr);
+                    node2iolc.at(j).add(tr);
+                }
+                else if ( first < 0 or first > traceIdx ) {
+                    complete = false;
                 }
             }
             
+            // All nodes following node i are distinguished from it
             if ( complete ) break;
             traceIdx++;
         
@@ -1086,7 +1114,7 @@ void Fsm::calcStateIdentificationSetsFast()
     
     
     for (size_t i = 0; i < size(); ++ i) {
-        std::unique_ptr<Tree> iTree { new Tree(presentationLayer->clone()) };
+        std::unique_ptr<Tree> iTree { new Tree(presentationLayer) };
         iTree->addToRoot(node2iolc.at(i));
         stateIdentificationSets.push_back(std::move(iTree));
     }
@@ -1099,83 +1127,127 @@ void Fsm::appendStateIdentificationSets(Tree *Wp2) const
     
     for (vector<int> lli : cnt.getIOLists())
     {
-        InputTrace itrc = InputTrace(lli, presentationLayer->clone());
+        InputTrace itrc = InputTrace(lli, presentationLayer);
         
         /*Which are the target nodes reachable via input trace lli
          in this FSM?*/
-        unordered_set<FsmNode*> tgtNodes = getInitialState()->after(itrc);
+        StateSet tgtNodes = getInitialState()->afterAsStateSet(lli);
         
-        for (FsmNode const *n : tgtNodes)
-        {
-            int nodeId = n->getId();
+        tgtNodes.forEach([this, &itrc, Wp2](int nodeId) {
             
             /*Get state identification set associated with n*/
-            auto const &wNodeId = stateIdentificationSets.at(nodeId);
+            auto const &wNodeId = stateIdentificationSets.at(nodes[nodeId]->getId());
             
             /*Append state identification set to Wp2 tree node
              reached after applying  itrc*/
             Wp2->addAfter(itrc, wNodeId->getIOLists());
-        }
+        });
     }
 }
 
 
+void Fsm::appendStateIdentificationSets(SuffixSharingTree& Wp2) const
+{
+    appendToReachedStates(Wp2, stateIdentificationSets);
+}
+
+void Fsm::appendToReachedStates(SuffixSharingTree& tree,
+                                const vector<unique_ptr<Tree>>& sets) const
+{
+    shared_ptr<const CSRTransitionTable> csr = getCSRTransitionTable();
+    
+    /*The sets appended to a leaf only depend on the target nodes
+     reachable via its input trace, so that they are appended once
+     to every subtree shared by leaves reaching the same nodes*/
+    vector<int> initial = getInitialState()->afterAsStateSet(vector<int>()).toVector();
+    
+    tree.addAfterLeaves(initial,
+                        [&csr](const vector<int>& tgtNodes, const int x) {
+                            return csr->after(tgtNodes, vector<int> { x });
+                        },
+                        [this, &sets](const vector<int>& tgtNodes) {
+                            IOListContainer cnt(presentationLayer);
+                            for (int nodeId : tgtNodes) {
+                                IOListContainer w = sets.at(nodes[nodeId]->getId())->getIOLists();
+                                for (auto& lst : w.getIOLists()) {
+                                    cnt.getIOLists().push_back(std::move(lst));
+                                }
+                            }
+                            return cnt;
+                        });
+}
+
 IOListContainer Fsm::wMethod(const unsigned int numAddStates) {
     return transformToObservableFSM().minimise().wMethodOnMinimisedFsm(numAddStates);
 }
 
 IOListContainer Fsm::wMethodOnMinimisedFsm(const unsigned int numAddStates) {
+    return wMethodTreeOnMinimisedFsm(numAddStates).getIOLists();
+}
+
+SuffixSharingTree Fsm::wMethodTreeOnMinimisedFsm(const unsigned int numAddStates) {
     
-    std::unique_ptr<Tree> iTree = getTransitionCover();
+    /* The test tree is built with shared W suffixes and only
+       expanded when its test cases are enumerated */
+    SuffixSharingTree iTree(*getTransitionCover());
     
     if ( numAddStates > 0 ) {
         IOListContainer inputEnum = IOListContainer(maxInput,
                                                     1,
                                                     (int)numAddStates,
-                                                    presentationLayer->clone());
-        iTree->add(inputEnum);
+                                                    presentationLayer);
+        iTree.add(inputEnum);
     }
     
     
     IOListContainer w = getCharacterisationSet();
-    iTree->add(w);
+    iTree.add(w);
     
-    return iTree->getIOLists();
+    return iTree;
     
 }
 
 IOListContainer Fsm::wpMethod(const unsigned int numAddStates) {
+    return wpMethodTree(numAddStates).getIOLists();
+}
+
+SuffixSharingTree Fsm::wpMethodTree(const unsigned int numAddStates) {
     std::unique_ptr<Tree> scov = getStateCover();
     std::unique_ptr<Tree> tcov = getTransitionCover();
     tcov->remove(scov.get());
     IOListContainer w = getCharacterisationSet();
     calcStateIdentificationSetsFast();
     
-    std::unique_ptr<Tree> Wp1 = scov->clone();
+    SuffixSharingTree Wp1(*scov);
     if (numAddStates > 0) {
         IOListContainer inputEnum = IOListContainer(maxInput, 1,
                                                     (int)numAddStates,
-                                                    presentationLayer->clone());
-        Wp1->add(inputEnum);
+                                                    presentationLayer);
+        Wp1.add(inputEnum);
     }
-    Wp1->add(w);
+    Wp1.add(w);
     
-    std::unique_ptr<Tree> Wp2 = tcov->clone();
+    SuffixSharingTree Wp2(*tcov);
     if (numAddStates > 0) {
         IOListContainer inputEnum = IOListContainer(maxInput,
                                                     (int)numAddStates,
                                                     (int)numAddStates,
-                                                    presentationLayer->clone());
-        Wp2->add(inputEnum);
+                                                    presentationLayer);
+        Wp2.add(inputEnum);
     }
-    appendStateIdentificationSets(Wp2.get());
+    appendStateIdentificationSets(Wp2);
 
-    Wp1->unionTree(Wp2.get());
-    return Wp1->getIOLists();
+    Wp1.unionTree(Wp2);
+    return Wp1;
 }
 
 
 IOListContainer Fsm::hsiMethod(const unsigned int numAddStates)
+{
+    return hsiMethodTree(numAddStates).getIOLists();
+}
+
+SuffixSharingTree Fsm::hsiMethodTree(const unsigned int numAddStates)
 {
 
     if (!isObservable())
@@ -1187,18 +1259,18 @@ IOListContainer Fsm::hsiMethod(const unsigned int numAddStates)
     IOListContainer wSet = getCharacterisationSet();
 
     /* V.(Inputs from length 1 to m-n+1) */
-    std::unique_ptr<Tree> hsi = getStateCover();
+    SuffixSharingTree hsi(*getStateCover());
     IOListContainer inputEnum = IOListContainer(maxInput,
                                                     1,
                                                     (int)numAddStates + 1,
-                                                    presentationLayer->clone());
-    hsi->add(inputEnum);
+                                                    presentationLayer);
+    hsi.add(inputEnum);
 
     /* initialize HWi trees */
     std::vector<std::unique_ptr<Tree>> hwiTrees;
     for (unsigned i = 0; i < nodes.size(); i++)
     {
-        std::unique_ptr<Tree> emptyTree { new Tree(presentationLayer->clone()) };
+        std::unique_ptr<Tree> emptyTree { new Tree(presentationLayer) };
         hwiTrees.push_back(std::move(emptyTree));
     }
 
@@ -1207,66 +1279,116 @@ IOListContainer Fsm::hsiMethod(const unsigned int numAddStates)
      * of the characterisation set that distinguishes the two nodes.
      * Add the distinguishing sequence to both HWi and HWj.
      */
+    DistinguishabilityMatrix distinguish(getCSRTransitionTable(), wSet.getIOLists(), numThreads);
     for (unsigned i = 0; i < nodes.size()-1; i++)
     {
-        FsmNode *node1 = nodes[i].get();
         for (unsigned j = i+1; j < nodes.size(); j++)
         {
-            FsmNode *node2 = nodes[j].get();
-            bool distinguished = false;
-            for (auto iolst : wSet.getIOLists())
-            {
-                if (node1->distinguished(node2, iolst)){
-                    distinguished = true;
-                    hwiTrees[i]->addToRoot(iolst);
-                    hwiTrees[j]->addToRoot(iolst);
-                    break;
-                }
+            int u = distinguish.firstDistinguishingTrace(i, j);
+            if (u >= 0) {
+                auto const &iolst = wSet.getIOLists().at(u);
+                hwiTrees[i]->addToRoot(iolst);
+                hwiTrees[j]->addToRoot(iolst);
             }
-            if (!distinguished) {
+            else {
                 cout << "[ERR] Found inconsistency when applying HSI-Method: FSM not minimal." << endl;
             }
         }
     }
 
     /* Append harmonised state identification sets */
-    IOListContainer cnt = hsi->getIOLists();
-    for (auto lli : cnt.getIOLists())
-    {
-        InputTrace itrc = InputTrace(lli, presentationLayer->clone());
-
-        /*Which are the target nodes reachable via input trace lli
-         in this FSM?*/
-        unordered_set<FsmNode*> tgtNodes = getInitialState()->after(itrc);
+    appendToReachedStates(hsi, hwiTrees);
 
-        for (auto n : tgtNodes)
-        {
-            int nodeId = n->getId();
-
-            /* harmonised state identification set associated with n*/
-            Tree *hwNodeId = hwiTrees[nodeId].get();
-
-            /* Append harmonised state identification set to hsi tree node
-               reached after applying itrc */
-            hsi->addAfter(itrc,hwNodeId->getIOLists());
-        }
-    }
-
-    return hsi->getIOLists();
+    return hsi;
 }
 
 TestSuite Fsm::createTestSuite(IOListContainer testCases)
 {
-    IOListContainer::IOListBaseType tcLst = testCases.getIOLists();
-    TestSuite theSuite;
-    std::transform(tcLst.begin(), tcLst.end(), std::back_inserter(theSuite), 
-                   [this](IOListContainer::IOListBaseType::value_type const &trace){
-        return apply(InputTrace(trace, presentationLayer->clone()));
+    IOListContainer::IOListBaseType const &tcLst = testCases.getIOLists();
+    
+    // Executing the test cases in lexicographic order walks the tree
+    // of test cases depth-first, so that consecutive test cases share
+    // their longest common prefix
+    vector<size_t> order(tcLst.size());
+    for ( size_t i = 0; i < order.size(); i++ ) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&tcLst](size_t a, size_t b) {
+        return tcLst[a] < tcLst[b];
     });
     
+    // The subtrees of the test case tree below the root are
+    // executed concurrently: group g starts at order[groupStart[g]]
+    vector<size_t> groupStart;
+    for ( size_t k = 0; k < order.size(); k++ ) {
+        if ( k == 0 or tcLst[order[k]].empty() or tcLst[order[k-1]].empty()
+            or tcLst[order[k]][0] != tcLst[order[k-1]][0] ) {
+            groupStart.push_back(k);
+        }
+    }
+    groupStart.push_back(order.size());
+    const size_t numGroups = groupStart.size() - 1;
+    
+    vector<unique_ptr<OutputTree>> results(tcLst.size());
+    FsmNode *initialState = getInitialState();
+    auto execute = [this, &tcLst, &order, &groupStart, &results, initialState, numGroups]
+    (const size_t firstGroup, const size_t step) {
+        PrefixSimulation simulation(initialState);
+        for ( size_t g = firstGroup; g < numGroups; g += step ) {
+            for ( size_t k = groupStart[g]; k < groupStart[g + 1]; k++ ) {
+                vector<int> const &trc = tcLst[order[k]];
+                size_t numShared = 0;
+                if ( k > groupStart[g] ) {
+                    vector<int> const &previous = tcLst[order[k - 1]];
+                    while ( numShared < trc.size() and numShared < previous.size()
+                           and trc[numShared] == previous[numShared] ) {
+                        ++ numShared;
+                    }
+                }
+                results[order[k]].reset(new OutputTree(simulation.run(trc, numShared, presentationLayer)));
+            }
+        }
+    };
+    
+    unsigned threads = numThreads > 0 ? numThreads : max(1u, thread::hardware_concurrency());
+    threads = static_cast<unsigned>(min<size_t>(threads, numGroups));
+    if ( threads <= 1 ) {
+        execute(0, 1);
+    }
+    else {
+        vector<thread> workers;
+        for ( unsigned t = 0; t < threads; t++ ) {
+            workers.emplace_back(execute, t, threads);
+        }
+        for ( auto& w : workers ) {
+            w.join();
+        }
+    }
+    
+    TestSuite theSuite;
+    theSuite.reserve(results.size());
+    for ( auto &ot : results ) {
+        theSuite.push_back(std::move(*ot));
+    }
     return theSuite;
 }
 
+void Fsm::createTestSuite(const IOListContainer::IOListSource& testCases,
+                          const TestSuite::OutputTreeVisitor& visitor)
+{
+    // Test trees enumerate their test cases depth-first, so that
+    // sharing the prefix with the previous test case suffices
+    PrefixSimulation simulation(getInitialState());
+    vector<int> previous;
+    testCases([this, &simulation, &previous, &visitor](const vector<int>& trc) {
+        size_t numShared = 0;
+        while ( numShared < trc.size() and numShared < previous.size()
+               and trc[numShared] == previous[numShared] ) {
+            ++ numShared;
+        }
+        visitor(simulation.run(trc, numShared, presentationLayer));
+        previous.assign(trc.begin(), trc.end());
+    });
+}
+
 bool Fsm::isCompletelyDefined() const
 {
     bool cDefd = true;
@@ -1300,9 +1422,9 @@ bool Fsm::isDeterministic() const
     });
 }
 
-void Fsm::setPresentationLayer(std::unique_ptr<FsmPresentationLayer> &&ppresentationLayer)
+void Fsm::setPresentationLayer(const std::shared_ptr<const FsmPresentationLayer>& ppresentationLayer)
 {
-    presentationLayer = std::move(ppresentationLayer);
+    presentationLayer = ppresentationLayer;
 }
 
 ostream & operator<<(ostream & out, const Fsm & fsm)
@@ -1353,7 +1475,7 @@ Fsm::createRandomFsm(const string & fsmName,
                      const int maxInput,
                      const int maxOutput,
                      const int maxState,
-                     std::unique_ptr<FsmPresentationLayer> &&pl,
+                     const std::shared_ptr<const FsmPresentationLayer>& pl,
                      const unsigned seed) {
     
     // Initialisation of random number generation
@@ -1414,7 +1536,7 @@ Fsm::createRandomFsm(const string & fsmName,
             x0 = rand() % (maxInput+1);
             y0 = rand() % (maxOutput+1);
             std::unique_ptr<FsmTransition> transition { new FsmTransition(srcNode,whiteNode,
-                                                            std::unique_ptr<FsmLabel>(new FsmLabel(x0,y0,pl.get()))) };
+                                                            FsmLabel(x0,y0)) };
             // Add transition to adjacency list of the source node
             srcNode->addTransition(std::move(transition));
             thisNode->setColor(FsmNode::black);
@@ -1444,98 +1566,32 @@ Fsm::createRandomFsm(const string & fsmName,
                     bfsq.push_back(tgtNode);
                 }
                 std::unique_ptr<FsmTransition> transition { new FsmTransition(srcNode,tgtNode,
-                                                                std::unique_ptr<FsmLabel>(new FsmLabel(x,y,pl.get()))) };
+                                                                FsmLabel(x,y)) };
                 // Add transition to adjacency list of the source node
                 srcNode->addTransition(std::move(transition));
             }
         }
     }
     
-    return std::unique_ptr<Fsm>(new Fsm(fsmName,maxInput,maxOutput,std::move(lst),std::move(pl)));
+    return std::unique_ptr<Fsm>(new Fsm(fsmName,maxInput,maxOutput,std::move(lst),pl));
 }
 
 std::unique_ptr<Fsm> Fsm::createMutant(const std::string & fsmName,
                                        const size_t numOutputFaults,
                                        const size_t numTransitionFaults) const {
     
-    srand(getRandomSeed());
-    
-    auto newPresentationLayer = presentationLayer->clone();
-    // Create new nodes for the mutant.
-    std::vector<std::unique_ptr<FsmNode> > lst;
-    for ( int n = 0; n <= maxState; n++ ) {
-        lst.emplace_back(new FsmNode(n,fsmName));
-    }
-    
-    // Now add transitions that correspond exactly to the transitions in
-    // this FSM
-    for ( int n = 0; n <= maxState; n++ ) {
-        auto theNewFsmNodeSrc = lst[n].get();
-        auto theOldFsmNodeSrc = nodes[n].get();
-        for ( auto &tr : theOldFsmNodeSrc->getTransitions() ) {
-            int tgtId = tr->getTarget()->getId();
-            auto newLbl = tr->getLabel()->clone();
-            std::unique_ptr<FsmTransition> transition { new FsmTransition(theNewFsmNodeSrc,lst[tgtId].get(),std::move(newLbl)) };
-            theNewFsmNodeSrc->addTransition(std::move(transition));
-        }
-    }
+    return createMutantOverlay(fsmName,numOutputFaults,numTransitionFaults).toFsm();
+}
+
+FsmMutant Fsm::createMutantOverlay(const std::string & fsmName,
+                                   const size_t numOutputFaults,
+                                   const size_t numTransitionFaults) const {
     
-    // Now add transition faults to the new machine
-    for ( size_t tf = 0; tf < numTransitionFaults; tf++ ) {
-        int srcNodeId = rand() % (maxState+1);
-        int newTgtNodeId = rand() % (maxState+1);
-        int trNo = rand() % lst[srcNodeId]->getTransitions().size();
-        auto &tr = lst.at(srcNodeId)->getTransitions().at(trNo);
-        if ( tr->getTarget()->getId() == newTgtNodeId ) {
-            newTgtNodeId = (newTgtNodeId+1) % (maxState+1);
-        }
-        lst.at(srcNodeId)->getTransitions().at(trNo)->setTarget(lst.at(newTgtNodeId).get());
-    }
-    
-    // Now add output faults to the new machine
-    for (size_t of = 0; of < numOutputFaults; of++ ) {
-        int srcNodeId = rand() % (maxState+1);
-        int trNo = rand() % lst[srcNodeId]->getTransitions().size();
-        auto &tr = lst.at(srcNodeId)->getTransitions().at(trNo);
-        int theInput = tr->getLabel()->getInput();
-        int newOutVal = rand() % (maxOutput+1);
-        int originalNewOutVal = rand() % (maxOutput+1);
-        bool newOutValOk;
-        
-        // We don't want to modify this transition in such a way
-        // that another one with the same label and the same
-        // source/target nodes already exists.
-        do {
-            
-            newOutValOk = true;
-            
-            for ( auto &trOther : lst[srcNodeId]->getTransitions() ) {
-                if ( tr == trOther ) continue;
-                if ( trOther->getTarget()->getId() != tr->getTarget()->getId() )
-                    continue;
-                if ( trOther->getLabel()->getInput() != theInput ) continue;
-                if ( trOther->getLabel()->getOutput() == newOutVal ) {
-                    newOutValOk = false;
-                }
-            }
-            
-            if ( not newOutValOk ) {
-                newOutVal = (newOutVal+1) % (maxOutput+1);
-            }
-            
-        } while ( (not newOutValOk) and (originalNewOutVal != newOutVal) );
-        
-        if ( newOutValOk ) {
-            
-            std::unique_ptr<FsmLabel> newLbl { new FsmLabel(tr->getLabel()->getInput(),
-                                                     newOutVal,
-                                                     newPresentationLayer.get()) };
-            
-            tr->setLabel(std::move(newLbl));
-        }
-    }
+    srand(getRandomSeed());
     
-    return std::unique_ptr<Fsm>(new Fsm(fsmName,maxInput,maxOutput,std::move(lst), std::move(newPresentationLayer)));
+    FsmMutant mutant(*this,fsmName);
+    mutant.injectFaults(*this,numOutputFaults,numTransitionFaults);
+    return mutant;
 }
 
 
@@ -1638,10 +1694,14 @@ bool Fsm::removeUnreachableNodes(std::vector<std::unique_ptr<FsmNode>>& unreacha
     // This is necessary, because during minimisation with OFSM tables or
     // Pk-tables, the algorithms rely on the range of row numbers being
     // identical to the range of node ids of the reachable nodes.
+    // The presentation layer may be shared with traces and trees, so
+    // state names are removed from a private copy.
+    std::unique_ptr<FsmPresentationLayer> newPl;
     int subtractFromId = 0;
     for ( auto &n : nodes ) {
         if ( not n->hasBeenVisited() ) {
-            presentationLayer->removeState2String(n->getId() - subtractFromId);
+            if ( newPl == nullptr ) newPl = presentationLayer->clone();
+            newPl->removeState2String(n->getId() - subtractFromId);
             unreachableNodes.push_back(std::move(n));
             ++subtractFromId;
         }
@@ -1652,6 +1712,9 @@ bool Fsm::removeUnreachableNodes(std::vector<std::unique_ptr<FsmNode>>& unreacha
     }
     
     nodes = std::move(newNodes);
+    if ( newPl != nullptr ) presentationLayer = std::move(newPl);
+    invalidateCSRTransitionTable();
+    invalidateOFSMPartition();
     
     return (unreachableNodes.size() > 0);
 }
@@ -1660,13 +1723,11 @@ bool Fsm::removeUnreachableNodes(std::vector<std::unique_ptr<FsmNode>>& unreacha
 
 bool Fsm::distinguishable(const FsmNode& s1, const FsmNode& s2) {
     
-    if ( ofsmTableLst.empty() ) {
-        calcOFSMTables();
+    if ( ofsmSplittingTree == nullptr ) {
+        calcOFSMPartition();
     }
     
-    shared_ptr<OFSMTable> p = ofsmTableLst.back();
-    
-    return ( p->getS2C().at(s1.getId()) != p->getS2C().at(s2.getId()) );
+    return ofsmSplittingTree->distinguishable(s1.getId(), s2.getId());
     
 }
 
@@ -7,6 +7,7 @@
 #define FSM_FSM_FSM_H_
 
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <set>
@@ -18,6 +19,8 @@
 
 #include "fsm/FsmVisitor.h"
 #include "trees/Tree.h"
+#include "trees/TestSuite.h"
+#include "fsm/FsmMutant.h"
 #include "fsm/FsmTransition.h"
 
 
@@ -28,8 +31,10 @@ class OutputTree;
 class InputTrace;
 class FsmPresentationLayer;
 class OFSMTable;
+class SplittingTree;
+class SuffixSharingTree;
 class IOListContainer;
-class TestSuite;
+class CSRTransitionTable;
 
 enum Minimal
 {
@@ -43,7 +48,7 @@ protected:
     /**
      *  Default constructors without effect - needed by sub-classes
      */
-    Fsm(std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+    Fsm(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
     Fsm();
     
     /** Name of the FSM -- appears in nodes when printing the FSM as a dot graph */
@@ -70,13 +75,35 @@ protected:
     Minimal minimal;
 
     
-    std::vector<std::shared_ptr<OFSMTable>> ofsmTableLst;
+    /**
+     *  OFSM table of this FSM, carrying the equivalence classes of
+     *  the states, created by calcOFSMPartition()
+     */
+    std::shared_ptr<OFSMTable> ofsmTable;
+    
+    /**
+     *  History of the OFSM table refinement, from which distinguishing
+     *  traces are derived, created by calcOFSMPartition()
+     */
+    std::shared_ptr<SplittingTree> ofsmSplittingTree;
     std::vector<std::unique_ptr<Tree>> stateIdentificationSets;
-    std::unique_ptr<FsmPresentationLayer> presentationLayer;
-    std::unique_ptr<FsmNode> newNode(const int id, std::pair<FsmNode*, FsmNode*> const &p, FsmPresentationLayer *pl) const;
-    bool contains(std::deque<std::pair<FsmNode*, FsmNode*>> const &lst, std::pair<FsmNode*, FsmNode*> const &p) const;
-    bool contains(std::vector<FsmNode*> const &lst, FsmNode const *n) const;
-    FsmNode * findp(std::vector<FsmNode*> const &lst, std::pair<FsmNode*, FsmNode*> const &p) const;
+    std::shared_ptr<const FsmPresentationLayer> presentationLayer;
+    
+    /**
+     *  Compressed sparse row copy of the transition relation, created
+     *  on demand by getCSRTransitionTable() and dropped whenever the
+     *  transition relation changes
+     */
+    mutable std::shared_ptr<CSRTransitionTable> csrTable;
+    
+    /**
+     *  Number of threads used for calculating characterisation sets
+     *  and state identification sets and for executing test suites,
+     *  see setNumThreads()
+     */
+    unsigned numThreads;
+    
+    std::unique_ptr<FsmNode> newNode(const int id, std::pair<FsmNode*, FsmNode*> const &p, FsmPresentationLayer const *pl) const;
     void parseLine(const std::string & line);
     void readFsm(const std::string & fname);
     
@@ -84,7 +111,21 @@ protected:
     void readFsmInitial (const std::string & fname);
     
     
-    std::string labelString(std::unordered_set<FsmNode*> const &lbl) const;
+    /**
+     * Return the name of a state of the observable FSM, built from the
+     * names of the states it comprises
+     * @param lbl Sorted list of the indices of the comprised states
+     */
+    std::string labelString(std::vector<int> const &lbl) const;
+    
+    /**
+     * Append to every leaf of tree the sets of input traces associated
+     * with the states reached by the input trace of the leaf
+     * @param sets The set of state s is sets.at(s), it is appended
+     *        as in Tree::addAfter()
+     */
+    void appendToReachedStates(SuffixSharingTree& tree,
+                               const std::vector<std::unique_ptr<Tree>>& sets) const;
     
     /**
      *  Return a random seed to be used for random generation
@@ -100,9 +141,25 @@ protected:
     std::vector< std::unordered_set<int> > getEquivalentInputsFromPrimeMachine();
 
     /**
-     *   Calculate OFSM tables and store them in ofsmTableLst
+     *   Calculate the equivalence classes of the states by signature
+     *   refinement (see OFSMPartition), and store them in ofsmTable
+     *   and the refinement history in ofsmSplittingTree
      */
-    void calcOFSMTables();
+    void calcOFSMPartition();
+    
+    /**
+     *   Add a distinguishing trace to w for every pair of states that
+     *   are not yet distinguished by w, visiting the pairs in
+     *   lexicographic order (Gill's algorithm).
+     *   For completely specified FSMs, the pairs not yet distinguished
+     *   are found by a ResponsePartition, calculated by numThreads
+     *   threads; otherwise each pair is checked by
+     *   FsmNode::distinguished(). In both cases, w does not depend on
+     *   the number of threads.
+     *   @param calcTrace Calculates a trace distinguishing two states
+     */
+    void addDistinguishingTraces(Tree& w,
+                                 const std::function<InputTrace(FsmNode*, FsmNode*)>& calcTrace);
     
 public:
     
@@ -121,7 +178,7 @@ public:
         const int maxNodes,
         const int maxInput,
         const int maxOutput,
-        std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+        const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
     
     /**
      *  Constructor creating an FSM specified in a file.
@@ -149,7 +206,7 @@ public:
      *
      */
     Fsm(const std::string& fname,
-        std::unique_ptr<FsmPresentationLayer> &&presentationLayer,
+        const std::shared_ptr<const FsmPresentationLayer>& presentationLayer,
         const std::string& fsmName);
     
     
@@ -166,7 +223,7 @@ public:
         const int maxInput,
         const int maxOutput,
         std::vector<std::unique_ptr<FsmNode>> &&lst,
-        std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+        const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
     
     
     /**
@@ -196,7 +253,7 @@ public:
                     const int maxInput,
                     const int maxOutput,
                     const int maxState,
-                    std::unique_ptr<FsmPresentationLayer> &&presentationLayer,
+                    const std::shared_ptr<const FsmPresentationLayer>& presentationLayer,
                     const unsigned seed = 0);
     
     /**
@@ -204,12 +261,25 @@ public:
      *  and/or transition faults only.
      *
      *  The number of states remains the same. If FSM is completely
-     *  specified, the same will hold for the mutant.
+     *  specified, the same will hold for the mutant. Faults which
+     *  would duplicate another transition of the same state are
+     *  not injected.
      */
     std::unique_ptr<Fsm> createMutant(const std::string & fsmName,
                                       const size_t numOutputFaults,
                                       const size_t numTransitionFaults) const;
     
+    /**
+     *  Create a mutant of the FSM like createMutant(), but represent
+     *  it as a set of modified transitions over the transition table
+     *  of this FSM. The mutant shares the table with this FSM and
+     *  with all other mutants, so that large numbers of mutants
+     *  can be created and executed cheaply.
+     */
+    FsmMutant createMutantOverlay(const std::string & fsmName,
+                                  const size_t numOutputFaults,
+                                  const size_t numTransitionFaults) const;
+    
     
     /**
      * Write FSM to text file using the standard format in each line
@@ -236,13 +306,38 @@ public:
     int getMaxInput() const;
     int getMaxOutput() const;
     std::vector<std::unique_ptr<FsmNode>> const &getNodes() const;
-    FsmPresentationLayer * getPresentationLayer() const;
+    const std::shared_ptr<const FsmPresentationLayer>& getPresentationLayer() const;
     int getInitStateIdx() const;
     void resetColor();
     void toDot(const std::string & fname);
     
     /**
-     Create a new FSM that represents the intersection of this and the other FSM
+     *  Return the transition relation of this FSM in compressed sparse
+     *  row format. The table is created on first use and cached until
+     *  the transition relation is modified.
+     */
+    std::shared_ptr<const CSRTransitionTable> getCSRTransitionTable() const;
+    
+    /**
+     *  Drop the cached CSR transition table. Called whenever
+     *  transitions are added, removed or redirected, and whenever
+     *  the initial state changes.
+     */
+    void invalidateCSRTransitionTable() const { csrTable = nullptr; }
+    
+    /**
+     *  Drop the OFSM table and splitting tree created by
+     *  calcOFSMPartition(). Called together with
+     *  invalidateCSRTransitionTable() when transitions change.
+     */
+    void invalidateOFSMPartition();
+    
+    /**
+     Create a new FSM that represents the intersection of this and the other FSM.
+     Only the pairs of states reachable from the pair of initial states
+     are created, in breadth-first order. The pairs are identified through
+     a hash table, and the transitions of both states of a pair are joined
+     on their labels using a LabelIndex of each FSM.
      @param f the other FSM
      @return a new FSM which equals the intersection of this and f
      */
@@ -278,6 +373,14 @@ public:
     
     /**
      *  Transform an FSM to its observable equivalent.
+     *
+     *  The states of the observable FSM are the sets of states of this
+     *  FSM reachable by the same I/O traces. They are created in
+     *  breadth-first order and identified through a hash table keyed
+     *  by the sorted list of the comprised state indices, so that the
+     *  transformation takes time linear in the number of transitions
+     *  of the created states (up to a logarithmic factor for sorting).
+     *  Each state is named after the comprised states in ascending order.
      */
     Fsm transformToObservableFSM() const;
     
@@ -315,6 +418,12 @@ public:
      @return minimal observable FSM which is equivalent to this FSM
      */
     Fsm minimise();
+    
+    /**
+     * Check whether the input traces of w distinguish every pair of
+     * different states of this observable FSM. The responses of the
+     * states are compared by a DistinguishabilityMatrix.
+     */
     bool isCharSet(Tree const *w) const;
     void minimiseCharSet(Tree const *w);
     
@@ -332,17 +441,44 @@ public:
      */
     IOListContainer getCharacterisationSet();
     
+    /**
+     *  Set the number of threads calculating the responses of the
+     *  states to the traces of the characterisation set in
+     *  getCharacterisationSet(), executing the test cases in
+     *  createTestSuite(), calculating the minimal hitting sets in
+     *  calcStateIdentificationSets() and refining the OFSM-table
+     *  classes in minimiseObservableFSM() (see OFSMPartition), or 0
+     *  to use one thread per hardware thread.
+     *  The results do not depend on this number.
+     *  By default, a single thread is used.
+     */
+    void setNumThreads(const unsigned n) { numThreads = n; }
+    unsigned getNumThreads() const { return numThreads; }
+    
     /**
      * Calculate the state identification sets. The sets are stored
      * in list stateIdentificationSets, ordered by the FSM state numbers.
      * \pre The FSM must be observable and minimal, and the characterisation
      * set must have been previously calculated using operation
      * getCharacterisationSet().
+     * The state identification sets are minimal hitting sets of the
+     * sets of traces in W distinguishing a state from the other ones;
+     * they are calculated concurrently for different states.
+     * The traces distinguishing each pair of states are taken from a
+     * DistinguishabilityMatrix, which simulates every state once per
+     * trace of W. calcStateIdentificationSetsFast() uses the same
+     * matrix, but only the first trace of W distinguishing each pair.
      */
     void calcStateIdentificationSets();
     void calcStateIdentificationSetsFast();
 
+    /**
+     * Append to every leaf of Wp2 the state identification sets of the
+     * states reached by the input trace of the leaf.
+     * \pre The state identification sets must have been calculated.
+     */
     void appendStateIdentificationSets(Tree *Wp2) const;
+    void appendStateIdentificationSets(SuffixSharingTree& Wp2) const;
     
     /**
      * Perform test generation by means of the W Method, as applicable
@@ -375,6 +511,14 @@ public:
      */
     IOListContainer wMethodOnMinimisedFsm(const unsigned int m);
     
+    /**
+     * Return the test tree of wMethodOnMinimisedFsm(), whose maximal
+     * input traces are the test cases. The tree shares its suffixes,
+     * so that the test cases can be enumerated by
+     * SuffixSharingTree::forEachIOList() without expanding them all.
+     */
+    SuffixSharingTree wMethodTreeOnMinimisedFsm(const unsigned int m);
+    
     
     /**
      * Perform test generation by means of the Wp Method. The algorithm
@@ -391,6 +535,11 @@ public:
      * @return A test suite
      */
     IOListContainer wpMethod(const unsigned int numAddStates);
+    
+    /**
+     * Return the test tree of wpMethod(), see wMethodTreeOnMinimisedFsm()
+     */
+    SuffixSharingTree wpMethodTree(const unsigned int numAddStates);
 
     /**
      * WORK IN PROGRESS
@@ -404,6 +553,11 @@ public:
      * @return A test suite
      */
     IOListContainer hsiMethod(const unsigned int numAddStates);
+    
+    /**
+     * Return the test tree of hsiMethod(), see wMethodTreeOnMinimisedFsm()
+     */
+    SuffixSharingTree hsiMethodTree(const unsigned int numAddStates);
 
     
     /**
@@ -421,6 +575,13 @@ public:
      *  Recall that the OutputTree is reduced to just an output list for
      *  the given input trace, if the FSM is deterministic.
      *
+     *  The test cases are executed depth-first in lexicographic order,
+     *  so that the states reached by a common prefix of several test
+     *  cases are calculated only once. The subtrees of the test case
+     *  tree below its root are executed concurrently, see setNumThreads().
+     *  The OutputTrees coincide with those created by apply(), and
+     *  they are returned in the order of the test cases.
+     *
      *  Recall further that two TestSuite instances can be compared
      *  with respect to I/O-equivalence, using TestSuite method isEquivalentTo().
      *  They can also be checked with respect to a reduction relationship
@@ -428,6 +589,20 @@ public:
      */
     TestSuite createTestSuite(IOListContainer testCases);
     
+    /**
+     *  Execute the test cases enumerated by testCases one at a time and
+     *  pass their OutputTrees to visitor, in the order of the test cases.
+     *  Apart from the OutputTree visited, only the states reached by the
+     *  prefixes of the current test case are held in memory, so that
+     *  test trees like wMethodTreeOnMinimisedFsm() can be executed
+     *  without expanding their test cases.
+     *
+     *  The OutputTrees coincide with those returned by
+     *  createTestSuite(IOListContainer).
+     */
+    void createTestSuite(const IOListContainer::IOListSource& testCases,
+                         const TestSuite::OutputTreeVisitor& visitor);
+    
     /**
      *  Identify equivalent inputs for completely specified FSMs.
      *  Two members x1, x2 of the FSM input alphabet are equivalent,
@@ -456,7 +631,7 @@ public:
     bool isDeterministic() const;
     
     
-    void setPresentationLayer(std::unique_ptr<FsmPresentationLayer> &&ppresentationLayer);
+    void setPresentationLayer(const std::shared_ptr<const FsmPresentationLayer>& ppresentationLayer);
     
     
     /** Return the number of states in this FSM */
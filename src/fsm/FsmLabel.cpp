@@ -4,56 +4,50 @@
  * Licensed under the EUPL V.1.1
  */
 #include "fsm/FsmLabel.h"
+#include "utils/prepostconditions.h"
 
 FsmLabel::FsmLabel(const int input,
-                   const int output,
-                   const FsmPresentationLayer *presentationLayer)
-	: input(input), output(output), presentationLayer(presentationLayer)
+                   const int output)
+	: io((static_cast<uint32_t>(input) << 16) | static_cast<uint32_t>(output))
 {
-
-}
-
-FsmLabel::FsmLabel(const FsmLabel& other) :
-   input(other.input), output(other.output), presentationLayer(other.presentationLayer)
-{
-    
+	Expects(input >= 0 && input <= maxValue);
+	Expects(output >= 0 && output <= maxValue);
 }
 
 std::unique_ptr<FsmLabel> FsmLabel::clone() const {
 	return std::unique_ptr<FsmLabel>(new FsmLabel(*this));
 }
 
-int FsmLabel::getInput() const
+bool operator==(FsmLabel const & label1, FsmLabel const & label2)
 {
-	return input;
+	return label1.io == label2.io;
 }
 
-int FsmLabel::getOutput() const
+bool operator!=(FsmLabel const & label1, FsmLabel const & label2)
 {
-	return output;
+	return label1.io != label2.io;
 }
 
-bool operator==(FsmLabel const & label1, FsmLabel const & label2)
+bool operator<(FsmLabel const & label1, FsmLabel const & label2)
 {
-	return label1.getInput() == label2.getInput() && label1.getOutput() == label2.getOutput();
+	// The input occupies the upper bits, so that this is the
+	// lexicographic order on (input, output)
+	return label1.io < label2.io;
 }
 
-bool operator<(FsmLabel const & label1, FsmLabel const & label2)
+void FsmLabel::print(std::ostream & out, FsmPresentationLayer const *presentationLayer) const
 {
-	if (label1.getInput() < label2.getInput())
-	{
-		return true;
-	}
-	else if (label1.getInput() == label2.getInput() && label1.getOutput() < label2.getOutput())
+	if (presentationLayer == nullptr)
 	{
-		return true;
+		out << *this;
+		return;
 	}
-	return false;
+	out << presentationLayer->getInId(getInput()) << "/" << presentationLayer->getOutId(getOutput());
 }
 
 std::ostream & operator<<(std::ostream & out, const FsmLabel & label)
 {
-	out << label.presentationLayer->getInId(label.input) << "/" << label.presentationLayer->getOutId(label.output);
+	out << label.getInput() << "/" << label.getOutput();
 	return out;
 }
 
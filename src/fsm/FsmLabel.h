@@ -6,44 +6,46 @@
 #ifndef FSM_FSM_FSMLABEL_H_
 #define FSM_FSM_FSMLABEL_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "fsm/FsmVisitor.h"
 #include "interface/FsmPresentationLayer.h"
 
+/**
+ Class representing an input/output label of an FSM transition.
+ The label is a value type: input and output are packed into a
+ single 32-bit word, with the input in the upper and the output
+ in the lower 16 bits. The names of inputs and outputs are obtained
+ from the presentation layer of the FSM owning the transition.
+ */
 class FsmLabel
 {
 private:
 	/**
-	The input of this label
+	The input (bits 16..31) and output (bits 0..15) of this label
 	*/
-	const int input;
+	uint32_t io;
 
+public:
 	/**
-	The output of this label
+	Maximal value admissible for inputs and outputs
 	*/
-	const int output;
+	static const int maxValue = 0xFFFF;
 
 	/**
-	The presentation layer used by this label
+	Create a label
+	@param input The input, in range 0..maxValue
+	@param output The output, in range 0..maxValue
 	*/
-	FsmPresentationLayer const *presentationLayer;
-public:
-	/**
-	 * Create a FsmLabel
-	 * @param input The input of this label
-	 * @param output The ouput of this label
-	 * @param maxInput The number of input
-	 * @param presentationLayer The presentation layer used by this label
-	 */
 	FsmLabel(const int input,
-             const int output,
-             const FsmPresentationLayer *presentationLayer);
+             const int output);
     
     /**
-     * Copy constructor
+     * Copy constructor and assignment, copying the packed value
      */
-    FsmLabel(const FsmLabel& other);
+    FsmLabel(const FsmLabel& other) = default;
+    FsmLabel& operator=(const FsmLabel& other) = default;
 
 	std::unique_ptr<FsmLabel> clone() const;
 
@@ -51,13 +53,20 @@ public:
 	Getter for the input
 	@return The input of this label
 	*/
-	int getInput() const;
+	int getInput() const { return static_cast<int>(io >> 16); }
 
 	/**
 	Getter for the output
 	@return The output of this label
 	*/
-	int getOutput() const;
+	int getOutput() const { return static_cast<int>(io & 0xFFFF); }
+
+	/**
+	Getter for the packed representation of the label, suitable
+	as key for hash tables and sorted indexes
+	@return input * 2^16 + output
+	*/
+	uint32_t getPackedValue() const { return io; }
 
 	/**
 	Check wheter or not, the 2 label are the same
@@ -66,6 +75,7 @@ public:
 	@return True if they are the same, false otherwise
 	*/
 	friend bool operator==(FsmLabel const & label1, FsmLabel const & label2);
+	friend bool operator!=(FsmLabel const & label1, FsmLabel const & label2);
 
     /**
      *  Accept an FsmVisitor
@@ -74,6 +84,7 @@ public:
     
 	/**
 	Check wheter or not, label1 is "smaller" than label2. this operator is needed 
+	for the use of this class in a set (in the java version, it's comparator)
 	@param label1 The first label
 	@param label2 The second label
 	@return True if label1 is "smaller" than label2, false otherwise
@@ -81,7 +92,16 @@ public:
 	friend bool operator<(FsmLabel const & label1, FsmLabel const & label2);
 
 	/**
-	Output the FsmLabel to a standard output stream
+	Output the FsmLabel to a standard output stream, using the
+	names defined by a presentation layer
+	@param out The standard output stream to use
+	@param presentationLayer The presentation layer defining the names
+	*/
+	void print(std::ostream & out, FsmPresentationLayer const *presentationLayer) const;
+
+	/**
+	Output the FsmLabel to a standard output stream, using the
+	numeric values of input and output
 	@param out The standard output stream to use
 	@param label The FsmLabel to print
 	@return The standard output stream used, to allow user to cascade <<
@@ -97,7 +117,7 @@ namespace std
 	public:
 		size_t operator()(const FsmLabel & x) const noexcept
 		{
-			return ((51 + std::hash<int>()(x.getInput())) * 51 + std::hash<int>()(x.getOutput()));
+			return std::hash<uint32_t>()(x.getPackedValue());
 		}
 	};
 }
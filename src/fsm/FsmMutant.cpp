@@ -0,0 +1,301 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+
+#include "fsm/CSRTransitionTable.h"
+#include "fsm/Fsm.h"
+#include "fsm/FsmMutant.h"
+#include "fsm/FsmNode.h"
+#include "fsm/FsmTransition.h"
+#include "fsm/InputTrace.h"
+#include "fsm/IOTrace.h"
+#include "fsm/OutputTrace.h"
+#include "trees/OutputTree.h"
+#include "trees/TreeEdge.h"
+#include "trees/TreeNode.h"
+
+using namespace std;
+
+FsmMutant::FsmMutant(const Fsm& fsm, const string& name)
+: name(name),
+base(fsm.getCSRTransitionTable()),
+presentationLayer(fsm.getPresentationLayer())
+{
+
+}
+
+FsmMutant::TransitionFault const * FsmMutant::findFault(const int t) const
+{
+    if ( faults.empty() ) return nullptr;
+    auto it = lower_bound(faults.begin(), faults.end(), t,
+                          [](TransitionFault const &f, int pos) {
+                              return f.transition < pos;
+                          });
+    if ( it == faults.end() or it->transition != t ) return nullptr;
+    return &(*it);
+}
+
+FsmMutant::TransitionFault & FsmMutant::getFault(const int t)
+{
+    auto it = lower_bound(faults.begin(), faults.end(), t,
+                          [](TransitionFault const &f, int pos) {
+                              return f.transition < pos;
+                          });
+    if ( it == faults.end() or it->transition != t ) {
+        it = faults.insert(it, { t, base->getOutput(t), base->getTarget(t) });
+    }
+    return *it;
+}
+
+int FsmMutant::getOutput(const int t) const
+{
+    TransitionFault const *f = findFault(t);
+    return (f == nullptr) ? base->getOutput(t) : f->output;
+}
+
+int FsmMutant::getTarget(const int t) const
+{
+    TransitionFault const *f = findFault(t);
+    return (f == nullptr) ? base->getTarget(t) : f->target;
+}
+
+void FsmMutant::setOutput(const int t, const int y)
+{
+    getFault(t).output = y;
+}
+
+void FsmMutant::setTarget(const int t, const int s)
+{
+    getFault(t).target = s;
+}
+
+bool FsmMutant::hasOtherTransition(const int s, const int t,
+                                   const int y, const int tgt) const
+{
+    auto r = base->range(s, base->getInput(t));
+    for ( int other = r.first; other < r.second; other++ ) {
+        if ( other == t ) continue;
+        if ( getTarget(other) != tgt ) continue;
+        if ( getOutput(other) == y ) return true;
+    }
+    return false;
+}
+
+int FsmMutant::getPosition(const Fsm& fsm, const int s, const int trNo) const
+{
+    // Transitions with the same input keep their order in the table
+    auto const &transitions = fsm.getNodes()[s]->getTransitions();
+    int x = transitions[trNo]->getLabel()->getInput();
+    int t = base->range(s, x).first;
+    for ( int k = 0; k < trNo; k++ ) {
+        if ( transitions[k]->getLabel()->getInput() == x ) t++;
+    }
+    return t;
+}
+
+void FsmMutant::injectFaults(const Fsm& fsm,
+                             const size_t numOutputFaults,
+                             const size_t numTransitionFaults)
+{
+    int numStates = base->size();
+    int maxOutput = base->getMaxOutput();
+    if ( numStates == 0 ) return;
+
+    // Transition faults: redirect a transition to another state
+    for ( size_t tf = 0; tf < numTransitionFaults; tf++ ) {
+        int srcNodeId = rand() % numStates;
+        int newTgtNodeId = rand() % numStates;
+        int numTrans = base->end(srcNodeId) - base->begin(srcNodeId);
+        if ( numTrans == 0 ) continue;
+        int t = getPosition(fsm, srcNodeId, rand() % numTrans);
+        int originalNewTgtNodeId = newTgtNodeId;
+        bool newTgtOk;
+
+        // As for output faults below, the redirected transition
+        // must neither keep its target nor duplicate another one
+        do {
+            newTgtOk = getTarget(t) != newTgtNodeId and
+                not hasOtherTransition(srcNodeId, t, getOutput(t), newTgtNodeId);
+            if ( not newTgtOk ) {
+                newTgtNodeId = (newTgtNodeId+1) % numStates;
+            }
+        } while ( (not newTgtOk) and (originalNewTgtNodeId != newTgtNodeId) );
+
+        if ( newTgtOk ) {
+            setTarget(t, newTgtNodeId);
+        }
+    }
+
+    // Output faults: change the output of a transition
+    for ( size_t of = 0; of < numOutputFaults; of++ ) {
+        int srcNodeId = rand() % numStates;
+        int numTrans = base->end(srcNodeId) - base->begin(srcNodeId);
+        if ( numTrans == 0 ) continue;
+        int t = getPosition(fsm, srcNodeId, rand() % numTrans);
+        int newOutVal = rand() % (maxOutput+1);
+        int originalNewOutVal = rand() % (maxOutput+1);
+        bool newOutValOk;
+
+        // We don't want to modify this transition in such a way
+        // that another one with the same label and the same
+        // source/target nodes already exists.
+        do {
+            newOutValOk = not hasOtherTransition(srcNodeId, t, newOutVal, getTarget(t));
+            if ( not newOutValOk ) {
+                newOutVal = (newOutVal+1) % (maxOutput+1);
+            }
+        } while ( (not newOutValOk) and (originalNewOutVal != newOutVal) );
+
+        if ( newOutValOk ) {
+            setOutput(t, newOutVal);
+        }
+    }
+}
+
+StateSet FsmMutant::after(const int s, const vector<int>& itrc) const
+{
+    StateSet states(base->size());
+    states.insert(s);
+    return after(states, itrc);
+}
+
+StateSet FsmMutant::after(const StateSet& states, const vector<int>& itrc) const
+{
+    if ( faults.empty() ) return base->after(states, itrc);
+
+    StateSet current(states);
+    StateSet next(base->size());
+
+    for ( int x : itrc ) {
+        next.clear();
+        current.forEach([this, x, &next](int s) {
+            auto r = base->range(s, x);
+            for ( int t = r.first; t < r.second; t++ ) {
+                next.insert(getTarget(t));
+            }
+        });
+        swap(current, next);
+        if ( current.empty() ) break;
+    }
+
+    return current;
+}
+
+OutputTree FsmMutant::apply(const InputTrace& itrc) const
+{
+    OutputTree ot = OutputTree(itrc, presentationLayer);
+    if ( base->getInitStateIdx() < 0 ) return ot;
+
+    // Pairs of output tree leaves and the mutant states
+    // reached by the outputs along the path to the leaf
+    deque<pair<TreeNode*, int>> leaves;
+    deque<pair<TreeNode*, int>> nextLeaves;
+    leaves.emplace_back(ot.getRoot(), base->getInitStateIdx());
+
+    for ( auto it = itrc.cbegin(); it != itrc.cend(); ++it ) {
+        nextLeaves.clear();
+        for ( auto const &leaf : leaves ) {
+            auto r = base->range(leaf.second, *it);
+            for ( int t = r.first; t < r.second; t++ ) {
+                std::unique_ptr<TreeEdge> te { new TreeEdge(getOutput(t)) };
+                auto tgtNodePtr = te->getTarget();
+                leaf.first->add(std::move(te));
+                nextLeaves.emplace_back(tgtNodePtr, getTarget(t));
+            }
+        }
+        swap(leaves, nextLeaves);
+    }
+
+    return ot;
+}
+
+IOTrace FsmMutant::applyDet(const InputTrace& i) const
+{
+    vector<int> o;
+    int s = base->getInitStateIdx();
+
+    // Apply input trace as far as possible, using the first
+    // transition for each input, as in Dfsm::applyDet()
+    if ( s >= 0 ) {
+        for ( auto it = i.cbegin(); it != i.cend(); ++it ) {
+            auto r = base->range(s, *it);
+            if ( r.first == r.second ) break;
+            o.push_back(getOutput(r.first));
+            s = getTarget(r.first);
+        }
+    }
+
+    auto ifirst = i.cbegin();
+    auto ilast = ifirst + o.size();
+
+    return IOTrace(InputTrace(vector<int>(ifirst, ilast), presentationLayer),
+                   OutputTrace(o, presentationLayer));
+}
+
+bool FsmMutant::pass(const IOTrace& io) const
+{
+    vector<int> itrc = io.getInputTrace().get();
+    vector<int> otrc = io.getOutputTrace().get();
+
+    if ( base->getInitStateIdx() < 0 ) return otrc.empty();
+    if ( itrc.size() < otrc.size() ) return false;
+
+    StateSet current(base->size());
+    StateSet next(base->size());
+    current.insert(base->getInitStateIdx());
+
+    for ( size_t n = 0; n < otrc.size(); n++ ) {
+        int x = itrc[n];
+        int y = otrc[n];
+        next.clear();
+        current.forEach([this, x, y, &next](int s) {
+            auto r = base->range(s, x);
+            for ( int t = r.first; t < r.second; t++ ) {
+                if ( getOutput(t) == y ) next.insert(getTarget(t));
+            }
+        });
+        swap(current, next);
+        if ( current.empty() ) return false;
+    }
+
+    if ( itrc.size() == otrc.size() ) return true;
+
+    // The outputs end before the inputs: this is only admissible if
+    // the next input is undefined in all states reached
+    int x = itrc[otrc.size()];
+    bool defined = false;
+    current.forEach([this, x, &defined](int s) {
+        auto r = base->range(s, x);
+        if ( r.first != r.second ) defined = true;
+    });
+    return not defined;
+}
+
+unique_ptr<Fsm> FsmMutant::toFsm() const
+{
+    std::vector<std::unique_ptr<FsmNode> > lst;
+    for ( int n = 0; n < base->size(); n++ ) {
+        lst.emplace_back(new FsmNode(n,name));
+    }
+
+    for ( int n = 0; n < base->size(); n++ ) {
+        for ( int t = base->begin(n); t < base->end(n); t++ ) {
+            std::unique_ptr<FsmTransition> transition {
+                new FsmTransition(lst[n].get(),
+                                  lst[getTarget(t)].get(),
+                                  FsmLabel(base->getInput(t), getOutput(t))) };
+            lst[n]->addTransition(std::move(transition));
+        }
+    }
+
+    return unique_ptr<Fsm>(new Fsm(name,
+                                   base->getMaxInput(),
+                                   base->getMaxOutput(),
+                                   std::move(lst),
+                                   presentationLayer));
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_FSMMUTANT_H_
+#define FSM_FSM_FSMMUTANT_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fsm/StateSet.h"
+
+class Fsm;
+class CSRTransitionTable;
+class FsmPresentationLayer;
+class InputTrace;
+class IOTrace;
+class OutputTree;
+
+/**
+ Class representing a mutant of an FSM as a set of modified
+ transitions over the transition table of the original FSM.
+
+ The transition table of the original FSM is shared by all its
+ mutants and never modified. Each mutant only stores the transitions
+ whose output or target state differs from the original, so that
+ creating a mutant costs a few bytes per fault, instead of a copy
+ of every node, transition and label.
+
+ Transitions are identified by their position in the CSR
+ transition table, and states by their index in the node list of
+ the original FSM.
+ */
+class FsmMutant
+{
+private:
+    /** A transition of the original FSM with modified output and/or target */
+    struct TransitionFault {
+        int transition;
+        int output;
+        int target;
+    };
+
+    /** Name of the mutant */
+    std::string name;
+
+    /** Transition table of the original FSM */
+    std::shared_ptr<const CSRTransitionTable> base;
+
+    /** Presentation layer of the original FSM */
+    std::shared_ptr<const FsmPresentationLayer> presentationLayer;
+
+    /** Modified transitions, sorted by their position in the base table */
+    std::vector<TransitionFault> faults;
+
+    /** Return the fault of transition t, or nullptr if t is unchanged */
+    TransitionFault const * findFault(const int t) const;
+
+    /** Return the fault of transition t, creating it if necessary */
+    TransitionFault & getFault(const int t);
+
+    /**
+     * Return true if state s has another transition than t with the
+     * same input as t, which produces output y and leads to state tgt
+     */
+    bool hasOtherTransition(const int s, const int t,
+                            const int y, const int tgt) const;
+
+    /**
+     * Return the position in the base table of transition trNo
+     * of state s, numbered as in the transition list of the
+     * node of fsm
+     */
+    int getPosition(const Fsm& fsm, const int s, const int trNo) const;
+
+public:
+    /**
+     * Create a mutant of fsm without any faults
+     * @param fsm The original FSM, whose transition table and
+     *            presentation layer are shared with the mutant
+     * @param name Name of the mutant
+     */
+    FsmMutant(const Fsm& fsm, const std::string& name);
+
+    std::string getName() const { return name; }
+
+    /** Return the transition table of the original FSM */
+    std::shared_ptr<const CSRTransitionTable> getBase() const { return base; }
+
+    /** Return the number of modified transitions */
+    size_t getNumFaults() const { return faults.size(); }
+
+    /** Return the output of transition t in the mutant */
+    int getOutput(const int t) const;
+
+    /** Return the target state of transition t in the mutant */
+    int getTarget(const int t) const;
+
+    /** Let transition t of the mutant produce output y */
+    void setOutput(const int t, const int y);
+
+    /** Let transition t of the mutant lead to state s */
+    void setTarget(const int t, const int s);
+
+    /**
+     * Inject faults into randomly chosen transitions, using rand().
+     * Every transition fault redirects a transition to another state,
+     * every output fault changes the output of a transition. Faults
+     * which would duplicate another transition of the same state
+     * are not injected.
+     * @param fsm The original FSM. Transitions are drawn by their
+     *            number in the transition lists of its nodes, so that
+     *            a seed creates the same faults as it did on copies
+     *            of the FSM.
+     */
+    void injectFaults(const Fsm& fsm,
+                      const size_t numOutputFaults,
+                      const size_t numTransitionFaults);
+
+    /**
+     * Return the set of states reachable from state s by
+     * input trace itrc
+     */
+    StateSet after(const int s, const std::vector<int>& itrc) const;
+
+    /**
+     * Return the set of states reachable from a set of
+     * states by input trace itrc
+     */
+    StateSet after(const StateSet& states, const std::vector<int>& itrc) const;
+
+    /**
+     * Apply an input trace to the initial state of the mutant
+     * @return The set of outputs created by itrc, encoded as an OutputTree
+     */
+    OutputTree apply(const InputTrace& itrc) const;
+
+    /**
+     * Apply an input trace to the initial state of a deterministic mutant.
+     * As in Dfsm::applyDet(), the result consists of the longest
+     * accepted prefix of i and the associated outputs.
+     */
+    IOTrace applyDet(const InputTrace& i) const;
+
+    /**
+     * Check whether an IO trace is in the language of the mutant.
+     * If the input trace is longer than the output trace, the IO
+     * trace is only accepted if the inputs following the outputs are
+     * undefined in every state reached, as for traces produced by
+     * applyDet() on incompletely specified machines.
+     */
+    bool pass(const IOTrace& io) const;
+
+    /**
+     * Create the mutant as a stand-alone FSM, with its own nodes
+     * and transitions
+     */
+    std::unique_ptr<Fsm> toFsm() const;
+};
+#endif //FSM_FSM_FSMMUTANT_H_
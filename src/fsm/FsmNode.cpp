@@ -3,14 +3,17 @@
  *
  * Licensed under the EUPL V.1.1
  */
+#include <algorithm>
 #include <deque>
 
+#include "fsm/CSRTransitionTable.h"
 #include "fsm/FsmNode.h"
 #include "fsm/FsmTransition.h"
 #include "fsm/OutputTrace.h"
 #include "fsm/OFSMTable.h"
 #include "fsm/DFSMTableRow.h"
 #include "fsm/PkTable.h"
+#include "fsm/SplittingTree.h"
 #include "trees/TreeEdge.h"
 #include "trees/TreeNode.h"
 #include "trees/OutputTree.h"
@@ -21,6 +24,137 @@
 
 using namespace std;
 
+namespace {
+
+    /** Result of a lockstep simulation which cannot decide a query */
+    const int undecided = -1;
+
+    /**
+     * Scratch buffers of the lockstep simulations in
+     * FsmNode::distinguished(), reused by all queries of a thread
+     */
+    struct LockstepBuffers {
+        /** Outputs produced by one state, not yet matched by the other one */
+        vector<int> lag;
+        /** States reached by both nodes, ordered by their output traces */
+        vector<FsmNode const*> states[2];
+        vector<FsmNode const*> nextStates[2];
+        /** Predecessor index and output of each of the next states */
+        vector<pair<int, int>> steps[2];
+        /** Outputs and targets of the transitions of a state for one input */
+        vector<pair<int, FsmNode const*>> successors;
+    };
+
+    thread_local LockstepBuffers buffers;
+
+    /**
+     * Return the transition of node for input x, or nullptr if x is
+     * undefined in node. Set ambiguous if there are several.
+     */
+    FsmTransition const *uniqueTransition(FsmNode const *node, const int x, bool& ambiguous)
+    {
+        FsmTransition const *result = nullptr;
+        for ( auto const &tr : node->getTransitions() ) {
+            if ( tr->getLabel()->getInput() != x ) continue;
+            if ( result != nullptr ) {
+                ambiguous = true;
+                return nullptr;
+            }
+            result = tr.get();
+        }
+        return result;
+    }
+
+    /**
+     * Apply iLst to n1 and n2 in lockstep, as long as both states reached
+     * are deterministic for the next input. Undefined inputs are skipped,
+     * so the outputs of one state may be matched later by the other one.
+     * @return 1 if the output traces differ, 0 if they coincide,
+     *         undecided if a nondeterministic state has been reached
+     */
+    int distinguishedDeterministic(FsmNode const *n1, FsmNode const *n2, const vector<int>& iLst)
+    {
+        vector<int>& lag = buffers.lag;
+        lag.clear();
+        size_t head = 0;
+        int leader = 0;
+        FsmNode const *node[2] = { n1, n2 };
+        
+        for ( int x : iLst ) {
+            for ( int k = 0; k < 2; k++ ) {
+                bool ambiguous = false;
+                FsmTransition const *tr = uniqueTransition(node[k], x, ambiguous);
+                if ( ambiguous ) return undecided;
+                if ( tr == nullptr ) continue;
+                
+                int y = tr->getLabel()->getOutput();
+                node[k] = tr->getTarget();
+                if ( head < lag.size() and leader != k ) {
+                    if ( lag[head++] != y ) return 1;
+                }
+                else {
+                    if ( head == lag.size() ) {
+                        lag.clear();
+                        head = 0;
+                    }
+                    leader = k;
+                    lag.push_back(y);
+                }
+            }
+        }
+        return head < lag.size() ? 1 : 0;
+    }
+
+    /**
+     * Apply iLst to n1 and n2 in lockstep, keeping the states reached
+     * by each node ordered by their output traces. If both nodes only
+     * reach observable states where the inputs are defined, the sets
+     * of output traces coincide iff the (predecessor, output) steps of
+     * both sides coincide after every input.
+     * @return 1 if the output traces differ, 0 if they coincide,
+     *         undecided if an input is undefined or a state reached is
+     *         not observable
+     */
+    int distinguishedObservable(FsmNode const *n1, FsmNode const *n2, const vector<int>& iLst)
+    {
+        buffers.states[0].assign(1, n1);
+        buffers.states[1].assign(1, n2);
+        vector<pair<int, FsmNode const*>>& successors = buffers.successors;
+        
+        for ( int x : iLst ) {
+            for ( int k = 0; k < 2; k++ ) {
+                vector<FsmNode const*>& states = buffers.states[k];
+                vector<FsmNode const*>& nextStates = buffers.nextStates[k];
+                vector<pair<int, int>>& steps = buffers.steps[k];
+                nextStates.clear();
+                steps.clear();
+                for ( size_t i = 0; i < states.size(); i++ ) {
+                    successors.clear();
+                    for ( auto const &tr : states[i]->getTransitions() ) {
+                        if ( tr->getLabel()->getInput() == x ) {
+                            successors.emplace_back(tr->getLabel()->getOutput(), tr->getTarget());
+                        }
+                    }
+                    if ( successors.empty() ) return undecided;
+                    sort(successors.begin(), successors.end());
+                    for ( size_t j = 0; j < successors.size(); j++ ) {
+                        if ( j > 0 and successors[j].first == successors[j - 1].first ) {
+                            return undecided;
+                        }
+                        nextStates.push_back(successors[j].second);
+                        steps.emplace_back(static_cast<int>(i), successors[j].first);
+                    }
+                }
+                // Copying keeps the capacities of both buffers growing
+                states.assign(nextStates.begin(), nextStates.end());
+            }
+            if ( buffers.steps[0] != buffers.steps[1] ) return 1;
+        }
+        return 0;
+    }
+
+}
+
 FsmNode::FsmNode(const int id)
 : id(id),
 visited(false),
@@ -38,7 +172,11 @@ FsmNode::FsmNode(const int id, const string & name)
 
 void FsmNode::setFsm(Fsm *fsm) {
     auto const &fsmNodes = fsm->getNodes();
-    if(fsmNodes.end() != std::find_if(fsmNodes.begin(), fsmNodes.end(), [this](std::unique_ptr<FsmNode> const &ptr){
+    // Nodes are usually stored at the index given by their id
+    if(id >= 0 && static_cast<size_t>(id) < fsmNodes.size() && fsmNodes[id].get() == this) {
+        this->fsm = fsm;
+    }
+    else if(fsmNodes.end() != std::find_if(fsmNodes.begin(), fsmNodes.end(), [this](std::unique_ptr<FsmNode> const &ptr){
         return ptr.get() == this;
     })) {
         this->fsm = fsm;
@@ -62,17 +200,16 @@ void FsmNode::addTransition(std::unique_ptr<FsmTransition> &&transition)
     for ( auto &tr : transitions ) {
         if ( tr->getTarget() == transition->getTarget()
             and
-            tr->getLabel() == transition->getLabel() ) {
+            *tr->getLabel() == *transition->getLabel() ) {
             return;
         }
     }
     
     transitions.emplace_back(std::move(transition));
-}
-
-std::vector<std::unique_ptr<FsmTransition>>& FsmNode::getTransitions()
-{
-    return transitions;
+    if ( fsm != nullptr ) {
+        fsm->invalidateCSRTransitionTable();
+        fsm->invalidateOFSMPartition();
+    }
 }
 
 std::vector<std::unique_ptr<FsmTransition>> const& FsmNode::getTransitions() const {
@@ -124,13 +261,12 @@ std::vector<FsmNode*> FsmNode::getDerivedFrom() const
 
 FsmNode* FsmNode::apply(const int e, OutputTrace & o) const
 {
-    InputTrace inputTrace(fsm->getPresentationLayer()->clone());
+    InputTrace inputTrace(fsm->getPresentationLayer());
     inputTrace.add(e);
     auto applyResult = apply(inputTrace);
-    auto leaves = applyResult.first.getLeaves();
-    auto treeNode = leaves.front();
+    auto treeNode = applyResult.first.getRoot()->getFirstLeaf();
     auto path = treeNode->getPath();
-    OutputTrace trace(path, fsm->getPresentationLayer()->clone());
+    OutputTrace trace(path, fsm->getPresentationLayer());
     o = std::move(trace);
     return applyResult.second[treeNode];
 }
@@ -153,7 +289,7 @@ std::pair<OutputTree, std::unordered_map<TreeNode*, FsmNode*>> FsmNode::apply(co
     deque<TreeNode*> tnl;
     unordered_map<TreeNode*, FsmNode*> t2f;
     
-    OutputTree ot = OutputTree(itrc, fsm->getPresentationLayer()->clone());
+    OutputTree ot = OutputTree(itrc, fsm->getPresentationLayer());
     TreeNode *root = ot.getRoot();
     
     //Cannot use `this` here as it is const.
@@ -189,9 +325,8 @@ std::pair<OutputTree, std::unordered_map<TreeNode*, FsmNode*>> FsmNode::apply(co
                 {
                     int y = tr->getLabel()->getOutput();
                     FsmNode *tgtState = tr->getTarget();
-                    std::unique_ptr<TreeNode> tgtNode { new TreeNode() };
-                    auto tgtNodePtr = tgtNode.get();
-                    std::unique_ptr<TreeEdge> te { new TreeEdge(y, std::move(tgtNode)) };
+                    std::unique_ptr<TreeEdge> te { new TreeEdge(y) };
+                    auto tgtNodePtr = te->getTarget();
                     thisTreeNode->add(std::move(te));
                     t2f[tgtNodePtr] = tgtState;
                 }
@@ -201,8 +336,28 @@ std::pair<OutputTree, std::unordered_map<TreeNode*, FsmNode*>> FsmNode::apply(co
     return std::make_pair(std::move(ot), std::move(t2f));
 }
 
+int FsmNode::getFsmIndex() const
+{
+    if ( fsm == nullptr ) return -1;
+    auto const &fsmNodes = fsm->getNodes();
+    if ( id >= 0 and static_cast<size_t>(id) < fsmNodes.size()
+        and fsmNodes[id].get() == this ) {
+        return id;
+    }
+    return -1;
+}
+
 std::unordered_set<FsmNode*> FsmNode::after(std::vector<int> const &itrc)
 {
+    if ( getFsmIndex() >= 0 ) {
+        auto const &fsmNodes = fsm->getNodes();
+        unordered_set<FsmNode*> nodeSet;
+        afterAsStateSet(itrc).forEach([&nodeSet, &fsmNodes](int n) {
+            nodeSet.insert(fsmNodes[n].get());
+        });
+        return nodeSet;
+    }
+    
     unordered_set<FsmNode*> nodeSet;
     nodeSet.insert(this);
 
@@ -222,6 +377,18 @@ std::unordered_set<FsmNode*> FsmNode::after(std::vector<int> const &itrc)
 }
 
 
+StateSet FsmNode::afterAsStateSet(std::vector<int> const &itrc) const
+{
+    // Nodes that are not stored in an FSM have no indices
+    int idx = getFsmIndex();
+    if ( idx < 0 ) return StateSet();
+    
+    std::shared_ptr<const CSRTransitionTable> csr = fsm->getCSRTransitionTable();
+    StateSet start(csr->size());
+    start.insert(idx);
+    return csr->after(start, itrc);
+}
+
 std::unordered_set<FsmNode*> FsmNode::after(InputTrace const &itrc)
 {
     return after(itrc.get());
@@ -288,7 +455,15 @@ shared_ptr<DFSMTableRow> FsmNode::getDFSMTableRow(const int maxInput) const
 
 bool FsmNode::distinguished(FsmNode const *otherNode, const vector<int>& iLst) const
 {
-    InputTrace itr = InputTrace(iLst, fsm->getPresentationLayer()->clone());
+    int result = distinguishedDeterministic(this, otherNode, iLst);
+    if ( result == undecided ) {
+        result = distinguishedObservable(this, otherNode, iLst);
+    }
+    if ( result != undecided ) return result == 1;
+    
+    /*Non-observable states or undefined inputs in nondeterministic
+     states: compare the complete output trees*/
+    InputTrace itr = InputTrace(iLst, fsm->getPresentationLayer());
     OutputTree ot1 = apply(itr).first;
     OutputTree ot2 = otherNode->apply(itr).first;
     
@@ -298,48 +473,36 @@ bool FsmNode::distinguished(FsmNode const *otherNode, const vector<int>& iLst) c
 std::unique_ptr<InputTrace> FsmNode::distinguished(FsmNode const *otherNode, Tree const *w) const
 {
     IOListContainer iolc = w->getIOLists();
-    IOListContainer::IOListBaseType inputLists = iolc.getIOLists();
     
-    for (vector<int>& iLst : inputLists)
+    for (vector<int>& iLst : iolc.getIOLists())
     {
         if (distinguished(otherNode, iLst))
         {
-            return std::unique_ptr<InputTrace>(new InputTrace(iLst, fsm->getPresentationLayer()->clone()));
+            return std::unique_ptr<InputTrace>(new InputTrace(iLst, fsm->getPresentationLayer()));
         }
     }
     return {};
 }
 
 InputTrace FsmNode::calcDistinguishingTrace(FsmNode *otherNode,
-                                            const vector<shared_ptr<PkTable>>& pktblLst,
+                                            const SplittingTree& splittingTree,
                                             const int maxInput)
 {
     /*Determine the smallest l >= 1, such that this and otherNode are
-     distinguished by P_l, but not by P_(l-1).
-     Note that table P_n is found at pktblLst.get(n-1)*/
-    unsigned int l;
-    for (l = 1; l <= pktblLst.size(); ++ l)
-    {
-        /*Two nodes are distinguished by a Pk-table, if they
-         reside in different Pk-table classes.*/
-        shared_ptr<PkTable> pk = pktblLst.at(l - 1);
-        if (pk->getClass(this->getId()) != pk->getClass(otherNode->getId()))
-        {
-            break;
-        }
-    }
+     distinguished by P_l, but not by P_(l-1). This is the round
+     in which their classes have been split.*/
+    int l = splittingTree.separatingRound(this->getId(), otherNode->getId());
     
     FsmNode *qi = this;
     FsmNode *qj = otherNode;
     
-    InputTrace itrc = InputTrace(fsm->getPresentationLayer()->clone());
+    InputTrace itrc = InputTrace(fsm->getPresentationLayer());
     
     for (int k = 1; l - k > 0; ++ k)
     {
         bool foundNext = false;
-        shared_ptr<PkTable> plMinK = pktblLst.at(l - k - 1);
         /*Determine input x such that qi.after(x) is distinguished
-         from qj.after(x) in plMinK*/
+         from qj.after(x) in P_(l-k)*/
         
         for (int x = 0; x <= maxInput; ++ x)
         {
@@ -349,7 +512,8 @@ InputTrace FsmNode::calcDistinguishingTrace(FsmNode *otherNode,
             FsmNode *qiNext = qi->after(x).front();
             FsmNode *qjNext = qj->after(x).front();
             
-            if ( plMinK->getClass(qiNext->getId()) != plMinK->getClass(qjNext->getId()) )
+            int r = splittingTree.separatingRound(qiNext->getId(), qjNext->getId());
+            if ( r > 0 and r <= l - k )
             {
                 qi = qiNext;
                 qj = qjNext;
@@ -370,8 +534,8 @@ InputTrace FsmNode::calcDistinguishingTrace(FsmNode *otherNode,
     bool foundLast = false;
     for (int x = 0; x <= maxInput; ++ x) {
         
-        OutputTrace oti = OutputTrace(fsm->getPresentationLayer()->clone());
-        OutputTrace otj = OutputTrace(fsm->getPresentationLayer()->clone());
+        OutputTrace oti = OutputTrace(fsm->getPresentationLayer());
+        OutputTrace otj = OutputTrace(fsm->getPresentationLayer());
         qi->apply(x, oti);
         qj->apply(x, otj);
         if (oti.get().front() != otj.get().front())
@@ -390,55 +554,47 @@ InputTrace FsmNode::calcDistinguishingTrace(FsmNode *otherNode,
 }
 
 InputTrace FsmNode::calcDistinguishingTrace(FsmNode const *otherNode,
-                                            const vector<shared_ptr<OFSMTable>>& ofsmTblLst,
+                                            const SplittingTree& splittingTree,
+                                            const OFSMTable& ofsmTbl,
                                             const int maxInput,
                                             const int maxOutput) const
 {
-    InputTrace itrc = InputTrace(fsm->getPresentationLayer()->clone());
+    InputTrace itrc = InputTrace(fsm->getPresentationLayer());
     int q1 = this->getId();
     int q2 = otherNode->getId();
     
     /*Now we know that this and otherNode are NOT distinguished by OFSM-Table-0.
      Determine the smallest l >= 1, such that this and otherNode are
      distinguished by OFSM-Table l, but not by OFSM-table (l-1).
-     Note that table OFSM-table n is found at ofsmTblLst.get(n).*/
-    unsigned int l;
-    for (l = 1; l < ofsmTblLst.size(); ++ l)
-    {
-        /*Two nodes are distinguished by a OFSM-table, if they
-         reside in different OFSM-table classes.*/
-        shared_ptr<OFSMTable> ot = ofsmTblLst.at(l);
-        if (ot->getS2C().at(q1) != ot->getS2C().at(q2))
-        {
-            break;
-        }
-    }
+     This is the round in which their classes have been split.*/
+    int l = splittingTree.separatingRound(q1, q2);
     
     for (int k = 1; l - k > 0; ++ k)
     {
-        shared_ptr<OFSMTable> ot = ofsmTblLst.at(l - k);
-        
         /*Determine IO x/y such that qi.after(x/y) is distinguished
-         from qj.after(x/y) in ot*/
-        for (int x = 0; x <= maxInput; ++ x)
+         from qj.after(x/y) in OFSM-table (l-k)*/
+        bool foundNext = false;
+        for (int x = 0; x <= maxInput and not foundNext; ++ x)
         {
             for (int y = 0; y <= maxOutput; ++ y)
             {
-                int q1Post = ot->get(q1, x, y);
-                int q2Post = ot->get(q2, x, y);
+                int q1Post = ofsmTbl.get(q1, x, y);
+                int q2Post = ofsmTbl.get(q2, x, y);
                 
                 if (q1Post < 0 || q2Post < 0)
                 {
                     continue;
                 }
                 
-                if (ot->getS2C().at(q1Post) != ot->getS2C().at(q2Post))
+                int r = splittingTree.separatingRound(q1Post, q2Post);
+                if (r > 0 and r <= l - k)
                 {
                     itrc.add(x);
                     
                     /*Set q1,q2 to their post-states under x/y*/
                     q1 = q1Post;
                     q2 = q2Post;
+                    foundNext = true;
                     break;
                 }
             }
@@ -447,13 +603,12 @@ InputTrace FsmNode::calcDistinguishingTrace(FsmNode const *otherNode,
     
     /*Now the case l == k. q1 and q2 must be distinguishable by at least
      one IO in OFSM-Table-0*/
-    shared_ptr<OFSMTable> ot0 = ofsmTblLst.front();
     for (int x = 0; x <= maxInput; ++ x)
     {
         for (int y = 0; y <= maxOutput; ++ y)
         {
-            if ( (ot0->get(q1, x, y) < 0 && ot0->get(q2, x, y) >= 0) or
-                 (ot0->get(q1, x, y) >= 0 && ot0->get(q2, x, y) < 0))
+            if ( (ofsmTbl.get(q1, x, y) < 0 && ofsmTbl.get(q2, x, y) >= 0) or
+                 (ofsmTbl.get(q1, x, y) >= 0 && ofsmTbl.get(q2, x, y) < 0))
             {
                 itrc.add(x);
                 return itrc;
@@ -465,6 +620,10 @@ InputTrace FsmNode::calcDistinguishingTrace(FsmNode const *otherNode,
 
 bool FsmNode::isObservable() const
 {
+    int idx = getFsmIndex();
+    if ( idx >= 0 ) {
+        return fsm->getCSRTransitionTable()->isObservable(idx);
+    }
     
     for ( size_t t = 0; t < transitions.size(); t++ ) {
         
@@ -17,6 +17,7 @@
 
 #include "fsm/FsmVisitor.h"
 #include "fsm/SegmentedTrace.h"
+#include "fsm/StateSet.h"
 
 class FsmTransition;
 class Fsm;
@@ -27,6 +28,7 @@ class OutputTrace;
 class InputTrace;
 class OFSMTable;
 class PkTable;
+class SplittingTree;
 class DFSMTableRow;
 class TraceSegment;
 
@@ -56,6 +58,12 @@ private:
 		addDerivedFrom(others...);
 	}
     
+    /**
+     * Return the position of this node in the node list of its FSM,
+     * or -1 if the node is not associated with an FSM.
+     */
+    int getFsmIndex() const;
+    
 public:
 	const static int white = 0;
 	const static int grey = 1;
@@ -74,7 +82,6 @@ public:
 	void addTransition(std::unique_ptr<FsmTransition> &&transition);
     
     
-    std::vector<std::unique_ptr<FsmTransition>>& getTransitions();
     std::vector<std::unique_ptr<FsmTransition>> const & getTransitions() const;
     int getId() const;
     void setId(const int id) { this->id = id; }
@@ -109,6 +116,16 @@ public:
     std::unordered_set<FsmNode*> after(std::vector<int> const &itrc);
     std::unordered_set<FsmNode*> after(TraceSegment const &seg);
 
+	/**
+	Return the set of states reachable from this node after having
+	applied the input trace itrc, as a bitset over the node indices
+	of the FSM this node belongs to.
+	@param itrc Input trace to be applied, starting with this FsmNode
+	@return Set of the indices of the nodes reachable via itrc, empty
+	if this node is not stored in an FSM
+	*/
+    StateSet afterAsStateSet(std::vector<int> const &itrc) const;
+
 	/**
 	Return list of nodes that can be reached from this node
 	when applying input x
@@ -124,6 +141,18 @@ public:
 	void setColor(const int color);
 	int getColor() const;
 	std::shared_ptr<DFSMTableRow> getDFSMTableRow(const int maxInput) const;
+
+	/**
+	Check whether this node and otherNode produce different sets of output
+	traces when applying iLst. As in apply(), undefined inputs are skipped.
+	Both nodes are simulated in lockstep until their outputs diverge.
+	Deterministic and observable states are handled without heap
+	allocations, using scratch buffers that are reused by all queries
+	of the calling thread; for other states the output trees are compared.
+	@param otherNode The other FSM state
+	@param iLst Input trace to be applied to both states
+	@return true if and only if iLst distinguishes the states
+	*/
 	bool distinguished(FsmNode const *otherNode, const std::vector<int>& iLst) const;
 	std::unique_ptr<InputTrace> distinguished(FsmNode const *otherNode, Tree const *w) const;
 
@@ -131,22 +160,25 @@ public:
 	Calculate a distinguishing input trace for a DFSM node. The algorithm is based
 	on Pk-tables
 	@param otherNode The other FSM state, to be distinguished from this FSM state
-	@param pktblLst  List of Pk-tables, pre-calculated for this DFSM
+	@param splittingTree  History of the Pk-tables, pre-calculated for this DFSM:
+	       round k of the tree corresponds to table P_k
 	@param maxInput  Maximal value of the input alphabet with range 0..maxInput
 	@return Distinguishing trace as instance of InputTrace
 	*/
-	InputTrace calcDistinguishingTrace(FsmNode *otherNode, const std::vector<std::shared_ptr<PkTable>>& pktblLst, const int maxInput);
+	InputTrace calcDistinguishingTrace(FsmNode *otherNode, const SplittingTree& splittingTree, const int maxInput);
 
 	/**
 	Calculate a distinguishing input trace for a (potentially nondeterministic)
 	FSM node. The algorithm is based on OFSM-tables
 	@param otherNode The other FSM state, to be distinguished from this FSM state
-	@param ofsmTblLst  List of OFSM-tables, pre-calculated for this FSM
+	@param splittingTree  History of the OFSM-tables, pre-calculated for this FSM:
+	       round k of the tree corresponds to OFSM-table k
+	@param ofsmTbl  OFSM-table of this FSM, providing the post-states
 	@param maxInput  Maximal value of the input alphabet with range 0..maxInput
 	@param maxOutput Maximal value of the output alphabet in range 0..maxOutput
 	@return Distinguishing trace as instance of InputTrace
 	*/
-	InputTrace calcDistinguishingTrace(FsmNode const *otherNode, const std::vector<std::shared_ptr<OFSMTable>>& ofsmTblLst, const int maxInput, const int maxOutput) const;
+	InputTrace calcDistinguishingTrace(FsmNode const *otherNode, const SplittingTree& splittingTree, const OFSMTable& ofsmTbl, const int maxInput, const int maxOutput) const;
 	bool isObservable() const;
 
 	/**
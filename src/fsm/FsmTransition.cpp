@@ -4,14 +4,15 @@
  * Licensed under the EUPL V.1.1
  */
 #include "fsm/FsmTransition.h"
+#include "fsm/Fsm.h"
 #include "fsm/FsmNode.h"
 
 using namespace std;
 
 FsmTransition::FsmTransition(FsmNode * source,
                              FsmNode * target,
-                             std::unique_ptr<FsmLabel> &&label)
-	: source(source), target(target), label(std::move(label))
+                             const FsmLabel &label)
+	: source(source), target(target), label(label)
 {
     
     if ( source == nullptr ) {
@@ -21,10 +22,6 @@ FsmTransition::FsmTransition(FsmNode * source,
     if ( target == nullptr ) {
         cerr << "ERROR: Constructor FsmTransition() called with null pointer as target node" << endl;
     }
-    
-    if ( this->label == nullptr ) {
-        cerr << "ERROR: Constructor FsmTransition() called with null pointer as label" << endl;
-    }
 
 }
 
@@ -44,26 +41,43 @@ FsmNode * FsmTransition::getTarget() const
 
 void FsmTransition::setTarget(FsmNode * tgt) {
     target = tgt;
+    invalidateFsmIndex();
+}
+
+void FsmTransition::setLabel(const FsmLabel &lbl) {
+    label = lbl;
+    invalidateFsmIndex();
 }
 
-void FsmTransition::setLabel(std::unique_ptr<FsmLabel> &&lbl) {
-    label = std::move(lbl);
+void FsmTransition::invalidateFsmIndex() const {
+    if ( source != nullptr and source->getFsm() != nullptr ) {
+        source->getFsm()->invalidateCSRTransitionTable();
+        source->getFsm()->invalidateOFSMPartition();
+    }
 }
 
 
-FsmLabel * FsmTransition::getLabel() const
+std::vector<std::string>& FsmTransition::getSatisfied()
 {
-	return label.get();
+    if ( satisfies == nullptr ) {
+        satisfies.reset(new std::vector<std::string>());
+    }
+    return *satisfies;
 }
 
 ostream & operator<<(ostream& out, FsmTransition& transition)
 {
-	out << transition.getSource()->getId() << " -> " << transition.getTarget()->getId() << "[label=\" " << *transition.label << "   \"];";
+	FsmNode *src = transition.getSource();
+	FsmPresentationLayer const *pl =
+		(src->getFsm() != nullptr) ? src->getFsm()->getPresentationLayer().get() : nullptr;
+	out << src->getId() << " -> " << transition.getTarget()->getId() << "[label=\" ";
+	transition.label.print(out, pl);
+	out << "   \"];";
 	return out;
 }
 
 void FsmTransition::accept(FsmVisitor &v) {
     v.visit(*this);
-    label->accept(v);
+    label.accept(v);
     //target->accept(v);
 }
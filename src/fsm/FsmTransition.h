@@ -7,6 +7,8 @@
 #define FSM_FSM_FSMTRANSITION_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "fsm/FsmLabel.h"
 #include "fsm/FsmVisitor.h"
@@ -27,14 +29,21 @@ private:
 	FsmNode *target;
 
 	/**
-	 * The label of this transition
+	 * The label of this transition, stored by value
 	 */
-	std::unique_ptr<FsmLabel> label;
+	FsmLabel label;
     
     /**
-     *  List of requirements satisfied by the transition
+     *  List of requirements satisfied by the transition. The list
+     *  is only allocated when the first requirement is added.
      */
-    std::vector<std::string> satisfies;
+    std::unique_ptr<std::vector<std::string>> satisfies;
+    
+    /**
+     * Drop index structures of the FSM owning the source node,
+     * after this transition has been modified
+     */
+    void invalidateFsmIndex() const;
     
 public:
 	/**
@@ -45,7 +54,7 @@ public:
 	*/
 	FsmTransition(FsmNode *source,
                   FsmNode *target,
-                  std::unique_ptr<FsmLabel> &&label);
+                  const FsmLabel &label);
 
 	/**
 	 * Getter for the source
@@ -62,7 +71,7 @@ public:
     /** setter functions */
     void setSource(FsmNode * src);
     void setTarget(FsmNode * tgt);
-    void setLabel(std::unique_ptr<FsmLabel> &&lbl);
+    void setLabel(const FsmLabel &lbl);
 
     
     /** 
@@ -75,13 +84,13 @@ public:
 	Getter for the label
 	@return The label of this transition
 	*/
-    FsmLabel * getLabel() const;
+    FsmLabel const * getLabel() const { return &label; }
     
     /**
      *  Get list of requirements satisified by the transition
      */
-    std::vector<std::string>& getSatisfied() { return satisfies; }
-    void addSatisfies(std::string req) { satisfies.push_back(req); }
+    std::vector<std::string>& getSatisfied();
+    void addSatisfies(std::string req) { getSatisfied().push_back(req); }
 
 	/**
 	Output the FsmTransition to a standard output stream
@@ -0,0 +1,287 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <string>
+
+#include "fsm/DenseDFSMTable.h"
+#include "fsm/Dfsm.h"
+#include "fsm/FsmNode.h"
+#include "fsm/FsmTransition.h"
+#include "fsm/HopcroftPartition.h"
+#include "interface/FsmPresentationLayer.h"
+
+using namespace std;
+
+HopcroftPartition::HopcroftPartition(const shared_ptr<const DenseDFSMTable>& table)
+: table(table), numClasses(0)
+{
+    const int n = table->size();
+    const int k = table->getNumInputs();
+    
+    classOf.assign(n, -1);
+    leafOf.assign(n, 0);
+    splitTree.push_back({ -1, 0, -1 });
+    if ( n == 0 ) return;
+    
+    // The states of each block are stored contiguously in elems,
+    // block b occupies elems[first[b]..end[b]-1]. While a splitter
+    // is processed, the marked states of b are moved to the front
+    // of the block, up to markEnd[b].
+    vector<int> elems(n);
+    vector<int> loc(n);
+    vector<int> blockOf(n);
+    vector<int> first;
+    vector<int> end;
+    vector<int> markEnd;
+    vector<int> nodeOf;
+    vector<bool> inWork;
+    vector<int> work;
+    
+    // Initial partition: states with equal outputs for all inputs
+    for ( int s = 0; s < n; s++ ) elems[s] = s;
+    auto outputsLess = [&table, k](int s1, int s2) {
+        for ( int x = 0; x < k; x++ ) {
+            int y1 = table->getOutput(s1, x);
+            int y2 = table->getOutput(s2, x);
+            if ( y1 != y2 ) return y1 < y2;
+        }
+        return s1 < s2;
+    };
+    sort(elems.begin(), elems.end(), outputsLess);
+    
+    for ( int i = 0; i < n; i++ ) {
+        bool newBlock = (i == 0);
+        for ( int x = 0; x < k and not newBlock; x++ ) {
+            newBlock = table->getOutput(elems[i-1], x) != table->getOutput(elems[i], x);
+        }
+        if ( newBlock ) {
+            if ( i > 0 ) end.push_back(i);
+            first.push_back(i);
+        }
+        loc[elems[i]] = i;
+        blockOf[elems[i]] = static_cast<int>(first.size()) - 1;
+    }
+    end.push_back(n);
+    
+    int numBlocks = static_cast<int>(first.size());
+    markEnd = first;
+    inWork.assign(numBlocks, false);
+    
+    if ( numBlocks == 1 ) {
+        nodeOf.push_back(0);
+    }
+    else {
+        // Every block but the largest one is a splitter: the partition is
+        // stable with respect to the set of all states, so it is stable
+        // with respect to the largest block, once it is stable with
+        // respect to all other blocks.
+        int largest = 0;
+        for ( int b = 0; b < numBlocks; b++ ) {
+            nodeOf.push_back(addSplitNode(0));
+            if ( end[b] - first[b] > end[largest] - first[largest] ) largest = b;
+        }
+        for ( int b = 0; b < numBlocks; b++ ) {
+            if ( b == largest ) continue;
+            work.push_back(b);
+            inWork[b] = true;
+        }
+    }
+    
+    // Inverse transition relation: the x-predecessors of state t are
+    // preds[predStart[x*n+t]..predStart[x*n+t+1]-1]
+    vector<int> predStart(static_cast<size_t>(k) * n + 1, 0);
+    vector<int> preds(static_cast<size_t>(k) * n);
+    for ( int s = 0; s < n; s++ ) {
+        for ( int x = 0; x < k; x++ ) {
+            predStart[static_cast<size_t>(x) * n + table->getNext(s, x) + 1]++;
+        }
+    }
+    for ( size_t i = 1; i < predStart.size(); i++ ) {
+        predStart[i] += predStart[i-1];
+    }
+    {
+        vector<int> fill(predStart.begin(), predStart.end() - 1);
+        for ( int s = 0; s < n; s++ ) {
+            for ( int x = 0; x < k; x++ ) {
+                preds[fill[static_cast<size_t>(x) * n + table->getNext(s, x)]++] = s;
+            }
+        }
+    }
+    
+    vector<int> splitter;
+    vector<int> touched;
+    
+    while ( not work.empty() ) {
+        
+        int c = work.back();
+        work.pop_back();
+        inWork[c] = false;
+        
+        // The splitter block may itself be split while it is processed,
+        // so its states are copied first
+        splitter.assign(elems.begin() + first[c], elems.begin() + end[c]);
+        
+        for ( int x = 0; x < k; x++ ) {
+            
+            // Mark all states with an x-successor in the splitter
+            touched.clear();
+            for ( int t : splitter ) {
+                size_t idx = static_cast<size_t>(x) * n + t;
+                for ( int i = predStart[idx]; i < predStart[idx+1]; i++ ) {
+                    int s = preds[i];
+                    int b = blockOf[s];
+                    if ( markEnd[b] == first[b] ) touched.push_back(b);
+                    int pos = loc[s];
+                    if ( pos < markEnd[b] ) continue;
+                    int other = elems[markEnd[b]];
+                    elems[pos] = other;
+                    loc[other] = pos;
+                    elems[markEnd[b]] = s;
+                    loc[s] = markEnd[b];
+                    markEnd[b]++;
+                }
+            }
+            
+            // Split every block which has marked and unmarked states:
+            // the marked states form a new block
+            for ( int b : touched ) {
+                
+                if ( markEnd[b] == end[b] ) {
+                    markEnd[b] = first[b];
+                    continue;
+                }
+                
+                int nb = numBlocks++;
+                first.push_back(first[b]);
+                end.push_back(markEnd[b]);
+                markEnd.push_back(first[b]);
+                inWork.push_back(false);
+                first[b] = markEnd[b];
+                
+                for ( int i = first[nb]; i < end[nb]; i++ ) {
+                    blockOf[elems[i]] = nb;
+                }
+                
+                int node = nodeOf[b];
+                splitTree[node].input = x;
+                nodeOf[b] = addSplitNode(node);
+                nodeOf.push_back(addSplitNode(node));
+                
+                if ( inWork[b] or end[nb] - first[nb] <= end[b] - first[b] ) {
+                    work.push_back(nb);
+                    inWork[nb] = true;
+                }
+                else {
+                    work.push_back(b);
+                    inWork[b] = true;
+                }
+            }
+        }
+    }
+    
+    // Number the classes in the order of their smallest member
+    vector<int> blockClass(numBlocks, -1);
+    for ( int s = 0; s < n; s++ ) {
+        int b = blockOf[s];
+        if ( blockClass[b] < 0 ) blockClass[b] = numClasses++;
+        classOf[s] = blockClass[b];
+        leafOf[s] = nodeOf[b];
+    }
+}
+
+int HopcroftPartition::addSplitNode(const int parent)
+{
+    splitTree.push_back({ parent, splitTree[parent].depth + 1, -1 });
+    return static_cast<int>(splitTree.size()) - 1;
+}
+
+int HopcroftPartition::commonAncestor(int n1, int n2) const
+{
+    while ( splitTree[n1].depth > splitTree[n2].depth ) n1 = splitTree[n1].parent;
+    while ( splitTree[n2].depth > splitTree[n1].depth ) n2 = splitTree[n2].parent;
+    while ( n1 != n2 ) {
+        n1 = splitTree[n1].parent;
+        n2 = splitTree[n2].parent;
+    }
+    return n1;
+}
+
+vector<int> HopcroftPartition::calcDistinguishingTrace(int s1, int s2) const
+{
+    vector<int> trc;
+    if ( classOf[s1] == classOf[s2] ) return trc;
+    
+    while ( true ) {
+        
+        int x = splitTree[commonAncestor(leafOf[s1], leafOf[s2])].input;
+        
+        // s1 and s2 have been separated by the initial partition,
+        // so they produce different outputs for some input
+        if ( x < 0 ) {
+            for ( x = 0; x < table->getNumInputs(); x++ ) {
+                if ( table->getOutput(s1, x) != table->getOutput(s2, x) ) {
+                    trc.push_back(x);
+                    break;
+                }
+            }
+            return trc;
+        }
+        
+        // s1 and s2 have been separated by input x, so their
+        // x-successors have been separated by an earlier split
+        trc.push_back(x);
+        s1 = table->getNext(s1, x);
+        s2 = table->getNext(s2, x);
+    }
+}
+
+Dfsm HopcroftPartition::toFsm(const int maxOutput, const FsmPresentationLayer& presentationLayer) const
+{
+    string minFsmName("");
+    std::vector<std::unique_ptr<FsmNode>> nodeLst;
+    
+    /* As for PkTable::toFsm(), states are named by the
+     * set of original states they represent
+     */
+    vector<string> minState2String(numClasses, "{");
+    vector<int> representative(numClasses, -1);
+    for ( int s = 0; s < size(); s++ ) {
+        int c = classOf[s];
+        if ( representative[c] < 0 ) {
+            representative[c] = s;
+        }
+        else {
+            minState2String[c] += ",";
+        }
+        minState2String[c] += presentationLayer.getStateId(s,"");
+    }
+    for ( auto &name : minState2String ) {
+        name += "}";
+    }
+    
+    std::unique_ptr<FsmPresentationLayer> minPl { new FsmPresentationLayer(presentationLayer.getIn2String(),
+                                                                           presentationLayer.getOut2String(),
+                                                                           minState2String) };
+    
+    for ( int c = 0; c < numClasses; c++ ) {
+        nodeLst.emplace_back(new FsmNode(c, ""));
+    }
+    
+    // Equivalent states have equivalent post-states, so the
+    // transitions of one representative per class suffice
+    for ( int c = 0; c < numClasses; c++ ) {
+        int s = representative[c];
+        for ( int x = 0; x < table->getNumInputs(); x++ ) {
+            FsmNode *tgtNode = nodeLst[classOf[table->getNext(s, x)]].get();
+            std::unique_ptr<FsmTransition> tr { new FsmTransition(nodeLst[c].get(),
+                                                                  tgtNode,
+                                                                  FsmLabel(x, table->getOutput(s, x))) };
+            nodeLst[c]->addTransition(std::move(tr));
+        }
+    }
+    
+    return Dfsm(minFsmName, table->getNumInputs() - 1, maxOutput, std::move(nodeLst), std::move(minPl));
+}
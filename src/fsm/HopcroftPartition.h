@@ -0,0 +1,117 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_HOPCROFTPARTITION_H_
+#define FSM_FSM_HOPCROFTPARTITION_H_
+
+#include <memory>
+#include <vector>
+
+class DenseDFSMTable;
+class Dfsm;
+class FsmPresentationLayer;
+
+/**
+ Class representing the partition of the states of a completely
+ specified DFSM into equivalence classes, calculated by Hopcroft's
+ partition refinement algorithm in O(|I| n log n) time.
+
+ Starting from the partition into states with equal outputs, blocks
+ are split with respect to splitter blocks until the partition is
+ stable. Every split is recorded in a split tree: the states of a
+ block are the leaves below its tree node, and the node of a block
+ which has been split carries the input which separated its states.
+ This history suffices to derive a
+ distinguishing trace for every pair of inequivalent states,
+ replacing the sequence of Pk-tables for this purpose.
+ */
+class HopcroftPartition
+{
+private:
+    /** A node of the split tree */
+    struct SplitNode {
+        /** Parent node, or -1 for the root */
+        int parent;
+        /** Distance from the root */
+        int depth;
+        /**
+         * Input which split this node, or -1 if the node has been
+         * split by outputs (root only) or has not been split at all.
+         * If the node has been split by input x, exactly one of two
+         * states separated by this split has an x-successor in the
+         * splitter block, so that their x-successors have already
+         * been separated by an earlier split.
+         */
+        int input;
+    };
+
+    /** The DFSM table the partition has been calculated for */
+    std::shared_ptr<const DenseDFSMTable> table;
+
+    /** Split tree, the root (node 0) contains all states */
+    std::vector<SplitNode> splitTree;
+
+    /** Leaf of the split tree for each state */
+    std::vector<int> leafOf;
+
+    /** Equivalence class for each state */
+    std::vector<int> classOf;
+
+    /** Number of equivalence classes */
+    int numClasses;
+
+    /** Add a node with the given parent to the split tree */
+    int addSplitNode(const int parent);
+
+    /**
+     * Return the lowest common ancestor of two nodes of the
+     * split tree
+     */
+    int commonAncestor(int n1, int n2) const;
+
+public:
+    /**
+     * Calculate the equivalence classes of a DFSM
+     * @param table Transition table of the DFSM
+     * \pre The DFSM is completely specified
+     */
+    explicit HopcroftPartition(const std::shared_ptr<const DenseDFSMTable>& table);
+
+    /** Return the number of states */
+    int size() const { return static_cast<int>(classOf.size()); }
+
+    /** Return the number of equivalence classes */
+    int getNumClasses() const { return numClasses; }
+
+    /**
+     * Return the equivalence class of state s. Classes are numbered
+     * in the order of their smallest member.
+     */
+    int getClass(const int s) const { return classOf[s]; }
+
+    /** Return true if and only if states s1 and s2 are not equivalent */
+    bool distinguishable(const int s1, const int s2) const {
+        return classOf[s1] != classOf[s2];
+    }
+
+    /**
+     * Calculate an input trace distinguishing two states, by following
+     * the recorded splits from the block where s1 and s2 were separated
+     * back to the initial partition by outputs.
+     * @return Distinguishing input trace, or an empty trace if s1 and s2
+     *         are equivalent
+     */
+    std::vector<int> calcDistinguishingTrace(int s1, int s2) const;
+
+    /**
+     * Generate the minimised DFSM, with one state for each equivalence
+     * class, as PkTable::toFsm() does for the last Pk-table.
+     * @param maxOutput Maximal output of the DFSM
+     * @param presentationLayer Presentation layer of the DFSM
+     * @return The minimised DFSM
+     */
+    Dfsm toFsm(const int maxOutput, const FsmPresentationLayer& presentationLayer) const;
+};
+#endif //FSM_FSM_HOPCROFTPARTITION_H_
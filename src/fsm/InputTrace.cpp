@@ -5,14 +5,14 @@
  */
 #include "fsm/InputTrace.h"
 
-InputTrace::InputTrace(std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: Trace(std::move(presentationLayer))
+InputTrace::InputTrace(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: Trace(presentationLayer)
 {
 
 }
 
-InputTrace::InputTrace(const std::vector<int>& trace, std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: Trace(trace, std::move(presentationLayer))
+InputTrace::InputTrace(const std::vector<int>& trace, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: Trace(trace, presentationLayer)
 {
 
 }
@@ -19,7 +19,7 @@ public:
 	Create an empty input trace, with only one presentation layer
 	@param presentationLayer The presentation layer used by the trace
 	*/
-	InputTrace(std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+	InputTrace(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	/**
 	Create an input trace
@@ -27,7 +27,7 @@ public:
 	@param presentationLayer The presentation layer used by the trace
 	*/
 	InputTrace(const std::vector<int>& trace,
-               std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+               const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	/**
 	Output the InputTrace to a standard output stream
@@ -6,15 +6,50 @@
 #ifndef FSM_FSM_INT2INTMAP_H_
 #define FSM_FSM_INT2INTMAP_H_
 
-#include <map>
+#include <cstddef>
+#include <vector>
 
-class Int2IntMap : public std::map<int, int>
+/**
+ Class representing a total map from the keys 0..maxKey to integers,
+ where -1 denotes an undefined value.
+
+ The values are stored contiguously and indexed by their key, so that
+ a lookup is a single array access instead of a search tree walk.
+ */
+class Int2IntMap
 {
+private:
+    /** values[k] is the value associated with key k */
+    std::vector<int> values;
+
 public:
     /**
-     * Create a standard map and initialise every element to -1
-     * @param maxInput The size of the map
+     * Create a map and initialise every element to -1
+     * @param maxInput The maximal key of the map, i.e. the map
+     *                 has maxInput+1 elements
+     */
+    explicit Int2IntMap(const int maxInput);
+
+    /** Return the number of keys, i.e. maxInput+1 */
+    size_t size() const { return values.size(); }
+
+    /** Return the value of key k, without range check */
+    int& operator[](const int k) { return values[k]; }
+    int operator[](const int k) const { return values[k]; }
+
+    /**
+     * Return the value of key k
+     * @throws std::out_of_range if k is not a key of the map
      */
-    Int2IntMap(const int maxInput);
+    int& at(const int k) { return values.at(k); }
+    int at(const int k) const { return values.at(k); }
+
+    friend bool operator==(const Int2IntMap& m1, const Int2IntMap& m2) {
+        return m1.values == m2.values;
+    }
+
+    friend bool operator!=(const Int2IntMap& m1, const Int2IntMap& m2) {
+        return m1.values != m2.values;
+    }
 };
 #endif //FSM_FSM_INT2INTMAP_H_
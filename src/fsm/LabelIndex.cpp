@@ -0,0 +1,51 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <tuple>
+
+#include "fsm/CSRTransitionTable.h"
+#include "fsm/LabelIndex.h"
+
+using namespace std;
+
+LabelIndex::LabelIndex(const CSRTransitionTable& csr)
+{
+    const int numStates = csr.size();
+    offset.reserve(numStates + 1);
+    input.reserve(csr.getNumTransitions());
+    output.reserve(csr.getNumTransitions());
+    target.reserve(csr.getNumTransitions());
+
+    vector< tuple<int, int, int> > entries;
+    for ( int s = 0; s < numStates; s++ ) {
+        offset.push_back(static_cast<int>(target.size()));
+
+        entries.clear();
+        for ( int t = csr.begin(s); t < csr.end(s); t++ ) {
+            entries.emplace_back(csr.getInput(t), csr.getOutput(t), csr.getTarget(t));
+        }
+        sort(entries.begin(), entries.end());
+        entries.erase(unique(entries.begin(), entries.end()), entries.end());
+
+        for ( auto const &e : entries ) {
+            input.push_back(get<0>(e));
+            output.push_back(get<1>(e));
+            target.push_back(get<2>(e));
+        }
+    }
+    offset.push_back(static_cast<int>(target.size()));
+}
+
+int LabelIndex::labelEnd(const int s, int t) const
+{
+    const int x = input[t];
+    const int y = output[t];
+    const int last = end(s);
+    while ( t < last and input[t] == x and output[t] == y ) {
+        ++ t;
+    }
+    return t;
+}
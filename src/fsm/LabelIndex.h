@@ -0,0 +1,70 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_LABELINDEX_H_
+#define FSM_FSM_LABELINDEX_H_
+
+#include <vector>
+
+class CSRTransitionTable;
+
+/**
+ Class indexing the outgoing transitions of each state of an FSM by
+ their input/output label.
+
+ Like CSRTransitionTable, the transitions are stored contiguously per
+ state, but ordered by input, output and target state, and transitions
+ with the same label and target occur only once. All transitions of a
+ state carrying a given label therefore form one consecutive range,
+ and the transitions of two states can be joined on their labels by a
+ single merge pass.
+ */
+class LabelIndex
+{
+private:
+    /** offset[s] is the position of the first transition of state s */
+    std::vector<int> offset;
+
+    /** Input, output and target state of each transition */
+    std::vector<int> input;
+    std::vector<int> output;
+    std::vector<int> target;
+
+public:
+    /**
+     * Create the label index of the transitions of an FSM
+     * @param csr The CSR transition table of the FSM
+     */
+    explicit LabelIndex(const CSRTransitionTable& csr);
+
+    /** Return the number of states */
+    int size() const { return static_cast<int>(offset.size()) - 1; }
+
+    /** Position of the first outgoing transition of state s */
+    int begin(const int s) const { return offset[s]; }
+
+    /** Position after the last outgoing transition of state s */
+    int end(const int s) const { return offset[s + 1]; }
+
+    int getInput(const int t) const { return input[t]; }
+    int getOutput(const int t) const { return output[t]; }
+    int getTarget(const int t) const { return target[t]; }
+
+    /**
+     * Return true if and only if transition t1 of this index has a
+     * smaller label than transition t2 of index other
+     */
+    bool labelLess(const int t1, const LabelIndex& other, const int t2) const {
+        return input[t1] < other.input[t2] or
+        (input[t1] == other.input[t2] and output[t1] < other.output[t2]);
+    }
+
+    /**
+     * Return the position after the last transition with the same
+     * label as transition t, among the transitions of its state s
+     */
+    int labelEnd(const int s, int t) const;
+};
+#endif //FSM_FSM_LABELINDEX_H_
@@ -0,0 +1,189 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "fsm/OFSMPartition.h"
+#include "fsm/OFSMTable.h"
+
+using namespace std;
+
+namespace {
+
+    /** Minimal number of table entries hashed by one thread */
+    const size_t minEntriesPerThread = 1 << 16;
+
+    /** Mix a value into a hash (64 bit variant of boost::hash_combine) */
+    inline uint64_t hashCombine(uint64_t h, const uint64_t v) {
+        h ^= v + 0x9e3779b97f4a7c15ULL + (h << 12) + (h >> 4);
+        return h;
+    }
+
+    /**
+     * Group of threads executing jobs 1..numJobs-1 of a round, while
+     * the calling thread executes job 0. The threads are started once
+     * and wait for the next round in between.
+     */
+    class RoundWorkers {
+    public:
+        RoundWorkers(const unsigned numJobs, const function<void(unsigned)>& job)
+        : job(job), round(0), numRunning(0), stop(false)
+        {
+            for ( unsigned t = 1; t < numJobs; t++ ) {
+                threads.emplace_back([this, t]() { work(t); });
+            }
+        }
+
+        ~RoundWorkers() {
+            {
+                lock_guard<mutex> lock(m);
+                stop = true;
+            }
+            roundStarted.notify_all();
+            for ( auto& th : threads ) {
+                th.join();
+            }
+        }
+
+        /** Execute all jobs once and wait until they are finished */
+        void run() {
+            {
+                lock_guard<mutex> lock(m);
+                round++;
+                numRunning = threads.size();
+            }
+            roundStarted.notify_all();
+            job(0);
+            unique_lock<mutex> lock(m);
+            roundFinished.wait(lock, [this]() { return numRunning == 0; });
+        }
+
+    private:
+        function<void(unsigned)> job;
+        vector<thread> threads;
+        mutex m;
+        condition_variable roundStarted;
+        condition_variable roundFinished;
+        size_t round;
+        size_t numRunning;
+        bool stop;
+
+        void work(const unsigned t) {
+            size_t lastRound = 0;
+            while ( true ) {
+                {
+                    unique_lock<mutex> lock(m);
+                    roundStarted.wait(lock, [this, lastRound]() {
+                        return stop or round != lastRound;
+                    });
+                    if ( stop ) return;
+                    lastRound = round;
+                }
+                job(t);
+                lock_guard<mutex> lock(m);
+                if ( --numRunning == 0 ) roundFinished.notify_one();
+            }
+        }
+    };
+
+}
+
+OFSMPartition::OFSMPartition(const OFSMTable& tbl, const unsigned numThreads)
+: numStates(tbl.size()), classOf(numStates), numClasses(numStates > 0 ? 1 : 0),
+  splittingTree(numStates)
+{
+    for ( int n = 0; n < numStates; n++ ) {
+        classOf[n] = 0;
+    }
+    if ( numStates == 0 ) return;
+
+    vector<uint64_t> hashes(numStates);
+    size_t entries = static_cast<size_t>(numStates) * tbl.getRow(0).size();
+    unsigned threads = numThreads > 0 ? numThreads : max(1u, thread::hardware_concurrency());
+    threads = static_cast<unsigned>(min<size_t>(threads, entries / minEntriesPerThread));
+    if ( threads <= 1 ) {
+        do {
+            calcSignatureHashes(tbl, hashes, 0, numStates);
+        } while ( refine(tbl, hashes) );
+        return;
+    }
+
+    // The same threads hash their chunk of the states in every round
+    const int chunk = static_cast<int>((numStates + threads - 1) / threads);
+    RoundWorkers workers(threads, [this, &tbl, &hashes, chunk](unsigned t) {
+        int first = min(static_cast<int>(t) * chunk, numStates);
+        calcSignatureHashes(tbl, hashes, first, min(first + chunk, numStates));
+    });
+    do {
+        workers.run();
+    } while ( refine(tbl, hashes) );
+}
+
+void OFSMPartition::calcSignatureHashes(const OFSMTable& tbl,
+                                        vector<uint64_t>& hashes,
+                                        const int first,
+                                        const int last) const {
+    for ( int n = first; n < last; n++ ) {
+        OFSMTableRow row = tbl.getRow(n);
+        uint64_t h = static_cast<uint64_t>(classOf[n]);
+        for ( size_t k = 0; k < row.size(); k++ ) {
+            // Undefined labels contribute 0, post-states their class + 1
+            int post = row[k];
+            h = hashCombine(h, post < 0 ? 0 : static_cast<uint64_t>(classOf[post]) + 1);
+        }
+        hashes[n] = h;
+    }
+}
+
+bool OFSMPartition::refine(const OFSMTable& tbl, const vector<uint64_t>& hashes) {
+
+    // New classes are created in the order of their smallest member.
+    // For each new class, rep holds this member and sameHash the next
+    // class whose signature has the same hash value, or -1.
+    S2CMap newClassOf(numStates);
+    vector<int> rep;
+    vector<int> sameHash;
+    unordered_map<uint64_t, int> classOfHash;
+    classOfHash.reserve(2 * numClasses);
+
+    for ( int n = 0; n < numStates; n++ ) {
+
+        OFSMTableRow row = tbl.getRow(n);
+        auto ins = classOfHash.emplace(hashes[n], static_cast<int>(rep.size()));
+
+        int c = ins.first->second;
+        int last = -1;
+        if ( not ins.second ) {
+            // Resolve hash collisions by comparing the signatures
+            while ( c >= 0 ) {
+                if ( classOf[rep[c]] == classOf[n] and
+                    tbl.getRow(rep[c]).classEquals(classOf, row) ) {
+                    break;
+                }
+                last = c;
+                c = sameHash[c];
+            }
+        }
+
+        if ( c < 0 or ins.second ) {
+            c = static_cast<int>(rep.size());
+            rep.push_back(n);
+            sameHash.push_back(-1);
+            if ( last >= 0 ) sameHash[last] = c;
+        }
+        newClassOf[n] = c;
+    }
+
+    bool split = static_cast<int>(rep.size()) > numClasses;
+    classOf = newClassOf;
+    splittingTree.refine(classOf);
+    numClasses = static_cast<int>(rep.size());
+    return split;
+}
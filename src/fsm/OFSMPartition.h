@@ -0,0 +1,92 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_OFSMPARTITION_H_
+#define FSM_FSM_OFSMPARTITION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "fsm/SplittingTree.h"
+#include "fsm/typedef.inc"
+
+class OFSMTable;
+
+/**
+ Class representing the partition of the states of an observable FSM
+ into equivalence classes, calculated from its initial OFSMTable by
+ refinement rounds over hashed state signatures.
+
+ The signature of a state consists of its current class and, for each
+ input/output label x/y, the class of its x/y-post-state, or -1 if the
+ state has no transition labelled by x/y. Each round groups the states
+ by their signatures in a hash table, so that a round takes time linear
+ in the size of the table, instead of comparing every state of a class
+ with a reference row. The signature hashes are independent of each
+ other and are calculated concurrently for large tables, by the same
+ threads in all rounds.
+
+ Round k yields the same classes as the k-th table created by
+ OFSMTable::next(). Instead of these tables, only the final mapping of
+ states to classes and the splitting tree of the rounds are kept.
+ */
+class OFSMPartition
+{
+private:
+    /** Number of states of the FSM */
+    int numStates;
+
+    /** Current class of each state */
+    S2CMap classOf;
+
+    /** Number of classes */
+    int numClasses;
+
+    /** History of the refinement rounds */
+    SplittingTree splittingTree;
+
+    /**
+     * Calculate the hashes of the signatures of states first..last-1,
+     * based on the current classes
+     */
+    void calcSignatureHashes(const OFSMTable& tbl,
+                             std::vector<uint64_t>& hashes,
+                             const int first,
+                             const int last) const;
+
+    /**
+     * Split the current classes into classes of states with equal
+     * signatures.
+     * @param hashes The hashes of the signatures of all states
+     * @return true if and only if at least one class has been split
+     */
+    bool refine(const OFSMTable& tbl, const std::vector<uint64_t>& hashes);
+
+public:
+    /**
+     * Calculate the equivalence classes of an observable FSM
+     * @param tbl The initial OFSMTable of the FSM
+     * @param numThreads Number of threads calculating the signature
+     *        hashes of large tables, or 0 for one thread per hardware
+     *        thread. The classes do not depend on this number.
+     */
+    explicit OFSMPartition(const OFSMTable& tbl, const unsigned numThreads = 1);
+
+    /** Return the number of equivalence classes */
+    int getNumClasses() const { return numClasses; }
+
+    /**
+     * Return the mapping from states to their equivalence classes.
+     * Classes are numbered in the order of their smallest member.
+     */
+    const S2CMap& getS2C() const { return classOf; }
+
+    /**
+     * Return the splitting tree of the refinement, where round k
+     * corresponds to the k-th OFSM table
+     */
+    const SplittingTree& getSplittingTree() const { return splittingTree; }
+};
+#endif //FSM_FSM_OFSMPARTITION_H_
@@ -4,7 +4,6 @@
  * Licensed under the EUPL V.1.1
  */
 #include "fsm/OFSMTable.h"
-#include "fsm/OFSMTableRow.h"
 #include "fsm/Fsm.h"
 #include "fsm/FsmNode.h"
 #include "fsm/FsmTransition.h"
@@ -13,13 +12,15 @@ using namespace std;
 
 shared_ptr<OFSMTable> OFSMTable::nextAfterZero()
 {
-	shared_ptr<OFSMTable> next = make_shared<OFSMTable>(numStates, maxInput, maxOutput, rows, presentationLayer);
+	shared_ptr<OFSMTable> next = make_shared<OFSMTable>(numStates, maxInput, maxOutput, postStates, presentationLayer);
 	next->tblId = 1;
 
 	int thisClass = 0;
 	S2CMap newS2C = next->getS2C();
 	for (int n = 0; n < numStates; ++ n)
 	{
+		OFSMTableRow rowN = getRow(n);
+
 		/*If FSM node n is already associated with a class,
 		skip this node*/
 		if (newS2C.at(n) >= 0)
@@ -38,7 +39,7 @@ shared_ptr<OFSMTable> OFSMTable::nextAfterZero()
 			/*Node m should be associated with the same class as
 			n, if and only if its outgoing transitions are labelled
 			in the same way as the ones of node n*/
-			if (rows.at(n)->ioEquals(rows.at(m)))
+			if (newS2C[m] < 0 && rowN.ioEquals(getRow(m)))
 			{
 				newS2C [m] = thisClass;//insertion
 			}
@@ -55,29 +56,31 @@ shared_ptr<OFSMTable> OFSMTable::nextAfterZero()
 }
 
 OFSMTable::OFSMTable(vector<std::unique_ptr<FsmNode>> const &nodes, const int maxInput, const int maxOutput, FsmPresentationLayer const *presentationLayer)
-	: numStates(static_cast<int> (nodes.size())), maxInput(maxInput), maxOutput(maxOutput), tblId(0), s2c(numStates), presentationLayer(presentationLayer)
+	: numStates(static_cast<int> (nodes.size())), maxInput(maxInput), maxOutput(maxOutput), tblId(0), s2c(numStates),
+	  rowSize((maxInput + 1) * (maxOutput + 1)), presentationLayer(presentationLayer)
 {
 	for (int n = 0; n < numStates; ++ n)
 	{
 		s2c[n] = 0;
 	}
 
+	shared_ptr<vector<int>> entries = make_shared<vector<int>>(static_cast<size_t>(numStates) * rowSize, -1);
 	for (int i = 0; i < numStates; ++ i)
 	{
-		rows.push_back(make_shared<OFSMTableRow>(maxInput, maxOutput));
-
 		for (auto &tr : nodes.at(i)->getTransitions())
 		{
 			int x = tr->getLabel()->getInput();
 			int y = tr->getLabel()->getOutput();
 			FsmNode *tgtNode = tr->getTarget();
-			rows.at(i)->set(x, y, tgtNode->getId());
+			(*entries)[i * rowSize + x * (maxOutput + 1) + y] = tgtNode->getId();
 		}
 	}
+	postStates = entries;
 }
 
-OFSMTable::OFSMTable(const int numStates, const int maxInput, const int maxOutput, const vector<shared_ptr<OFSMTableRow>>& rows, FsmPresentationLayer const *presentationLayer)
-	: numStates(numStates), maxInput(maxInput), maxOutput(maxOutput), tblId(0), s2c(numStates), rows(rows), presentationLayer(presentationLayer)
+OFSMTable::OFSMTable(const int numStates, const int maxInput, const int maxOutput, const shared_ptr<const vector<int>>& postStates, FsmPresentationLayer const *presentationLayer)
+	: numStates(numStates), maxInput(maxInput), maxOutput(maxOutput), tblId(0), s2c(numStates),
+	  rowSize((maxInput + 1) * (maxOutput + 1)), postStates(postStates), presentationLayer(presentationLayer)
 {
 
 }
@@ -87,7 +90,7 @@ int OFSMTable::getId()
 	return tblId;
 }
 
-S2CMap OFSMTable::getS2C()
+const S2CMap& OFSMTable::getS2C() const
 {
 	return s2c;
 }
@@ -97,11 +100,6 @@ void OFSMTable::setS2C(const S2CMap & ps2c)
 	s2c = ps2c;
 }
 
-int OFSMTable::get(const int id, const int x, const int y)
-{
-	return rows.at(id)->get(x, y);
-}
-
 int OFSMTable::maxClassId() const
 {
 	int id = 0;
@@ -122,32 +120,39 @@ shared_ptr<OFSMTable> OFSMTable::next()
 		return nextAfterZero();
 	}
 
-	shared_ptr<OFSMTable> next = make_shared<OFSMTable>(numStates, maxInput, maxOutput, rows, presentationLayer);
+	shared_ptr<OFSMTable> next = make_shared<OFSMTable>(numStates, maxInput, maxOutput, postStates, presentationLayer);
 	next->tblId = tblId + 1;
 
+	/*Rows are compared by their class signatures, which
+	is equivalent to comparing them by classEquals()*/
+	vector<int> signatures = calcClassSignatures();
+	auto signature = [this, &signatures](const int n) {
+		return OFSMTableRow(signatures.data() + n * rowSize, maxInput, maxOutput);
+	};
+
 	int thisClass = 0;
 	int thisNewClassId = maxClassId() + 1;
-	shared_ptr<OFSMTableRow> refRow;
-	shared_ptr<OFSMTableRow> newClassRefRow;
+	int refRow;
+	int newClassRefRow;
 	S2CMap newS2C = next->getS2C();
 	bool haveNewClasses = false;
 
 	do
 	{
-		refRow = nullptr;
+		refRow = -1;
 
 		for (int n = 0; n < numStates; ++ n)
 		{
 			/*We are only interested in nodes n belonging to
 			the same class according to s2c*/
-			if (s2c.at(n) != thisClass)
+			if (s2c[n] != thisClass)
 			{
 				continue;
 			}
 
 			/*If n is already associated with a class in the new OFSM table
 			nxt, then do not change this*/
-			if (newS2C.at(n) >= 0)
+			if (newS2C[n] >= 0)
 			{
 				continue;
 			}
@@ -156,9 +161,9 @@ shared_ptr<OFSMTable> OFSMTable::next()
 			currently associated with thisClass. This node
 			always keeps the old class thisClass in the new
 			OFSMTable*/
-			if (refRow == nullptr)
+			if (refRow < 0)
 			{
-				refRow = rows.at(n);
+				refRow = n;
 				newS2C [n] = thisClass;//insertion
 				continue;
 			}
@@ -169,7 +174,7 @@ shared_ptr<OFSMTable> OFSMTable::next()
 			post states are all equivalent to the post states
 			of the first node associated with this class (this first
 			node is represented by refRow).*/
-			if (refRow->classEquals(s2c, rows.at(n)))
+			if (signature(refRow) == signature(n))
 			{
 				newS2C [n] = thisClass;//insertion
 				continue;
@@ -182,7 +187,7 @@ shared_ptr<OFSMTable> OFSMTable::next()
 			This node gets the next unused class id, which is always
 			stored in thisNewClassId.*/
 			haveNewClasses = true;
-			newClassRefRow = rows.at(n);
+			newClassRefRow = n;
 			newS2C [n] = thisNewClassId;//insertion
 
 			/*Now search for other nodes with id > n that were
@@ -190,13 +195,12 @@ shared_ptr<OFSMTable> OFSMTable::next()
 			should also belong into the new class thisNewClassId*/
 			for (int m = n + 1; m < numStates; ++ m)
 			{
-				if (s2c.at(m) == thisClass && newClassRefRow->classEquals(s2c, rows.at(m)))
+				if (s2c[m] == thisClass && signature(newClassRefRow) == signature(m))
 				{
 					newS2C [m] = thisNewClassId;//insertion
 				}
 			}
 
-			newClassRefRow = nullptr;
 			++ thisNewClassId;
 		}
 
@@ -204,12 +208,23 @@ shared_ptr<OFSMTable> OFSMTable::next()
 		the set of nodes currently belonging to (thisClass+1),
 		if any of those exist.*/
 		++ thisClass;
-	} while (refRow != nullptr);
+	} while (refRow >= 0);
 
 	next->setS2C(newS2C);
 	return haveNewClasses ? next : nullptr;
 }
 
+vector<int> OFSMTable::calcClassSignatures() const
+{
+	const vector<int> & entries = *postStates;
+	vector<int> signatures(entries.size());
+	for (size_t k = 0; k < entries.size(); ++ k)
+	{
+		signatures[k] = (entries[k] < 0) ? -1 : s2c[entries[k]];
+	}
+	return signatures;
+}
+
 string OFSMTable::getMembers(const int c) const
 {
 	string memSet = "{";
@@ -235,8 +250,8 @@ string OFSMTable::getMembers(const int c) const
 
 bool OFSMTable::compareColumns(int x1, int y1, int x2, int y2) {
     
-    for ( size_t r = 0; r < rows.size(); r++ ) {
-        if ( rows[r]->get(x1,y1) != rows[r]->get(x2,y2) ) {
+    for ( int r = 0; r < numStates; r++ ) {
+        if ( get(r,x1,y1) != get(r,x2,y2) ) {
             return false;
         }
     }
@@ -249,6 +264,28 @@ Fsm OFSMTable::toFsm(const string & name) const
 {
 	string minFsmName = name;
 	vector<std::unique_ptr<FsmNode>> nodeLst;
+	const int numClasses = maxClassId() + 1;
+
+	/* Collect the members of all classes in one pass over the states,
+	 * together with the first OFSMTableRow of each class. Since other
+	 * rows associated with the same class have equivalent post-states,
+	 * we only need one representative row per class.
+	 */
+	vector<string> members(numClasses, "{");
+	vector<int> repRow(numClasses, -1);
+	for (int i = 0; i < numStates; ++ i)
+	{
+		int c = s2c.at(i);
+		if (repRow[c] < 0)
+		{
+			repRow[c] = i;
+		}
+		else
+		{
+			members[c] += ",";
+		}
+		members[c] += presentationLayer->getStateId(i,"");
+	}
     
     /* We need a new presentation layer.
      * Input and output names are the same as for the original FSM,
@@ -256,8 +293,8 @@ Fsm OFSMTable::toFsm(const string & name) const
      *  original nodes that are equivalent.
      */
     vector<string> minState2String;
-    for (int i = 0; i <= maxClassId(); ++i) {
-        string newName(minFsmName + "\n" + getMembers(i));
+    for (int i = 0; i < numClasses; ++i) {
+        string newName(minFsmName + "\n" + members[i] + "}");
         minState2String.push_back(newName);
     }
     
@@ -270,7 +307,7 @@ Fsm OFSMTable::toFsm(const string & name) const
      * For external names of the new states, we use their
      * sets of equivalent states, as stored in minState2String
      */
-	for (int i = 0; i <= maxClassId(); ++ i)
+	for (int i = 0; i < numClasses; ++ i)
 	{
 		nodeLst.emplace_back(new FsmNode(i, minState2String[i]));
 	}
@@ -284,21 +321,7 @@ Fsm OFSMTable::toFsm(const string & name) const
          * class id the state belongs to.
          */
         int classId = srcNode->getId();
-
-		/* Find the first OFSMTableRow where the associated original
-         * FsmState belongs to class classId.
-         * Since other rows associated with the same class have
-         * equivalent post-states, we only need to
-		 * find one representative row.
-         */
-		shared_ptr<OFSMTableRow> row = nullptr;
-		for (int i = 0; i < numStates && row == nullptr; i++)
-		{
-			if (classId == s2c.at(i))
-			{
-				row = rows[i];
-			}
-		}
+		int row = repRow[classId];
 
 		/*
          * Process all outgoing transitions of the original
@@ -309,32 +332,23 @@ Fsm OFSMTable::toFsm(const string & name) const
 		{
 			for (int y = 0; y <= maxOutput; y++)
 			{
-				int tgtStateId = row->get(x, y);
+				int tgtStateId = get(row, x, y);
 				if (tgtStateId >= 0)
 				{
-					/* Get the class id of the target node in the original FSM */
+					/* Get the class id of the target node in the original FSM.
+					 * Remember: the node in nodeLst at this index has
+					 * the class id as node id.
+					 */
 					int tgtClassId = s2c.at(tgtStateId);
-
-					/* Find the new FsmNode in the minimised FSM
-                     * which has tgtClassId as node id
-                     */
-					for (auto const &tgtNode : nodeLst)
-                    {
-                        /* Remember: all nodes in nodeLst have an id
-                         * which equals their class id.
-                         */
-                        if (tgtNode->getId() == tgtClassId)
-						{
-							/* Create the transition with label x/y
-                             * and target node tgtNode
-                             */
-							std::unique_ptr<FsmTransition> tr { new FsmTransition(srcNode.get(),
-																				  tgtNode.get(),
-																				  std::unique_ptr<FsmLabel>(new FsmLabel(x, y, minPl.get()))) };
-							srcNode->addTransition(std::move(tr));
-							break;
-						}
-					}
+					FsmNode *tgtNode = nodeLst[tgtClassId].get();
+
+					/* Create the transition with label x/y
+					 * and target node tgtNode
+					 */
+					std::unique_ptr<FsmTransition> tr { new FsmTransition(srcNode.get(),
+																		  tgtNode,
+																		  FsmLabel(x, y)) };
+					srcNode->addTransition(std::move(tr));
 				}
 			}
 		}
@@ -380,7 +394,7 @@ ostream & operator<<(ostream & out, const OFSMTable & ofsmTable)
 		{
 			for (int y = 0; y <= ofsmTable.maxOutput; ++ y)
 			{
-				out << " & " << ofsmTable.rows [i]->get(x, y);
+				out << " & " << ofsmTable.get(i, x, y);
 			}
 		}
 		out << "\\\\\\hline" << endl;
@@ -9,9 +9,9 @@
 #include <memory>
 #include <vector>
 
+#include "fsm/OFSMTableRow.h"
 #include "fsm/typedef.inc"
 
-class OFSMTableRow;
 class FsmPresentationLayer;
 class FsmNode;
 class Fsm;
@@ -31,6 +31,10 @@ The table structure is as follows.
 
 \note This representation is well-defined if and only if the FSM is observable.
 
+The rows are stored in one contiguous array of numStates*(maxInput+1)*(maxOutput+1)
+post-states. This array never changes during minimisation, so it is shared
+by all OFSMTables created from the initial one by next().
+
 Additionally, each OFSMTable contains an S2CMap which maps FSM states to their equivalence
 class associated with the current OFSMTable
 */
@@ -63,8 +67,11 @@ private:
 	/** Mapping from a given state to its current class */
 	S2CMap s2c;
 
-	/** Rows of the OFSM table */
-	std::vector<std::shared_ptr<OFSMTableRow>> rows;
+	/** Number of entries per row, i.e. (maxInput+1)*(maxOutput+1) */
+	int rowSize;
+
+	/** Rows of the OFSM table, row n starts at index n*rowSize */
+	std::shared_ptr<const std::vector<int>> postStates;
 
 	/**
 	The presentation layer used by the OFSMTable
@@ -78,6 +85,15 @@ private:
 	exactly the same set of input/output labels
 	*/
 	std::shared_ptr<OFSMTable> nextAfterZero();
+
+	/**
+	Calculate the class signatures of all rows: the signature of row n
+	contains s2c[r'] at the position of each post-state r' of row n,
+	and -1 where row n has no post-state. Two rows are classEquals()
+	if and only if their signatures are equal.
+	@return numStates*rowSize signatures, row n starts at index n*rowSize
+	*/
+	std::vector<int> calcClassSignatures() const;
 public:
 	/**
 	This constructor creates the initial OFSMTable for an observable FSM.
@@ -89,14 +105,25 @@ public:
 	*/
 	OFSMTable(std::vector<std::unique_ptr<FsmNode>> const &nodes, const int maxInput, const int maxOutput, FsmPresentationLayer const *presentationLayer);
 	
-	//TODO
-	OFSMTable(const int numStates, const int maxInput, const int maxOutput, const std::vector<std::shared_ptr<OFSMTableRow>>& rows, FsmPresentationLayer const *presentationLayer);
+	/**
+	Create an OFSMTable over the post-states of another one,
+	where all nodes are not yet associated with any class.
+	*/
+	OFSMTable(const int numStates, const int maxInput, const int maxOutput, const std::shared_ptr<const std::vector<int>>& postStates, FsmPresentationLayer const *presentationLayer);
 	
+	/**
+	Return the number of states, i.e. the number of rows
+	*/
+	int size() const
+	{
+		return numStates;
+	}
+
 	//TODO
 	int getId();
 
 	//TODO
-	S2CMap getS2C();
+	const S2CMap& getS2C() const;
 
 	//TODO
 	void setS2C(const S2CMap & ps2c);
@@ -110,7 +137,19 @@ public:
 	n >= 0 if FSM state id has an outgoing transition labelled by x/y,
 	which ends at FSM state n
 	*/
-	int get(const int id, const int x, const int y);
+	int get(const int id, const int x, const int y) const
+	{
+		return (*postStates)[id * rowSize + x * (maxOutput + 1) + y];
+	}
+
+	/**
+	Get the row associated with state id
+	@param id state id in range 0..(nodes.length-1)
+	*/
+	OFSMTableRow getRow(const int id) const
+	{
+		return OFSMTableRow(postStates->data() + id * rowSize, maxInput, maxOutput);
+	}
 
 	//TODO
 	int maxClassId() const;
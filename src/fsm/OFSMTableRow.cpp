@@ -1,65 +1,121 @@
 /*
  * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
- * 
+ *
  * Licensed under the EUPL V.1.1
  */
 #include "fsm/OFSMTableRow.h"
 
-OFSMTableRow::OFSMTableRow(const int maxInput, const int maxOutput)
-	: maxInput(maxInput), maxOutput(maxOutput)
-{
-	matrix.insert(matrix.end(), maxInput + 1, std::vector<int>());
-	for (int i = 0; i <= maxInput; ++ i)
-	{
-		matrix.at(i).insert(matrix.at(i).end(), maxOutput + 1, -1);
-	}
-}
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-void OFSMTableRow::set(const int i, const int j, const int postState)
+OFSMTableRow::OFSMTableRow(const int *entries, const int maxInput, const int maxOutput)
+	: maxInput(maxInput), maxOutput(maxOutput), entries(entries)
 {
-	matrix [i] [j] = postState;//insertion
+
 }
 
-int OFSMTableRow::get(const int i, const int j) const
+bool OFSMTableRow::equal(const int *a, const int *b, const size_t n)
 {
-	return matrix.at(i).at(j);
+	size_t k = 0;
+#if defined(__AVX2__)
+	for (; k + 8 <= n; k += 8)
+	{
+		__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + k));
+		__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + k));
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(va, vb)) != -1)
+		{
+			return false;
+		}
+	}
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+	for (; k + 4 <= n; k += 4)
+	{
+		__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + k));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + k));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(va, vb)) != 0xFFFF)
+		{
+			return false;
+		}
+	}
+#endif
+	for (; k < n; ++ k)
+	{
+		if (a[k] != b[k])
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
-bool OFSMTableRow::ioEquals(const std::shared_ptr<OFSMTableRow> r) const
+bool OFSMTableRow::equalSigns(const int *a, const int *b, const size_t n)
 {
-	for (int i = 0; i <= maxInput; ++ i)
+	/*a[k] and b[k] have the same sign if and only if
+	the sign bit of a[k] ^ b[k] is clear*/
+	size_t k = 0;
+#if defined(__AVX2__)
+	for (; k + 8 <= n; k += 8)
+	{
+		__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + k));
+		__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + k));
+		if (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_xor_si256(va, vb))) != 0)
+		{
+			return false;
+		}
+	}
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+	for (; k + 4 <= n; k += 4)
+	{
+		__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + k));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + k));
+		if (_mm_movemask_ps(_mm_castsi128_ps(_mm_xor_si128(va, vb))) != 0)
+		{
+			return false;
+		}
+	}
+#endif
+	for (; k < n; ++ k)
 	{
-		for (int j = 0; j <= maxOutput; ++ j)
+		if ((a[k] < 0) != (b[k] < 0))
 		{
-			if ((get(i, j) >= 0 && r->get(i, j) < 0) || (get(i, j) < 0 && r->get(i, j) >= 0))
-			{
-				return false;
-			}
+			return false;
 		}
 	}
 	return true;
 }
 
-bool OFSMTableRow::classEquals(const S2CMap & s2c, const std::shared_ptr<OFSMTableRow> r)
+bool OFSMTableRow::ioEquals(const OFSMTableRow & r) const
+{
+	return equalSigns(entries, r.entries, size());
+}
+
+bool OFSMTableRow::classEquals(const S2CMap & s2c, const OFSMTableRow & r) const
 {
 	if (!ioEquals(r))
 	{
 		return false;
 	}
 
-	for (int i = 0; i <= maxInput; ++ i)
+	for (size_t k = 0; k < size(); ++ k)
 	{
-		for (int j = 0; j <= maxOutput; ++ j)
+		if (entries[k] < 0)
+		{
+			continue;
+		}
+		if (s2c[entries[k]] != s2c[r.entries[k]])
 		{
-			if (matrix.at(i).at(j) < 0)
-			{
-				continue;
-			}
-			if (s2c.at(matrix.at(i).at(j)) != s2c.at(r->get(i, j)))
-			{
-				return false;
-			}
+			return false;
 		}
 	}
 	return true;
 }
+
+bool OFSMTableRow::operator==(const OFSMTableRow & r) const
+{
+	return equal(entries, r.entries, size());
+}
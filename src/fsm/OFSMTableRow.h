@@ -1,19 +1,26 @@
 /*
  * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
- * 
+ *
  * Licensed under the EUPL V.1.1
  */
 #ifndef FSM_FSM_OFSMTABLEROW_H_
 #define FSM_FSM_OFSMTABLEROW_H_
 
-#include <memory>
-#include <vector>
+#include <cstddef>
 
 #include "fsm/Int2IntMap.h"
 #include "fsm/typedef.inc"
 
 /**
-Class representing one table row of an OFSMTable
+Class representing one table row of an OFSMTable.
+
+A row does not own its entries: it is a view of (maxInput+1)*(maxOutput+1)
+consecutive elements of the contiguous array holding all rows of an
+OFSMTable, where the post-state for input/output i/j is found at
+position i*(maxOutput+1)+j.
+
+Row comparisons are performed by vectorised kernels (AVX2 if the compiler
+targets it, SSE2 otherwise, with a scalar fallback on other platforms).
 */
 class OFSMTableRow
 {
@@ -29,33 +36,46 @@ private:
 	int maxOutput;
 
 	/**
-	The OFSMTableRow itself
+	The entries of this row, owned by the table
 	*/
-	std::vector<std::vector<int>> matrix;
+	const int *entries;
+
 public:
 	/**
 	Create a OFSMTableRow
+	@param entries The (maxInput+1)*(maxOutput+1) entries of the row
 	@param maxInput The maximal input
 	@param maxOutput The maximal output
 	*/
-	OFSMTableRow(const int maxInput, const int maxOutput);
+	OFSMTableRow(const int *entries, const int maxInput, const int maxOutput);
 
 	/**
-	Set for the element at the position i / j as postState
+	Getter for the element at the position i / j
 	@param i The line number
 	@param j The column number
-	@param postState The value
 	@return The element
 	*/
-	void set(const int i, const int j, const int postState);
+	int get(const int i, const int j) const
+	{
+		return entries[i * (maxOutput + 1) + j];
+	}
 
 	/**
-	Getter for the element at the position i / j
-	@param i The line number
-	@param j The column number
-	@return The element
+	Getter for the k-th entry of the row, i.e. the element at the position
+	k / (maxOutput+1) / k % (maxOutput+1)
+	*/
+	int operator[](const size_t k) const
+	{
+		return entries[k];
+	}
+
+	/**
+	Return the number of entries of the row
 	*/
-	int get(const int i, const int j) const;
+	size_t size() const
+	{
+		return static_cast<size_t>(maxInput + 1) * (maxOutput + 1);
+	}
 
 	/**
 	Return false if and only if this row represents a state that
@@ -63,13 +83,31 @@ public:
 	represented by r has no emanating transition labelled with i/o or
 	vice versa.
 	*/
-	bool ioEquals(const std::shared_ptr<OFSMTableRow> r) const;
+	bool ioEquals(const OFSMTableRow & r) const;
 
 	/**
 	Return false if and only if this row represents a state that
 	is mapped to a post state by input/output i/o which is associated
 	with another equivalence class than the post state r.get(i,o).
 	*/
-	bool classEquals(const S2CMap & s2c, const std::shared_ptr<OFSMTableRow> r);
+	bool classEquals(const S2CMap & s2c, const OFSMTableRow & r) const;
+
+	/**
+	Return true if and only if both rows have identical entries. Applied to
+	rows of class signatures (see OFSMTable::calcClassSignatures()), this
+	is equivalent to classEquals().
+	*/
+	bool operator==(const OFSMTableRow & r) const;
+
+	/**
+	Return true if and only if the first n elements of a and b are equal
+	*/
+	static bool equal(const int *a, const int *b, const size_t n);
+
+	/**
+	Return true if and only if, for the first n elements of a and b,
+	a[k] < 0 exactly if b[k] < 0
+	*/
+	static bool equalSigns(const int *a, const int *b, const size_t n);
 };
 #endif //FSM_FSM_OFSMTABLEROW_H_
@@ -5,14 +5,14 @@
  */
 #include "fsm/OutputTrace.h"
 
-OutputTrace::OutputTrace(std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: Trace(std::move(presentationLayer))
+OutputTrace::OutputTrace(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: Trace(presentationLayer)
 {
 
 }
 
-OutputTrace::OutputTrace(const std::vector<int>& trace, std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: Trace(trace, std::move(presentationLayer))
+OutputTrace::OutputTrace(const std::vector<int>& trace, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: Trace(trace, presentationLayer)
 {
 
 }
@@ -19,14 +19,14 @@ public:
 	Create an empty output trace, with only one presentation layer
 	@param presentationLayer The presentation layer used by the trace
 	*/
-	OutputTrace(std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+	OutputTrace(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	/**
 	Create an output trace
 	@param trace The trace itself, represented by a list of int
 	@param presentationLayer The presentation layer used by the trace
 	*/
-	OutputTrace(const std::vector<int>& trace, std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+	OutputTrace(const std::vector<int>& trace, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	/**
 	Output the OutputTrace to a standard output stream
@@ -35,7 +35,7 @@ void PkTable::setClass(const int n, const int c)
 
 int PkTable::getClass(const int n) const
 {
-	return s2c.at(n);
+	return s2c[n];
 }
 
 int PkTable::maxClassId() const
@@ -71,7 +71,7 @@ shared_ptr<PkTable> PkTable::getPkPlusOneTable() const
         {
             // We are only interested in rows that were assigned to thisClass
             // in this Pk-table.
-            if (s2c.at(i) != thisClass)
+            if (s2c[i] != thisClass)
             {
                 continue;
             }
@@ -148,7 +148,7 @@ shared_ptr<PkTable> PkTable::getPkPlusOneTable() const
             // equivalent to rows.at(i).
             for (unsigned int j = i + 1; j < rows.size(); ++j)
             {
-                if ( s2c.at(j) == thisClass and
+                if ( s2c[j] == thisClass and
                     pkp1->getClass(j) < 0 and
                     newClassRefRow->isEquivalent(*rows.at(j), s2c) )
                 {
@@ -243,10 +243,9 @@ Dfsm PkTable::toFsm(string name, const int maxOutput)
 					break;
 				}
 			}
-			std::unique_ptr<FsmLabel> lbl { new FsmLabel(x, y, minPl.get()) };
             std::unique_ptr<FsmTransition> tr { new FsmTransition(srcNode.get(),
                                                                   tgtNode,
-                                                                  std::move(lbl)) };
+                                                                  FsmLabel(x, y)) };
 			srcNode->addTransition(std::move(tr));
 		}
 	}
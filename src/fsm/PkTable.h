@@ -85,6 +85,11 @@ public:
      */
     int getClass(const int n) const;
     
+    /**
+     * Return the mapping from states to their Pk-equivalence classes
+     */
+    const S2CMap& getS2C() const { return s2c; }
+    
     /**
      * Get the maximum id of the Pk-equivalence class
      * @return The id
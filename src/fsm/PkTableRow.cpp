@@ -36,16 +36,16 @@ bool PkTableRow::isEquivalent(const PkTableRow& row, const S2CMap& s2c) const
         // a certain state and for a certain input, the output
         // is set to -1, because there is no transition handling
         // this input
-        if(i2p.at(i) == -1) {
-            if (row.getI2PMap().at(i) != -1) {
+        if(i2p[i] == -1) {
+            if (row.i2p[i] != -1) {
                 return false;
             }
         }
-        else if ( row.getI2PMap().at(i) == -1 ) {
+        else if ( row.i2p[i] == -1 ) {
             // We know already that i2p.at(i) >= 0
             return false;
         }
-        else if( s2c.at(i2p.at(i)) != s2c.at(row.getI2PMap().at(i)) )
+        else if( s2c[i2p[i]] != s2c[row.i2p[i]] )
         {
             return false;
         }
@@ -0,0 +1,96 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+#include "fsm/CSRTransitionTable.h"
+#include "fsm/ResponsePartition.h"
+
+using namespace std;
+
+namespace {
+
+    /** Minimal number of states whose responses are calculated by one thread */
+    const int minStatesPerThread = 256;
+
+    /** Hash of a response, extended by the class of the state */
+    struct ResponseHash {
+        size_t operator()(const vector<int>& key) const {
+            uint64_t h = key.size();
+            for ( int v : key ) {
+                h ^= static_cast<uint64_t>(v) + 0x9e3779b97f4a7c15ULL + (h << 12) + (h >> 4);
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+}
+
+ResponsePartition::ResponsePartition(const shared_ptr<const CSRTransitionTable>& csr,
+                                     const unsigned numThreads)
+: csr(csr),
+  numThreads(numThreads > 0 ? numThreads : max(1u, thread::hardware_concurrency())),
+  classOf(csr->size(), 0),
+  nextInClass(csr->size(), -1),
+  numClasses(csr->size() > 0 ? 1 : 0)
+{
+    for ( int s = 0; s + 1 < csr->size(); s++ ) {
+        nextInClass[s] = s + 1;
+    }
+}
+
+void ResponsePartition::calcResponses(const vector<int>& itrc,
+                                      vector< vector<int> >& responses,
+                                      const int first,
+                                      const int last) const
+{
+    for ( int s = first; s < last; s++ ) {
+        csr->response(s, itrc, responses[s]);
+    }
+}
+
+void ResponsePartition::refine(const vector<int>& itrc)
+{
+    const int numStates = csr->size();
+    if ( numStates == 0 ) return;
+
+    vector< vector<int> > responses(numStates);
+    int threads = min(static_cast<int>(numThreads), numStates / minStatesPerThread);
+    if ( threads <= 1 ) {
+        calcResponses(itrc, responses, 0, numStates);
+    }
+    else {
+        vector<thread> workers;
+        int chunk = (numStates + threads - 1) / threads;
+        for ( int first = 0; first < numStates; first += chunk ) {
+            int last = min(first + chunk, numStates);
+            workers.emplace_back([this, &itrc, &responses, first, last]() {
+                calcResponses(itrc, responses, first, last);
+            });
+        }
+        for ( auto& w : workers ) {
+            w.join();
+        }
+    }
+
+    // New classes are created in the order of their smallest member
+    unordered_map<vector<int>, int, ResponseHash> classOfResponse;
+    classOfResponse.reserve(2 * numClasses);
+    for ( int s = 0; s < numStates; s++ ) {
+        vector<int>& key = responses[s];
+        key.push_back(classOf[s]);
+        auto ins = classOfResponse.emplace(std::move(key), static_cast<int>(classOfResponse.size()));
+        classOf[s] = ins.first->second;
+    }
+    numClasses = static_cast<int>(classOfResponse.size());
+
+    vector<int> lastOfClass(numClasses, -1);
+    for ( int s = numStates - 1; s >= 0; s-- ) {
+        nextInClass[s] = lastOfClass[classOf[s]];
+        lastOfClass[classOf[s]] = s;
+    }
+}
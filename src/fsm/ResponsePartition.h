@@ -0,0 +1,93 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_RESPONSEPARTITION_H_
+#define FSM_FSM_RESPONSEPARTITION_H_
+
+#include <memory>
+#include <vector>
+
+class CSRTransitionTable;
+
+/**
+ Class representing the partition of the states of an FSM into classes
+ of states which are not distinguished by a set of input traces.
+
+ Two states are distinguished by an input trace if their responses,
+ i.e. the sets of output traces produced when applying the input trace,
+ differ. This is the relation checked by FsmNode::distinguished(); as
+ there, an input that is undefined in a state leaves the state and the
+ output trace unchanged. Adding an input trace refines the partition
+ by the responses of all states to this trace, so that the states not
+ yet distinguished by a set of traces are found without comparing
+ output trees pairwise.
+
+ The responses are calculated on the read-only CSR transition table
+ of the FSM, concurrently by the given number of threads. The partition
+ does not depend on the number of threads.
+ */
+class ResponsePartition
+{
+private:
+    /** Transition relation of the FSM */
+    std::shared_ptr<const CSRTransitionTable> csr;
+
+    /** Number of threads calculating the responses */
+    unsigned numThreads;
+
+    /** Class of each state */
+    std::vector<int> classOf;
+
+    /** Next larger state of the same class, or -1 */
+    std::vector<int> nextInClass;
+
+    /** Number of classes */
+    int numClasses;
+
+    /**
+     * Calculate the responses of states first..last-1 to an input
+     * trace, each encoded as the sorted list of its output traces,
+     * every output trace preceded by its length
+     */
+    void calcResponses(const std::vector<int>& itrc,
+                       std::vector< std::vector<int> >& responses,
+                       const int first,
+                       const int last) const;
+
+public:
+    /**
+     * Create the partition for the empty set of input traces, where
+     * all states belong to the same class
+     * @param csr Transition relation of the FSM
+     * @param numThreads Number of threads calculating the responses,
+     *        or 0 to use one thread per hardware thread
+     */
+    ResponsePartition(const std::shared_ptr<const CSRTransitionTable>& csr,
+                      const unsigned numThreads);
+
+    /**
+     * Split the classes by the responses of their states to an
+     * additional input trace
+     */
+    void refine(const std::vector<int>& itrc);
+
+    /** Return the number of classes */
+    int getNumClasses() const { return numClasses; }
+
+    /**
+     * Return true if and only if states s1 and s2 are distinguished
+     * by one of the input traces added so far
+     */
+    bool distinguished(const int s1, const int s2) const {
+        return classOf[s1] != classOf[s2];
+    }
+
+    /**
+     * Return the smallest state larger than s which is not distinguished
+     * from s, or -1 if there is none
+     */
+    int nextUndistinguished(const int s) const { return nextInClass[s]; }
+};
+#endif //FSM_FSM_RESPONSEPARTITION_H_
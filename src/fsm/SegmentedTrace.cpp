@@ -40,8 +40,8 @@ vector<int> TraceSegment::getCopy() const {
     return w;
 }
 
-Trace TraceSegment::getAsTrace(std::unique_ptr<FsmPresentationLayer> &&presentationLayer) const {
-    return Trace(getCopy(), std::move(presentationLayer));
+Trace TraceSegment::getAsTrace(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer) const {
+    return Trace(getCopy(), presentationLayer);
 }
 
 size_t TraceSegment::size() const {
@@ -38,7 +38,7 @@ public:
     std::vector<int> &get() { return segment; }
     
     std::vector<int> getCopy() const;
-    Trace getAsTrace(std::unique_ptr<FsmPresentationLayer> && presentationLayer) const;
+    Trace getAsTrace(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer) const;
     
     size_t size() const;
     
@@ -0,0 +1,73 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+
+#include "fsm/SplittingTree.h"
+
+using namespace std;
+
+SplittingTree::SplittingTree(const int numStates)
+: leafOf(numStates, 0), numRounds(0), numClasses(numStates > 0 ? 1 : 0)
+{
+    nodes.push_back({ -1, 0, -1 });
+}
+
+bool SplittingTree::refine(const S2CMap& classOf)
+{
+    ++ numRounds;
+    const int numStates = static_cast<int>(leafOf.size());
+
+    // Since the new classes refine the current ones, each new class
+    // lies in exactly one leaf. Count the new classes of each leaf.
+    int numNewClasses = 0;
+    for ( int s = 0; s < numStates; s++ ) {
+        numNewClasses = max(numNewClasses, classOf[s] + 1);
+    }
+    vector<int> leafOfClass(numNewClasses, -1);
+    vector<int> classesInLeaf(nodes.size(), 0);
+    for ( int s = 0; s < numStates; s++ ) {
+        int c = classOf[s];
+        if ( leafOfClass[c] < 0 ) {
+            leafOfClass[c] = leafOf[s];
+            ++ classesInLeaf[leafOf[s]];
+        }
+    }
+
+    // Leaves containing more than one new class get one child per class
+    vector<int> nodeOfClass(numNewClasses, -1);
+    bool split = false;
+    for ( int s = 0; s < numStates; s++ ) {
+        int leaf = leafOf[s];
+        if ( classesInLeaf[leaf] <= 1 ) continue;
+
+        int c = classOf[s];
+        if ( nodeOfClass[c] < 0 ) {
+            nodes[leaf].round = numRounds;
+            nodeOfClass[c] = static_cast<int>(nodes.size());
+            nodes.push_back({ leaf, nodes[leaf].depth + 1, -1 });
+            split = true;
+        }
+        leafOf[s] = nodeOfClass[c];
+    }
+
+    numClasses = numNewClasses;
+    return split;
+}
+
+int SplittingTree::separatingRound(int s1, int s2) const
+{
+    int n1 = leafOf[s1];
+    int n2 = leafOf[s2];
+    if ( n1 == n2 ) return -1;
+
+    while ( nodes[n1].depth > nodes[n2].depth ) n1 = nodes[n1].parent;
+    while ( nodes[n2].depth > nodes[n1].depth ) n2 = nodes[n2].parent;
+    while ( n1 != n2 ) {
+        n1 = nodes[n1].parent;
+        n2 = nodes[n2].parent;
+    }
+    return nodes[n1].round;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_SPLITTINGTREE_H_
+#define FSM_FSM_SPLITTINGTREE_H_
+
+#include <vector>
+
+#include "fsm/typedef.inc"
+
+/**
+ Class recording the history of a partition refinement, such as the
+ sequence of Pk-tables of a DFSM or of OFSM tables of an observable FSM.
+
+ Each node of the tree represents a class of states. The root
+ contains all states, and the children of a node are the classes
+ it has been split into. A node also records the refinement round
+ in which it has been split, so that two states are separated by the
+ classes of round r if and only if the lowest common ancestor of their
+ leaves has been split in a round <= r.
+
+ Only one node per class and round in which it was split is stored,
+ i.e. at most 2n-1 nodes for n states, instead of one full table per
+ round. The information about which input (or input/output pair)
+ separated two states is recovered from the transition table on demand,
+ by searching for an input whose post-states have been separated in an
+ earlier round.
+ */
+class SplittingTree
+{
+private:
+    /** A node of the splitting tree */
+    struct Node {
+        /** Parent node, or -1 for the root */
+        int parent;
+        /** Distance from the root */
+        int depth;
+        /** Round in which this node has been split, or -1 */
+        int round;
+    };
+
+    /** Nodes of the tree, the root (node 0) contains all states */
+    std::vector<Node> nodes;
+
+    /** Leaf of the tree, i.e. current class, for each state */
+    std::vector<int> leafOf;
+
+    /** Number of refinement rounds recorded so far */
+    int numRounds;
+
+    /** Number of leaves */
+    int numClasses;
+
+public:
+    /**
+     * Create a tree where all states belong to the same class
+     * @param numStates Number of states
+     */
+    explicit SplittingTree(const int numStates);
+
+    /**
+     * Record the next refinement round.
+     * @param classOf Mapping from each state to its class after the
+     *        round. This partition refines the current one.
+     * @return true if and only if at least one class has been split
+     */
+    bool refine(const S2CMap& classOf);
+
+    /** Return the number of refinement rounds recorded */
+    int getNumRounds() const { return numRounds; }
+
+    /** Return the number of classes after the last round */
+    int getNumClasses() const { return numClasses; }
+
+    /**
+     * Return the round in which states s1 and s2 have been separated,
+     * in range 1..getNumRounds(), or -1 if they still belong to the
+     * same class.
+     */
+    int separatingRound(int s1, int s2) const;
+
+    /**
+     * Return true if and only if states s1 and s2 belong to different
+     * classes after the last round
+     */
+    bool distinguishable(const int s1, const int s2) const {
+        return leafOf[s1] != leafOf[s2];
+    }
+};
+#endif //FSM_FSM_SPLITTINGTREE_H_
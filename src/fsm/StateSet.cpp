@@ -0,0 +1,101 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+
+#include "fsm/StateSet.h"
+
+using namespace std;
+
+StateSet::StateSet(const int numStates)
+: numStates(numStates),
+words((numStates + 63) / 64, 0)
+{
+    
+}
+
+int StateSet::lowestBit(uint64_t w)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(w);
+#else
+    int n = 0;
+    while ( (w & 1) == 0 ) {
+        w >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+void StateSet::clear()
+{
+    fill(words.begin(), words.end(), 0);
+}
+
+bool StateSet::empty() const
+{
+    return all_of(words.begin(), words.end(), [](uint64_t w) { return w == 0; });
+}
+
+int StateSet::count() const
+{
+    int n = 0;
+    for ( uint64_t w : words ) {
+#if defined(__GNUC__) || defined(__clang__)
+        n += __builtin_popcountll(w);
+#else
+        for ( ; w != 0; w &= w - 1 ) n++;
+#endif
+    }
+    return n;
+}
+
+bool StateSet::intersects(const StateSet& other) const
+{
+    size_t len = min(words.size(), other.words.size());
+    for ( size_t w = 0; w < len; w++ ) {
+        if ( (words[w] & other.words[w]) != 0 ) return true;
+    }
+    return false;
+}
+
+StateSet& StateSet::operator|=(const StateSet& other)
+{
+    size_t len = min(words.size(), other.words.size());
+    for ( size_t w = 0; w < len; w++ ) {
+        words[w] |= other.words[w];
+    }
+    return *this;
+}
+
+StateSet& StateSet::operator&=(const StateSet& other)
+{
+    size_t len = min(words.size(), other.words.size());
+    for ( size_t w = 0; w < len; w++ ) {
+        words[w] &= other.words[w];
+    }
+    for ( size_t w = len; w < words.size(); w++ ) {
+        words[w] = 0;
+    }
+    return *this;
+}
+
+vector<int> StateSet::toVector() const
+{
+    vector<int> v;
+    forEach([&v](int s) { v.push_back(s); });
+    return v;
+}
+
+bool operator==(StateSet const & set1, StateSet const & set2)
+{
+    return set1.numStates == set2.numStates and set1.words == set2.words;
+}
+
+bool operator!=(StateSet const & set1, StateSet const & set2)
+{
+    return not (set1 == set2);
+}
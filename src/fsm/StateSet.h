@@ -0,0 +1,80 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_FSM_STATESET_H_
+#define FSM_FSM_STATESET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ Class representing a set of FSM states as a dynamic bitset.
+ State s is a member of the set if and only if bit s is set.
+
+ Set operations work on 64 states at a time, and iteration skips
+ empty words, so that sparse sets over large FSMs are traversed
+ without testing every state.
+ */
+class StateSet
+{
+private:
+    /** Number of states the set ranges over, i.e. 0..numStates-1 */
+    int numStates;
+
+    /** Bit s % 64 of words[s / 64] represents state s */
+    std::vector<uint64_t> words;
+
+    /** Index of the lowest bit set in a non-zero word */
+    static int lowestBit(uint64_t w);
+
+public:
+    /**
+     * Create an empty set ranging over states 0..numStates-1
+     */
+    explicit StateSet(const int numStates = 0);
+
+    /** Return the number of states this set ranges over */
+    int getNumStates() const { return numStates; }
+
+    void insert(const int s) { words[s >> 6] |= (uint64_t(1) << (s & 63)); }
+    void erase(const int s) { words[s >> 6] &= ~(uint64_t(1) << (s & 63)); }
+    bool contains(const int s) const { return (words[s >> 6] >> (s & 63)) & 1; }
+
+    /** Remove all states from the set, keeping its range */
+    void clear();
+
+    bool empty() const;
+
+    /** Return the number of states contained in the set */
+    int count() const;
+
+    /** Check whether this set and other have at least one common state */
+    bool intersects(const StateSet& other) const;
+
+    StateSet& operator|=(const StateSet& other);
+    StateSet& operator&=(const StateSet& other);
+
+    /**
+     * Call f(s) for every state s in the set, in ascending order
+     */
+    template<class Function>
+    void forEach(Function f) const {
+        for ( std::size_t w = 0; w < words.size(); w++ ) {
+            uint64_t bits = words[w];
+            while ( bits != 0 ) {
+                f(static_cast<int>(w * 64) + lowestBit(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    /** Return the states of the set in ascending order */
+    std::vector<int> toVector() const;
+
+    friend bool operator==(StateSet const & set1, StateSet const & set2);
+    friend bool operator!=(StateSet const & set1, StateSet const & set2);
+};
+#endif //FSM_FSM_STATESET_H_
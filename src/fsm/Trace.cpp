@@ -5,20 +5,20 @@
  */
 #include "fsm/Trace.h"
 
-Trace::Trace(std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: presentationLayer(std::move(presentationLayer))
+Trace::Trace(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: presentationLayer(presentationLayer)
 {
 
 }
 
-Trace::Trace(const std::vector<int>& trace, std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: trace(trace), presentationLayer(std::move(presentationLayer))
+Trace::Trace(const std::vector<int>& trace, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: trace(trace), presentationLayer(presentationLayer)
 {
 
 }
 
 Trace::Trace(Trace const &other)
-	: trace(other.trace), presentationLayer(other.presentationLayer->clone()) {
+	: trace(other.trace), presentationLayer(other.presentationLayer) {
 }
 
 void Trace::add(const int e) {
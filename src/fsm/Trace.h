@@ -22,13 +22,13 @@ protected:
 	/**
 	The presentation layer used by the trace
 	*/
-	std::unique_ptr<FsmPresentationLayer> presentationLayer;
+	std::shared_ptr<const FsmPresentationLayer> presentationLayer;
 public:
 	/**
 	Create an empty trace, with only one presentation layer
 	@param presentationLayer The presentation layer used by the trace
 	*/
-	Trace(std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+	Trace(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	/**
 	Create a trace
@@ -36,7 +36,7 @@ public:
 	@param presentationLayer The presentation layer used by the trace
 	*/
 	Trace(const std::vector<int>& trace,
-          std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+          const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 	
 	Trace(Trace const &other);
 	Trace(Trace &&other) = default;
@@ -72,7 +72,7 @@ public:
 	*/
 	std::vector<int>::const_iterator cend() const;
     
-    FsmPresentationLayer * getPresentationLayer() const { return presentationLayer.get(); }
+    const std::shared_ptr<const FsmPresentationLayer>& getPresentationLayer() const { return presentationLayer; }
     
     
     /**
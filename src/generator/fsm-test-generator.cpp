@@ -20,6 +20,7 @@
 
 #include "trees/IOListContainer.h"
 #include "trees/OutputTree.h"
+#include "trees/SuffixSharingTree.h"
 #include "trees/TestSuite.h"
 
 #define DBG 0
@@ -63,7 +64,7 @@ static string tcFilePrefix;
 static generation_method_t genMethod;
 static unsigned int numAddStates;
 
-static std::unique_ptr<FsmPresentationLayer> pl = nullptr;
+static std::shared_ptr<const FsmPresentationLayer> pl = nullptr;
 static shared_ptr<Dfsm> dfsm = nullptr;
 static shared_ptr<Dfsm> dfsmAbstraction = nullptr;
 static shared_ptr<Fsm> fsm = nullptr;
@@ -292,7 +293,7 @@ static void readModel(model_type_t mtp,
         case FSM_CSV:
             isDeterministic = true;
             myDfsm = make_shared<Dfsm>(thisFileName,thisFsmName);
-            pl = myDfsm->getPresentationLayer()->clone();
+            pl = myDfsm->getPresentationLayer();
             
             break;
             
@@ -307,7 +308,7 @@ static void readModel(model_type_t mtp,
             
             if ( jReader.parse(document.str(),root) ) {
                 myDfsm = make_shared<Dfsm>(root);
-                pl = myDfsm->getPresentationLayer()->clone();
+                pl = myDfsm->getPresentationLayer();
             }
             else {
                 cerr << "Could not parse JSON model - exit." << endl;
@@ -326,10 +327,10 @@ static void readModel(model_type_t mtp,
                 std::ifstream stateFile(plStateFile);
                 pl.reset(new FsmPresentationLayer(inputFile,outputFile,stateFile));
             }
-            myFsm = make_shared<Fsm>(modelFile,pl->clone(),fsmName);
+            myFsm = make_shared<Fsm>(modelFile,pl,fsmName);
             if ( myFsm->isDeterministic() ) {
                 isDeterministic = true;
-                myDfsm = make_shared<Dfsm>(modelFile,pl->clone(),fsmName);
+                myDfsm = make_shared<Dfsm>(modelFile,pl,fsmName);
                 myFsm = nullptr;
             }
             break;
@@ -350,7 +351,7 @@ static void readModelAbstraction(model_type_t mtp,
                                  string thisFileName,
                                  string thisFsmName,
                                  shared_ptr<Dfsm>& myDfsm,
-                                 FsmPresentationLayer *plRef) {
+                                 const shared_ptr<const FsmPresentationLayer>& plRef) {
     
     myDfsm = nullptr;
     
@@ -358,7 +359,7 @@ static void readModelAbstraction(model_type_t mtp,
     switch ( mtp ) {
         case FSM_CSV:
             isDeterministic = true;
-            myDfsm = make_shared<Dfsm>(thisFileName,thisFsmName,plRef->clone());
+            myDfsm = make_shared<Dfsm>(thisFileName,thisFsmName,plRef);
             break;
             
         case FSM_JSON:
@@ -371,7 +372,7 @@ static void readModelAbstraction(model_type_t mtp,
             inputFile.close();
             
             if ( jReader.parse(document.str(),root) ) {
-                myDfsm = make_shared<Dfsm>(root,plRef);
+                myDfsm = make_shared<Dfsm>(root,plRef.get());
             }
             else {
                 cerr << "Could not parse JSON model - exit." << endl;
@@ -454,7 +455,7 @@ unique_ptr<Tree> getPrefixRelationTreeWithoutTrace(const Tree* a, const Tree* b,
     IOListContainer::IOListBaseType aPrefixes = aIOlst.getIOLists();
     IOListContainer::IOListBaseType bPrefixes = bIOlst.getIOLists();
 
-    unique_ptr<Tree> tree {new Tree(pl->clone())};
+    unique_ptr<Tree> tree {new Tree(pl)};
 
     if (aPrefixes.at(0).empty() && bPrefixes.at(0).empty())
     {
@@ -515,7 +516,7 @@ static void addSHTraces(deque<pair<SegmentedTrace,SegmentedTrace>>  X,
     
     
     // Add all traces from X-pairs, extended by distinguishing traces
-    for ( const auto p : X ) {
+    for ( const auto &p : X ) {
         SegmentedTrace const tr1 = p.first;
         SegmentedTrace const tr2 = p.second;
         FsmNode *s1 = tr1.getTgtNode();
@@ -633,7 +634,7 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
     cout << "ABSMIN size = " << dfsmAbstractionMin.size() << endl;
     
     FsmNode* s0 = dfsmRefMin.getInitialState();
-    FsmPresentationLayer* pl = dfsmRefMin.getPresentationLayer();
+    shared_ptr<const FsmPresentationLayer> pl = dfsmRefMin.getPresentationLayer();
 
     shared_ptr<Tree> iTreeH = dfsmRefMin.getStateCover();
     shared_ptr<Tree> iTreeSH = dfsmRefMin.getStateCover();
@@ -648,7 +649,7 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
     IOListContainer inputEnum = IOListContainer(dfsmRefMin.getMaxInput(),
                                                 1,
                                                 numAddStates + 1,
-                                                pl->clone());
+                                                pl);
     B->add(inputEnum);
     iTreeH->unionTree(B.get());
     iTreeSH->unionTree(B.get());
@@ -661,10 +662,10 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
     // A
     for (unsigned i = 0; i < iolV.size(); i++)
     {
-        InputTrace* alpha = new InputTrace(iolV.at(i), pl->clone());
+        InputTrace* alpha = new InputTrace(iolV.at(i), pl);
         for (unsigned j = i + 1; j < iolV.size(); j++)
         {
-            InputTrace* beta = new InputTrace(iolV.at(j), pl->clone());
+            InputTrace* beta = new InputTrace(iolV.at(j), pl);
 
             unique_ptr<Tree> alphaTree = iTreeH->getSubTree(alpha);
             unique_ptr<Tree> betaTree = iTreeH->getSubTree(beta);
@@ -673,10 +674,10 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
 
             InputTrace gamma = dfsmRefMin.calcDistinguishingTrace(alpha, beta, prefixRelationTree.get());
 
-            shared_ptr<InputTrace> iAlphaGamma = make_shared<InputTrace>(alpha->get(), pl->clone());
+            shared_ptr<InputTrace> iAlphaGamma = make_shared<InputTrace>(alpha->get(), pl);
             iAlphaGamma->append(gamma.get());
 
-            shared_ptr<InputTrace> iBetaGamma = make_shared<InputTrace>(beta->get(), pl->clone());
+            shared_ptr<InputTrace> iBetaGamma = make_shared<InputTrace>(beta->get(), pl);
             iBetaGamma->append(gamma.get());
 
             iTreeH->addToRoot(iAlphaGamma->get());
@@ -699,12 +700,12 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
     {
         for (auto alpha : iolV)
         {
-            InputTrace iAlphaBeta(alpha, pl->clone());
+            InputTrace iAlphaBeta(alpha, pl);
             iAlphaBeta.append(beta);
 
             for (auto o : iolV)
             {
-                InputTrace iOmega(o, pl->clone());
+                InputTrace iOmega(o, pl);
 
                 FsmNode* s0AfterAlphaBeta = *s0->after(iAlphaBeta).begin();
                 FsmNode* s0AfterOmega = *s0->after(iOmega).begin();
@@ -719,13 +720,13 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
     {
         for (const auto &g1 : iolB)
         {
-            shared_ptr<InputTrace> iVG1 = make_shared<InputTrace>(v, pl->clone());
+            shared_ptr<InputTrace> iVG1 = make_shared<InputTrace>(v, pl);
             iVG1->append(g1);
 
             for (unsigned i = 1; i < g1.size(); ++i)
             {
                 vector<int> g2(begin(g1), begin(g1) + i);
-                shared_ptr<InputTrace> iVG2 = make_shared<InputTrace>(v, pl->clone());
+                shared_ptr<InputTrace> iVG2 = make_shared<InputTrace>(v, pl);
                 iVG2->append(g2);
 
                 FsmNode* s0AfterVG1 = *s0->after(*iVG1).begin();
@@ -738,8 +739,8 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
 
     /* h method */
     for (TracePair tracePair : tracesToCompare)  {
-        InputTrace* alpha = new InputTrace(tracePair.first, pl->clone());
-        InputTrace* beta = new InputTrace(tracePair.second, pl->clone());
+        InputTrace* alpha = new InputTrace(tracePair.first, pl);
+        InputTrace* beta = new InputTrace(tracePair.second, pl);
 
         unique_ptr<Tree> alphaTree = iTreeH->getSubTree(alpha);
         unique_ptr<Tree> betaTree = iTreeH->getSubTree(beta);
@@ -747,9 +748,9 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
 
         InputTrace gamma = dfsmRefMin.calcDistinguishingTrace(alpha, beta, prefixRelationTree.get());
 
-        shared_ptr<InputTrace> iAlphaGamma = make_shared<InputTrace>(alpha->get(), pl->clone());
+        shared_ptr<InputTrace> iAlphaGamma = make_shared<InputTrace>(alpha->get(), pl);
         iAlphaGamma->append(gamma.get());
-        shared_ptr<InputTrace> iBetaGamma = make_shared<InputTrace>(beta->get(), pl->clone());
+        shared_ptr<InputTrace> iBetaGamma = make_shared<InputTrace>(beta->get(), pl);
         iBetaGamma->append(gamma.get());
 
         iTreeH->addToRoot(iAlphaGamma->get());
@@ -770,8 +771,8 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
 
     /* safety h */
     for (TracePair tracePair : tracesToCompare)  {
-        shared_ptr<InputTrace> alpha = make_shared<InputTrace>(tracePair.first, pl->clone());
-        shared_ptr<InputTrace> beta = make_shared<InputTrace>(tracePair.second, pl->clone());
+        shared_ptr<InputTrace> alpha = make_shared<InputTrace>(tracePair.first, pl);
+        shared_ptr<InputTrace> beta = make_shared<InputTrace>(tracePair.second, pl);
 
         FsmNode* afterAlpha = *abs_s0->after(*alpha).begin();
         FsmNode* afterBeta = *abs_s0->after(*beta).begin();
@@ -828,8 +829,8 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
             TracePair tracePair = it->second;
             vector<int> gamma = tracePair2gamma[tracePair];
 
-            InputTrace* alpha = new InputTrace(tracePair.first, pl->clone());
-            InputTrace* beta = new InputTrace(tracePair.second, pl->clone());
+            InputTrace* alpha = new InputTrace(tracePair.first, pl);
+            InputTrace* beta = new InputTrace(tracePair.second, pl);
 
             unique_ptr<Tree> alphaTree = iTreeSH->getSubTree(alpha);
             unique_ptr<Tree> betaTree = iTreeSH->getSubTree(beta);
@@ -871,9 +872,9 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
 
                 // delete this test case and its partner if possible
                 auto oldGamma = tracePair2gamma[tracePair];
-                auto iAlphaGammaOld = make_shared<InputTrace>(tracePair.first, pl->clone());
+                auto iAlphaGammaOld = make_shared<InputTrace>(tracePair.first, pl);
                 iAlphaGammaOld->append(oldGamma);
-                auto iBetaGammaOld = make_shared<InputTrace>(tracePair.first, pl->clone());
+                auto iBetaGammaOld = make_shared<InputTrace>(tracePair.first, pl);
                 iBetaGammaOld->append(oldGamma);
                 TreeNode* afterAGOld = iTreeSH->getRoot()->after(iAlphaGammaOld->cbegin(), iAlphaGammaOld->cend());
                 if (afterAGOld && afterAGOld->isLeaf())
@@ -885,9 +886,9 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
                 // insert new two new test cases
                 // actual insertion is done after iteration
                 auto newGamma = pair2NewGamma[tracePair];
-                auto iAlphaGamma = make_shared<InputTrace>(tracePair.first, pl->clone());
+                auto iAlphaGamma = make_shared<InputTrace>(tracePair.first, pl);
                 iAlphaGamma->append(newGamma);
-                auto iBetaGamma =  make_shared<InputTrace>(tracePair.second, pl->clone());
+                auto iBetaGamma =  make_shared<InputTrace>(tracePair.second, pl);
                 iBetaGamma->append(newGamma);
 
                 newTestCases.emplace_back(iAlphaGamma->get(), tracePair);
@@ -931,9 +932,8 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
     for ( size_t n = 0; n < dfsmRefMin.size(); n++ ) {
         dfsmMinNodes2dfsmNodes.push_back(0);
     }
-    shared_ptr<PkTable> pDfsm = dfsm->getPktblLst().back();
     for ( size_t n = 0; n < dfsm->size(); n++ ) {
-        dfsmMinNodes2dfsmNodes[pDfsm->getClass(n)] = n;
+        dfsmMinNodes2dfsmNodes[dfsm->getMinimisedStateIdx(n)] = n;
     }
     
 #if DBG
@@ -966,10 +966,10 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
     cout << "ABSMIN size = " << dfsmAbstractionMin.size() << endl;
     
     FsmNode *s0 = dfsmRefMin.getInitialState();
-    FsmPresentationLayer *pl = dfsmRefMin.getPresentationLayer();
+    shared_ptr<const FsmPresentationLayer> pl = dfsmRefMin.getPresentationLayer();
     
     // Create an empty test suite as a tree of input traces
-    shared_ptr<Tree> testSuiteTree = make_shared<Tree>(pl->clone());
+    shared_ptr<Tree> testSuiteTree = make_shared<Tree>(pl);
     
     shared_ptr<Tree> V = dfsmRefMin.getStateCover();
     
@@ -1014,7 +1014,7 @@ static void safeHMethod(const shared_ptr<TestSuite> &testSuite) {
     IOListContainer inputEnum = IOListContainer(dfsmRefMin.getMaxInput(),
                                                 1,
                                                 numAddStates + 1,
-                                                pl->clone());
+                                                pl);
     IOListContainer::IOListBaseType inputEnumVec = inputEnum.getIOLists();
     deque< TraceSegment > inputEnumDeq;
     for ( const auto &v : inputEnumVec ) {
@@ -1158,7 +1158,7 @@ static void safeWpMethod(const shared_ptr<TestSuite> &testSuite) {
         IOListContainer inputEnum = IOListContainer(dfsm->getMaxInput(),
                                                     1,
                                                     numAddStates,
-                                                    pl->clone());
+                                                    pl);
         W22->add(inputEnum);
         W22->add(wSafe);
         W2->unionTree(W22.get());
@@ -1170,7 +1170,7 @@ static void safeWpMethod(const shared_ptr<TestSuite> &testSuite) {
     IOListContainer inputEnum2 = IOListContainer(dfsm->getMaxInput(),
                                                  (numAddStates+1),
                                                  (numAddStates+1),
-                                                 pl->clone());
+                                                 pl);
     W3->add(inputEnum2);
     
     dfsmAbstractionMin.appendStateIdentificationSets(W3.get());
@@ -1227,7 +1227,7 @@ static void safeWMethod(const shared_ptr<TestSuite> &testSuite) {
     IOListContainer inputEnum = IOListContainer(dfsm->getMaxInput(),
                                                 1,
                                                 numAddStates+1,
-                                                pl->clone());
+                                                pl);
     W22->add(inputEnum);
     
     W22->add(wSafe);
@@ -1244,43 +1244,52 @@ static void safeWMethod(const shared_ptr<TestSuite> &testSuite) {
 
 
 
+/**
+ *  Return the enumeration of the output trees of the test cases of
+ *  a test tree, executed against the reference model one at a time
+ */
+static TestSuite::OutputTreeSource executeTestTree(const shared_ptr<SuffixSharingTree> &testTree) {
+    
+    Fsm *ref = (dfsm != nullptr) ? static_cast<Fsm*>(dfsm.get()) : fsm.get();
+    
+    return [ref, testTree](const TestSuite::OutputTreeVisitor &visitor) {
+        ref->createTestSuite([&testTree](const IOListContainer::IOListVisitor &tcVisitor) {
+            testTree->forEachIOList(tcVisitor);
+        }, visitor);
+    };
+}
+
 static void generateTestSuite() {
     
     shared_ptr<TestSuite> testSuite =
     make_shared<TestSuite>();
     
+    /* The test cases of the W-, Wp- and HSI-Methods are enumerated from
+     their test trees and written to the test suite file one at a time,
+     the other methods create the complete test suite first */
+    TestSuite::OutputTreeSource testSuiteSource =
+    [&testSuite](const TestSuite::OutputTreeVisitor &visitor) {
+        testSuite->forEach(visitor);
+    };
+    
     switch ( genMethod ) {
         case WMETHOD:
             if ( dfsm != nullptr ) {
-                IOListContainer iolc = dfsm->wMethod(numAddStates);
-                for ( auto const &inVec : iolc.getIOLists() ) {
-                    shared_ptr<InputTrace> itrc = make_shared<InputTrace>(inVec,pl->clone());
-                    testSuite->push_back(dfsm->apply(*itrc));
-                }
+                Dfsm dfsmMin = dfsm->minimise();
+                testSuiteSource = executeTestTree(make_shared<SuffixSharingTree>(dfsmMin.wMethodTreeOnMinimisedDfsm(numAddStates)));
             }
             else {
-                IOListContainer iolc = fsm->wMethod(numAddStates);
-                for ( auto const &inVec : iolc.getIOLists() ) {
-                    shared_ptr<InputTrace> itrc = make_shared<InputTrace>(inVec,pl->clone());
-                    testSuite->push_back(fsm->apply(*itrc));
-                }
+                Fsm fsmMin = fsm->transformToObservableFSM().minimise();
+                testSuiteSource = executeTestTree(make_shared<SuffixSharingTree>(fsmMin.wMethodTreeOnMinimisedFsm(numAddStates)));
             }
             break;
             
         case WPMETHOD:
             if ( dfsm != nullptr ) {
-                IOListContainer iolc = dfsm->wpMethod(numAddStates);
-                for ( auto const &inVec : iolc.getIOLists() ) {
-                    shared_ptr<InputTrace> itrc = make_shared<InputTrace>(inVec,pl->clone());
-                    testSuite->push_back(dfsm->apply(*itrc));
-                }
+                testSuiteSource = executeTestTree(make_shared<SuffixSharingTree>(dfsm->wpMethodTree(numAddStates)));
             }
             else {
-                IOListContainer iolc = fsm->wpMethod(numAddStates);
-                for ( auto const &inVec : iolc.getIOLists() ) {
-                    shared_ptr<InputTrace> itrc = make_shared<InputTrace>(inVec,pl->clone());
-                    testSuite->push_back(fsm->apply(*itrc));
-                }
+                testSuiteSource = executeTestTree(make_shared<SuffixSharingTree>(fsm->wpMethodTree(numAddStates)));
             }
             break;
             
@@ -1289,27 +1298,16 @@ static void generateTestSuite() {
                 Dfsm dfsmMin = dfsm->minimise();
                 IOListContainer iolc =
                 dfsmMin.hMethodOnMinimisedDfsm(numAddStates);
-                for ( auto const &inVec : iolc.getIOLists() ) {
-                    shared_ptr<InputTrace> itrc = make_shared<InputTrace>(inVec,pl->clone());
-                    testSuite->push_back(dfsm->apply(*itrc));
-                }
+                *testSuite = dfsm->createTestSuite(iolc);
             }
             break;
             
         case HSIMETHOD:
             if ( dfsm != nullptr ) {
-                IOListContainer iolc = dfsm->hsiMethod(numAddStates);
-                for ( auto const &inVec : iolc.getIOLists() ) {
-                    shared_ptr<InputTrace> itrc = make_shared<InputTrace>(inVec,pl->clone());
-                    testSuite->push_back(dfsm->apply(*itrc));
-                }
+                testSuiteSource = executeTestTree(make_shared<SuffixSharingTree>(dfsm->hsiMethodTree(numAddStates)));
             }
             else {
-                IOListContainer iolc = fsm->hsiMethod(numAddStates);
-                for ( auto const &inVec : iolc.getIOLists() ) {
-                    shared_ptr<InputTrace> itrc = make_shared<InputTrace>(inVec,pl->clone());
-                    testSuite->push_back(fsm->apply(*itrc));
-                }
+                testSuiteSource = executeTestTree(make_shared<SuffixSharingTree>(fsm->hsiMethodTree(numAddStates)));
             }
             break;
             
@@ -1325,30 +1323,34 @@ static void generateTestSuite() {
             break;
     }
     
-    testSuite->save(testSuiteFileName);
+    size_t numTestCases = 0;
+    size_t totalLength = 0;
     
-    if ( rttMbtStyle ) {
-        int numTc = 0;
-        for ( size_t tIdx = 0; tIdx < testSuite->size(); tIdx++ ) {
+    TestSuite::save(testSuiteFileName,
+                    [&testSuiteSource, &numTestCases, &totalLength](const TestSuite::OutputTreeVisitor &visitor) {
+        testSuiteSource([&visitor, &numTestCases, &totalLength](const OutputTree &ot) {
             
-            OutputTree ot = testSuite->at(tIdx);
-            vector<IOTrace> iotrcVec = ot.toIOTrace();
+            visitor(ot);
             
-            for ( size_t iIdx = 0; iIdx < iotrcVec.size(); iIdx++ ) {
-                ostringstream tcFileName;
-                tcFileName << tcFilePrefix << tIdx << "_" << iIdx << ".log";
-                ofstream outFile(tcFileName.str());
-                outFile << iotrcVec[iIdx].toRttString();
-                outFile.close();
-                numTc++;
+            if ( rttMbtStyle ) {
+                vector<IOTrace> iotrcVec = ot.toIOTrace();
+                
+                for ( size_t iIdx = 0; iIdx < iotrcVec.size(); iIdx++ ) {
+                    ostringstream tcFileName;
+                    tcFileName << tcFilePrefix << numTestCases << "_" << iIdx << ".log";
+                    ofstream outFile(tcFileName.str());
+                    outFile << iotrcVec[iIdx].toRttString();
+                    outFile.close();
+                }
             }
             
-        }
-        
-    }
+            numTestCases++;
+            totalLength += ot.getInputTrace().size();
+        });
+    });
     
-    cout << "Number of test cases: " << testSuite->size() << endl;
-    cout << "        total length: " << testSuite->totalLength() << endl;
+    cout << "Number of test cases: " << numTestCases << endl;
+    cout << "        total length: " << totalLength << endl;
     
 }
 
@@ -1367,7 +1369,7 @@ int main(int argc, char* argv[])
             exit(1);
         }
         
-        FsmPresentationLayer *plRef = dfsm->getPresentationLayer();
+        shared_ptr<const FsmPresentationLayer> plRef = dfsm->getPresentationLayer();
         
         readModelAbstraction(modelAbstractionType,
                              modelAbstractionFile,
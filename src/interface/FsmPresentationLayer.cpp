@@ -16,13 +16,16 @@ FsmPresentationLayer::FsmPresentationLayer(const FsmPresentationLayer& pl)
     in2String = pl.in2String;
     out2String = pl.out2String;
     state2String = pl.state2String;
+    inIndex = pl.inIndex;
+    outIndex = pl.outIndex;
+    stateIndex = pl.stateIndex;
     
 }
 
 FsmPresentationLayer::FsmPresentationLayer(const std::vector<std::string>& in2String, const std::vector<std::string>& out2String, const std::vector<std::string>& state2String)
 	: in2String(in2String), out2String(out2String), state2String(state2String)
 {
-
+    rebuildIndices();
 }
 
 FsmPresentationLayer::FsmPresentationLayer(std::istream& inputs, std::istream& outputs, std::istream& states)
@@ -43,6 +46,15 @@ FsmPresentationLayer::FsmPresentationLayer(std::istream& inputs, std::istream& o
 	{
 		state2String.push_back(line);
 	}
+
+    rebuildIndices();
+}
+
+void FsmPresentationLayer::rebuildIndices()
+{
+    inIndex.rebuild(in2String);
+    outIndex.rebuild(out2String);
+    stateIndex.rebuild(state2String);
 }
 
 std::unique_ptr<FsmPresentationLayer> FsmPresentationLayer::clone() const {
@@ -52,6 +64,7 @@ std::unique_ptr<FsmPresentationLayer> FsmPresentationLayer::clone() const {
 void FsmPresentationLayer::addState2String(std::string name)
 {
     state2String.push_back(name);
+    stateIndex.add(state2String);
 }
 
 void FsmPresentationLayer::removeState2String(const int index)
@@ -59,6 +72,8 @@ void FsmPresentationLayer::removeState2String(const int index)
     if (index >= 0 && state2String.size() > static_cast<size_t>(index))
     {
         state2String.erase(state2String.begin() + index);
+        // Positions behind the removed name have changed
+        stateIndex.rebuild(state2String);
     }
 }
 
@@ -159,36 +174,45 @@ bool FsmPresentationLayer::compare(FsmPresentationLayer const *otherPresentation
 }
 
 
-boost::optional<int> FsmPresentationLayer::in2Num(const std::string& name) const {
-    
-    for ( size_t i = 0; i < in2String.size(); i++ ) {
-        if ( in2String[i] == name ) { 
-			return boost::make_optional<int>(i);
-		}
-    }
-    
-    return boost::none;
-    
+static boost::optional<int> toOptional(const int idx) {
+    if ( idx < 0 ) return boost::none;
+    return boost::optional<int>(idx);
 }
 
-boost::optional<int> FsmPresentationLayer::out2Num(const std::string& name) const {
-    
-    for ( size_t i = 0; i < out2String.size(); i++ ) {
-        if ( out2String[i] == name ) {
-			return boost::make_optional<int>(i);
-		}
-    }
-    
-    return boost::none;
+boost::optional<int> FsmPresentationLayer::in2Num(boost::string_view name) const {
+    return toOptional(inIndex.find(in2String,name));
+}
+
+boost::optional<int> FsmPresentationLayer::out2Num(boost::string_view name) const {
+    return toOptional(outIndex.find(out2String,name));
+}
+
+boost::optional<int> FsmPresentationLayer::state2Num(boost::string_view name) const {
+    return toOptional(stateIndex.find(state2String,name));
 }
 
-boost::optional<int> FsmPresentationLayer::state2Num(const std::string& name) const {
+bool FsmPresentationLayer::ioLine2Num(boost::string_view line,
+                                      std::vector<int>& inVec,
+                                      std::vector<int>& outVec) const {
     
-    for ( size_t i = 0; i < state2String.size(); i++ ) {
-        if ( state2String[i] == name ) {
-			return boost::make_optional<int>(i);
-		}
+    inVec.clear();
+    outVec.clear();
+    
+    size_t pos = 0;
+    while ( (pos = line.find('(',pos)) != boost::string_view::npos ) {
+        
+        size_t slash = line.find('/',pos + 1);
+        if ( slash == boost::string_view::npos ) return false;
+        size_t close = line.find(')',slash + 1);
+        if ( close == boost::string_view::npos ) return false;
+        
+        inVec.push_back(inIndex.find(in2String,
+                                     line.substr(pos + 1,slash - pos - 1)));
+        outVec.push_back(outIndex.find(out2String,
+                                       line.substr(slash + 1,close - slash - 1)));
+        
+        pos = close + 1;
     }
     
-    return boost::none;
+    return not inVec.empty();
 }
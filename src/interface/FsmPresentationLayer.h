@@ -11,8 +11,11 @@
 #include <string>
 #include <vector>
 #include <boost/optional/optional.hpp>
+#include <boost/utility/string_view.hpp>
 #include <memory>
 
+#include "interface/SymbolIndex.h"
+
 class FsmPresentationLayer
 {
 private:
@@ -30,6 +33,17 @@ private:
 	 * A vector containing a string for each state
 	 */
 	std::vector<std::string> state2String;
+
+    /**
+     * Hash indices for name lookups in in2String, out2String
+     * and state2String
+     */
+    SymbolIndex inIndex;
+    SymbolIndex outIndex;
+    SymbolIndex stateIndex;
+
+    /** Re-create all hash indices from the name vectors */
+    void rebuildIndices();
 public:
 	/**
 	 * Create a new presentation layer containing nothing
@@ -107,17 +121,33 @@ public:
     /**
      *  Convert input name to input number
      */
-    boost::optional<int> in2Num(const std::string& name) const;
+    boost::optional<int> in2Num(boost::string_view name) const;
     
     /**
      *  Convert output name to output number
      */
-    boost::optional<int> out2Num(const std::string& name) const;
+    boost::optional<int> out2Num(boost::string_view name) const;
     
     /**
      *  Convert state name to state number
      */
-    boost::optional<int> state2Num(const std::string& name) const;
+    boost::optional<int> state2Num(boost::string_view name) const;
+
+    /**
+     *  Convert an IO line of the form (x1/y1).(x2/y2)...(xn/yn)
+     *  to input and output numbers, as used in test suite files.
+     *  Everything outside the parentheses is ignored.
+     *  @param line   The IO line to be parsed
+     *  @param inVec  On return, the input numbers x1,...,xn. Unknown
+     *                input names are mapped to -1.
+     *  @param outVec On return, the output numbers y1,...,yn. Unknown
+     *                output names are mapped to -1.
+     *  @return false if the line is malformed or does not contain
+     *          any IO pair, true otherwise
+     */
+    bool ioLine2Num(boost::string_view line,
+                    std::vector<int>& inVec,
+                    std::vector<int>& outVec) const;
 
 	/**
 	 * Dump the current inputs into an output stream
@@ -0,0 +1,86 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include "interface/SymbolIndex.h"
+
+using namespace std;
+
+SymbolIndex::SymbolIndex() : slots(16, -1), numEntries(0)
+{
+
+}
+
+size_t SymbolIndex::hash(boost::string_view name)
+{
+    // FNV-1a
+    size_t h = 2166136261u;
+    for ( char c : name ) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void SymbolIndex::insert(const vector<string>& names, const int idx)
+{
+    size_t mask = slots.size() - 1;
+    size_t pos = hash(names[idx]) & mask;
+    while ( slots[pos] >= 0 ) {
+        pos = (pos + 1) & mask;
+    }
+    slots[pos] = idx;
+    numEntries++;
+}
+
+void SymbolIndex::grow(const vector<string>& names)
+{
+    vector<int> old;
+    old.swap(slots);
+    slots.assign(2 * old.size(), -1);
+    numEntries = 0;
+    for ( int idx : old ) {
+        if ( idx >= 0 ) insert(names, idx);
+    }
+}
+
+void SymbolIndex::rebuild(const vector<string>& names)
+{
+    size_t capacity = 16;
+    while ( capacity < 2 * names.size() ) capacity *= 2;
+    slots.assign(capacity, -1);
+    numEntries = 0;
+
+    for ( size_t i = 0; i < names.size(); i++ ) {
+        if ( find(names, names[i]) < 0 ) {
+            insert(names, static_cast<int>(i));
+        }
+    }
+}
+
+void SymbolIndex::add(const vector<string>& names)
+{
+    if ( names.empty() ) return;
+    int idx = static_cast<int>(names.size()) - 1;
+    if ( find(names, names[idx]) >= 0 ) return;
+
+    // Keep the load factor below 1/2, so that probe sequences stay short
+    if ( 2 * (numEntries + 1) > slots.size() ) grow(names);
+    insert(names, idx);
+}
+
+int SymbolIndex::find(const vector<string>& names, boost::string_view name) const
+{
+    size_t mask = slots.size() - 1;
+    size_t pos = hash(name) & mask;
+    while ( slots[pos] >= 0 ) {
+        const string& candidate = names[slots[pos]];
+        if ( name.size() == candidate.size() and
+             name.compare(boost::string_view(candidate)) == 0 ) {
+            return slots[pos];
+        }
+        pos = (pos + 1) & mask;
+    }
+    return -1;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_INTERFACE_SYMBOLINDEX_H_
+#define FSM_INTERFACE_SYMBOLINDEX_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/utility/string_view.hpp>
+
+/**
+ Hash index over a vector of symbol names, mapping each name
+ to its position in the vector.
+
+ The index does not own any strings: its open addressing table
+ only stores positions, and lookups compare against the names
+ vector passed by the caller. Therefore the index stays valid
+ when the names vector is copied or reallocated, as long as
+ the caller keeps both in sync via add() and rebuild().
+
+ Lookups are performed on boost::string_view keys, so that
+ names can be resolved directly from a parse buffer without
+ creating temporary strings.
+
+ If a name occurs several times in the vector, the index
+ refers to its first occurrence.
+ */
+class SymbolIndex
+{
+private:
+    /** Slots of the open addressing table, -1 marks an empty slot */
+    std::vector<int> slots;
+
+    /** Number of names registered in the table */
+    size_t numEntries;
+
+    static size_t hash(boost::string_view name);
+
+    /** Insert position idx without checking for duplicates */
+    void insert(const std::vector<std::string>& names, const int idx);
+
+    /** Double the table size and re-insert all registered positions */
+    void grow(const std::vector<std::string>& names);
+
+public:
+    SymbolIndex();
+
+    /**
+     * Re-create the index for all members of a names vector
+     * @param names The vector of names to be indexed
+     */
+    void rebuild(const std::vector<std::string>& names);
+
+    /**
+     * Register the last member of a names vector, after
+     * it has been appended by the caller.
+     * @param names The vector of names, including the new member
+     */
+    void add(const std::vector<std::string>& names);
+
+    /**
+     * Look up a name
+     * @param names The vector of names this index has been built for
+     * @param name  The name to be looked up
+     * @return The position of name in names, or -1 if it does not occur
+     */
+    int find(const std::vector<std::string>& names,
+             boost::string_view name) const;
+};
+
+#endif //FSM_INTERFACE_SYMBOLINDEX_H_
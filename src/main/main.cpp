@@ -4,21 +4,50 @@
  * Licensed under the EUPL V.1.1
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <fstream>
 #include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
 //#include <stdlib.h>
 #include <interface/FsmPresentationLayer.h>
+#include <interface/SymbolIndex.h>
 #include <fsm/Dfsm.h>
 #include <fsm/Fsm.h>
+#include <fsm/FsmMutant.h>
 #include <fsm/FsmNode.h>
+#include <fsm/ConformanceChecker.h>
+#include <fsm/FsmTransition.h>
+#include <fsm/CSRTransitionTable.h>
+#include <fsm/DenseDFSMTable.h>
+#include <fsm/DistinguishabilityMatrix.h>
+#include <fsm/DistinguishingOracle.h>
+#include <fsm/HopcroftPartition.h>
+#include <fsm/Int2IntMap.h>
 #include <fsm/IOTrace.h>
+#include <fsm/OFSMPartition.h>
+#include <fsm/OFSMTable.h>
+#include <fsm/OFSMTableRow.h>
+#include <fsm/PkTable.h>
 #include <fsm/FsmPrintVisitor.h>
 #include <fsm/FsmSimVisitor.h>
 #include <fsm/FsmOraVisitor.h>
+#include <sets/HittingSet.h>
 #include <trees/IOListContainer.h>
 #include <trees/OutputTree.h>
+#include <trees/SuffixSharingTree.h>
 #include <trees/TestSuite.h>
+#include <trees/TreeEdge.h>
 #include "json/json.h"
 
 
@@ -59,7 +88,7 @@ void test1() {
     inp.push_back(1);
     
     
-    InputTrace i(inp,d.getPresentationLayer()->clone());
+    InputTrace i(inp,d.getPresentationLayer());
     
     cout << "InputTrace = " << i << endl;
     
@@ -80,7 +109,7 @@ void test1() {
     
     
     inp.insert(inp.begin(),9);
-    InputTrace j(inp,d.getPresentationLayer()->clone());
+    InputTrace j(inp,d.getPresentationLayer());
     IOTrace u = d.applyDet(j);
     cout << "IOTrace u = " << u << endl;
     assert("TC-DFSM-0001",
@@ -239,7 +268,7 @@ void test4() {
         IOListContainer::IOListBaseType iols = c.getIOLists();
         
         for ( auto const &inLst : iols ) {
-            auto iTr = make_shared<InputTrace>(inLst,f->getPresentationLayer()->clone());
+            auto iTr = make_shared<InputTrace>(inLst,f->getPresentationLayer());
             f->apply(*iTr,true);
         }
         
@@ -262,7 +291,7 @@ void test4() {
                 for ( auto const &inLst : iols ) {
                     ostringstream oss;
                     oss << iCtr++;
-                    auto iTr = make_shared<InputTrace>(inLst,f->getPresentationLayer()->clone());
+                    auto iTr = make_shared<InputTrace>(inLst,f->getPresentationLayer());
                     filebuf fbot;
                     OutputTree ot = f->apply(*iTr,markAsVisited);
                     fbot.open ("FailedStateCover" + oss.str() + ".dot",
@@ -483,7 +512,7 @@ void test10() {
     << endl;
     
     shared_ptr<Dfsm> d = nullptr;
-    FsmPresentationLayer *pl;
+    shared_ptr<const FsmPresentationLayer> pl;
     Reader jReader;
     Value root;
     stringstream document;
@@ -519,7 +548,7 @@ void test10() {
             
             for ( auto const &inputs : inLst ) {
                 
-                InputTrace itr(inputs,pl->clone());
+                InputTrace itr(inputs,pl);
                 
                 OutputTree o1 = node1->apply(itr, false);
                 OutputTree o2 = node2->apply(itr, false);
@@ -554,6 +583,2012 @@ void test10() {
     
 }
 
+void test11() {
+    
+    cout << "TC-FSM-0011 Check that CSR transition tables coincide with "
+    << "the transitions of the FSM nodes" << endl;
+    
+    // Outputs and targets of the transitions of node n labelled with x,
+    // in the order of the transition list
+    auto nodeTransitions = [](FsmNode *n, const int x) {
+        vector<pair<int,int>> lst;
+        for ( auto const &tr : n->getTransitions() ) {
+            if ( tr->getLabel()->getInput() == x ) {
+                lst.emplace_back(tr->getLabel()->getOutput(), tr->getTarget()->getId());
+            }
+        }
+        return lst;
+    };
+    
+    bool sameTransitions = true;
+    bool samePostStates = true;
+    bool sameProperties = true;
+    bool sameInitialStates = true;
+    for ( int i = 0; i < 20; i++ ) {
+        shared_ptr<Fsm> f = Fsm::createRandomFsm("F",2,2,6 + i,make_shared<FsmPresentationLayer>(),i + 1);
+        auto const &nodes = f->getNodes();
+        
+        auto check = [&]() {
+            auto csr = f->getCSRTransitionTable();
+            if ( csr->size() != (int)nodes.size()
+                or csr->getInitStateIdx() != f->getInitialState()->getId() ) {
+                sameInitialStates = false;
+            }
+            bool observable = true;
+            bool completelyDefined = true;
+            for ( auto const &n : nodes ) {
+                int s = n->getId();
+                if ( csr->end(s) - csr->begin(s) != (int)n->getTransitions().size() ) {
+                    sameTransitions = false;
+                }
+                for ( int x = 0; x <= f->getMaxInput(); x++ ) {
+                    vector<pair<int,int>> expected = nodeTransitions(n.get(), x);
+                    vector<pair<int,int>> lst;
+                    auto r = csr->range(s, x);
+                    for ( int t = r.first; t < r.second; t++ ) {
+                        if ( csr->getInput(t) != x ) sameTransitions = false;
+                        lst.emplace_back(csr->getOutput(t), csr->getTarget(t));
+                    }
+                    if ( lst != expected ) sameTransitions = false;
+                    
+                    if ( expected.empty() ) completelyDefined = false;
+                    set<int> outputs;
+                    for ( auto const &p : expected ) outputs.insert(p.first);
+                    if ( outputs.size() != expected.size() ) observable = false;
+                }
+            }
+            if ( csr->isObservable() != observable
+                or csr->isCompletelyDefined() != completelyDefined ) {
+                sameProperties = false;
+            }
+            
+            // Apply every input trace up to length 3 node by node
+            IOListContainer iolc(f->getMaxInput(),1,3,f->getPresentationLayer());
+            for ( auto const &n : nodes ) {
+                for ( auto const &inLst : iolc.getIOLists() ) {
+                    set<int> reached { n->getId() };
+                    for ( int x : inLst ) {
+                        set<int> next;
+                        for ( int s : reached ) {
+                            for ( FsmNode *tgt : nodes[s]->after(x) ) next.insert(tgt->getId());
+                        }
+                        reached = next;
+                    }
+                    vector<int> expected(reached.begin(), reached.end());
+                    if ( csr->after(vector<int> { n->getId() }, inLst) != expected ) {
+                        samePostStates = false;
+                    }
+                }
+            }
+        };
+        
+        check();
+        
+        // The table is created again after the FSM has been modified
+        FsmNode *src = nodes[rand() % nodes.size()].get();
+        FsmNode *tgt = nodes[rand() % nodes.size()].get();
+        unique_ptr<FsmTransition> tr { new FsmTransition(src,tgt,FsmLabel(rand() % 3,rand() % 3)) };
+        src->addTransition(std::move(tr));
+        check();
+        nodes[nodes.size() - 1]->markAsInitial();
+        check();
+        auto &transitions = src->getTransitions();
+        transitions.front()->setTarget(nodes[0].get());
+        check();
+    }
+    
+    assert("TC-FSM-0011", sameTransitions,
+           "Every input slice of the CSR table holds the transitions of the node, in their order");
+    assert("TC-FSM-0011", samePostStates,
+           "States reached in the CSR table coincide with states reached node by node");
+    assert("TC-FSM-0011", sameProperties,
+           "Observability and completeness of the CSR table coincide with those of the nodes");
+    assert("TC-FSM-0011", sameInitialStates,
+           "The CSR table follows the number of states and the initial state of the FSM");
+}
+
+void test12() {
+    
+    cout << "TC-FSM-0012 Check that dense DFSM tables simulate "
+    << "DFSMs like their nodes" << endl;
+    
+    bool sameTransitions = true;
+    bool sameRuns = true;
+    bool samePass = true;
+    bool sameCompleteness = true;
+    for ( int i = 0; i < 20; i++ ) {
+        srand(i + 1);
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        
+        // Random DFSM where every input is undefined with probability 1/4
+        // in every state, unless the DFSM is completely specified
+        const int numStates = 5 + i;
+        const int maxInput = 2;
+        const int maxOutput = 2;
+        const bool complete = i % 4 == 0;
+        vector<unique_ptr<FsmNode>> lst;
+        for ( int n = 0; n < numStates; n++ ) {
+            lst.emplace_back(new FsmNode(n,"D"));
+        }
+        for ( int n = 0; n < numStates; n++ ) {
+            for ( int x = 0; x <= maxInput; x++ ) {
+                if ( not complete and rand() % 4 == 0 ) continue;
+                FsmNode *tgt = lst[rand() % numStates].get();
+                unique_ptr<FsmTransition> tr { new FsmTransition(lst[n].get(),tgt,FsmLabel(x,rand() % (maxOutput + 1))) };
+                lst[n]->addTransition(std::move(tr));
+            }
+        }
+        Dfsm d("D",maxInput,maxOutput,std::move(lst),pl);
+        auto dense = d.getDenseDFSMTable();
+        auto const &nodes = d.getNodes();
+        
+        // Post-state and output of node n under x, or -1
+        auto transition = [](FsmNode *n, const int x) {
+            for ( auto const &tr : n->getTransitions() ) {
+                if ( tr->getLabel()->getInput() == x ) {
+                    return make_pair(tr->getTarget()->getId(), tr->getLabel()->getOutput());
+                }
+            }
+            return make_pair(-1, -1);
+        };
+        
+        bool completelyDefined = true;
+        for ( auto const &n : nodes ) {
+            for ( int x = -1; x <= maxInput + 1; x++ ) {
+                auto p = transition(n.get(), x);
+                if ( dense->getNext(n->getId(), x) != p.first
+                    or dense->getOutput(n->getId(), x) != p.second ) {
+                    sameTransitions = false;
+                }
+                if ( x >= 0 and x <= maxInput and p.first < 0 ) completelyDefined = false;
+            }
+        }
+        if ( dense->size() != numStates or dense->getInitStateIdx() != d.getInitStateIdx()
+            or dense->isCompletelyDefined() != completelyDefined ) {
+            sameCompleteness = false;
+        }
+        
+        // Apply every input trace up to length 4 node by node
+        IOListContainer iolc(maxInput,1,4,pl);
+        vector<int> otrc;
+        for ( auto const &n : nodes ) {
+            for ( auto const &inLst : iolc.getIOLists() ) {
+                int s = n->getId();
+                vector<int> expected;
+                bool accepted = true;
+                for ( int x : inLst ) {
+                    auto p = transition(nodes[s].get(), x);
+                    if ( p.first < 0 ) {
+                        accepted = false;
+                        break;
+                    }
+                    expected.push_back(p.second);
+                    s = p.first;
+                }
+                if ( dense->apply(n->getId(), inLst, otrc) != s or otrc != expected ) {
+                    sameRuns = false;
+                }
+                if ( dense->after(n->getId(), inLst) != (accepted ? s : -1) ) {
+                    sameRuns = false;
+                }
+                
+                if ( not dense->pass(n->getId(), inLst, expected) ) samePass = false;
+                if ( not expected.empty() ) {
+                    vector<int> wrong(expected);
+                    wrong.back() = (wrong.back() + 1) % (maxOutput + 1);
+                    if ( dense->pass(n->getId(), inLst, wrong) ) samePass = false;
+                }
+            }
+        }
+    }
+    
+    assert("TC-FSM-0012", sameTransitions,
+           "Post-states and outputs of the dense table coincide with the transitions of the nodes");
+    assert("TC-FSM-0012", sameCompleteness,
+           "Size, initial state and completeness of the dense table coincide with the DFSM");
+    assert("TC-FSM-0012", sameRuns,
+           "Input traces applied to the dense table reach the states and outputs reached node by node");
+    assert("TC-FSM-0012", samePass,
+           "The dense table passes exactly the outputs produced node by node");
+}
+
+void test13() {
+    
+    cout << "TC-FSM-0013 Check that state sets behave like sets of "
+    << "states and nodes" << endl;
+    
+    bool sameSets = true;
+    for ( int numStates : { 1, 5, 63, 64, 65, 130 } ) {
+        srand(numStates);
+        StateSet s1(numStates);
+        StateSet s2(numStates);
+        set<int> e1;
+        set<int> e2;
+        for ( int k = 0; k < 3 * numStates; k++ ) {
+            int s = rand() % numStates;
+            switch ( rand() % 4 ) {
+                case 0: s1.insert(s); e1.insert(s); break;
+                case 1: s1.erase(s); e1.erase(s); break;
+                case 2: s2.insert(s); e2.insert(s); break;
+                default: s2.erase(s); e2.erase(s); break;
+            }
+            
+            vector<int> visited;
+            s1.forEach([&visited](int t) { visited.push_back(t); });
+            vector<int> expected(e1.begin(), e1.end());
+            if ( s1.toVector() != expected or visited != expected
+                or s1.count() != (int)e1.size() or s1.empty() != e1.empty()
+                or s1.contains(s) != (e1.count(s) > 0) ) {
+                sameSets = false;
+            }
+            
+            set<int> common;
+            set_intersection(e1.begin(), e1.end(), e2.begin(), e2.end(),
+                             inserter(common, common.begin()));
+            if ( s1.intersects(s2) != not common.empty()
+                or (s1 == s2) != (e1 == e2) or (s1 != s2) != (e1 != e2) ) {
+                sameSets = false;
+            }
+            
+            StateSet u(s1);
+            u |= s2;
+            StateSet n(s1);
+            n &= s2;
+            set<int> eu(e1);
+            eu.insert(e2.begin(), e2.end());
+            if ( u.toVector() != vector<int>(eu.begin(), eu.end())
+                or n.toVector() != vector<int>(common.begin(), common.end()) ) {
+                sameSets = false;
+            }
+        }
+        s1.clear();
+        if ( not s1.empty() or s1.getNumStates() != numStates ) sameSets = false;
+    }
+    
+    bool samePostStates = true;
+    for ( int i = 0; i < 10; i++ ) {
+        shared_ptr<Fsm> f = Fsm::createRandomFsm("F",2,2,10 + 10 * i,make_shared<FsmPresentationLayer>(),i + 1);
+        IOListContainer iolc(f->getMaxInput(),1,3,f->getPresentationLayer());
+        for ( auto const &n : f->getNodes() ) {
+            for ( auto const &inLst : iolc.getIOLists() ) {
+                unordered_set<FsmNode*> reached { n.get() };
+                for ( int x : inLst ) {
+                    unordered_set<FsmNode*> next;
+                    for ( FsmNode *m : reached ) {
+                        unordered_set<FsmNode*> ms = m->afterAsSet(x);
+                        next.insert(ms.begin(), ms.end());
+                    }
+                    reached = next;
+                }
+                set<int> expected;
+                for ( FsmNode *m : reached ) expected.insert(m->getId());
+                
+                vector<int> lst = n->afterAsStateSet(inLst).toVector();
+                if ( lst != vector<int>(expected.begin(), expected.end())
+                    or n->after(inLst) != reached ) {
+                    samePostStates = false;
+                }
+            }
+        }
+    }
+    
+    // Nodes outside an FSM reach no states
+    FsmNode single(0,"N");
+    bool detachedNodeEmpty = single.afterAsStateSet(vector<int> { 0 }).empty();
+    
+    assert("TC-FSM-0013", sameSets,
+           "State sets coincide with std::set under insertion, erasure and set operations");
+    assert("TC-FSM-0013", samePostStates,
+           "States reached as state sets coincide with nodes reached node by node");
+    assert("TC-FSM-0013", detachedNodeEmpty,
+           "A node outside an FSM reaches the empty state set");
+}
+
+void test14() {
+    
+    cout << "TC-FSM-0014 Check that Tree::remove() prunes the traces "
+    << "of the other tree and keeps the root" << endl;
+    
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    
+    // Leaves which also occur in the other tree are removed, together
+    // with the nodes which become leaves by this
+    Tree tree(pl);
+    tree.addToRoot(IOListContainer(IOListContainer::IOListBaseType { { 0, 1 }, { 0, 2 }, { 1 } }, pl));
+    Tree other(pl);
+    other.addToRoot(IOListContainer(IOListContainer::IOListBaseType { { 0, 1 }, { 1, 2 } }, pl));
+    tree.remove(&other);
+    bool pruned = tree.getIOLists().getIOLists() == IOListContainer::IOListBaseType { { 0, 2 } };
+    
+    // Removing a tree from itself leaves the root only
+    Tree copy(tree);
+    copy.remove(&tree);
+    bool rootKept = copy.getRoot()->isLeaf() and not copy.getRoot()->isDeleted();
+    
+    // Deleting the only leaf deletes its ancestors up to the root
+    Tree single(pl);
+    single.addToRoot(IOListContainer(IOListContainer::IOListBaseType { { 0, 1 } }, pl));
+    single.getLeaves().front()->deleteNode();
+    bool rootCleared = single.getRoot()->isLeaf();
+    
+    // The Wp-Method removes the state cover from the transition cover
+    bool wpCreated = true;
+    for ( int i = 0; i < 5; i++ ) {
+        Dfsm d("TC-FSM-0014",10 + 5 * i,2,2,pl);
+        Dfsm dMin = d.minimise();
+        if ( dMin.wpMethod(1).size() == 0 ) wpCreated = false;
+    }
+    
+    assert("TC-FSM-0014", pruned,
+           "Traces of the other tree are removed from the tree");
+    assert("TC-FSM-0014", rootKept,
+           "The root is kept when all traces are removed");
+    assert("TC-FSM-0014", rootCleared,
+           "Deleting the only leaf of a tree stops at the root");
+    assert("TC-FSM-0014", wpCreated,
+           "The Wp-Method creates test suites on minimised DFSMs");
+}
+
+void test15() {
+    
+    cout << "TC-FSM-0015 Check that packed labels behave like "
+    << "input/output pairs" << endl;
+    
+    srand(32);
+    auto randomValue = []() {
+        switch ( rand() % 4 ) {
+            case 0: return 0;
+            case 1: return FsmLabel::maxValue;
+            case 2: return rand() % 4;
+            default: return rand() % (FsmLabel::maxValue + 1);
+        }
+    };
+    
+    vector<FsmLabel> labels;
+    vector<pair<int,int>> pairs;
+    for ( int k = 0; k < 500; k++ ) {
+        int x = randomValue();
+        int y = randomValue();
+        labels.emplace_back(x, y);
+        pairs.emplace_back(x, y);
+    }
+    
+    bool sameValues = true;
+    bool sameOrder = true;
+    for ( size_t k = 0; k < labels.size(); k++ ) {
+        if ( labels[k].getInput() != pairs[k].first
+            or labels[k].getOutput() != pairs[k].second ) {
+            sameValues = false;
+        }
+        FsmLabel copy(labels[k]);
+        if ( copy != labels[k] or copy.getPackedValue() != labels[k].getPackedValue() ) {
+            sameValues = false;
+        }
+        for ( size_t m = 0; m < labels.size(); m += 7 ) {
+            if ( (labels[k] == labels[m]) != (pairs[k] == pairs[m])
+                or (labels[k] != labels[m]) != (pairs[k] != pairs[m])
+                or (labels[k] < labels[m]) != (pairs[k] < pairs[m]) ) {
+                sameOrder = false;
+            }
+        }
+    }
+    
+    // Sets of labels contain the same elements as sets of pairs
+    set<FsmLabel> labelSet(labels.begin(), labels.end());
+    unordered_set<FsmLabel> labelHashSet(labels.begin(), labels.end());
+    set<pair<int,int>> pairSet(pairs.begin(), pairs.end());
+    vector<pair<int,int>> fromLabels;
+    for ( auto const &lbl : labelSet ) fromLabels.emplace_back(lbl.getInput(), lbl.getOutput());
+    bool sameSets = fromLabels == vector<pair<int,int>>(pairSet.begin(), pairSet.end())
+        and labelHashSet.size() == pairSet.size();
+    
+    // Labels of transitions are modified in place
+    shared_ptr<Fsm> f = Fsm::createRandomFsm("F",3,3,5,make_shared<FsmPresentationLayer>(),32);
+    for ( auto const &n : f->getNodes() ) {
+        for ( auto &tr : n->getTransitions() ) {
+            int x = tr->getLabel()->getInput();
+            int y = (tr->getLabel()->getOutput() + 1) % 4;
+            tr->setLabel(FsmLabel(x, y));
+            if ( tr->getLabel()->getInput() != x or tr->getLabel()->getOutput() != y ) {
+                sameValues = false;
+            }
+        }
+    }
+    
+    assert("TC-FSM-0015", sameValues,
+           "Packed labels return the inputs and outputs they have been created with");
+    assert("TC-FSM-0015", sameOrder,
+           "Packed labels are compared like input/output pairs");
+    assert("TC-FSM-0015", sameSets,
+           "Sets and hash sets of packed labels contain the same elements as sets of pairs");
+}
+
+void test16() {
+    
+    cout << "TC-FSM-0016 Check that symbol indices find the same names "
+    << "as a linear search" << endl;
+    
+    srand(33);
+    auto randomName = []() {
+        string name;
+        int len = rand() % 4;
+        for ( int k = 0; k < len; k++ ) name += static_cast<char>('a' + rand() % 3);
+        return name;
+    };
+    
+    // Position of the first occurrence of name, or -1
+    auto linearFind = [](const vector<string>& names, const string& name) {
+        auto it = find(names.begin(), names.end(), name);
+        return it == names.end() ? -1 : static_cast<int>(it - names.begin());
+    };
+    
+    bool sameIndex = true;
+    vector<string> names;
+    SymbolIndex index;
+    for ( int k = 0; k < 200; k++ ) {
+        names.push_back(randomName());
+        index.add(names);
+        if ( k % 50 == 49 ) {
+            // The index stays valid for copies of the names
+            vector<string> copy(names);
+            names.swap(copy);
+        }
+        for ( int q = 0; q < 10; q++ ) {
+            string name = randomName();
+            if ( index.find(names, name) != linearFind(names, name) ) sameIndex = false;
+        }
+    }
+    names.erase(names.begin(), names.begin() + names.size() / 2);
+    index.rebuild(names);
+    for ( int q = 0; q < 100; q++ ) {
+        string name = randomName();
+        if ( index.find(names, name) != linearFind(names, name) ) sameIndex = false;
+    }
+    
+    // Lookups of the presentation layer
+    vector<string> in2String { "a", "b", "ab", "a" };
+    vector<string> out2String { "x", "", "yy" };
+    FsmPresentationLayer pl(in2String, out2String, vector<string> { "s0", "s1" });
+    bool sameLookup = true;
+    for ( int k = 0; k < 20; k++ ) {
+        if ( rand() % 2 == 0 ) {
+            pl.addState2String("s" + to_string(rand() % 10));
+        }
+        else {
+            pl.removeState2String(rand() % (pl.getState2String().size() + 1));
+        }
+        for ( int q = 0; q < 10; q++ ) {
+            string name = "s" + to_string(rand() % 10);
+            boost::optional<int> idx = pl.state2Num(name);
+            if ( (idx ? *idx : -1) != linearFind(pl.getState2String(), name) ) sameLookup = false;
+        }
+    }
+    for ( const string name : { "a", "b", "ab", "ba", "", "x", "yy" } ) {
+        boost::optional<int> in = pl.in2Num(name);
+        boost::optional<int> out = pl.out2Num(name);
+        if ( (in ? *in : -1) != linearFind(in2String, name)
+            or (out ? *out : -1) != linearFind(out2String, name) ) {
+            sameLookup = false;
+        }
+    }
+    vector<int> inVec;
+    vector<int> outVec;
+    if ( not pl.ioLine2Num("(a/x).(ab/yy).(c/x).(b/)", inVec, outVec)
+        or inVec != vector<int> { 0, 2, -1, 1 } or outVec != vector<int> { 0, 2, 0, 1 }
+        or pl.ioLine2Num("(a/x).(b", inVec, outVec) ) {
+        sameLookup = false;
+    }
+    
+    assert("TC-FSM-0016", sameIndex,
+           "Symbol indices return the first occurrence of every name, as a linear search");
+    assert("TC-FSM-0016", sameLookup,
+           "Names of inputs, outputs and states are resolved as by a linear search");
+}
+
+
+void test17() {
+    
+    cout << "TC-FSM-0017 Show that mutant overlays behave like the "
+    << "mutants created by createMutant()" << endl;
+    
+    shared_ptr<Fsm> f = Fsm::createRandomFsm("F",3,3,10,make_shared<FsmPresentationLayer>(),11);
+    shared_ptr<const FsmPresentationLayer> pl = f->getPresentationLayer();
+    
+    FsmMutant mutant = f->createMutantOverlay("F_M",2,2);
+    unique_ptr<Fsm> fMutant = mutant.toFsm();
+    
+    assert("TC-FSM-0017",
+           mutant.getNumFaults() > 0 and mutant.getNumFaults() <= 4,
+           "Mutant overlay stores only the modified transitions");
+    
+    IOListContainer iolc(f->getMaxInput(),1,3,pl);
+    
+    bool sameOutputs = true;
+    bool samePostStates = true;
+    bool passOwnOutputs = true;
+    for ( auto const &inLst : iolc.getIOLists() ) {
+        
+        InputTrace itr(inLst,pl);
+        
+        OutputTree o1 = mutant.apply(itr);
+        OutputTree o2 = fMutant->apply(itr);
+        vector<OutputTrace> ot1 = o1.getOutputTraces();
+        vector<OutputTrace> ot2 = o2.getOutputTraces();
+        sort(ot1.begin(),ot1.end());
+        sort(ot2.begin(),ot2.end());
+        if ( ot1 != ot2 ) sameOutputs = false;
+        
+        StateSet s1 = mutant.after(f->getInitStateIdx(),inLst);
+        StateSet s2(static_cast<int>(fMutant->size()));
+        for ( auto n : fMutant->getInitialState()->after(inLst) ) {
+            s2.insert(n->getId());
+        }
+        if ( s1 != s2 ) samePostStates = false;
+        
+        for ( auto const &io : o2.toIOTrace() ) {
+            if ( not mutant.pass(io) ) passOwnOutputs = false;
+        }
+    }
+    
+    assert("TC-FSM-0017", sameOutputs,
+           "Mutant overlay and stand-alone mutant produce the same output trees");
+    assert("TC-FSM-0017", samePostStates,
+           "Mutant overlay and stand-alone mutant reach the same states");
+    assert("TC-FSM-0017", passOwnOutputs,
+           "Mutant overlay passes every IO trace of the stand-alone mutant");
+    
+    shared_ptr<Dfsm> gdc =
+    make_shared<Dfsm>("../../resources/garage-door-controller.csv","GDC");
+    FsmMutant gdcMutant = gdc->createMutantOverlay("GDC_M",1,1);
+    Dfsm gdcMutantDfsm(*gdcMutant.toFsm());
+    
+    IOListContainer gdcTraces(gdc->getMaxInput(),1,4,gdc->getPresentationLayer());
+    bool sameIOTraces = true;
+    for ( auto const &inLst : gdcTraces.getIOLists() ) {
+        InputTrace itr(inLst,gdc->getPresentationLayer());
+        IOTrace io1 = gdcMutant.applyDet(itr);
+        IOTrace io2 = gdcMutantDfsm.applyDet(itr);
+        if ( not (io1 == io2) or
+             gdcMutant.pass(gdc->applyDet(itr)) != gdcMutantDfsm.pass(gdc->applyDet(itr)) ) {
+            sameIOTraces = false;
+        }
+    }
+    
+    assert("TC-FSM-0017", sameIOTraces,
+           "applyDet() and pass() on a DFSM mutant overlay agree with the stand-alone mutant");
+}
+
+void test18() {
+    
+    cout << "TC-FSM-0018 Check that Int2IntMap behaves like a map "
+    << "initialised with -1" << endl;
+    
+    srand(34);
+    bool sameMaps = true;
+    for ( int maxKey : { 0, 1, 7, 100 } ) {
+        Int2IntMap m1(maxKey);
+        Int2IntMap m2(maxKey);
+        map<int,int> e1;
+        map<int,int> e2;
+        for ( int k = 0; k <= maxKey; k++ ) {
+            e1[k] = -1;
+            e2[k] = -1;
+        }
+        for ( int q = 0; q < 5 * (maxKey + 1); q++ ) {
+            int k = rand() % (maxKey + 1);
+            int v = rand() % 5 - 1;
+            if ( rand() % 2 == 0 ) {
+                m1[k] = v;
+                e1[k] = v;
+            }
+            else {
+                m2.at(k) = v;
+                e2.at(k) = v;
+            }
+            if ( m1.size() != e1.size() or (m1 == m2) != (e1 == e2) or (m1 != m2) != (e1 != e2) ) {
+                sameMaps = false;
+            }
+            Int2IntMap const &c1 = m1;
+            for ( auto const &p : e1 ) {
+                if ( c1[p.first] != p.second or c1.at(p.first) != p.second ) sameMaps = false;
+            }
+        }
+        
+        // Keys outside the map are rejected, as by std::map::at()
+        for ( int k : { -1, maxKey + 1 } ) {
+            bool thrown = false;
+            try {
+                m1.at(k);
+            }
+            catch ( std::out_of_range& ) {
+                thrown = true;
+            }
+            if ( not thrown ) sameMaps = false;
+        }
+    }
+    
+    // Rows of Pk-tables map every input to the output and the
+    // post-state of the transition of their state
+    bool sameRows = true;
+    for ( int i = 0; i < 5; i++ ) {
+        Dfsm d("D",10 + 5 * i,2,2,make_shared<FsmPresentationLayer>());
+        d.calcPkTables();
+        shared_ptr<PkTable> pk = d.getPkTable();
+        for ( auto const &n : d.getNodes() ) {
+            map<int,int> io;
+            map<int,int> i2p;
+            for ( int x = 0; x <= d.getMaxInput(); x++ ) {
+                io[x] = -1;
+                i2p[x] = -1;
+            }
+            for ( auto const &tr : n->getTransitions() ) {
+                io[tr->getLabel()->getInput()] = tr->getLabel()->getOutput();
+                i2p[tr->getLabel()->getInput()] = tr->getTarget()->getId();
+            }
+            auto row = pk->getRow(n->getId());
+            for ( int x = 0; x <= d.getMaxInput(); x++ ) {
+                if ( row->getIOMap().at(x) != io[x] or row->getI2PMap().at(x) != i2p[x]
+                    or row->get(x) != i2p[x] ) {
+                    sameRows = false;
+                }
+            }
+        }
+    }
+    
+    assert("TC-FSM-0018", sameMaps,
+           "Int2IntMap coincides with std::map under assignment, lookup and comparison");
+    assert("TC-FSM-0018", sameRows,
+           "Pk-table rows map inputs to the outputs and post-states of the transitions");
+}
+
+void test19() {
+    
+    cout << "TC-FSM-0019 Show that the vectorised OFSM table row "
+    << "comparisons agree with element-wise comparisons" << endl;
+    
+    srand(12);
+    bool kernelsOk = true;
+    for ( int n = 0; n < 40; n++ ) {
+        for ( int rep = 0; rep < 20; rep++ ) {
+            vector<int> a(n), b(n);
+            for ( int k = 0; k < n; k++ ) {
+                a[k] = rand() % 3 - 1;
+                b[k] = (rand() % 4 == 0) ? rand() % 3 - 1 : a[k];
+            }
+            bool eq = true;
+            bool eqSigns = true;
+            for ( int k = 0; k < n; k++ ) {
+                if ( a[k] != b[k] ) eq = false;
+                if ( (a[k] < 0) != (b[k] < 0) ) eqSigns = false;
+            }
+            if ( OFSMTableRow::equal(a.data(),b.data(),n) != eq or
+                 OFSMTableRow::equalSigns(a.data(),b.data(),n) != eqSigns ) {
+                kernelsOk = false;
+            }
+        }
+    }
+    assert("TC-FSM-0019", kernelsOk,
+           "equal() and equalSigns() agree with element-wise comparison");
+    
+    bool sameSize = true;
+    for ( int i = 0; i < 5; i++ ) {
+        Dfsm d("D",50,3,3,make_shared<FsmPresentationLayer>());
+        // minimise() removes the unreachable states of d first
+        Dfsm dMin = d.minimise();
+        Fsm fMin = d.minimiseObservableFSM();
+        if ( fMin.size() != dMin.size() ) sameSize = false;
+    }
+    assert("TC-FSM-0019", sameSize,
+           "Minimisation by OFSM tables and by Pk-tables yields the same number of states");
+}
+
+void test20() {
+    
+    cout << "TC-FSM-0020 Show that Hopcroft's algorithm and the Pk-tables "
+    << "yield the same equivalence classes" << endl;
+    
+    bool sameClasses = true;
+    bool tracesDistinguish = true;
+    for ( int i = 0; i < 5; i++ ) {
+        Dfsm d("D",60,2,1,make_shared<FsmPresentationLayer>());
+        vector<unique_ptr<FsmNode>> uNodes;
+        d.removeUnreachableNodes(uNodes);
+        
+        d.calcPartition();
+        d.calcPkTables();
+        shared_ptr<PkTable> pk = d.getPkTable();
+        HopcroftPartition hp(d.getDenseDFSMTable());
+        auto dense = d.getDenseDFSMTable();
+        
+        for ( int n = 0; n < (int)d.size(); n++ ) {
+            for ( int m = n+1; m < (int)d.size(); m++ ) {
+                bool pkEquivalent = pk->getClass(n) == pk->getClass(m);
+                if ( pkEquivalent != (hp.getClass(n) == hp.getClass(m)) ) {
+                    sameClasses = false;
+                }
+                if ( pkEquivalent ) continue;
+                
+                vector<int> trc = hp.calcDistinguishingTrace(n,m);
+                vector<int> o1, o2;
+                dense->apply(n,trc,o1);
+                dense->apply(m,trc,o2);
+                if ( o1 == o2 ) tracesDistinguish = false;
+            }
+        }
+    }
+    
+    assert("TC-FSM-0020", sameClasses,
+           "Two states are equivalent according to Hopcroft's algorithm iff they are equivalent according to the Pk-tables");
+    assert("TC-FSM-0020", tracesDistinguish,
+           "Traces derived from the split history distinguish inequivalent states");
+}
+
+void test21() {
+    
+    cout << "TC-FSM-0021 Show that signature refinement and the sequence "
+    << "of OFSM tables yield the same equivalence classes" << endl;
+    
+    bool sameClasses = true;
+    bool sameSize = true;
+    for ( unsigned int i = 1; i <= 5; i++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        Fsm f = Fsm::createRandomFsm("F",1,1,20,pl,i)->transformToObservableFSM();
+        
+        shared_ptr<OFSMTable> tbl =
+        make_shared<OFSMTable>(f.getNodes(),f.getMaxInput(),f.getMaxOutput(),pl.get());
+        shared_ptr<OFSMTable> last;
+        while ( tbl != nullptr ) {
+            last = tbl;
+            tbl = tbl->next();
+        }
+        
+        OFSMPartition partition(*last);
+        const S2CMap& s2c = last->getS2C();
+        for ( int n = 0; n < last->size(); n++ ) {
+            for ( int m = n+1; m < last->size(); m++ ) {
+                if ( (s2c[n] == s2c[m]) !=
+                     (partition.getS2C()[n] == partition.getS2C()[m]) ) {
+                    sameClasses = false;
+                }
+            }
+        }
+        
+        if ( (int)f.minimiseObservableFSM().size() != last->maxClassId() + 1 ) {
+            sameSize = false;
+        }
+    }
+    
+    assert("TC-FSM-0021", sameClasses,
+           "Two states are in the same class after signature refinement iff they are in the same class of the last OFSM table");
+    assert("TC-FSM-0021", sameSize,
+           "minimiseObservableFSM() creates one state per class of the last OFSM table");
+}
+
+void test22() {
+    
+    cout << "TC-FSM-0022 Show that the distinguishing traces derived from "
+    << "the Pk-table splitting tree are shortest distinguishing traces" << endl;
+    
+    bool tracesDistinguish = true;
+    bool tracesShortest = true;
+    for ( int i = 0; i < 5; i++ ) {
+        Dfsm d = Dfsm("D",40,2,1,make_shared<FsmPresentationLayer>()).minimise();
+        auto dense = d.getDenseDFSMTable();
+        const int n = (int)d.size();
+        
+        // Length of the shortest distinguishing traces, by the
+        // classical k-equivalence iteration
+        vector< vector<int> > shortest(n, vector<int>(n, -1));
+        vector< vector<bool> > eq(n, vector<bool>(n, true));
+        for ( int k = 1; k <= n; k++ ) {
+            vector< vector<bool> > eqNext(eq);
+            for ( int s1 = 0; s1 < n; s1++ ) {
+                for ( int s2 = 0; s2 < n; s2++ ) {
+                    if ( not eq[s1][s2] ) continue;
+                    for ( int x = 0; x <= d.getMaxInput(); x++ ) {
+                        if ( dense->getOutput(s1,x) != dense->getOutput(s2,x) or
+                             not eq[dense->getNext(s1,x)][dense->getNext(s2,x)] ) {
+                            eqNext[s1][s2] = false;
+                            shortest[s1][s2] = k;
+                            break;
+                        }
+                    }
+                }
+            }
+            eq = eqNext;
+        }
+        
+        d.calculateDistMatrix();
+        for ( int s1 = 0; s1 < n; s1++ ) {
+            for ( int s2 = s1+1; s2 < n; s2++ ) {
+                vector< vector<int> > traces =
+                d.getDistTraces(*d.getNodes()[s1],*d.getNodes()[s2]);
+                if ( traces.empty() ) tracesDistinguish = false;
+                for ( auto& trc : traces ) {
+                    vector<int> o1, o2;
+                    dense->apply(s1,trc,o1);
+                    dense->apply(s2,trc,o2);
+                    if ( o1 == o2 ) tracesDistinguish = false;
+                    if ( (int)trc.size() != shortest[s1][s2] ) tracesShortest = false;
+                }
+            }
+        }
+    }
+    
+    assert("TC-FSM-0022", tracesDistinguish,
+           "Every pair of states of a minimal DFSM is distinguished by its distinguishing traces");
+    assert("TC-FSM-0022", tracesShortest,
+           "The distinguishing traces are shortest distinguishing traces");
+}
+
+void test23() {
+    
+    cout << "TC-FSM-0023 Show that the distinguishing oracle yields the "
+    << "same distinguishing traces as the Pk-tables" << endl;
+    
+    bool sameTraces = true;
+    bool sameDistTraces = true;
+    bool sameCharSet = true;
+    bool capRespected = true;
+    for ( int i = 0; i < 5; i++ ) {
+        Dfsm d("D",40,2,1,make_shared<FsmPresentationLayer>());
+        Dfsm withOracle = d.minimise();
+        Dfsm withPk = d.minimise();
+        withPk.calcDistinguishingOracle(0);
+        withPk.calcPkTables();
+        
+        auto oracle = DistinguishingOracle::create(withOracle.getDenseDFSMTable());
+        if ( DistinguishingOracle::create(withPk.getDenseDFSMTable(), 0) != nullptr ) {
+            capRespected = false;
+        }
+        
+        withOracle.calculateDistMatrix();
+        withPk.calculateDistMatrix();
+        
+        const int n = (int)withOracle.size();
+        for ( int s1 = 0; s1 < n; s1++ ) {
+            for ( int s2 = s1+1; s2 < n; s2++ ) {
+                FsmNode* q1 = withPk.getNodes()[s1].get();
+                FsmNode* q2 = withPk.getNodes()[s2].get();
+                
+                InputTrace pkTrc =
+                q1->calcDistinguishingTrace(q2,*withPk.getPkSplittingTree(),withPk.getMaxInput());
+                if ( pkTrc.get() != oracle->calcDistinguishingTrace(s1,s2) ) {
+                    sameTraces = false;
+                }
+                
+                if ( withPk.getDistTraces(*q1,*q2) !=
+                     withOracle.getDistTraces(*withOracle.getNodes()[s1],
+                                              *withOracle.getNodes()[s2]) ) {
+                    sameDistTraces = false;
+                }
+            }
+        }
+        
+        if ( withOracle.getCharacterisationSet().getIOLists() !=
+             withPk.getCharacterisationSet().getIOLists() ) {
+            sameCharSet = false;
+        }
+    }
+    
+    assert("TC-FSM-0023", sameTraces,
+           "Oracle and Pk-tables yield the same distinguishing trace for each pair of states");
+    assert("TC-FSM-0023", sameDistTraces,
+           "Oracle and Pk-tables yield the same sets of shortest distinguishing traces");
+    assert("TC-FSM-0023", sameCharSet,
+           "Oracle and Pk-tables yield the same characterisation set");
+    assert("TC-FSM-0023", capRespected,
+           "No oracle is created if it exceeds the memory cap");
+}
+
+
+void test24() {
+    
+    cout << "TC-FSM-0024 Check that the observable FSM created by "
+    << "hashed subset construction is equivalent to the original FSM" << endl;
+    
+    bool observable = true;
+    bool sameOutputs = true;
+    bool distinctStates = true;
+    bool deterministic = true;
+    for ( int i = 0; i < 20; i++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        shared_ptr<Fsm> f = Fsm::createRandomFsm("F",2,2,12,pl,i);
+        Fsm fObs = f->transformToObservableFSM();
+        Fsm fObs2 = f->transformToObservableFSM();
+        
+        if ( not fObs.isObservable() ) observable = false;
+        
+        // Each state of the observable FSM comprises a different set
+        // of states of the original FSM
+        unordered_set<string> names;
+        for ( auto const &n : fObs.getNodes() ) {
+            if ( not names.insert(n->getName()).second ) distinctStates = false;
+        }
+        
+        if ( fObs.size() != fObs2.size() ) {
+            deterministic = false;
+        }
+        else {
+            for ( size_t n = 0; n < fObs.size(); n++ ) {
+                if ( fObs.getNodes()[n]->getName() != fObs2.getNodes()[n]->getName() ) {
+                    deterministic = false;
+                }
+            }
+        }
+        
+        // Compare the complete output traces of both FSMs for all
+        // input traces of length 1..4
+        auto outputs = [](Fsm& m, const InputTrace& itrc) {
+            set<vector<int>> result;
+            for ( auto const &otrc : m.apply(itrc).getOutputTraces() ) {
+                if ( otrc.size() == itrc.size() ) result.insert(otrc.get());
+            }
+            return result;
+        };
+        for ( int len = 1; len <= 4; len++ ) {
+            vector<int> inputs(len, 0);
+            bool done = false;
+            while ( not done ) {
+                InputTrace itrc(inputs,pl);
+                if ( outputs(*f,itrc) != outputs(fObs,itrc) ) sameOutputs = false;
+                
+                int k = len - 1;
+                while ( k >= 0 and inputs[k] == f->getMaxInput() ) inputs[k--] = 0;
+                if ( k < 0 ) done = true;
+                else ++inputs[k];
+            }
+        }
+    }
+    
+    assert("TC-FSM-0024", observable,
+           "The transformed FSM is observable");
+    assert("TC-FSM-0024", sameOutputs,
+           "The transformed FSM produces the same outputs as the original FSM");
+    assert("TC-FSM-0024", distinctStates,
+           "Each state of the transformed FSM comprises a different set of states");
+    assert("TC-FSM-0024", deterministic,
+           "The transformation creates the same states in the same order on each run");
+}
+
+
+void test25() {
+    
+    cout << "TC-FSM-0025 Check that the intersection of two FSMs "
+    << "accepts exactly the common I/O traces" << endl;
+    
+    bool sameOutputs = true;
+    bool silent = true;
+    bool reachable = true;
+    for ( int i = 0; i < 20; i++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        shared_ptr<Fsm> f1 = Fsm::createRandomFsm("F",2,2,8,pl,i+1);
+        shared_ptr<Fsm> f2 = Fsm::createRandomFsm("G",2,2,8,pl,i+101);
+        
+        // The intersection must not write to the console
+        ostringstream captured;
+        streambuf* coutBuf = cout.rdbuf(captured.rdbuf());
+        Fsm p = f1->intersect(*f2);
+        cout.rdbuf(coutBuf);
+        if ( not captured.str().empty() ) silent = false;
+        
+        // Every state of the intersection is reachable
+        unordered_set<FsmNode*> reached { p.getInitialState() };
+        vector<FsmNode*> bfs { p.getInitialState() };
+        for ( size_t k = 0; k < bfs.size(); k++ ) {
+            for ( auto const &tr : bfs[k]->getTransitions() ) {
+                if ( reached.insert(tr->getTarget()).second ) bfs.push_back(tr->getTarget());
+            }
+        }
+        if ( reached.size() != p.size() ) reachable = false;
+        
+        // The complete output traces of the intersection are those
+        // produced by both FSMs, for all input traces of length 1..4
+        auto outputs = [](Fsm& m, const InputTrace& itrc) {
+            set<vector<int>> result;
+            for ( auto const &otrc : m.apply(itrc).getOutputTraces() ) {
+                if ( otrc.size() == itrc.size() ) result.insert(otrc.get());
+            }
+            return result;
+        };
+        for ( int len = 1; len <= 4; len++ ) {
+            vector<int> inputs(len, 0);
+            bool done = false;
+            while ( not done ) {
+                InputTrace itrc(inputs,pl);
+                set<vector<int>> o1 = outputs(*f1,itrc);
+                set<vector<int>> o2 = outputs(*f2,itrc);
+                set<vector<int>> common;
+                set_intersection(o1.begin(), o1.end(), o2.begin(), o2.end(),
+                                 inserter(common, common.begin()));
+                if ( outputs(p,itrc) != common ) sameOutputs = false;
+                
+                int k = len - 1;
+                while ( k >= 0 and inputs[k] == f1->getMaxInput() ) inputs[k--] = 0;
+                if ( k < 0 ) done = true;
+                else ++inputs[k];
+            }
+        }
+    }
+    
+    assert("TC-FSM-0025", sameOutputs,
+           "The intersection produces exactly the outputs common to both FSMs");
+    assert("TC-FSM-0025", reachable,
+           "The intersection contains only reachable states");
+    assert("TC-FSM-0025", silent,
+           "The intersection does not write to the console");
+}
+
+
+void test26() {
+    
+    cout << "TC-FSM-0026 Check that the conformance checker finds "
+    << "shortest counterexamples for equivalence and reduction" << endl;
+    
+    bool equivalenceCorrect = true;
+    bool reductionCorrect = true;
+    bool shortest = true;
+    bool validCounterexample = true;
+    for ( int i = 0; i < 40; i++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        shared_ptr<Fsm> ref = Fsm::createRandomFsm("R",1,1,4 + i % 8,pl,i+1);
+        shared_ptr<Fsm> impl;
+        switch ( i % 4 ) {
+            case 0:
+                impl = Fsm::createRandomFsm("I",1,1,4 + i % 8,pl,i+201);
+                break;
+            case 1:
+                impl = ref->createMutant("I",1,1);
+                break;
+            case 2:
+                impl = make_shared<Fsm>(ref->transformToObservableFSM());
+                break;
+            default: {
+                // Deterministic restriction of ref: keep only the
+                // first transition for each state and input
+                vector<unique_ptr<FsmNode>> lst;
+                for ( auto const &n : ref->getNodes() ) {
+                    lst.emplace_back(new FsmNode(n->getId(), n->getName()));
+                }
+                for ( auto const &n : ref->getNodes() ) {
+                    set<int> inputs;
+                    for ( auto const &tr : n->getTransitions() ) {
+                        if ( not inputs.insert(tr->getLabel()->getInput()).second ) continue;
+                        unique_ptr<FsmTransition> t { new FsmTransition(lst[n->getId()].get(),
+                            lst[tr->getTarget()->getId()].get(), *tr->getLabel()) };
+                        lst[n->getId()]->addTransition(std::move(t));
+                    }
+                }
+                impl = make_shared<Fsm>("I",ref->getMaxInput(),ref->getMaxOutput(),std::move(lst),pl);
+                break;
+            }
+        }
+        
+        // Determine by exhaustive comparison of the output traces of
+        // all input traces of length 1..6 the shortest length of a
+        // trace violating equivalence and reduction, or 0
+        auto outputs = [](Fsm& m, const InputTrace& itrc) {
+            set<vector<int>> result;
+            for ( auto const &otrc : m.apply(itrc).getOutputTraces() ) {
+                if ( otrc.size() == itrc.size() ) result.insert(otrc.get());
+            }
+            return result;
+        };
+        size_t firstNonEquivalent = 0;
+        size_t firstNonReduction = 0;
+        for ( int len = 1; len <= 6; len++ ) {
+            vector<int> inputs(len, 0);
+            bool done = false;
+            while ( not done ) {
+                InputTrace itrc(inputs,pl);
+                set<vector<int>> oImpl = outputs(*impl,itrc);
+                set<vector<int>> oRef = outputs(*ref,itrc);
+                if ( firstNonEquivalent == 0 and oImpl != oRef ) {
+                    firstNonEquivalent = len;
+                }
+                if ( firstNonReduction == 0 and
+                    not includes(oRef.begin(), oRef.end(), oImpl.begin(), oImpl.end()) ) {
+                    firstNonReduction = len;
+                }
+                
+                int k = len - 1;
+                while ( k >= 0 and inputs[k] == ref->getMaxInput() ) inputs[k--] = 0;
+                if ( k < 0 ) done = true;
+                else ++inputs[k];
+            }
+        }
+        
+        ConformanceChecker checker(*impl,*ref);
+        for ( int reduction = 0; reduction <= 1; reduction++ ) {
+            bool pass = reduction ? checker.isReduction() : checker.isEquivalent();
+            size_t expected = reduction ? firstNonReduction : firstNonEquivalent;
+            shared_ptr<IOTrace> cex = checker.getCounterexample();
+            
+            // Violations longer than 6 are not detected exhaustively
+            if ( (expected > 0 and pass) or (not pass and cex == nullptr) or
+                 (pass and cex != nullptr) ) {
+                if ( reduction ) reductionCorrect = false;
+                else equivalenceCorrect = false;
+                continue;
+            }
+            if ( pass ) continue;
+            
+            if ( expected > 0 and cex->getInputTrace().size() != expected ) {
+                shortest = false;
+            }
+            
+            // The counterexample is a trace of exactly one of the FSMs,
+            // or of the implementation only for reductions
+            InputTrace itrc = cex->getInputTrace();
+            vector<int> otrc = cex->getOutputTrace().get();
+            set<vector<int>> oImpl = outputs(*impl,itrc);
+            set<vector<int>> oRef = outputs(*ref,itrc);
+            bool inImpl = oImpl.count(otrc) > 0;
+            bool inRef = oRef.count(otrc) > 0;
+            if ( reduction ? not (inImpl and not inRef) : inImpl == inRef ) {
+                validCounterexample = false;
+            }
+        }
+        
+        // Every FSM is equivalent to and a reduction of itself
+        ConformanceChecker self(*ref,*ref);
+        if ( not self.isEquivalent() or not self.isReduction() ) {
+            equivalenceCorrect = false;
+        }
+    }
+    
+    // An FSM read from an empty file has no initial state and only
+    // produces the empty trace
+    {
+        ofstream emptyFile("empty.fsm");
+    }
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    Fsm empty("empty.fsm",pl,"E");
+    remove("empty.fsm");
+    shared_ptr<Fsm> f = Fsm::createRandomFsm("F",1,1,4,pl,1);
+    ConformanceChecker emptyImpl(empty,*f);
+    ConformanceChecker emptyRef(*f,empty);
+    ConformanceChecker emptyBoth(empty,empty);
+    bool noInitialState = emptyImpl.isReduction() and emptyBoth.isEquivalent()
+        and emptyBoth.isReduction() and not emptyImpl.isEquivalent()
+        and emptyImpl.getCounterexample()->getInputTrace().size() == 1
+        and not emptyRef.isReduction()
+        and emptyRef.getCounterexample()->getInputTrace().size() == 1;
+    
+    assert("TC-FSM-0026", equivalenceCorrect,
+           "Equivalence check agrees with exhaustive comparison of output traces");
+    assert("TC-FSM-0026", reductionCorrect,
+           "Reduction check agrees with exhaustive comparison of output traces");
+    assert("TC-FSM-0026", shortest,
+           "Counterexamples are shortest violating traces");
+    assert("TC-FSM-0026", validCounterexample,
+           "Counterexamples violate the checked relation");
+    assert("TC-FSM-0026", noInitialState,
+           "FSMs without initial state only produce the empty trace");
+}
+
+void test27() {
+    
+    cout << "TC-FSM-0027 Check that characterisation sets distinguish all "
+    << "states and do not depend on the number of threads" << endl;
+    
+    bool sameW = true;
+    bool charSet = true;
+    
+    // Calculate the characterisation set of a copy of f, using the
+    // given number of threads
+    auto calcW = [](const Fsm& f, const unsigned numThreads) {
+        Fsm copy(f);
+        copy.setNumThreads(numThreads);
+        ostringstream captured;
+        streambuf* coutBuf = cout.rdbuf(captured.rdbuf());
+        IOListContainer w = copy.getCharacterisationSet();
+        cout.rdbuf(coutBuf);
+        return w.getIOLists();
+    };
+    
+    // Minimal observable FSMs, every second one with an input that is
+    // undefined in some states
+    for ( int i = 0; i < 10; i++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        shared_ptr<Fsm> r = Fsm::createRandomFsm("F",2,2,10 + i,pl,i+1);
+        vector<unique_ptr<FsmNode>> lst;
+        for ( auto const &n : r->getNodes() ) {
+            lst.emplace_back(new FsmNode(n->getId(), n->getName()));
+        }
+        for ( auto const &n : r->getNodes() ) {
+            for ( auto const &tr : n->getTransitions() ) {
+                if ( i % 2 == 1 and n->getId() % 3 == 1 and tr->getLabel()->getInput() == 0 ) {
+                    continue;
+                }
+                unique_ptr<FsmTransition> t { new FsmTransition(lst[n->getId()].get(),
+                    lst[tr->getTarget()->getId()].get(), *tr->getLabel()) };
+                lst[n->getId()]->addTransition(std::move(t));
+            }
+        }
+        Fsm f("F",r->getMaxInput(),r->getMaxOutput(),std::move(lst),pl);
+        Fsm fMin = f.minimise();
+        
+        IOListContainer::IOListBaseType w1 = calcW(fMin,1);
+        if ( calcW(fMin,4) != w1 or calcW(fMin,0) != w1 ) sameW = false;
+        
+        Tree w(pl);
+        w.addToRoot(IOListContainer(w1,pl));
+        if ( not fMin.isCharSet(&w) ) charSet = false;
+    }
+    
+    // A minimised DFSM, large enough for the responses to be
+    // calculated by several threads
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    Dfsm d("TC-FSM-0027",1500,3,3,pl);
+    Dfsm dMin = d.minimise();
+    vector<IOListContainer::IOListBaseType> wLst;
+    for ( unsigned numThreads : { 1, 4, 0 } ) {
+        Dfsm copy(dMin);
+        copy.setNumThreads(numThreads);
+        wLst.push_back(copy.getCharacterisationSet().getIOLists());
+    }
+    if ( wLst[1] != wLst[0] or wLst[2] != wLst[0] ) sameW = false;
+    
+    // The outputs of the states to the traces of W are pairwise different
+    set<vector<vector<int>>> responses;
+    for ( auto const &n : dMin.getNodes() ) {
+        vector<vector<int>> response;
+        for ( auto const &itrc : wLst[0] ) {
+            for ( auto const &otrc : n->apply(InputTrace(itrc,pl),false).getOutputTraces() ) {
+                response.push_back(otrc.get());
+            }
+        }
+        responses.insert(response);
+    }
+    if ( responses.size() != dMin.size() ) charSet = false;
+    
+    assert("TC-FSM-0027", sameW,
+           "Characterisation sets do not depend on the number of threads");
+    assert("TC-FSM-0027", charSet,
+           "Characterisation sets distinguish all states");
+}
+
+void test28() {
+    
+    cout << "TC-FSM-0028 Check that the lockstep simulation in "
+    << "FsmNode::distinguished() agrees with the output trees" << endl;
+    
+    bool agrees = true;
+    for ( int i = 0; i < 25; i++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        shared_ptr<Fsm> r;
+        switch ( i % 5 ) {
+            case 0:
+            case 1:
+                r = make_shared<Dfsm>("TC-FSM-0028",6,1,2,pl);
+                break;
+            case 2:
+                r = Fsm::createRandomFsm("F",1,2,5,pl,i+1);
+                break;
+            default:
+                r = make_shared<Fsm>(Fsm::createRandomFsm("F",1,2,5,pl,i+1)->transformToObservableFSM());
+                break;
+        }
+        
+        // Cases 1 and 4: drop input 0 in every third state
+        vector<unique_ptr<FsmNode>> lst;
+        for ( auto const &n : r->getNodes() ) {
+            lst.emplace_back(new FsmNode(n->getId(), n->getName()));
+        }
+        for ( auto const &n : r->getNodes() ) {
+            for ( auto const &tr : n->getTransitions() ) {
+                if ( i % 5 % 3 == 1 and n->getId() % 3 == 1 and tr->getLabel()->getInput() == 0 ) {
+                    continue;
+                }
+                unique_ptr<FsmTransition> t { new FsmTransition(lst[n->getId()].get(),
+                    lst[tr->getTarget()->getId()].get(), *tr->getLabel()) };
+                lst[n->getId()]->addTransition(std::move(t));
+            }
+        }
+        Fsm f("F",r->getMaxInput(),r->getMaxOutput(),std::move(lst),pl);
+        
+        // All input traces of length 0..4
+        vector<vector<int>> traces { { } };
+        for ( size_t k = 0; k < traces.size(); k++ ) {
+            if ( traces[k].size() == 4 ) continue;
+            for ( int x = 0; x <= f.getMaxInput(); x++ ) {
+                traces.push_back(traces[k]);
+                traces.back().push_back(x);
+            }
+        }
+        
+        auto const &nodes = f.getNodes();
+        for ( auto const &n1 : nodes ) {
+            for ( auto const &n2 : nodes ) {
+                for ( auto const &itrc : traces ) {
+                    InputTrace inputs(itrc,pl);
+                    OutputTree o1 = n1->apply(inputs,false);
+                    OutputTree o2 = n2->apply(inputs,false);
+                    if ( n1->distinguished(n2.get(),itrc) != !(o1 == o2) ) agrees = false;
+                }
+            }
+        }
+    }
+    
+    assert("TC-FSM-0028", agrees,
+           "The lockstep simulation agrees with the comparison of output trees");
+}
+
+void test29() {
+    
+    cout << "TC-FSM-0029 Check that test suites executed with shared "
+    << "prefixes coincide with the application of each test case" << endl;
+    
+    bool sameSuites = true;
+    for ( int i = 0; i < 12; i++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        shared_ptr<Fsm> r;
+        if ( i % 3 == 0 ) {
+            r = make_shared<Dfsm>("TC-FSM-0029",8,2,2,pl);
+        }
+        else {
+            r = Fsm::createRandomFsm("F",2,2,6,pl,i+1);
+        }
+        
+        // Every third FSM is partial: drop input 1 in every second state
+        vector<unique_ptr<FsmNode>> lst;
+        for ( auto const &n : r->getNodes() ) {
+            lst.emplace_back(new FsmNode(n->getId(), n->getName()));
+        }
+        for ( auto const &n : r->getNodes() ) {
+            for ( auto const &tr : n->getTransitions() ) {
+                if ( i % 3 == 2 and n->getId() % 2 == 1 and tr->getLabel()->getInput() == 1 ) {
+                    continue;
+                }
+                unique_ptr<FsmTransition> t { new FsmTransition(lst[n->getId()].get(),
+                    lst[tr->getTarget()->getId()].get(), *tr->getLabel()) };
+                lst[n->getId()]->addTransition(std::move(t));
+            }
+        }
+        Fsm f("F",r->getMaxInput(),r->getMaxOutput(),std::move(lst),pl);
+        
+        // Random test cases with many shared prefixes and duplicates,
+        // including the empty one
+        srand(i + 1);
+        IOListContainer::IOListBaseType tcLst { { } };
+        for ( int k = 0; k < 60; k++ ) {
+            vector<int> trc;
+            int len = rand() % 6;
+            for ( int j = 0; j < len; j++ ) trc.push_back(rand() % (f.getMaxInput() + 1));
+            tcLst.push_back(trc);
+        }
+        IOListContainer testCases(tcLst,pl);
+        
+        for ( unsigned numThreads : { 1, 3 } ) {
+            f.setNumThreads(numThreads);
+            TestSuite suite = f.createTestSuite(testCases);
+            if ( suite.size() != tcLst.size() ) {
+                sameSuites = false;
+                continue;
+            }
+            for ( size_t k = 0; k < tcLst.size(); k++ ) {
+                OutputTree expected = f.apply(InputTrace(tcLst[k],pl));
+                if ( suite[k].getInputTrace() != expected.getInputTrace() or
+                    suite[k].getOutputTraces() != expected.getOutputTraces() or
+                    suite[k].size() != expected.size() ) {
+                    sameSuites = false;
+                }
+            }
+        }
+    }
+    
+    assert("TC-FSM-0029", sameSuites,
+           "Test suites coincide with the output trees of their test cases");
+}
+
+void test30() {
+    
+    cout << "TC-FSM-0030 Check that minimal hitting sets are smallest "
+    << "hitting sets and can be calculated concurrently" << endl;
+    
+    // Check whether h hits every set of s
+    auto hits = [](const unordered_set<int>& h, const vector<unordered_set<int>>& s) {
+        for ( auto const &z : s ) {
+            bool hit = false;
+            for ( int x : z ) hit = hit or h.count(x) > 0;
+            if ( not hit ) return false;
+        }
+        return true;
+    };
+    
+    bool smallest = true;
+    bool hittingSets = true;
+    bool concurrent = true;
+    for ( int i = 0; i < 40; i++ ) {
+        srand(i + 1);
+        const int numElements = 4 + i % 9;
+        vector<unordered_set<int>> s(1 + rand() % 15);
+        for ( auto &z : s ) {
+            do {
+                for ( int x = 0; x < numElements; x++ ) {
+                    if ( rand() % 3 == 0 ) z.insert(10 * x);
+                }
+            } while ( z.empty() );
+        }
+        
+        // Smallest hitting set by exhaustive search
+        size_t minSize = numElements;
+        for ( int bits = 0; bits < (1 << numElements); bits++ ) {
+            unordered_set<int> h;
+            for ( int x = 0; x < numElements; x++ ) {
+                if ( bits & (1 << x) ) h.insert(10 * x);
+            }
+            if ( h.size() < minSize and hits(h,s) ) minSize = h.size();
+        }
+        
+        HittingSet hs(s);
+        unordered_set<int> h = hs.calcMinCardHittingSet();
+        if ( h.size() != minSize ) smallest = false;
+        bool optimal = false;
+        unordered_set<int> hBudget = hs.calcMinCardHittingSet(chrono::milliseconds(1000),&optimal);
+        if ( not optimal or hBudget.size() != minSize ) smallest = false;
+        unordered_set<int> hGreedy = hs.calcGreedyHittingSet();
+        if ( not hits(h,s) or not hits(hBudget,s) or not hits(hGreedy,s) ) hittingSets = false;
+        if ( hGreedy.size() < minSize ) hittingSets = false;
+        
+        vector<unordered_set<int>> results(4);
+        vector<thread> workers;
+        for ( size_t t = 0; t < results.size(); t++ ) {
+            workers.emplace_back([&hs, &results, t]() {
+                results[t] = hs.calcMinCardHittingSet();
+            });
+        }
+        for ( auto &w : workers ) w.join();
+        for ( auto const &r : results ) {
+            if ( r != h ) concurrent = false;
+        }
+    }
+    
+    // A set system without hitting set yields the union of its sets
+    HittingSet noHs({ { 1, 2 }, { } });
+    if ( noHs.calcMinCardHittingSet() != unordered_set<int>({ 1, 2 }) ) hittingSets = false;
+    
+    assert("TC-FSM-0030", smallest,
+           "The hitting sets calculated are smallest hitting sets");
+    assert("TC-FSM-0030", hittingSets,
+           "Exact and greedy calculations yield hitting sets");
+    assert("TC-FSM-0030", concurrent,
+           "Concurrent calculations yield the same hitting sets");
+}
+
+void test31() {
+    
+    cout << "TC-FSM-0031 Check that the distinguishability matrix agrees "
+    << "with FsmNode::distinguished()" << endl;
+    
+    bool agrees = true;
+    bool firstTrace = true;
+    for ( int i = 0; i < 25; i++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        shared_ptr<Fsm> r;
+        switch ( i % 5 ) {
+            case 0:
+            case 1:
+                r = make_shared<Dfsm>("TC-FSM-0031",6,1,2,pl);
+                break;
+            default:
+                r = make_shared<Fsm>(Fsm::createRandomFsm("F",1,2,5,pl,i+1)->transformToObservableFSM());
+                break;
+        }
+        
+        // Cases 1 and 4: drop input 0 in every third state
+        vector<unique_ptr<FsmNode>> lst;
+        for ( auto const &n : r->getNodes() ) {
+            lst.emplace_back(new FsmNode(n->getId(), n->getName()));
+        }
+        for ( auto const &n : r->getNodes() ) {
+            for ( auto const &tr : n->getTransitions() ) {
+                if ( i % 5 % 3 == 1 and n->getId() % 3 == 1 and tr->getLabel()->getInput() == 0 ) {
+                    continue;
+                }
+                unique_ptr<FsmTransition> t { new FsmTransition(lst[n->getId()].get(),
+                    lst[tr->getTarget()->getId()].get(), *tr->getLabel()) };
+                lst[n->getId()]->addTransition(std::move(t));
+            }
+        }
+        Fsm f("F",r->getMaxInput(),r->getMaxOutput(),std::move(lst),pl);
+        
+        // All input traces of length 0..3
+        vector<vector<int>> traces { { } };
+        for ( size_t k = 0; k < traces.size(); k++ ) {
+            if ( traces[k].size() == 3 ) continue;
+            for ( int x = 0; x <= f.getMaxInput(); x++ ) {
+                traces.push_back(traces[k]);
+                traces.back().push_back(x);
+            }
+        }
+        
+        DistinguishabilityMatrix matrix(f.getCSRTransitionTable(),traces,1);
+        auto const &nodes = f.getNodes();
+        for ( int s1 = 0; s1 < static_cast<int>(nodes.size()); s1++ ) {
+            vector<unordered_set<int>> sets;
+            for ( int s2 = 0; s2 < static_cast<int>(nodes.size()); s2++ ) {
+                unordered_set<int> z = matrix.getDistinguishingTraces(s1,s2);
+                if ( s2 != s1 and find(sets.begin(),sets.end(),z) == sets.end() ) sets.push_back(z);
+            }
+            vector<unordered_set<int>> distinctSets = matrix.getDistinguishingTraceSets(s1);
+            if ( distinctSets.size() != sets.size() ) firstTrace = false;
+            for ( auto const &z : distinctSets ) {
+                if ( find(sets.begin(),sets.end(),z) == sets.end() ) firstTrace = false;
+            }
+            for ( int s2 = 0; s2 < static_cast<int>(nodes.size()); s2++ ) {
+                int first = -1;
+                unordered_set<int> all;
+                for ( int u = 0; u < static_cast<int>(traces.size()); u++ ) {
+                    bool d = nodes[s1]->distinguished(nodes[s2].get(),traces[u]);
+                    if ( matrix.distinguished(s1,s2,u) != d ) agrees = false;
+                    if ( d and first < 0 ) first = u;
+                    if ( d ) all.insert(u);
+                }
+                if ( matrix.firstDistinguishingTrace(s1,s2) != first ) firstTrace = false;
+                if ( matrix.getDistinguishingTraces(s1,s2) != all ) firstTrace = false;
+                if ( matrix.distinguished(s1,s2) != (first >= 0) ) firstTrace = false;
+            }
+        }
+    }
+    
+    // A minimised DFSM, large enough for the responses to be
+    // calculated by several threads
+    shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+    Dfsm d("TC-FSM-0031",1500,3,3,pl);
+    Dfsm dMin = d.minimise();
+    ostringstream captured;
+    streambuf* coutBuf = cout.rdbuf(captured.rdbuf());
+    IOListContainer w = dMin.getCharacterisationSet();
+    cout.rdbuf(coutBuf);
+    
+    DistinguishabilityMatrix m1(dMin.getCSRTransitionTable(),w.getIOLists(),1);
+    DistinguishabilityMatrix m4(dMin.getCSRTransitionTable(),w.getIOLists(),4);
+    bool sameSignatures = true;
+    for ( int s = 0; s < m1.size(); s++ ) {
+        for ( int u = 0; u < m1.getNumTraces(); u++ ) {
+            if ( m1.getSignature(s,u) != m4.getSignature(s,u) ) sameSignatures = false;
+        }
+    }
+    
+    Tree wTree(pl);
+    wTree.addToRoot(w);
+    Tree wPart(pl);
+    IOListContainer::IOListBaseType wLst { w.getIOLists().front() };
+    wPart.addToRoot(IOListContainer(wLst,pl));
+    
+    assert("TC-FSM-0031", agrees,
+           "Traces distinguish states in the matrix if and only if they distinguish their output trees");
+    assert("TC-FSM-0031", firstTrace,
+           "The distinguishing traces of pairs and their distinct sets are reported correctly");
+    assert("TC-FSM-0031", sameSignatures,
+           "The signatures do not depend on the number of threads");
+    assert("TC-FSM-0031", m1.distinguishesAllStates() and dMin.isCharSet(&wTree) and not dMin.isCharSet(&wPart),
+           "A characterisation set distinguishes all states, but not a single one of its traces");
+}
+
+/** Trie with linearly searched children, as reference for TreeNode */
+struct ReferenceTrie {
+    vector<pair<int, unique_ptr<ReferenceTrie>>> children;
+    
+    void add(vector<int>::const_iterator it, vector<int>::const_iterator end) {
+        if ( it == end ) return;
+        for ( auto &c : children ) {
+            if ( c.first == *it ) {
+                c.second->add(it + 1, end);
+                return;
+            }
+        }
+        children.emplace_back(*it, unique_ptr<ReferenceTrie>(new ReferenceTrie()));
+        children.back().second->add(it + 1, end);
+    }
+    
+    void traverse(vector<int>& v, vector<vector<int>>& ioll) const {
+        for ( auto const &c : children ) {
+            v.push_back(c.first);
+            c.second->traverse(v, ioll);
+            v.pop_back();
+        }
+        ioll.push_back(v);
+    }
+};
+
+/**
+ * Check that every child of n and its descendants is found by its
+ * label, unless an earlier child carries the same label
+ */
+bool childrenIndexed(TreeNode *n) {
+    auto const &children = n->getChildren();
+    for ( size_t i = 0; i < children.size(); i++ ) {
+        size_t first = 0;
+        while ( children[first]->getIO() != children[i]->getIO() ) ++ first;
+        vector<int> x { children[i]->getIO() };
+        if ( n->after(x.cbegin(), x.cend()) != children[first]->getTarget() ) return false;
+        if ( children[i]->getTarget()->getParent() != n ) return false;
+        if ( not childrenIndexed(children[i]->getTarget()) ) return false;
+    }
+    return true;
+}
+
+void test32() {
+    
+    cout << "TC-FSM-0032 Check that trees with indexed children "
+    << "coincide with tries searching their children linearly" << endl;
+    
+    bool sameTraces = true;
+    bool sameLookups = true;
+    bool indexed = true;
+    bool copies = true;
+    for ( int i = 0; i < 12; i++ ) {
+        srand(i + 1);
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        
+        // Wide alphabets, and labels which are negative or too
+        // large to be direct-indexed
+        vector<int> alphabet;
+        const int width = (i % 3 == 0) ? 3 : ((i % 3 == 1) ? 300 : 40);
+        for ( int x = 0; x < width; x++ ) alphabet.push_back(x);
+        if ( i % 2 == 1 ) {
+            alphabet.push_back(-7);
+            alphabet.push_back(5000);
+            alphabet.push_back(123456);
+        }
+        
+        Tree tree(pl);
+        ReferenceTrie reference;
+        vector<vector<int>> traces;
+        for ( int k = 0; k < 400; k++ ) {
+            vector<int> trc;
+            int len = 1 + rand() % 4;
+            for ( int d = 0; d < len; d++ ) {
+                // Prefer few labels near the root, so that paths are shared
+                int range = d == 0 ? min<int>(alphabet.size(), 8 + i) : alphabet.size();
+                trc.push_back(alphabet[rand() % range]);
+            }
+            traces.push_back(trc);
+            tree.addToRoot(trc);
+            reference.add(trc.cbegin(), trc.cend());
+        }
+        
+        vector<int> v1, v2;
+        vector<vector<int>> ioll1, ioll2;
+        tree.getRoot()->traverse(v1, ioll1);
+        reference.traverse(v2, ioll2);
+        if ( ioll1 != ioll2 ) sameTraces = false;
+        
+        for ( auto const &trc : traces ) {
+            for ( size_t len = 0; len <= trc.size(); len++ ) {
+                TreeNode *n = tree.getRoot()->after(trc.cbegin(), trc.cbegin() + len);
+                if ( n == nullptr or n->getPath() != vector<int>(trc.begin(), trc.begin() + len) ) {
+                    sameLookups = false;
+                }
+            }
+            vector<int> missing(trc);
+            missing.push_back(-1000);
+            if ( tree.getRoot()->after(missing.cbegin(), missing.cend()) != nullptr ) sameLookups = false;
+        }
+        
+        TreeNode *root = tree.getRoot();
+        unique_ptr<Tree> copy = tree.clone();
+        if ( not (*copy->getRoot() == *root) or not copy->getRoot()->superTreeOf(root)
+            or not root->superTreeOf(copy->getRoot()) ) {
+            copies = false;
+        }
+        
+        // Duplicate labels, as in output trees of non-observable FSMs
+        for ( int k = 0; k < 6; k++ ) {
+            root->add(unique_ptr<TreeEdge>(new TreeEdge(alphabet[k % alphabet.size()])));
+        }
+        if ( not childrenIndexed(root) or not childrenIndexed(tree.clone()->getRoot()) ) indexed = false;
+        
+        // Removing a part of the traces keeps the index consistent
+        Tree part(pl);
+        for ( size_t k = 0; k < traces.size(); k += 3 ) part.addToRoot(traces[k]);
+        tree.remove(&part);
+        if ( not childrenIndexed(root) ) indexed = false;
+    }
+    
+    assert("TC-FSM-0032", sameTraces,
+           "Trees with indexed children contain the same traces in the same order");
+    assert("TC-FSM-0032", sameLookups,
+           "Traces are found in trees with indexed children if and only if they have been added");
+    assert("TC-FSM-0032", indexed,
+           "Every child is found by its label, also after removing subtrees");
+    assert("TC-FSM-0032", copies,
+           "Copies of trees with indexed children are equal to the original");
+}
+
+
+void test33() {
+    
+    cout << "TC-FSM-0033 Check that trees sharing their suffixes represent "
+    << "the same test cases as trees" << endl;
+    
+    bool sameTraces = true;
+    bool sameSizes = true;
+    bool sameUnions = true;
+    bool shared = true;
+    for ( int i = 0; i < 20; i++ ) {
+        srand(i + 1);
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        const int maxInput = 1 + i % 3;
+        
+        auto randomTraces = [maxInput, &pl](const int num, const int maxLen) {
+            IOListContainer::IOListBaseType ioll;
+            for ( int k = 0; k < num; k++ ) {
+                vector<int> trc;
+                int len = rand() % (maxLen + 1);
+                for ( int d = 0; d < len; d++ ) trc.push_back(rand() % (maxInput + 1));
+                ioll.push_back(trc);
+            }
+            return IOListContainer(ioll, pl);
+        };
+        
+        Tree tree(pl);
+        tree.addToRoot(randomTraces(1 + i % 7, 4));
+        SuffixSharingTree dag(tree);
+        if ( dag.getIOLists().getIOLists() != tree.getIOLists().getIOLists() ) sameTraces = false;
+        
+        // V.Sigma^k.W
+        IOListContainer inputEnum(maxInput, 1, 1 + i % 3, pl);
+        IOListContainer w = randomTraces(1 + i % 4, 3);
+        tree.add(inputEnum);
+        dag.add(inputEnum);
+        tree.add(w);
+        dag.add(w);
+        if ( dag.getIOLists().getIOLists() != tree.getIOLists().getIOLists() ) sameTraces = false;
+        if ( dag.size() != tree.size() ) sameSizes = false;
+        if ( i % 3 == 2 and dag.getNumStoredNodes() * 10 > tree.size() ) shared = false;
+        
+        // Appending at the root and after existing and missing traces
+        IOListContainer more = randomTraces(3, 3);
+        tree.addToRoot(more);
+        dag.addToRoot(more);
+        IOListContainer afterTraces = randomTraces(4, 3);
+        for ( auto const &trc : afterTraces.getIOLists() ) {
+            tree.addAfter(InputTrace(trc, pl), more);
+            dag.addAfter(trc, more);
+        }
+        if ( dag.getIOLists().getIOLists() != tree.getIOLists().getIOLists() ) sameTraces = false;
+        
+        // Appending traces depending on the parity of the sum of the inputs
+        IOListContainer odd = randomTraces(2, 2);
+        IOListContainer even = randomTraces(2, 2);
+        IOListContainer leaves = tree.getIOLists();
+        for ( auto const &trc : leaves.getIOLists() ) {
+            int sum = 0;
+            for ( int x : trc ) sum += x;
+            tree.addAfter(InputTrace(trc, pl), (sum % 2 == 1) ? odd : even);
+        }
+        dag.addAfterLeaves({ 0 },
+                           [](const vector<int>& key, const int x) {
+                               return vector<int> { (key[0] + x) % 2 };
+                           },
+                           [&odd, &even](const vector<int>& key) {
+                               return key[0] == 1 ? odd : even;
+                           });
+        if ( dag.getIOLists().getIOLists() != tree.getIOLists().getIOLists() ) sameTraces = false;
+        if ( dag.size() != tree.size() ) sameSizes = false;
+        
+        // The union inserts the traces of the other tree breadth-first
+        Tree other(pl);
+        other.addToRoot(randomTraces(6, 5));
+        other.add(randomTraces(2, 2));
+        SuffixSharingTree otherDag(other);
+        tree.unionTree(&other);
+        dag.unionTree(otherDag);
+        if ( dag.getIOLists().getIOLists() != tree.getIOLists().getIOLists() ) sameUnions = false;
+        if ( dag.size() != tree.size() ) sameSizes = false;
+    }
+    
+    assert("TC-FSM-0033", sameTraces,
+           "Trees sharing their suffixes enumerate the same test cases in the same order");
+    assert("TC-FSM-0033", sameUnions,
+           "Unions of trees sharing their suffixes enumerate the same test cases in the same order");
+    assert("TC-FSM-0033", sameSizes,
+           "Trees sharing their suffixes represent trees of the same size");
+    assert("TC-FSM-0033", shared,
+           "Trees sharing their suffixes store a fraction of the nodes of V.Sigma^3.W trees");
+}
+
+
+void test34() {
+    
+    cout << "TC-FSM-0034 Check that streamed test cases and test suites "
+    << "coincide with the materialised ones" << endl;
+    
+    bool sameIOLists = true;
+    bool sameSuites = true;
+    bool sameFiles = true;
+    for ( unsigned i = 0; i < 10; i++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        shared_ptr<Fsm> f = Fsm::createRandomFsm("F",2,2,5,pl,i + 1);
+        Fsm fMin = f->transformToObservableFSM().minimise();
+        
+        // Collect the I/O lists visited, the buffer passed is reused
+        auto collect = [](IOListContainer::IOListBaseType& ioll) {
+            return [&ioll](const vector<int>& lst) { ioll.push_back(lst); };
+        };
+        
+        unique_ptr<Tree> tcov = fMin.getTransitionCover();
+        IOListContainer::IOListBaseType visited;
+        tcov->forEachIOList(collect(visited));
+        if ( visited != tcov->getIOLists().getIOLists() ) sameIOLists = false;
+        visited.clear();
+        tcov->forEachIOListWithPrefixes(collect(visited));
+        if ( visited != tcov->getIOListsWithPrefixes().getIOLists() ) sameIOLists = false;
+        
+        SuffixSharingTree wTree = fMin.wMethodTreeOnMinimisedFsm(i % 3);
+        IOListContainer testCases = wTree.getIOLists();
+        visited.clear();
+        wTree.forEachIOList(collect(visited));
+        if ( visited != testCases.getIOLists() ) sameIOLists = false;
+        if ( testCases.getIOLists() != fMin.wMethodOnMinimisedFsm(i % 3).getIOLists() ) sameIOLists = false;
+        
+        TestSuite suite = f->createTestSuite(testCases);
+        size_t k = 0;
+        f->createTestSuite([&wTree](const IOListContainer::IOListVisitor& visitor) {
+            wTree.forEachIOList(visitor);
+        }, [&suite, &k, &sameSuites](const OutputTree& ot) {
+            if ( k >= suite.size() or ot.getInputTrace() != suite[k].getInputTrace()
+                or ot.getOutputTraces() != suite[k].getOutputTraces()
+                or ot.size() != suite[k].size() ) {
+                sameSuites = false;
+            }
+            k++;
+        });
+        if ( k != suite.size() ) sameSuites = false;
+        
+        suite.save("TC-FSM-0034-suite.txt");
+        TestSuite::save("TC-FSM-0034-stream.txt", [&f, &testCases](const TestSuite::OutputTreeVisitor& visitor) {
+            f->createTestSuite([&testCases](const IOListContainer::IOListVisitor& tcVisitor) {
+                testCases.forEach(tcVisitor);
+            }, visitor);
+        });
+        ifstream suiteFile("TC-FSM-0034-suite.txt");
+        ifstream streamFile("TC-FSM-0034-stream.txt");
+        stringstream suiteText, streamText;
+        suiteText << suiteFile.rdbuf();
+        streamText << streamFile.rdbuf();
+        if ( suiteText.str() != streamText.str() ) sameFiles = false;
+        suiteFile.close();
+        streamFile.close();
+        std::remove("TC-FSM-0034-suite.txt");
+        std::remove("TC-FSM-0034-stream.txt");
+    }
+    
+    assert("TC-FSM-0034", sameIOLists,
+           "Visited I/O lists coincide with the materialised I/O lists");
+    assert("TC-FSM-0034", sameSuites,
+           "Test cases executed one at a time coincide with createTestSuite()");
+    assert("TC-FSM-0034", sameFiles,
+           "Test suites saved one output tree at a time coincide with saved test suites");
+}
+
+
+void test35() {
+    
+    cout << "TC-FSM-0035 Check that the leaves and counters maintained by "
+    << "trees coincide with recalculated ones" << endl;
+    
+    // Recalculate leaves in depth-first order, the number of nodes
+    // and the total length of the I/O lists by a full traversal
+    struct Traversal {
+        vector<TreeNode*> leaves;
+        size_t numNodes = 0;
+        size_t totalLength = 0;
+        void visit(TreeNode *n, size_t depth) {
+            numNodes++;
+            if ( n->isLeaf() ) {
+                leaves.push_back(n);
+                totalLength += depth;
+            }
+            for ( auto const &e : n->getChildren() ) visit(e->getTarget(), depth + 1);
+        }
+    };
+    
+    // Recalculate leaves in breadth-first order
+    auto breadthFirstLeaves = [](TreeNode *root) {
+        vector<TreeNode*> leaves;
+        deque<TreeNode*> worklist { root };
+        while ( not worklist.empty() ) {
+            TreeNode *n = worklist.front();
+            worklist.pop_front();
+            if ( n->isLeaf() ) leaves.push_back(n);
+            for ( auto const &e : n->getChildren() ) worklist.push_back(e->getTarget());
+        }
+        return leaves;
+    };
+    
+    bool sameLeaves = true;
+    bool sameCounters = true;
+    auto check = [&](Tree& tree) {
+        Traversal t;
+        t.visit(tree.getRoot(), 0);
+        Tree const &constTree = tree;
+        if ( tree.getLeaves() != t.leaves ) sameLeaves = false;
+        if ( constTree.getLeaves() != breadthFirstLeaves(tree.getRoot()) ) sameLeaves = false;
+        if ( tree.size() != t.numNodes or tree.getNumLeaves() != t.leaves.size()
+            or tree.totalLength() != t.totalLength ) {
+            sameCounters = false;
+        }
+    };
+    
+    for ( int i = 0; i < 30; i++ ) {
+        srand(i + 1);
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        
+        auto randomTraces = [](const int num, const int maxLen) {
+            IOListContainer::IOListBaseType ioll;
+            for ( int k = 0; k < num; k++ ) {
+                vector<int> trc;
+                int len = rand() % (maxLen + 1);
+                for ( int d = 0; d < len; d++ ) trc.push_back(rand() % 3);
+                ioll.push_back(trc);
+            }
+            return ioll;
+        };
+        
+        Tree tree(pl);
+        check(tree);
+        tree.addToRoot(IOListContainer(randomTraces(5, 4), pl));
+        check(tree);
+        tree.add(IOListContainer(randomTraces(2, 2), pl));
+        check(tree);
+        for ( auto const &trc : randomTraces(3, 3) ) {
+            tree.addAfter(InputTrace(trc, pl), IOListContainer(randomTraces(2, 2), pl));
+        }
+        check(tree);
+        
+        unique_ptr<Tree> copy = tree.clone();
+        check(*copy);
+        
+        // Remove the traces of another tree and delete random leaves
+        Tree other(pl);
+        other.addToRoot(IOListContainer(randomTraces(4, 3), pl));
+        copy->remove(&other);
+        check(*copy);
+        for ( int k = 0; k < 5 and copy->getRoot()->getChildren().size() > 0; k++ ) {
+            vector<TreeNode*> leaves = copy->getLeaves();
+            TreeNode *n = leaves.at(rand() % leaves.size());
+            if ( i % 2 == 0 ) n->deleteSingleNode();
+            else n->deleteNode();
+            check(*copy);
+        }
+        copy->addToRoot(IOListContainer(randomTraces(3, 4), pl));
+        check(*copy);
+        check(tree);
+        
+        // Output trees are extended leaf by leaf
+        shared_ptr<Fsm> f = Fsm::createRandomFsm("F",2,2,4,pl,i + 1);
+        vector<int> trc = randomTraces(1, 6).front();
+        OutputTree ot = f->apply(InputTrace(trc, pl));
+        check(ot);
+    }
+    
+    TestSuite suite;
+    size_t length = 0;
+    for ( int k = 0; k < 10; k++ ) {
+        shared_ptr<FsmPresentationLayer> pl = make_shared<FsmPresentationLayer>();
+        suite.push_back(OutputTree(InputTrace(vector<int>(k, 0), pl), pl));
+        length += k;
+    }
+    
+    assert("TC-FSM-0035", sameLeaves,
+           "Leaves maintained by trees coincide with depth-first and breadth-first traversals");
+    assert("TC-FSM-0035", sameCounters,
+           "Node counts, leaf counts and total lengths maintained by trees are correct");
+    assert("TC-FSM-0035", suite.totalLength() == length,
+           "Total length of a test suite is the sum of its test case lengths");
+}
+
+
+
+
+
+
+
 
 void gdc_test1() {
     
@@ -564,7 +2599,7 @@ void gdc_test1() {
     shared_ptr<Dfsm> gdc =
     make_shared<Dfsm>("../../resources/garage-door-controller.csv","GDC");
     
-    FsmPresentationLayer *pl = gdc->getPresentationLayer();
+    shared_ptr<const FsmPresentationLayer> pl = gdc->getPresentationLayer();
     
     gdc->toDot("GDC");
     gdc->toCsv("GDC");
@@ -575,7 +2610,7 @@ void gdc_test1() {
     shared_ptr< TestSuite > testSuite =
         make_shared< TestSuite >();
     for ( auto const &inVec : iolc.getIOLists() ) {
-        shared_ptr<InputTrace> itrc = make_shared<InputTrace>(inVec,pl->clone());
+        shared_ptr<InputTrace> itrc = make_shared<InputTrace>(inVec,pl);
         testSuite->push_back(gdc->apply(*itrc));
     }
     
@@ -599,7 +2634,7 @@ void gdc_test1() {
 vector<IOTrace> runAgainstRefModel(shared_ptr<Dfsm> refModel,
                                    IOListContainer& c) {
     
-    FsmPresentationLayer *pl = refModel->getPresentationLayer();
+    shared_ptr<const FsmPresentationLayer> pl = refModel->getPresentationLayer();
     
     auto iolCnt = c.getIOLists();
     
@@ -608,7 +2643,7 @@ vector<IOTrace> runAgainstRefModel(shared_ptr<Dfsm> refModel,
 
     for ( auto const &lst : iolCnt ) {
         
-        InputTrace itr(lst,pl->clone());
+        InputTrace itr(lst,pl);
         IOTrace iotr = refModel->applyDet(itr);
         iotrLst.push_back(iotr);
         
@@ -618,15 +2653,15 @@ vector<IOTrace> runAgainstRefModel(shared_ptr<Dfsm> refModel,
     
 }
 
-void runAgainstMutant(shared_ptr<Dfsm> mutant, vector<IOTrace>& expected) {
+void runAgainstMutant(const FsmMutant& mutant, vector<IOTrace>& expected) {
     
     for ( auto io : expected ) {
         
         InputTrace i = io.getInputTrace();
         
-        if ( not mutant->pass(io) ) {
+        if ( not mutant.pass(io) ) {
             cout << "FAIL: expected " << io << endl
-            << "     : observed " << mutant->applyDet(i) << endl;
+            << "     : observed " << mutant.applyDet(i) << endl;
         }
         else {
             cout << "PASS: " << i << endl;
@@ -668,9 +2703,7 @@ void wVersusT() {
         
         cout << "Mutant No. " << (i+1) << ": " << endl;
         
-        shared_ptr<Dfsm> mutant =
-            make_shared<Dfsm>("FSBRTSX.csv","FSBRTS");
-        mutant->createAtRandom();
+        FsmMutant mutant = refModel->createMutantOverlay("FSBRTS_M",1,1);
         
 //        runAgainstMutant(mutant,expectedResultsW0);
 //        runAgainstMutant(mutant,expectedResultsW1);
@@ -746,6 +2779,31 @@ int main()
     test8();
     test9();
     test10();
+    test11();
+    test12();
+    test13();
+    test14();
+    test15();
+    test16();
+    test17();
+    test18();
+    test19();
+    test20();
+    test21();
+    test22();
+    test23();
+    test24();
+    test25();
+    test26();
+    test27();
+    test28();
+    test29();
+    test30();
+    test31();
+    test32();
+    test33();
+    test34();
+    test35();
     
 
     exit(0);
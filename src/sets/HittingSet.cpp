@@ -1,25 +1,311 @@
 /*
  * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
- * 
+ *
  * Licensed under the EUPL V.1.1
  */
+#include <algorithm>
+#include <cstdint>
+
 #include "sets/HittingSet.h"
 
+using namespace std;
+
+namespace {
+
+    /**
+     * Minimal hitting set search over bitsets. An instance holds
+     * the state of a single calculation.
+     */
+    class BitsetSolver
+    {
+    private:
+        /** Elements of the union of all sets, in ascending order */
+        vector<int> elements;
+
+        /** Number of 64 bit words of a bitset over the elements */
+        size_t words;
+
+        /** Distinct sets, none of them a superset of another one,
+         ordered by cardinality, each stored in words consecutive words */
+        vector<uint64_t> sets;
+        size_t numSets;
+
+        /** True if the set system contains the empty set */
+        bool hasEmptySet;
+
+        /** Elements (by index) of the current branch and of the
+         smallest hitting set found so far */
+        vector<int> chosen;
+        vector<int> best;
+
+        /** Deadline of a search with time budget */
+        bool limited;
+        chrono::steady_clock::time_point deadline;
+        bool timedOut;
+        size_t numNodes;
+
+        const uint64_t *set(const size_t i) const {
+            return &sets[i * words];
+        }
+
+        bool contains(const size_t i, const int e) const {
+            return (set(i)[e / 64] >> (e % 64)) & 1;
+        }
+
+        void search(const vector<size_t>& uncovered, vector<uint64_t>& forbidden);
+
+    public:
+        explicit BitsetSolver(const vector<unordered_set<int>>& s);
+
+        /** Calculate best by the greedy approximation */
+        void greedy();
+
+        /**
+         * Improve best by branch and bound
+         * @return true if the search has been completed
+         */
+        bool branchAndBound(const bool limited, const chrono::milliseconds timeBudget);
+
+        unordered_set<int> getBest() const;
+    };
+
+    BitsetSolver::BitsetSolver(const vector<unordered_set<int>>& s)
+    : hasEmptySet(false), limited(false), timedOut(false), numNodes(0)
+    {
+        for ( auto const &z : s ) {
+            elements.insert(elements.end(), z.begin(), z.end());
+            if ( z.empty() ) hasEmptySet = true;
+        }
+        sort(elements.begin(), elements.end());
+        elements.erase(unique(elements.begin(), elements.end()), elements.end());
+        words = (elements.size() + 63) / 64;
+
+        vector< vector<uint64_t> > bitsets;
+        bitsets.reserve(s.size());
+        for ( auto const &z : s ) {
+            vector<uint64_t> b(words, 0);
+            for ( int x : z ) {
+                size_t e = lower_bound(elements.begin(), elements.end(), x) - elements.begin();
+                b[e / 64] |= uint64_t(1) << (e % 64);
+            }
+            bitsets.push_back(std::move(b));
+        }
+        sort(bitsets.begin(), bitsets.end());
+        bitsets.erase(unique(bitsets.begin(), bitsets.end()), bitsets.end());
+
+        auto popcount = [](const vector<uint64_t>& b) {
+            size_t n = 0;
+            for ( uint64_t w : b ) n += __builtin_popcountll(w);
+            return n;
+        };
+        stable_sort(bitsets.begin(), bitsets.end(),
+                    [&popcount](const vector<uint64_t>& a, const vector<uint64_t>& b) {
+                        return popcount(a) < popcount(b);
+                    });
+
+        // A set is redundant if one of its subsets has to be hit as well
+        numSets = 0;
+        for ( auto const &b : bitsets ) {
+            bool redundant = false;
+            for ( size_t i = 0; i < numSets and not redundant; i++ ) {
+                redundant = true;
+                for ( size_t w = 0; w < words; w++ ) {
+                    if ( (set(i)[w] & ~b[w]) != 0 ) {
+                        redundant = false;
+                        break;
+                    }
+                }
+            }
+            if ( redundant ) continue;
+            sets.insert(sets.end(), b.begin(), b.end());
+            ++ numSets;
+        }
+    }
+
+    void BitsetSolver::greedy()
+    {
+        best.clear();
+        if ( hasEmptySet ) {
+            for ( size_t e = 0; e < elements.size(); e++ ) best.push_back(static_cast<int>(e));
+            return;
+        }
+
+        vector<bool> hit(numSets, false);
+        size_t numHit = 0;
+        while ( numHit < numSets ) {
+            vector<size_t> count(elements.size(), 0);
+            for ( size_t i = 0; i < numSets; i++ ) {
+                if ( hit[i] ) continue;
+                for ( size_t w = 0; w < words; w++ ) {
+                    for ( uint64_t b = set(i)[w]; b != 0; b &= b - 1 ) {
+                        ++ count[w * 64 + __builtin_ctzll(b)];
+                    }
+                }
+            }
+            int e = static_cast<int>(max_element(count.begin(), count.end()) - count.begin());
+            best.push_back(e);
+            for ( size_t i = 0; i < numSets; i++ ) {
+                if ( not hit[i] and contains(i, e) ) {
+                    hit[i] = true;
+                    ++ numHit;
+                }
+            }
+        }
+
+        // Drop elements whose sets are all hit by other elements,
+        // starting with the latest ones
+        vector<size_t> numHits(numSets, 0);
+        for ( int e : best ) {
+            for ( size_t i = 0; i < numSets; i++ ) {
+                if ( contains(i, e) ) ++ numHits[i];
+            }
+        }
+        for ( size_t k = best.size(); k-- > 0; ) {
+            bool needed = false;
+            for ( size_t i = 0; i < numSets and not needed; i++ ) {
+                needed = contains(i, best[k]) and numHits[i] == 1;
+            }
+            if ( needed ) continue;
+            for ( size_t i = 0; i < numSets; i++ ) {
+                if ( contains(i, best[k]) ) -- numHits[i];
+            }
+            best.erase(best.begin() + k);
+        }
+    }
+
+    bool BitsetSolver::branchAndBound(const bool limited, const chrono::milliseconds timeBudget)
+    {
+        if ( hasEmptySet ) return true;
+
+        this->limited = limited;
+        if ( limited ) deadline = chrono::steady_clock::now() + timeBudget;
+        timedOut = false;
+        numNodes = 0;
+        chosen.clear();
+
+        vector<size_t> uncovered(numSets);
+        for ( size_t i = 0; i < numSets; i++ ) uncovered[i] = i;
+        vector<uint64_t> forbidden(words, 0);
+        search(uncovered, forbidden);
+        return not timedOut;
+    }
+
+    void BitsetSolver::search(const vector<size_t>& uncovered, vector<uint64_t>& forbidden)
+    {
+        if ( timedOut ) return;
+        if ( limited and (++ numNodes % 1024) == 0 and chrono::steady_clock::now() > deadline ) {
+            timedOut = true;
+            return;
+        }
+
+        if ( uncovered.empty() ) {
+            if ( chosen.size() < best.size() ) best = chosen;
+            return;
+        }
+        if ( chosen.size() + 1 >= best.size() ) return;
+
+        // Lower bound: pairwise disjoint sets not yet hit need
+        // different elements. The set with fewest allowed elements
+        // is chosen for branching.
+        vector<uint64_t> packed(words, 0);
+        size_t bound = 0;
+        size_t branchSet = uncovered.front();
+        size_t branchSize = elements.size() + 1;
+        for ( size_t i : uncovered ) {
+            size_t allowed = 0;
+            bool disjoint = true;
+            for ( size_t w = 0; w < words; w++ ) {
+                uint64_t b = set(i)[w] & ~forbidden[w];
+                allowed += __builtin_popcountll(b);
+                if ( (b & packed[w]) != 0 ) disjoint = false;
+            }
+            if ( allowed == 0 ) return;
+            if ( allowed < branchSize ) {
+                branchSize = allowed;
+                branchSet = i;
+            }
+            if ( disjoint ) {
+                ++ bound;
+                for ( size_t w = 0; w < words; w++ ) packed[w] |= set(i)[w] & ~forbidden[w];
+            }
+        }
+        if ( chosen.size() + bound >= best.size() ) return;
+
+        // Branch on the allowed elements of branchSet, those hitting
+        // most sets first. Each branch excludes the elements of the
+        // preceding ones, so that no subset is explored twice.
+        vector< pair<size_t, int> > candidates;
+        for ( size_t w = 0; w < words; w++ ) {
+            for ( uint64_t b = set(branchSet)[w] & ~forbidden[w]; b != 0; b &= b - 1 ) {
+                candidates.emplace_back(0, static_cast<int>(w * 64 + __builtin_ctzll(b)));
+            }
+        }
+        for ( auto &c : candidates ) {
+            int ei = c.second;
+            size_t n = 0;
+            for ( size_t i : uncovered ) {
+                if ( contains(i, ei) ) ++ n;
+            }
+            c.first = n;
+        }
+        stable_sort(candidates.begin(), candidates.end(),
+                    [](const pair<size_t, int>& a, const pair<size_t, int>& b) {
+                        return a.first > b.first;
+                    });
+
+        vector<size_t> next;
+        for ( auto const &c : candidates ) {
+            int e = c.second;
+            next.clear();
+            for ( size_t i : uncovered ) {
+                if ( not contains(i, e) ) next.push_back(i);
+            }
+            chosen.push_back(e);
+            search(next, forbidden);
+            chosen.pop_back();
+            forbidden[e / 64] |= uint64_t(1) << (e % 64);
+        }
+        for ( auto const &c : candidates ) {
+            forbidden[c.second / 64] &= ~(uint64_t(1) << (c.second % 64));
+        }
+    }
+
+    unordered_set<int> BitsetSolver::getBest() const
+    {
+        unordered_set<int> result;
+        for ( int e : best ) result.insert(elements[e]);
+        return result;
+    }
+
+}
+
 HittingSet::HittingSet(const std::vector<std::unordered_set<int>>& s)
 	: s(s)
 {
-    // The initial hitting set candidate h is the union of
-    // all sets in s
-	for (std::unordered_set<int> z : s)
-	{
-		h.insert(z.begin(), z.end());
-	}
-	HsTreeNode::hSmallest = h;
+
 }
 
 std::unordered_set<int> HittingSet::calcMinCardHittingSet() const
 {
-	HsTreeNode root = HsTreeNode(h, s);
-	root.expandNode();
-	return HsTreeNode::hSmallest;
+	BitsetSolver solver(s);
+	solver.greedy();
+	solver.branchAndBound(false, chrono::milliseconds(0));
+	return solver.getBest();
+}
+
+std::unordered_set<int> HittingSet::calcMinCardHittingSet(const std::chrono::milliseconds timeBudget,
+                                                          bool *optimal) const
+{
+	BitsetSolver solver(s);
+	solver.greedy();
+	bool completed = solver.branchAndBound(true, timeBudget);
+	if (optimal != nullptr) *optimal = completed;
+	return solver.getBest();
+}
+
+std::unordered_set<int> HittingSet::calcGreedyHittingSet() const
+{
+	BitsetSolver solver(s);
+	solver.greedy();
+	return solver.getBest();
 }
@@ -1,17 +1,16 @@
 /*
  * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
- * 
+ *
  * Licensed under the EUPL V.1.1
  */
 #ifndef FSM_SETS_HITTINGSET_H_
 #define FSM_SETS_HITTINGSET_H_
 
+#include <chrono>
 #include <iostream>
 #include <unordered_set>
 #include <vector>
 
-#include "sets/HsTreeNode.h"
-
 class HittingSet
 {
 private:
@@ -20,9 +19,6 @@ private:
      * the minimal hitting set should be calculated
 	 */
 	std::vector<std::unordered_set<int>> s;
-
-	/** the current candidate for the minimal hitting set problem */
-	std::unordered_set<int> h;
 public:
    /**
 	* Create an object for solving the minimal hitting set problem.
@@ -39,7 +35,40 @@ public:
      *
      * @note this algorithm has worst case complexity
      * of O(2^(#(union s)))
+     *
+     * The sets are represented as bitsets over the union of s, and
+     * the search is a branch and bound: it branches on the elements
+     * of a smallest set not yet hit, excluding the elements of the
+     * preceding branches, so that no subset is explored twice. Branches
+     * are pruned if the number of pairwise disjoint sets not yet hit
+     * shows that they cannot improve the smallest hitting set found
+     * so far. All state is kept per call, so different objects may
+     * be used concurrently.
+     * If some set of s is empty, there is no hitting set, and the
+     * union of all sets is returned.
 	 */
 	std::unordered_set<int> calcMinCardHittingSet() const;
+
+	/**
+	 * Calculate a hitting set by branch and bound as in
+	 * calcMinCardHittingSet(), within a time budget.
+	 * @param timeBudget Maximal duration of the search
+	 * @param optimal If not null, set to true if and only if the
+	 *        search has been completed, so that the result is a
+	 *        smallest hitting set
+	 * @return The smallest hitting set found within the time budget,
+	 *         at most as large as the result of calcGreedyHittingSet()
+	 */
+	std::unordered_set<int> calcMinCardHittingSet(const std::chrono::milliseconds timeBudget,
+	                                              bool *optimal = nullptr) const;
+
+	/**
+	 * Calculate a hitting set approximately: repeatedly add the element
+	 * hitting most of the sets not yet hit, then drop elements that are
+	 * not needed. The result is not larger than ln(|s|)+1 times the size
+	 * of a smallest hitting set.
+	 * @return A hitting set which is minimal with respect to inclusion
+	 */
+	std::unordered_set<int> calcGreedyHittingSet() const;
 };
 #endif //FSM_SETS_HITTINGSET_H_
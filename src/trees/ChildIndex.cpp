@@ -0,0 +1,86 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <limits>
+
+#include "trees/ChildIndex.h"
+
+using namespace std;
+
+ChildIndex::ChildIndex()
+: numInline(0)
+{
+}
+
+int ChildIndex::findLarge(const int label) const
+{
+    if ( large->useHashed ) {
+        auto it = large->hashed.find(label);
+        return it == large->hashed.end() ? -1 : it->second;
+    }
+    if ( label < 0 or label >= static_cast<int>(large->direct.size()) ) return -1;
+    return large->direct[label] - 1;
+}
+
+void ChildIndex::insert(const int label, const int position)
+{
+    if ( find(label) >= 0 ) return;
+
+    if ( numInline >= 0 ) {
+        if ( numInline < inlineCapacity and position <= numeric_limits<uint16_t>::max() ) {
+            int i = numInline;
+            while ( i > 0 and inlineLabels[i - 1] > label ) {
+                inlineLabels[i] = inlineLabels[i - 1];
+                inlinePositions[i] = inlinePositions[i - 1];
+                -- i;
+            }
+            inlineLabels[i] = label;
+            inlinePositions[i] = static_cast<uint16_t>(position);
+            ++ numInline;
+            return;
+        }
+        makeLarge();
+    }
+    insertLarge(label, position);
+}
+
+void ChildIndex::makeLarge()
+{
+    large.reset(new LargeIndex());
+    large->useHashed = false;
+    const int n = numInline;
+    numInline = -1;
+    for ( int i = 0; i < n; i++ ) {
+        insertLarge(inlineLabels[i], inlinePositions[i]);
+    }
+}
+
+void ChildIndex::insertLarge(const int label, const int position)
+{
+    if ( not large->useHashed and (label < 0 or label >= maxDirectLabel) ) {
+        // Switch to the hash table for good
+        for ( int x = 0; x < static_cast<int>(large->direct.size()); x++ ) {
+            if ( large->direct[x] > 0 ) large->hashed.emplace(x, large->direct[x] - 1);
+        }
+        large->direct.clear();
+        large->direct.shrink_to_fit();
+        large->useHashed = true;
+    }
+
+    if ( large->useHashed ) {
+        large->hashed.emplace(label, position);
+        return;
+    }
+    if ( label >= static_cast<int>(large->direct.size()) ) {
+        large->direct.resize(label + 1, 0);
+    }
+    large->direct[label] = position + 1;
+}
+
+void ChildIndex::clear()
+{
+    numInline = 0;
+    large.reset();
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_TREES_CHILDINDEX_H_
+#define FSM_TREES_CHILDINDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+ Class mapping the labels of the outgoing edges of a tree node to the
+ positions of the edges in the node's list of children.
+
+ Most nodes of test trees and output trees have few children, so up
+ to inlineCapacity labels are kept in a small sorted array inside the
+ index, without any heap allocation. Above this fan-out, the labels are
+ looked up in a direct-indexed table as long as they are small
+ non-negative integers, as inputs and outputs usually are, and in a
+ hash table otherwise.
+
+ If several edges carry the same label, as in output trees of
+ non-observable FSMs, the position of the first one is kept.
+ */
+class ChildIndex
+{
+public:
+    /** Maximal number of labels stored inside the index */
+    static const int inlineCapacity = 4;
+
+    /** Labels from 0 to maxDirectLabel-1 can be direct-indexed */
+    static const int maxDirectLabel = 4096;
+
+private:
+    /** Number of labels in inlineLabels, or -1 if large is used */
+    int numInline;
+
+    /** Labels in ascending order and the positions of their edges */
+    int inlineLabels[inlineCapacity];
+    uint16_t inlinePositions[inlineCapacity];
+
+    /** Tables used above the inline capacity */
+    struct LargeIndex {
+        /** direct[x] is the position of the edge labelled x plus one,
+         or 0 if there is none; only used if hashed is empty */
+        std::vector<int> direct;
+        std::unordered_map<int, int> hashed;
+        bool useHashed;
+    };
+    std::unique_ptr<LargeIndex> large;
+
+    /** Move the inline labels into large */
+    void makeLarge();
+
+    void insertLarge(const int label, const int position);
+
+    int findLarge(const int label) const;
+
+public:
+    ChildIndex();
+
+    /**
+     * Return the position of the first edge labelled with label,
+     * or -1 if there is none
+     */
+    int find(const int label) const {
+        if ( numInline >= 0 ) {
+            for ( int i = 0; i < numInline and inlineLabels[i] <= label; i++ ) {
+                if ( inlineLabels[i] == label ) return inlinePositions[i];
+            }
+            return -1;
+        }
+        return findLarge(label);
+    }
+
+    /**
+     * Register an edge labelled with label at the given position,
+     * unless an edge with this label is already registered
+     */
+    void insert(const int label, const int position);
+
+    /** Remove all labels */
+    void clear();
+};
+#endif //FSM_TREES_CHILDINDEX_H_
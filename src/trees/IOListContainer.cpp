@@ -4,6 +4,7 @@
  * Licensed under the EUPL V.1.1
  */
 #include "trees/IOListContainer.h"
+#include <algorithm>
 #include <numeric>
 
 std::vector<int> IOListContainer::nextLst(const int maxInput, const std::vector<int>& lst) const
@@ -20,14 +21,14 @@ std::vector<int> IOListContainer::nextLst(const int maxInput, const std::vector<
 	return returnValue;
 }
 
-IOListContainer::IOListContainer(IOListBaseType const &iolLst, std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: iolLst(iolLst), presentationLayer(std::move(presentationLayer))
+IOListContainer::IOListContainer(IOListBaseType const &iolLst, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: iolLst(iolLst), presentationLayer(presentationLayer)
 {
 
 }
 
-IOListContainer::IOListContainer(const int maxInput, const int minLength, const int maxLenght, std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: presentationLayer(std::move(presentationLayer))
+IOListContainer::IOListContainer(const int maxInput, const int minLength, const int maxLenght, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: presentationLayer(presentationLayer)
 {
 	for (int len = minLength; len <= maxLenght; ++ len)
 	{
@@ -46,12 +47,12 @@ IOListContainer::IOListContainer(const int maxInput, const int minLength, const
 	}
 }
 
-IOListContainer::IOListContainer(std::unique_ptr<FsmPresentationLayer> &&pl)
-: presentationLayer(std::move(pl)) {
+IOListContainer::IOListContainer(const std::shared_ptr<const FsmPresentationLayer>& pl)
+: presentationLayer(pl) {
 }
 
 IOListContainer::IOListContainer(IOListContainer const &other)
-: iolLst(other.iolLst), presentationLayer(other.presentationLayer->clone()) {
+: iolLst(other.iolLst), presentationLayer(other.presentationLayer) {
 }
 
 IOListContainer::IOListBaseType & IOListContainer::getIOLists() {
@@ -63,6 +64,14 @@ void IOListContainer::add(const Trace & trc)
 	iolLst.push_back(trc.get());
 }
 
+void IOListContainer::forEach(const IOListVisitor& visitor) const
+{
+    for (auto const &lst : iolLst)
+    {
+        visitor(lst);
+    }
+}
+
 IOListContainer::size_type IOListContainer::size() const
 {
 	return iolLst.size();
@@ -6,6 +6,7 @@
 #ifndef FSM_TREES_IOLISTCONTAINER_H_
 #define FSM_TREES_IOLISTCONTAINER_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -17,6 +18,19 @@ class IOListContainer
 public:
     typedef std::vector<std::vector<int>> IOListBaseType;
     typedef IOListBaseType::size_type size_type;
+    
+    /**
+     * Visitor called with one input trace at a time. The trace passed
+     * may be a buffer reused for the next trace, so it is only valid
+     * during the call.
+     */
+    typedef std::function<void(const std::vector<int>&)> IOListVisitor;
+    
+    /**
+     * Enumeration of input traces, calling the visitor passed
+     * for every trace in turn
+     */
+    typedef std::function<void(const IOListVisitor&)> IOListSource;
 private:
     /**
      * The input list of this test cases
@@ -26,7 +40,7 @@ private:
     /**
      * The presentation layer used by this test cases
      */
-    std::unique_ptr<FsmPresentationLayer> presentationLayer;
+    std::shared_ptr<const FsmPresentationLayer> presentationLayer;
     
     /**
      * Check whether or not it is the last list
@@ -52,7 +66,7 @@ public:
      * @param iolLst The list of input traces
      * @param presentationLayer The presentation layer to use
      */
-    IOListContainer(IOListBaseType const &iolLst, std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+    IOListContainer(IOListBaseType const &iolLst, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
     
     /**
      * Create an IOListContainer with input traces from length minLength
@@ -67,11 +81,14 @@ public:
     IOListContainer(const int maxInput,
                     const int minLength,
                     const int maxLength,
-                    std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+                    const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
     
-    IOListContainer(std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+    IOListContainer(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
     IOListContainer(IOListContainer const &other);
+    IOListContainer(IOListContainer &&other) = default;
+    IOListContainer& operator=(IOListContainer const &other) = default;
+    IOListContainer& operator=(IOListContainer &&other) = default;
     
     /**
      * Getter for the input list
@@ -84,6 +101,11 @@ public:
      * @param trc The trace to add
      */
     void add(const Trace & trc);
+    
+    /**
+     * Call visitor for every input trace of the IOListContainer, in order
+     */
+    void forEach(const IOListVisitor& visitor) const;
 
     /**
      * Getter for the size of the IOListContainer
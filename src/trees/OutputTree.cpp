@@ -21,15 +21,15 @@ void OutputTree::printChildrenOutput(ostream& out, TreeNode const *top, int &idN
 
 OutputTree::OutputTree(std::unique_ptr<TreeNode> &&root,
                        InputTrace const &inputTrace,
-                       std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: Tree(std::move(root), std::move(presentationLayer)), inputTrace(inputTrace)
+                       const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: Tree(std::move(root), presentationLayer), inputTrace(inputTrace)
 {
 
 }
 
 OutputTree::OutputTree(InputTrace const &inputTrace,
-                       std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: Tree(std::move(presentationLayer)), inputTrace(inputTrace)
+                       const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: Tree(presentationLayer), inputTrace(inputTrace)
 {
 
 }
@@ -38,7 +38,7 @@ std::unique_ptr<OutputTree> OutputTree::clone() const {
 	return std::unique_ptr<OutputTree>(new OutputTree(*this));
 }
 
-InputTrace OutputTree::getInputTrace() const
+InputTrace const &OutputTree::getInputTrace() const
 {
     return inputTrace;
 }
@@ -48,7 +48,7 @@ std::vector<OutputTrace> OutputTree::getOutputTraces() const {
 	std::vector<OutputTrace> traces;
 	traces.reserve(lli.size());
 	for(unsigned int i = 0; i < lli.size(); ++i) {
-		traces.emplace_back(std::move(lli.at(i)), presentationLayer->clone());
+		traces.emplace_back(std::move(lli.at(i)), presentationLayer);
 	}
 	return traces;
 }
@@ -100,7 +100,7 @@ std::vector<IOTrace> OutputTree::toIOTrace() const {
     IOListContainer::IOListBaseType lli = getIOLists().getIOLists();
 	std::vector<IOTrace> result;
     for (vector<int> const &lst : lli) {
-        OutputTrace otrc(lst,presentationLayer->clone());
+        OutputTrace otrc(lst,presentationLayer);
         IOTrace iotrc(inputTrace,otrc);
         result.push_back(iotrc);
     }
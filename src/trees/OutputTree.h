@@ -42,7 +42,7 @@ public:
 	*/
 	OutputTree(std::unique_ptr<TreeNode> &&root,
                InputTrace const &inputTrace,
-               std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+               const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	/**
 	 * Create a new OutputTree
@@ -51,14 +51,14 @@ public:
 	 * @param presentationLayer The presentation layer to use
 	*/
 	OutputTree(InputTrace const &inputTrace,
-               std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+               const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	OutputTree(OutputTree const &other) = default;
 	OutputTree(OutputTree &&other) = default;
 
 	std::unique_ptr<OutputTree> clone() const;
 
-    InputTrace getInputTrace() const;
+    InputTrace const &getInputTrace() const;
 	std::vector<OutputTrace> getOutputTraces() const;
 
 	/**
@@ -0,0 +1,304 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#include <algorithm>
+#include <map>
+
+#include "trees/SuffixSharingTree.h"
+#include "trees/Tree.h"
+
+using namespace std;
+
+namespace {
+
+    /** Key of a pair of nodes in the memo tables */
+    uint64_t pairKey(const int a, const int b)
+    {
+        return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+    }
+
+}
+
+size_t SuffixSharingTree::ChildrenHash::operator()(const Children& children) const
+{
+    uint64_t h = children.size();
+    for ( const auto& c : children ) {
+        h ^= pairKey(c.first, c.second) + 0x9e3779b97f4a7c15ULL + (h << 12) + (h >> 4);
+    }
+    return static_cast<size_t>(h);
+}
+
+SuffixSharingTree::SuffixSharingTree(const shared_ptr<const FsmPresentationLayer>& presentationLayer)
+: root(leaf), presentationLayer(presentationLayer)
+{
+    makeNode(Children());
+}
+
+SuffixSharingTree::SuffixSharingTree(const Tree& tree)
+: SuffixSharingTree(tree.getPresentationLayer())
+{
+    root = makeNode(tree.getRoot());
+}
+
+int SuffixSharingTree::makeNode(Children&& children)
+{
+    auto ins = uniqueNodes.emplace(std::move(children), static_cast<int>(nodes.size()));
+    if ( ins.second ) {
+        nodes.push_back(&ins.first->first);
+    }
+    return ins.first->second;
+}
+
+int SuffixSharingTree::makeNode(const TreeNode *n)
+{
+    Children children;
+    for ( auto const &e : n->getChildren() ) {
+        children.emplace_back(e->getIO(), makeNode(e->getTarget()));
+    }
+    return makeNode(std::move(children));
+}
+
+int SuffixSharingTree::makeTrie(const IOListContainer& tcl)
+{
+    Tree trie(presentationLayer);
+    trie.addToRoot(tcl);
+    return makeNode(trie.getRoot());
+}
+
+int SuffixSharingTree::copyNode(const SuffixSharingTree& other, const int m,
+                                vector<int>& memo)
+{
+    if ( memo[m] >= 0 ) return memo[m];
+
+    Children children(*other.nodes[m]);
+    for ( auto& c : children ) {
+        c.second = copyNode(other, c.second, memo);
+    }
+    memo[m] = makeNode(std::move(children));
+    return memo[m];
+}
+
+int SuffixSharingTree::merge(const int a, const int b,
+                             unordered_map<uint64_t, int>& memo)
+{
+    if ( b == leaf or a == b ) return a;
+    if ( a == leaf ) return b;
+
+    auto it = memo.find(pairKey(a, b));
+    if ( it != memo.end() ) return it->second;
+
+    // The children of a keep their positions, children of b with new
+    // labels are appended in their order, as TreeNode::add() does
+    const Children& childrenB = *nodes[b];
+    Children children(*nodes[a]);
+    const size_t numChildrenA = children.size();
+    for ( const auto& cb : childrenB ) {
+        size_t i = 0;
+        while ( i < numChildrenA and children[i].first != cb.first ) i++;
+        if ( i < numChildrenA ) {
+            children[i].second = merge(children[i].second, cb.second, memo);
+        }
+        else {
+            children.push_back(cb);
+        }
+    }
+
+    int result = makeNode(std::move(children));
+    memo[pairKey(a, b)] = result;
+    return result;
+}
+
+int SuffixSharingTree::addEverywhere(const int n, const int trie,
+                                     vector<int>& memo,
+                                     unordered_map<uint64_t, int>& mergeMemo)
+{
+    if ( memo[n] >= 0 ) return memo[n];
+
+    // First delegate the work to the children, then append the trie
+    // to this node
+    Children children(*nodes[n]);
+    for ( auto& c : children ) {
+        c.second = addEverywhere(c.second, trie, memo, mergeMemo);
+    }
+    memo[n] = merge(makeNode(std::move(children)), trie, mergeMemo);
+    return memo[n];
+}
+
+int SuffixSharingTree::calcMinLeafDepth(const int n, vector<int>& memo) const
+{
+    if ( memo[n] >= 0 ) return memo[n];
+
+    int depth = 0;
+    if ( n != leaf ) {
+        depth = -1;
+        for ( const auto& c : *nodes[n] ) {
+            int d = calcMinLeafDepth(c.second, memo) + 1;
+            if ( depth < 0 or d < depth ) depth = d;
+        }
+    }
+    memo[n] = depth;
+    return depth;
+}
+
+int SuffixSharingTree::reorderBreadthFirst(const int n,
+                                           vector<int>& memo,
+                                           vector<int>& minLeafDepth)
+{
+    if ( memo[n] >= 0 ) return memo[n];
+
+    // Leaves are visited level by level, so that the children of a node
+    // are inserted in the order of their shallowest leaves
+    Children children(*nodes[n]);
+    stable_sort(children.begin(), children.end(),
+                [this, &minLeafDepth](const pair<int, int>& c1, const pair<int, int>& c2) {
+                    return calcMinLeafDepth(c1.second, minLeafDepth)
+                         < calcMinLeafDepth(c2.second, minLeafDepth);
+                });
+    for ( auto& c : children ) {
+        c.second = reorderBreadthFirst(c.second, memo, minLeafDepth);
+    }
+    memo[n] = makeNode(std::move(children));
+    return memo[n];
+}
+
+int SuffixSharingTree::addAfter(const int n,
+                                vector<int>::const_iterator lstIte,
+                                const vector<int>::const_iterator end,
+                                const int trie,
+                                unordered_map<uint64_t, int>& mergeMemo)
+{
+    if ( lstIte == end ) return merge(n, trie, mergeMemo);
+
+    Children children(*nodes[n]);
+    for ( auto& c : children ) {
+        if ( c.first == *lstIte ) {
+            int target = addAfter(c.second, lstIte + 1, end, trie, mergeMemo);
+            if ( target < 0 ) return -1;
+            c.second = target;
+            return makeNode(std::move(children));
+        }
+    }
+
+    /*Could not find an edge labelled by *lstIte*/
+    return -1;
+}
+
+void SuffixSharingTree::add(const IOListContainer& tcl)
+{
+    int trie = makeTrie(tcl);
+    vector<int> memo(nodes.size(), -1);
+    unordered_map<uint64_t, int> mergeMemo;
+    root = addEverywhere(root, trie, memo, mergeMemo);
+}
+
+void SuffixSharingTree::addToRoot(const IOListContainer& tcl)
+{
+    unordered_map<uint64_t, int> mergeMemo;
+    root = merge(root, makeTrie(tcl), mergeMemo);
+}
+
+void SuffixSharingTree::addAfter(const vector<int>& tr, const IOListContainer& cnt)
+{
+    unordered_map<uint64_t, int> mergeMemo;
+    int n = addAfter(root, tr.cbegin(), tr.cend(), makeTrie(cnt), mergeMemo);
+    if ( n >= 0 ) {
+        root = n;
+    }
+}
+
+void SuffixSharingTree::addAfterLeaves(const vector<int>& rootKey,
+                                       const function<vector<int>(const vector<int>&, const int)>& step,
+                                       const function<IOListContainer(const vector<int>&)>& suffixes)
+{
+    // Subtrees reached with equal keys are equal after appending
+    map<pair<int, vector<int>>, int> memo;
+    map<vector<int>, int> tries;
+
+    function<int(const int, const vector<int>&)> addAfterLeavesOf =
+    [this, &step, &suffixes, &memo, &tries, &addAfterLeavesOf](const int n, const vector<int>& key) {
+        if ( n == leaf ) {
+            auto it = tries.find(key);
+            if ( it == tries.end() ) {
+                it = tries.emplace(key, makeTrie(suffixes(key))).first;
+            }
+            return it->second;
+        }
+
+        auto it = memo.find(make_pair(n, key));
+        if ( it != memo.end() ) return it->second;
+
+        Children children(*nodes[n]);
+        for ( auto& c : children ) {
+            c.second = addAfterLeavesOf(c.second, step(key, c.first));
+        }
+        int result = makeNode(std::move(children));
+        memo.emplace(make_pair(n, key), result);
+        return result;
+    };
+
+    root = addAfterLeavesOf(root, rootKey);
+}
+
+void SuffixSharingTree::unionTree(const SuffixSharingTree& otherTree)
+{
+    vector<int> copyMemo(otherTree.nodes.size(), -1);
+    copyMemo[leaf] = leaf;
+    int otherRoot = copyNode(otherTree, otherTree.root, copyMemo);
+
+    vector<int> reorderMemo(nodes.size(), -1);
+    vector<int> minLeafDepth(nodes.size(), -1);
+    otherRoot = reorderBreadthFirst(otherRoot, reorderMemo, minLeafDepth);
+
+    unordered_map<uint64_t, int> mergeMemo;
+    root = merge(root, otherRoot, mergeMemo);
+}
+
+void SuffixSharingTree::forEachIOList(const int n, vector<int>& path,
+                                      const IOListContainer::IOListVisitor& visitor) const
+{
+    if ( n == leaf ) {
+        visitor(path);
+        return;
+    }
+    for ( const auto& c : *nodes[n] ) {
+        path.push_back(c.first);
+        forEachIOList(c.second, path, visitor);
+        path.pop_back();
+    }
+}
+
+void SuffixSharingTree::forEachIOList(const IOListContainer::IOListVisitor& visitor) const
+{
+    vector<int> path;
+    forEachIOList(root, path, visitor);
+}
+
+IOListContainer SuffixSharingTree::getIOLists() const
+{
+    IOListContainer result(presentationLayer);
+    IOListContainer::IOListBaseType& ioll = result.getIOLists();
+    forEachIOList([&ioll](const vector<int>& lst) {
+        ioll.push_back(lst);
+    });
+    return result;
+}
+
+size_t SuffixSharingTree::calcSize(const int n, vector<size_t>& memo) const
+{
+    if ( memo[n] > 0 ) return memo[n];
+
+    size_t theSize = 1;
+    for ( const auto& c : *nodes[n] ) {
+        theSize += calcSize(c.second, memo);
+    }
+    memo[n] = theSize;
+    return theSize;
+}
+
+size_t SuffixSharingTree::size() const
+{
+    vector<size_t> memo(nodes.size(), 0);
+    return calcSize(root, memo);
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright. Gaël Dottel, Christoph Hilken, and Jan Peleska 2016 - 2021
+ *
+ * Licensed under the EUPL V.1.1
+ */
+#ifndef FSM_TREES_SUFFIXSHARINGTREE_H_
+#define FSM_TREES_SUFFIXSHARINGTREE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "interface/FsmPresentationLayer.h"
+#include "trees/IOListContainer.h"
+
+class Tree;
+class TreeNode;
+
+/**
+ Class representing an input tree as a directed acyclic graph in which
+ identical subtrees are shared.
+
+ Test suites like V.Sigma^k.W append the same input traces to a large
+ number of tree nodes, so that most of the nodes of a Tree are roots of
+ identical subtrees. Here, every node is hash-consed: nodes with the
+ same labelled children are stored once, and the operations below
+ create new nodes instead of modifying existing ones. The number of
+ nodes stored therefore grows with the number of distinct subtrees
+ instead of the number of nodes of the tree represented.
+
+ The operations have the same effect as the Tree operations of the
+ same names, including the order of the children, so that getIOLists()
+ enumerates the same test cases in the same order as the Tree would.
+ As in input trees, the labels of the children of a node must be distinct.
+ */
+class SuffixSharingTree
+{
+private:
+    /** Labels and nodes of the children of a node, in the order of insertion */
+    typedef std::vector<std::pair<int, int>> Children;
+
+    struct ChildrenHash {
+        size_t operator()(const Children& children) const;
+    };
+
+    /** All nodes created so far, mapped to their numbers */
+    std::unordered_map<Children, int, ChildrenHash> uniqueNodes;
+
+    /** nodes[n] points to the children of node n in uniqueNodes */
+    std::vector<const Children*> nodes;
+
+    /** Node 0 is the only leaf */
+    static const int leaf = 0;
+
+    /** The root of the tree */
+    int root;
+
+    /** The presentation layer used by this tree */
+    std::shared_ptr<const FsmPresentationLayer> presentationLayer;
+
+    /** Return the node with the given children, creating it if necessary */
+    int makeNode(Children&& children);
+
+    /** Return the node representing the subtree of a Tree node */
+    int makeNode(const TreeNode *n);
+
+    /** Return the node representing the tree of the traces of tcl */
+    int makeTrie(const IOListContainer& tcl);
+
+    /** Return the node of this tree representing node m of other */
+    int copyNode(const SuffixSharingTree& other, const int m,
+                 std::vector<int>& memo);
+
+    /**
+     * Return the node representing the tree obtained by adding every
+     * trace of the tree represented by b to the tree represented by a
+     */
+    int merge(const int a, const int b,
+              std::unordered_map<uint64_t, int>& memo);
+
+    /** Append the tree represented by trie to every node below n */
+    int addEverywhere(const int n, const int trie,
+                      std::vector<int>& memo,
+                      std::unordered_map<uint64_t, int>& mergeMemo);
+
+    /**
+     * Return the node representing the tree obtained by inserting the
+     * leaves of n in breadth-first order into an empty tree. This is the
+     * order in which Tree::unionTree() inserts the traces of a tree.
+     */
+    int reorderBreadthFirst(const int n,
+                            std::vector<int>& memo,
+                            std::vector<int>& minLeafDepth);
+
+    int calcMinLeafDepth(const int n, std::vector<int>& memo) const;
+
+    int addAfter(const int n,
+                 std::vector<int>::const_iterator lstIte,
+                 const std::vector<int>::const_iterator end,
+                 const int trie,
+                 std::unordered_map<uint64_t, int>& mergeMemo);
+
+    void forEachIOList(const int n, std::vector<int>& path,
+                       const IOListContainer::IOListVisitor& visitor) const;
+
+    size_t calcSize(const int n, std::vector<size_t>& memo) const;
+
+public:
+    /**
+     * Create a tree consisting of the root only
+     * @param presentationLayer The presentation layer to use
+     */
+    explicit SuffixSharingTree(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
+
+    /**
+     * Create a tree representing the same input traces as a Tree
+     * @param tree Input tree whose nodes have children with distinct labels
+     */
+    explicit SuffixSharingTree(const Tree& tree);
+
+    SuffixSharingTree(const SuffixSharingTree& other) = delete;
+    SuffixSharingTree& operator=(const SuffixSharingTree& other) = delete;
+    SuffixSharingTree(SuffixSharingTree&& other) = default;
+
+    /**
+     * Append a list of input traces to EVERY node of the tree,
+     * as Tree::add() does
+     */
+    void add(const IOListContainer& tcl);
+
+    /**
+     * Insert a list of input traces at the root of the tree,
+     * as Tree::addToRoot() does
+     */
+    void addToRoot(const IOListContainer& tcl);
+
+    /**
+     * Append a list of input traces to the node reached by the
+     * input trace tr, as Tree::addAfter() does. If tr does not lead
+     * to a node of the tree, nothing is changed.
+     */
+    void addAfter(const std::vector<int>& tr, const IOListContainer& cnt);
+
+    /**
+     * Append a list of input traces to every leaf of the tree, as
+     * if addAfter() was called for every maximal trace of the tree.
+     * The list appended to a leaf may only depend on an abstraction of
+     * its trace, e.g. the FSM states reached by the trace, which is
+     * calculated from the root along the trace.
+     * @param rootKey  Abstraction of the empty trace
+     * @param step     step(key, x) is the abstraction of tr.x, if key
+     *                 is the abstraction of tr
+     * @param suffixes suffixes(key) is the list appended to the leaves
+     *                 whose traces have the abstraction key. It is called
+     *                 once for every key.
+     */
+    void addAfterLeaves(const std::vector<int>& rootKey,
+                        const std::function<std::vector<int>(const std::vector<int>&, const int)>& step,
+                        const std::function<IOListContainer(const std::vector<int>&)>& suffixes);
+
+    /**
+     * Construct the union of this tree and otherTree by adding every
+     * maximal input trace of otherTree to this tree, as
+     * Tree::unionTree() does
+     */
+    void unionTree(const SuffixSharingTree& otherTree);
+
+    /**
+     * Get the maximal input traces of the tree, in the depth-first
+     * order in which Tree::getIOLists() returns them for a non-const Tree
+     */
+    IOListContainer getIOLists() const;
+
+    /**
+     * Call visitor for every maximal input trace of the tree, in the
+     * order of getIOLists(). The test cases are expanded one at a time,
+     * so that only the trace currently visited is held in memory.
+     * @param visitor called with a buffer which is reused for the next trace
+     */
+    void forEachIOList(const IOListContainer::IOListVisitor& visitor) const;
+
+    /** Return the number of nodes of the tree represented */
+    size_t size() const;
+
+    /** Return the number of distinct subtrees stored */
+    size_t getNumStoredNodes() const { return nodes.size(); }
+};
+#endif //FSM_TREES_SUFFIXSHARINGTREE_H_
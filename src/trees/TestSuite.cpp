@@ -72,7 +72,7 @@ bool TestSuite::isReductionOf(TestSuite const &theOtherTs,
 
 ostream & operator<<(ostream & out, const TestSuite & testSuite)
 {
-	for (OutputTree ot : testSuite)
+	for (OutputTree const &ot : testSuite)
 	{
 		out << ot;
 	}
@@ -81,21 +81,38 @@ ostream & operator<<(ostream & out, const TestSuite & testSuite)
 
 void TestSuite::save(const std::string &name) {
     
+    save(name, [this](const OutputTreeVisitor &visitor) {
+        forEach(visitor);
+    });
+    
+}
+
+void TestSuite::save(const std::string &name, const OutputTreeSource &testSuite) {
+    
     ofstream out(name);
     
-    out << *this;
+    testSuite([&out](const OutputTree &ot) {
+        out << ot;
+    });
     
     out.close();
     
 }
 
+void TestSuite::forEach(const OutputTreeVisitor &visitor) const
+{
+    for (OutputTree const &ot : *this)
+    {
+        visitor(ot);
+    }
+}
+
 size_t TestSuite::totalLength() const
 {
     size_t length = 0;
-    for(unsigned i = 0; i < this->size(); ++i)
+    for(OutputTree const &o : *this)
     {
-        OutputTree const &o = this->at(i);
-        length += o.getInputTrace().get().size();
+        length += o.getInputTrace().size();
     }
     return length;
 }
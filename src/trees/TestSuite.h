@@ -6,6 +6,7 @@
 #ifndef FSM_TREES_TESTSUITE_H_
 #define FSM_TREES_TESTSUITE_H_
 
+#include <functional>
 #include <ostream>
 #include <vector>
 
@@ -15,6 +16,18 @@
 class TestSuite : public std::vector<OutputTree>
 {
 public:
+    /**
+     * Visitor called with one output tree of a test suite at a time.
+     * The output tree is only valid during the call.
+     */
+    typedef std::function<void(const OutputTree&)> OutputTreeVisitor;
+    
+    /**
+     * Enumeration of the output trees of a test suite, calling the
+     * visitor passed for every output tree in turn
+     */
+    typedef std::function<void(const OutputTreeVisitor&)> OutputTreeSource;
+    
    /**
 	* Create a new empty test suite
 	*/
@@ -58,7 +71,20 @@ public:
     void save(const std::string &name);
 
     /**
-     * @return The sum of all test case sizes in this test suite
+     *   Save the output trees enumerated by testSuite to file, using
+     *   the format of the << operator. The output trees are written
+     *   one at a time, so that the test suite is never held in memory.
+     */
+    static void save(const std::string &name, const OutputTreeSource &testSuite);
+    
+    /**
+     *  Call visitor for every output tree of this test suite, in order
+     */
+    void forEach(const OutputTreeVisitor &visitor) const;
+
+    /**
+     * @return The sum of all test case sizes in this test suite,
+     *         calculated in time linear in the number of test cases
      */
     size_t totalLength() const;
 };
@@ -5,24 +5,30 @@
  */
 #include "trees/Tree.h"
 
-void Tree::calcLeaves()
-{
-	leaves.clear();
-	root->calcLeaves(leaves);
-}
-
 void Tree::remove(TreeNode *thisNode, TreeNode const *otherNode)
 {
-	thisNode->deleteNode();
-
+	// Collect the corresponding children first, since removing
+	// a subtree modifies the list of children of thisNode
+	std::vector<std::pair<TreeNode*, TreeNode const*>> matches;
 	for (auto const &e : thisNode->getChildren())
 	{
 		TreeEdge *eOther = otherNode->hasEdge(e.get());
 		if (eOther != nullptr)
 		{
-			remove(e->getTarget(), eOther->getTarget());
+			matches.emplace_back(e->getTarget(), eOther->getTarget());
 		}
 	}
+
+	for (auto const &m : matches)
+	{
+		remove(m.first, m.second);
+	}
+
+	// Nodes which have become leaves are removed, the root is kept
+	if (thisNode->isLeaf() && thisNode->getParent() != nullptr)
+	{
+		thisNode->deleteSingleNode();
+	}
 }
 
 void Tree::printChildren(std::ostream & out, const TreeNode *top, int &idNode) const
@@ -49,20 +55,20 @@ bool Tree::inPrefixRelation(std::vector<int> aPath, std::vector<int> bPath) cons
     return true;
 }
 
-Tree::Tree(std::unique_ptr<TreeNode> &&root, std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: root(std::move(root)), presentationLayer(std::move(presentationLayer))
+Tree::Tree(std::unique_ptr<TreeNode> &&root, const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: root(std::move(root)), presentationLayer(presentationLayer)
 {
 
 }
 
-Tree::Tree(std::unique_ptr<FsmPresentationLayer> &&presentationLayer)
-	: root(new TreeNode()), presentationLayer(std::move(presentationLayer))
+Tree::Tree(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer)
+	: root(new TreeNode()), presentationLayer(presentationLayer)
 {
 
 }
 
 Tree::Tree(Tree const &other)
-    : root(other.root->clone()), presentationLayer(other.presentationLayer->clone()) {
+    : root(other.root->clone()), presentationLayer(other.presentationLayer) {
 }
 
 std::unique_ptr<Tree> Tree::clone() const {
@@ -71,30 +77,42 @@ std::unique_ptr<Tree> Tree::clone() const {
 
 std::vector<TreeNode*> Tree::getLeaves()
 {
-	calcLeaves();
+	std::vector<TreeNode*> leaves;
+	leaves.reserve(root->getNumLeaves());
+	root->calcLeaves(leaves);
 	return leaves;
 }
 
 std::vector<TreeNode*> Tree::getLeaves() const
 {
-    std::deque<TreeNode*> worklist;
-    worklist.push_back(root.get());
     std::vector<TreeNode*> leaves;
-    while(!worklist.empty()) {
-        TreeNode *front = worklist.front();
-        worklist.pop_front();
-        if(front->getChildren().size() == 0) {
-            leaves.push_back(front);
-        } else {
-            std::transform(front->getChildren().begin(), front->getChildren().end(),
-                           std::back_inserter(worklist), [](std::unique_ptr<TreeEdge> const &edge){
-                return edge->getTarget();
-            });
+    leaves.reserve(root->getNumLeaves());
+    
+    // A breadth-first traversal, one level at a time, visits the
+    // leaves of the same depth from left to right
+    std::vector<TreeNode*> level { root.get() };
+    std::vector<TreeNode*> nextLevel;
+    while (not level.empty()) {
+        for (TreeNode *n : level) {
+            if (n->isLeaf()) {
+                leaves.push_back(n);
+                continue;
+            }
+            for (auto const &e : n->getChildren()) {
+                nextLevel.push_back(e->getTarget());
+            }
         }
+        level.swap(nextLevel);
+        nextLevel.clear();
     }
 	return leaves;
 }
 
+size_t Tree::getNumLeaves() const
+{
+    return root->getNumLeaves();
+}
+
 TreeNode* Tree::getRoot() const
 {
 	return root.get();
@@ -103,7 +121,7 @@ TreeNode* Tree::getRoot() const
 std::unique_ptr<Tree> Tree::getSubTree(const InputTrace *alpha) const {
     TreeNode *afterAlpha = root->after(alpha->cbegin(), alpha->cend());
     std::unique_ptr<TreeNode> cpyNode { afterAlpha->clone() };
-    return std::unique_ptr<Tree> { new Tree(std::move(cpyNode), std::move(presentationLayer->clone())) };
+    return std::unique_ptr<Tree> { new Tree(std::move(cpyNode), presentationLayer) };
 }
 
 TreeNode* Tree::getSubTree( std::vector<int> const *alpha) const {
@@ -113,43 +131,53 @@ TreeNode* Tree::getSubTree( std::vector<int> const *alpha) const {
 
 IOListContainer Tree::getIOLists()
 {
-    auto leaves = getLeaves();
-    IOListContainer::IOListBaseType ioll;
-    ioll.reserve(leaves.size());
-
-	for (TreeNode *n : leaves)
-	{
-		ioll.emplace_back(std::move(n->getPath()));
-	}
-
-	return IOListContainer(ioll, presentationLayer->clone());
+    IOListContainer result(presentationLayer);
+    IOListContainer::IOListBaseType &ioll = result.getIOLists();
+    forEachIOList([&ioll](const std::vector<int> &lst) {
+        ioll.push_back(lst);
+    });
+	return result;
 }
 
 IOListContainer Tree::getIOLists() const {
-    auto leaves = getLeaves();
-    IOListContainer::IOListBaseType ioll;
-    ioll.reserve(leaves.size());
+    IOListContainer result(presentationLayer);
+    IOListContainer::IOListBaseType &ioll = result.getIOLists();
+    ioll.reserve(root->getNumLeaves());
+    forEachIOList([&ioll](const std::vector<int> &lst) {
+        ioll.push_back(lst);
+    });
+
+    // The lists are returned in the breadth-first order of getLeaves(),
+    // which orders the leaves of the same depth as the depth-first order
+    std::stable_sort(ioll.begin(), ioll.end(),
+                     [](std::vector<int> const &a, std::vector<int> const &b) {
+        return a.size() < b.size();
+    });
+	return result;
+}
 
-	for (TreeNode *n : leaves)
-	{
-		ioll.emplace_back(std::move(n->getPath()));
-	}
+IOListContainer Tree::getIOListsWithPrefixes() const
+{
+    IOListContainer result(presentationLayer);
+    IOListContainer::IOListBaseType &ioll = result.getIOLists();
+    forEachIOListWithPrefixes([&ioll](const std::vector<int> &lst) {
+        ioll.push_back(lst);
+    });
+    return result;
+}
 
-	return IOListContainer(ioll, presentationLayer->clone());
+void Tree::forEachIOList(const IOListContainer::IOListVisitor& visitor) const
+{
+    std::vector<int> path;
+    root->forEachLeafPath(path, visitor);
 }
 
-IOListContainer Tree::getIOListsWithPrefixes() const
+void Tree::forEachIOListWithPrefixes(const IOListContainer::IOListVisitor& visitor) const
 {
-    IOListContainer::IOListBaseType ioll;
-    
-    // Create empty I/O-list as vector
-    std::vector<int> thisVec; 
-    
-    // Perform in-order traversal of the tree
-    // and create all I/O-lists.
-    root->traverse(thisVec, ioll);
-    
-    return IOListContainer(ioll, presentationLayer->clone());
+    // Perform in-order traversal of the tree,
+    // starting with the empty I/O-list
+    std::vector<int> path;
+    root->forEachPath(path, visitor);
 }
 
 void Tree::remove(Tree const *otherTree)
@@ -205,9 +233,11 @@ void Tree::addAfter(const InputTrace & tr, const IOListContainer & cnt)
 
 
 size_t Tree::size() const {
-    size_t theSize = 0;
-    root->calcSize(theSize);
-    return theSize;
+    return root->getNumNodes();
+}
+
+size_t Tree::totalLength() const {
+    return root->getLeafDepthSum();
 }
 
 std::unique_ptr<Tree> Tree::getPrefixRelationTree(Tree const *b) const {
@@ -217,7 +247,7 @@ std::unique_ptr<Tree> Tree::getPrefixRelationTree(Tree const *b) const {
     auto const &aPrefixes = aIOlst.getIOLists();
     auto const &bPrefixes = bIOlst.getIOLists();
 
-    std::unique_ptr<Tree> tree { new Tree(presentationLayer->clone()) };
+    std::unique_ptr<Tree> tree { new Tree(presentationLayer) };
 
     if (aPrefixes.at(0).size() == 0 && bPrefixes.at(0).size() == 0) {
         return tree;
@@ -25,20 +25,10 @@ protected:
 	*/
 	std::unique_ptr<TreeNode> root;
 
-	/**
-	The list of the leaves of this tree (empty, unless you call calcleaves)
-	*/
-	std::vector<TreeNode*> leaves;
-
 	/**
 	The presentation layer used by this tree
 	*/
-	const std::unique_ptr<FsmPresentationLayer> presentationLayer;
-
-	/**
-	 * Calculate the leaves of the tree, calling calcLeaves on the root of the tree
-	 */
-	void calcLeaves();
+	const std::shared_ptr<const FsmPresentationLayer> presentationLayer;
 
 	//TODO
 	void remove(TreeNode *thisNode,
@@ -63,14 +53,14 @@ public:
 	@param presentationLayer The presentation layer to use
 	*/
 	Tree(std::unique_ptr<TreeNode> &&root,
-         std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+         const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	/**
 	Create a new tree, with a root and a presentation layer
 	@param root  root of the tree
 	@param presentationLayer The presentation layer to use
 	*/
-	Tree(std::unique_ptr<FsmPresentationLayer> &&presentationLayer);
+	Tree(const std::shared_ptr<const FsmPresentationLayer>& presentationLayer);
 
 	Tree(Tree const &other);
 	Tree(Tree &&other) = default;
@@ -78,18 +68,33 @@ public:
 	std::unique_ptr<Tree> clone() const;
 
 	/**
-	Calculate the leaves, then give the leaves back
-	@return The leaves of this tree
+	Give the leaves back. The leaves are maintained by the tree nodes
+	while the tree is changed, so that this takes time linear in the
+	number of leaves.
+	@return The leaves of this tree, in depth-first order for a non-const
+	tree and in breadth-first order for a const tree
 	*/
 	std::vector<TreeNode*> getLeaves();
 	std::vector<TreeNode*> getLeaves() const;
 
+	/**
+	Return the number of leaves of this tree, which is the number
+	of I/O lists returned by getIOLists()
+	*/
+	size_t getNumLeaves() const;
+
 	/**
 	Getter for the root of this tree
 	@return The root of this tree
 	*/
 	TreeNode *getRoot() const;
 
+	/**
+	Getter for the presentation layer
+	@return The presentation layer used by this tree
+	*/
+	const std::shared_ptr<const FsmPresentationLayer>& getPresentationLayer() const { return presentationLayer; }
+
 	/**
      * Get vector of all I/O lists in the tree.
      * Each list is represented as a vector.
@@ -112,11 +117,24 @@ public:
      */
     IOListContainer getIOListsWithPrefixes() const;
 
+    /**
+     * Call visitor for every I/O list of the tree, in the order of
+     * getIOLists(). Only the list currently visited is held in memory.
+     * @param visitor called with a buffer which is reused for the next list
+     */
+    void forEachIOList(const IOListContainer::IOListVisitor& visitor) const;
+    
+    /**
+     * Call visitor for every I/O list of the tree including all
+     * prefixes, in the order of getIOListsWithPrefixes()
+     */
+    void forEachIOListWithPrefixes(const IOListContainer::IOListVisitor& visitor) const;
+
 	/**
 	Special remove operation.
-	@param otherTree For all edges in otherTree that correspond to
-	an edge in this tree, the corresponding source
-	node and target node in this tree are marked as deleted.
+	@param otherTree Every leaf of this tree which also occurs in
+	otherTree is removed, together with the nodes which become
+	leaves by this. The root is kept.
 	*/
 	void remove(Tree const *otherTree);
 
@@ -163,6 +181,12 @@ public:
     
     /** Return number of nodes in the tree */
     size_t size() const;
+    
+    /**
+     * Return the sum of the lengths of the I/O lists returned by
+     * getIOLists(), i.e. the total length of the test cases of a test tree
+     */
+    size_t totalLength() const;
 
     /**
      *  Construct a pseudo-intersection tree of this Tree and b.
@@ -6,14 +6,18 @@
 #include "trees/TreeEdge.h"
 #include "trees/TreeNode.h"
 
-TreeEdge::TreeEdge(const int io, std::unique_ptr<TreeNode> &&target)
-	: io(io), target(std::move(target))
+TreeEdge::TreeEdge(const int io)
+	: io(io)
 {
 
 }
 
 TreeEdge::TreeEdge(TreeEdge const &other)
-    : io(other.io), target(other.target->clone()) {
+    : io(other.io), target(other.target) {
+}
+
+TreeEdge::TreeEdge(TreeEdge const &other, TreeNode **firstLeaf, TreeNode **lastLeaf)
+    : io(other.io), target(other.target, firstLeaf, lastLeaf) {
 }
 
 std::unique_ptr<TreeEdge> TreeEdge::clone() {
@@ -27,5 +31,5 @@ int TreeEdge::getIO() const
 
 TreeNode * TreeEdge::getTarget() const
 {
-	return target.get();
+	return const_cast<TreeNode*>(&target);
 }
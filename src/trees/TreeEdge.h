@@ -8,8 +8,14 @@
 
 #include <memory>
 
-class TreeNode;
+#include "trees/TreeNode.h"
 
+/**
+ An edge of a tree, together with its target node. Edge and target are
+ stored in a single object, so that the target node is neither allocated
+ nor accessed separately. The address of the target is fixed for the
+ lifetime of the edge.
+ */
 class TreeEdge
 {
 private:
@@ -21,17 +27,26 @@ private:
 	/**
 	The target of this tree edge
 	*/
-	std::unique_ptr<TreeNode> target;
+	TreeNode target;
 public:
 	/**
-	Create a new tree edge
+	Create a new tree edge leading to a new leaf
 	@param io The input or output of this tree edge
-	@param target The target of this tree edge
 	*/
-	TreeEdge(const int io, std::unique_ptr<TreeNode> &&target);
+	explicit TreeEdge(const int io);
 
+	/**
+	Create a copy of an edge and of the subtree of its target
+	*/
 	TreeEdge(TreeEdge const &other);
 
+	/**
+	Create a copy of an edge and of the subtree of its target
+	@param firstLeaf set to the first leaf of the copied subtree
+	@param lastLeaf set to the last leaf of the copied subtree
+	*/
+	TreeEdge(TreeEdge const &other, TreeNode **firstLeaf, TreeNode **lastLeaf);
+
     /**
      * Create and return a copy of this Edge
      */
@@ -11,18 +11,41 @@
 using namespace std;
 
 TreeNode::TreeNode()
-: parent(nullptr), deleted(false) {
+: parent(nullptr), deleted(false),
+  numNodes(1), numLeaves(1), leafDepthSum(0),
+  prevLeaf(nullptr), nextLeaf(nullptr) {
 }
 
-TreeNode::TreeNode(TreeNode const &other) {
+TreeNode::TreeNode(TreeNode const &other)
+: TreeNode(other, nullptr, nullptr) {
+}
+
+TreeNode::TreeNode(TreeNode const &other, TreeNode **firstLeaf, TreeNode **lastLeaf)
+: parent(nullptr), deleted(other.deleted),
+  numNodes(other.numNodes), numLeaves(other.numLeaves), leafDepthSum(other.leafDepthSum),
+  prevLeaf(nullptr), nextLeaf(nullptr) {
     children.reserve(other.children.size());
 
+    // The copied subtrees have the counters of the original ones,
+    // only their leaves have to be linked. Every copied subtree
+    // reports its first and last leaf.
+    TreeNode *first = other.children.empty() ? this : nullptr;
+    TreeNode *last = first;
     for(auto const &child : other.children) {
-        children.emplace_back(child->clone());
+        TreeNode *childFirst;
+        TreeNode *childLast;
+        children.emplace_back(new TreeEdge(*child, &childFirst, &childLast));
         children.back()->getTarget()->setParent(this);
+        linkLeaves(last, childFirst);
+        if ( first == nullptr ) first = childFirst;
+        last = childLast;
     }
     updateChildIndex();
-    parent = nullptr;
+    if ( firstLeaf != nullptr ) *firstLeaf = first;
+    if ( lastLeaf != nullptr ) *lastLeaf = last;
+}
+
+TreeNode::~TreeNode() {
 }
 
 std::unique_ptr<TreeNode> TreeNode::clone() const {
@@ -31,11 +54,16 @@ std::unique_ptr<TreeNode> TreeNode::clone() const {
 
 void TreeNode::updateChildIndex() {
     childIndex.clear();
-    for(auto const &child : children) {
-        childIndex.emplace_back(std::pair<TreeNode const*, TreeEdge const*>(child->getTarget(), child.get()));
+    for (size_t i = 0; i < children.size(); ++ i) {
+        childIndex.insert(children[i]->getIO(), static_cast<int>(i));
     }
 }
 
+TreeEdge *TreeNode::findEdge(const int io) const {
+    int i = childIndex.find(io);
+    return i < 0 ? nullptr : children[i].get();
+}
+
 void TreeNode::setParent(TreeNode *pparent) {
     parent = pparent;
 }
@@ -47,7 +75,7 @@ TreeNode * TreeNode::getParent() const {
 void TreeNode::deleteSingleNode() {
     deleted = true;
     
-    children.clear();
+    clearChildren();
 
     TreeNode const *c = this;
     TreeNode *t = parent;
@@ -60,11 +88,15 @@ void TreeNode::deleteSingleNode() {
 void TreeNode::deleteNode() {
     deleted = true;
     
-    children.clear();
+    clearChildren();
     
     TreeNode const *c = this;
     TreeNode *t = parent;
 
+    if(t == nullptr) {
+        return;
+    }
+
     if(t->getChildren().size() == 1) {
         t->deleteNode();
         return;
@@ -87,26 +119,126 @@ void TreeNode::remove(TreeNode const *node) {
     auto edgeToRemove = std::find_if(children.begin(), children.end(), [node](std::unique_ptr<TreeEdge> const &edge){
         return edge->getTarget() == node;
     });
+    
+    // Unlink the leaves of the subtree, this node takes their
+    // place if it becomes a leaf
+    TreeNode *prev = node->getFirstLeaf()->prevLeaf;
+    TreeNode *next = node->getLastLeaf()->nextLeaf;
+    const bool becomesLeaf = children.size() == 1;
+    if ( becomesLeaf ) {
+        linkLeaves(prev, this);
+        linkLeaves(this, next);
+    }
+    else {
+        linkLeaves(prev, next);
+    }
+    updateCounters(node, -1, becomesLeaf);
+    
     children.erase(edgeToRemove);
-    auto indexIter = std::find_if(childIndex.begin(), childIndex.end(), [node](std::pair<TreeNode const*, TreeEdge const*> const &value){
-        return value.first == node;
-    });
-    childIndex.erase(indexIter);
+    updateChildIndex();
 }
 
-void TreeNode::calcLeaves(std::vector<TreeNode*> &leaves) {
-    if (isLeaf()) {
-        leaves.push_back(this);
-    } else {
-        for (auto &child : children) {
-            child->getTarget()->calcLeaves(leaves);
+void TreeNode::clearChildren() {
+    while ( not children.empty() ) {
+        remove(children.back()->getTarget());
+    }
+}
+
+void TreeNode::linkLeaves(TreeNode *first, TreeNode *second) {
+    if ( first != nullptr ) first->nextLeaf = second;
+    if ( second != nullptr ) second->prevLeaf = first;
+}
+
+void TreeNode::updateCounters(TreeNode const *child, const int sign, const bool changedLeaf) {
+    size_t depth = 0;
+    for ( TreeNode *n = this; n != nullptr; n = n->parent, ++ depth ) {
+        // The leaves of child have depth depth + 1 below n
+        const size_t childDepthSum = child->leafDepthSum + child->numLeaves * (depth + 1);
+        if ( sign > 0 ) {
+            n->numNodes += child->numNodes;
+            n->numLeaves += child->numLeaves;
+            n->leafDepthSum += childDepthSum;
+            if ( changedLeaf ) {
+                n->numLeaves -= 1;
+                n->leafDepthSum -= depth;
+            }
+        }
+        else {
+            if ( changedLeaf ) {
+                n->numLeaves += 1;
+                n->leafDepthSum += depth;
+            }
+            n->numNodes -= child->numNodes;
+            n->numLeaves -= child->numLeaves;
+            n->leafDepthSum -= childDepthSum;
         }
     }
 }
 
+TreeNode *TreeNode::getFirstLeaf() const {
+    TreeNode const *n = this;
+    while ( not n->children.empty() ) {
+        n = n->children.front()->getTarget();
+    }
+    return const_cast<TreeNode*>(n);
+}
+
+TreeNode *TreeNode::getLastLeaf() const {
+    TreeNode const *n = this;
+    while ( not n->children.empty() ) {
+        n = n->children.back()->getTarget();
+    }
+    return const_cast<TreeNode*>(n);
+}
+
+TreeNode *TreeNode::getNextLeaf() const {
+    return nextLeaf;
+}
+
+size_t TreeNode::getNumNodes() const {
+    return numNodes;
+}
+
+size_t TreeNode::getNumLeaves() const {
+    return numLeaves;
+}
+
+size_t TreeNode::getLeafDepthSum() const {
+    return leafDepthSum;
+}
+
+void TreeNode::calcLeaves(std::vector<TreeNode*> &leaves) {
+    TreeNode *last = getLastLeaf();
+    for (TreeNode *n = getFirstLeaf(); n != last; n = n->nextLeaf) {
+        leaves.push_back(n);
+    }
+    leaves.push_back(last);
+}
+
 void TreeNode::add(std::unique_ptr<TreeEdge> &&edge) {
-    edge->getTarget()->setParent(this);
-    childIndex.emplace_back(std::make_pair(edge->getTarget(), edge.get()));
+    TreeNode *child = edge->getTarget();
+    child->setParent(this);
+    
+    // The leaves of the new subtree follow the last leaf of this
+    // subtree, or take the place of this node if it is a leaf
+    const bool wasLeaf = isLeaf();
+    TreeNode *prev;
+    TreeNode *next;
+    if ( wasLeaf ) {
+        prev = prevLeaf;
+        next = nextLeaf;
+        prevLeaf = nullptr;
+        nextLeaf = nullptr;
+    }
+    else {
+        prev = getLastLeaf();
+        next = prev->nextLeaf;
+    }
+    linkLeaves(prev, child->getFirstLeaf());
+    linkLeaves(child->getLastLeaf(), next);
+    updateCounters(child, 1, wasLeaf);
+    
+    childIndex.insert(edge->getIO(), static_cast<int>(children.size()));
     children.emplace_back(std::move(edge));
 }
 
@@ -115,24 +247,17 @@ bool TreeNode::isLeaf() const {
 }
 
 int TreeNode::getIO(TreeNode const *node) const {
-    auto edge = std::find_if(childIndex.begin(), childIndex.end(), 
-        [&node](std::pair<TreeNode const*, TreeEdge const*> const &child){
-            return child.first == node;
+    auto edge = std::find_if(children.begin(), children.end(),
+        [&node](std::unique_ptr<TreeEdge> const &child){
+            return child->getTarget() == node;
     });
-    Expects(edge != childIndex.end());
-    return (*edge).second->getIO();
+    Expects(edge != children.end());
+    return (*edge)->getIO();
 }
 
 TreeEdge * TreeNode::hasEdge(TreeEdge const *edge) const
 {
-    auto edgeIter = std::find_if(children.begin(), children.end(), [edge](std::unique_ptr<TreeEdge> const &child){
-        return child->getIO() == edge->getIO();
-    });
-    if(edgeIter != children.end()) {
-        return edgeIter->get();
-    } else {
-        return nullptr;
-    }
+    return findEdge(edge->getIO());
 }
 
 vector<int> TreeNode::getPath() const
@@ -163,24 +288,15 @@ bool TreeNode::superTreeOf(TreeNode const *otherNode) const
     
     for (auto &eOther : otherNode->children)
     {
-        int y = eOther->getIO();
-        bool yFound = false;
+        TreeEdge const *eMine = findEdge(eOther->getIO());
         
-        for (auto &eMine : children)
+        /*If this node does not have an outgoing edge labelled with y, the nodes differ.*/
+        if (eMine == nullptr)
         {
-            if (y == eMine->getIO())
-            {
-                if (!eMine->getTarget()->superTreeOf(eOther->getTarget()))
-                {
-                    return false;
-                }
-                yFound = true;
-                break;
-            }
+            return false;
         }
         
-        /*If this node does not have an outgoing edge labelled with y, the nodes differ.*/
-        if (!yFound)
+        if (!eMine->getTarget()->superTreeOf(eOther->getTarget()))
         {
             return false;
         }
@@ -206,75 +322,67 @@ bool operator==(TreeNode const & treeNode1, TreeNode const & treeNode2)
      have been generated from the SAME input.*/
     for (auto &e : treeNode1.children)
     {
-        int y = e->getIO();
-        bool yFound = false;
+        TreeEdge const *eOther = treeNode2.findEdge(e->getIO());
         
-        for (auto &eOther : treeNode2.children)
+        /*If otherNode does not have an outgoing edge labelled with y, the nodes differ.*/
+        if (eOther == nullptr)
         {
-            if (y == eOther->getIO())
-            {
-                if (!(*e->getTarget() == *eOther->getTarget()))
-                {
-                    return false;
-                }
-                yFound = true;
-                break;
-            }
+            return false;
         }
         
-        /*If otherNode does not have an outgoing edge labelled with y, the nodes differ.*/
-        if (!yFound)
+        if (!(*e->getTarget() == *eOther->getTarget()))
         {
             return false;
         }
-        
     }
     return true;
 }
 
 TreeNode *TreeNode::add(const int x) {
-    for (auto &e : children) {
-        if (e->getIO() == x) {
-            return e->getTarget();
-        }
+    TreeEdge *e = findEdge(x);
+    if (e != nullptr) {
+        return e->getTarget();
     }
     
-    auto returnValue = new TreeNode();
-    std::unique_ptr<TreeNode> tgt { returnValue };
-    std::unique_ptr<TreeEdge> edge { new TreeEdge(x, std::move(tgt)) };
+    std::unique_ptr<TreeEdge> edge { new TreeEdge(x) };
+    auto returnValue = edge->getTarget();
     add(std::move(edge));
     return returnValue;
 }
 
 void TreeNode::add(vector<int>::const_iterator lstIte, const vector<int>::const_iterator end)
 {
-    /*There may be no next list element, when this method is called*/
+    /*Follow the existing edges labelled with the inputs of the list*/
+    TreeNode *n = this;
+    while (lstIte != end)
+    {
+        TreeEdge *e = n->findEdge(*lstIte);
+        if (e == nullptr)
+        {
+            break;
+        }
+        n = e->getTarget();
+        ++lstIte;
+    }
+    
+    /*There may be no next list element, when the list is contained in the tree*/
     if (lstIte == end)
     {
         return;
     }
     
-    /*Which input is represented by the list iterator?*/
-    int x = *lstIte;
-    
-    for (auto &e : getChildren())
+    /*The remaining inputs are built as a detached chain, starting with
+     its last edge, and attached to n with a single add(), so that the
+     counters of the ancestors of n are only updated once*/
+    auto ite = end;
+    std::unique_ptr<TreeEdge> chain { new TreeEdge(*(--ite)) };
+    while (ite != lstIte)
     {
-        /*Is there already an edge labelled with this input?*/
-        if (e->getIO() == x)
-        {
-            /*We do not need to extend the tree, but follow the existing edge*/
-            TreeNode *nTgt = e->getTarget();
-            nTgt->add(lstIte+1, end);
-            return;
-        }
+        std::unique_ptr<TreeEdge> newEdge { new TreeEdge(*(--ite)) };
+        newEdge->getTarget()->add(std::move(chain));
+        chain = std::move(newEdge);
     }
-    
-    /*No edge labelled with x exists for this node.
-     Therefore one has to be created*/
-    TreeNode *newNode = new TreeNode();
-    std::unique_ptr<TreeEdge> newEdge { new TreeEdge(x, std::unique_ptr<TreeNode>(newNode)) };
-    add(std::move(newEdge));
-    newNode->add(lstIte+1, end);
+    n->add(std::move(chain));
 }
 
 void TreeNode::add(IOListContainer tcl)
@@ -309,11 +417,8 @@ int TreeNode::tentativeAddToThisNode(vector<int>::const_iterator start,
     
     // Now we have to check whether an existing edge
     // is labelled with inout *start
-    int x = *start;
-    for ( auto &e : children ) {
-        if ( e->getIO() == x ) {
-            return tentativeAddToThisNode(++start,stop);
-        }
+    if ( findEdge(*start) != nullptr ) {
+        return tentativeAddToThisNode(++start,stop);
     }
     
     // Adding this trace requires a new branch in the tree,
@@ -340,12 +445,10 @@ int TreeNode::tentativeAddToThisNode(vector<int>::const_iterator start,
     
     // Now we have to check whether an existing edge
     // is labelled with inout *start
-    int x = *start;
-    for ( auto const &e : children ) {
-        if ( e->getIO() == x ) {
-            TreeNode *next = e->getTarget();
-            return next->tentativeAddToThisNode(++start,stop,n);
-        }
+    TreeEdge const *e = findEdge(*start);
+    if ( e != nullptr ) {
+        TreeNode *next = e->getTarget();
+        return next->tentativeAddToThisNode(++start,stop,n);
     }
     
     // Adding this trace requires a new branch in the tree,
@@ -374,14 +477,10 @@ TreeNode *TreeNode::after(vector<int>::const_iterator lstIte, const vector<int>:
 {
     if (lstIte != end)
     {
-        int x = *lstIte;
-        
-        for (auto &e : getChildren())
+        TreeEdge *e = findEdge(*lstIte);
+        if (e != nullptr)
         {
-            if (e->getIO() == x)
-            {
-                return e->getTarget()->after(lstIte+1, end);
-            }
+            return e->getTarget()->after(lstIte+1, end);
         }
         
         /*Could not find an edge labelled by x*/
@@ -396,29 +495,42 @@ TreeNode *TreeNode::after(vector<int>::const_iterator lstIte, const vector<int>:
 }
 
 void TreeNode::calcSize(size_t& theSize) {
-    theSize++;
-    for ( auto &t : children) {
-        t->getTarget()->calcSize(theSize);
-    }
+    theSize += numNodes;
 }
 
 
 
 void TreeNode::traverse(vector<int>& v,
                         std::vector<std::vector<int>> &ioll) {
-                        //IOListContainer::IOListBaseType &ioll) {
+    forEachPath(v, [&ioll](const vector<int>& lst) {
+        ioll.push_back(lst);
+    });
+}
+
+void TreeNode::forEachLeafPath(vector<int>& v,
+                               const IOListContainer::IOListVisitor& visitor) const {
+    if ( isLeaf() ) {
+        visitor(v);
+        return;
+    }
+    for ( auto const &e : children ) {
+        v.push_back(e->getIO());
+        e->getTarget()->forEachLeafPath(v, visitor);
+        v.pop_back();
+    }
+}
+
+void TreeNode::forEachPath(vector<int>& v,
+                           const IOListContainer::IOListVisitor& visitor) const {
     // traverse all edges to child nodes
-    for ( auto &e : children ) {
-        int io = e->getIO();
-        TreeNode *n = e->getTarget();
-        v.push_back(io);
-        
-        n->traverse(v,ioll);
+    for ( auto const &e : children ) {
+        v.push_back(e->getIO());
+        e->getTarget()->forEachPath(v, visitor);
         
         // Pop the last element in v
         v.pop_back();
     }
     
-    // add v to vector of I/O-lists
-    ioll.push_back(v);
+    // visit v after the I/O-lists extending it
+    visitor(v);
 }
@@ -10,10 +10,14 @@
 #include <memory>
 #include <vector>
 
+#include "trees/ChildIndex.h"
 #include "trees/IOListContainer.h"
-#include "trees/TreeEdge.h"
+
+class TreeEdge;
 
 class TreeNode {
+	friend class TreeEdge;
+
 protected:
 	/**
 	The parent of this node
@@ -21,19 +25,71 @@ protected:
 	TreeNode *parent;
 
 	/**
-	A list containing the children of this node
+	A list containing the children of this node, in the order
+	in which they have been added. Every edge holds its target node.
 	*/
 	std::vector<std::unique_ptr<TreeEdge>> children;
-	mutable std::vector<std::pair<TreeNode const*,TreeEdge const*>> childIndex;
+
+	/**
+	The positions of the children in the list, indexed by their labels
+	*/
+	ChildIndex childIndex;
 
 	/**
 	Mark this node as deleted
 	*/
 	bool deleted;
 
+	/**
+	Number of nodes, number of leaves and sum of the depths of the
+	leaves of the subtree rooted in this node. They are updated along
+	the path to the root whenever a child is added or removed.
+	*/
+	size_t numNodes;
+	size_t numLeaves;
+	size_t leafDepthSum;
+
+	/**
+	The leaves of a tree are linked in depth-first order, so that the
+	leaves of every subtree are consecutive. Only used by leaves.
+	*/
+	TreeNode *prevLeaf;
+	TreeNode *nextLeaf;
+
+	/**
+	Update the counters of this node and its ancestors after child
+	has been added to (sign > 0) or removed from (sign < 0) this node
+	@param changedLeaf true if this node was a leaf before adding
+	       child or is a leaf after removing it
+	*/
+	void updateCounters(TreeNode const *child, const int sign, const bool changedLeaf);
+
+	/**
+	Remove all children, keeping the counters and leaves consistent
+	*/
+	void clearChildren();
+
+	/**
+	Link two consecutive leaves, either of which may be missing
+	*/
+	static void linkLeaves(TreeNode *first, TreeNode *second);
+
+	/**
+	Create a copy of other and all its children
+	@param firstLeaf if not nullptr, set to the first leaf of the copy
+	@param lastLeaf if not nullptr, set to the last leaf of the copy
+	*/
+	TreeNode(TreeNode const &other, TreeNode **firstLeaf, TreeNode **lastLeaf);
+
 	//TODO
 	void add(std::vector<int>::const_iterator lstIte, const std::vector<int>::const_iterator end);
 	void updateChildIndex();
+
+	/**
+	Return the first edge to a child labelled with io, or nullptr
+	if there is none
+	*/
+	TreeEdge *findEdge(const int io) const;
     
 public:
 	/**
@@ -43,6 +99,7 @@ public:
     
 	TreeNode(TreeNode const &);
 	TreeNode(TreeNode &&other) = default;
+	~TreeNode();
 
     /**
      * Create a copy of this TreeNode and all its children
@@ -95,6 +152,40 @@ public:
 	*/
 	void remove(TreeNode const *node);
 
+	/**
+	Getter for the first leaf of the subtree rooted in this node,
+	in depth-first order
+	*/
+	TreeNode *getFirstLeaf() const;
+
+	/**
+	Getter for the last leaf of the subtree rooted in this node,
+	in depth-first order
+	*/
+	TreeNode *getLastLeaf() const;
+
+	/**
+	Getter for the leaf following this leaf in depth-first order
+	@return nullptr if this is the last leaf of the tree
+	*/
+	TreeNode *getNextLeaf() const;
+
+	/**
+	Getter for the number of nodes of the subtree rooted in this node
+	*/
+	size_t getNumNodes() const;
+
+	/**
+	Getter for the number of leaves of the subtree rooted in this node
+	*/
+	size_t getNumLeaves() const;
+
+	/**
+	Getter for the sum of the depths of the leaves of the subtree
+	rooted in this node, which is the total length of its I/O lists
+	*/
+	size_t getLeafDepthSum() const;
+
 	/**
 	Calc the list of leaves of this tree
 	@param leaves An empty list, it will be used to insert the leaves
@@ -209,5 +300,28 @@ public:
     void traverse(std::vector<int>& v,
                   std::vector<std::vector<int>> &ioll);
                   //IOListContainer::IOListBaseType &ioll);
+
+    /**
+     * Call visitor for the I/O-list of every leaf below this node,
+     * in depth-first order.
+     *
+     * @param v current I/O-list, extended by the labels from this node
+     *        to the leaf while visiting it and restored afterwards
+     * @param visitor called with v for every leaf
+     */
+    void forEachLeafPath(std::vector<int>& v,
+                         const IOListContainer::IOListVisitor& visitor) const;
+    
+    /**
+     * Call visitor for the I/O-list of every node below this node,
+     * in the order of traverse()
+     */
+    void forEachPath(std::vector<int>& v,
+                     const IOListContainer::IOListVisitor& visitor) const;
 };
+
+// TreeEdge holds its target node and therefore requires the complete
+// definition of TreeNode
+#include "trees/TreeEdge.h"
+
 #endif //FSM_TREES_TREENODE_H_
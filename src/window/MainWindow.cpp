@@ -311,7 +311,7 @@ void MainWindow::saveFile()
 
 	QFileInfo info = QFileInfo(fileName);
 	std::string baseName = (info.path() + "/" + info.completeBaseName()).toStdString();
-	std::shared_ptr<FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
+	std::shared_ptr<const FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
 
 	std::ofstream inputFile(baseName + ".in");
 	presentationLayer->dumpIn(inputFile);
@@ -385,9 +385,9 @@ void MainWindow::intersection()
 	}
 
 	std::shared_ptr<Fsm> otherFsm = fsms.at(i);
-	std::shared_ptr<FsmPresentationLayer> presentationLayer1 = currentFsm->getPresentationLayer();
-	std::shared_ptr<FsmPresentationLayer> presentationLayer2 = otherFsm->getPresentationLayer();
-	if (presentationLayer1->compare(presentationLayer2) == false)
+	std::shared_ptr<const FsmPresentationLayer> presentationLayer1 = currentFsm->getPresentationLayer();
+	std::shared_ptr<const FsmPresentationLayer> presentationLayer2 = otherFsm->getPresentationLayer();
+	if (presentationLayer1->compare(presentationLayer2.get()) == false)
 	{
 		QErrorMessage message;
 		message.showMessage("You cannot intersect these 2 FSM because they doesn't have the same input/output");
@@ -408,7 +408,7 @@ void MainWindow::wpMethod()
 		return;
 	}
 
-	std::shared_ptr<FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
+	std::shared_ptr<const FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
 	IOListContainer w = currentFsm->wpMethod(p);
 	storeTestCases(currentFsm->getName() + "_test_cases.txt", w);
 
@@ -432,7 +432,7 @@ void MainWindow::wMethod()
 	}
 
 	Dfsm dfsm = *currentFsm;
-	std::shared_ptr<FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
+	std::shared_ptr<const FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
 	IOListContainer w = dfsm.wpMethod(m);
 	storeTestCases(currentFsm->getName() + "_test_cases.txt", w);
 
@@ -448,7 +448,7 @@ void MainWindow::wMethod()
 void MainWindow::createTestSuite()
 {
 	QString fileName = QFileDialog::getOpenFileName(this, "FSM Viewer", QString(), "Test cases (*.txt)");
-	std::shared_ptr<FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
+	std::shared_ptr<const FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
 	IOListContainer w = readTestCases(fileName.toStdString());
 
 	TestSuite testSuite;
@@ -464,7 +464,7 @@ void MainWindow::createTestSuite()
 void MainWindow::createOutputTree()
 {
 	QString fileName = QFileDialog::getOpenFileName(this, "FSM Viewer", QString(), "Test case (*.txt)");
-	std::shared_ptr<FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
+	std::shared_ptr<const FsmPresentationLayer> presentationLayer = currentFsm->getPresentationLayer();
 	InputTrace inputTrace = InputTrace(readTestCase (fileName.toStdString()), presentationLayer);
 	OutputTree outputTree = currentFsm->apply(inputTrace);
 